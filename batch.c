@@ -0,0 +1,428 @@
+#define _GNU_SOURCE /* memrchr */
+#include "batch.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <split/parse.h>
+#include <split/print.h>
+#include <split/scan.h>
+#include <split/split.h>
+
+#define BLOCKS_PER_WORKER (2)
+#define ERROR_MESSAGE_SIZE (256)
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t size;
+} Buffer;
+
+/* Buffers are kept while the block goes around the pipeline */
+typedef struct {
+    size_t seq;
+    size_t first_line; /* 1-based */
+    Buffer input;      /* whole lines, only last line of input may have no newline */
+    Buffer output;
+    Buffer errors;
+    bool failed;       /* some line failed */
+    bool alloc_failed;
+} Block;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    Block** blocks;
+    int size;
+    int start;
+    int num;
+} BlockQueue;
+
+typedef struct {
+    InputStream* input;
+    const SplitTransformOptions* options;
+    ResultCache* cache;
+    int block_num;
+    int worker_num;
+
+    BlockQueue free_blocks; /* reader takes, writer returns */
+    BlockQueue work;        /* reader to workers, NULL stops a worker */
+
+    /* Processed blocks by seq % block_num, taken by writer in order */
+    pthread_mutex_t done_mutex;
+    pthread_cond_t done_cond;
+    Block** done;
+    bool is_read;
+    size_t block_total; /* set once read */
+    bool alloc_failed;
+} Pipeline;
+
+typedef struct {
+    Pipeline* pipeline;
+    pthread_t thread;
+    SplitContext* context;
+    PrintBuffer output;
+    char error_message[ERROR_MESSAGE_SIZE];
+} Worker;
+
+static bool pipeline_init(Pipeline* pipeline, int worker_num);
+static void pipeline_cleanup(Pipeline* pipeline);
+static void* reader_main(void* arg);
+static void* worker_main(void* arg);
+static bool write_blocks(Pipeline* pipeline, FILE* output);
+
+static void process_block(Worker* worker, Block* block);
+static void process_line(Worker* worker, Block* block, size_t line_num, const char* line, size_t len);
+static void append_cached_output(const char* data, size_t len, void* user_data);
+static size_t count_lines(const char* data, size_t len);
+
+static bool queue_init(BlockQueue* queue, int size);
+static void queue_cleanup(BlockQueue* queue);
+static void queue_push(BlockQueue* queue, Block* block);
+static Block* queue_pop(BlockQueue* queue);
+static void done_push(Pipeline* pipeline, Block* block);
+static Block* done_pop(Pipeline* pipeline, size_t seq);
+
+static bool buffer_append(Buffer* buffer, const char* data, size_t len);
+
+
+int batch(
+    InputStream* input, FILE* output, const SplitTransformOptions* options, int worker_num,
+    ResultCache* cache)
+{
+    Pipeline pipeline;
+    if (!pipeline_init(&pipeline, worker_num)) {
+        fprintf(stderr, "Failed to allocate pipeline\n");
+        return EXIT_FAILURE;
+    }
+    pipeline.input = input;
+    pipeline.options = options;
+    pipeline.cache = cache;
+
+    /* Workers, fewer are used if not all can be started */
+    Worker* workers = calloc(worker_num, sizeof(Worker));
+    if (!workers) {
+        fprintf(stderr, "Failed to allocate pipeline\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < worker_num; ++i) {
+        Worker* worker = &workers[i];
+        worker->pipeline = &pipeline;
+        print_buffer_init(&worker->output);
+        worker->context = split_context_new();
+        if (!worker->context) {
+            fprintf(stderr, "Failed to allocate split context\n");
+            exit(EXIT_FAILURE);
+        }
+        if (pthread_create(&worker->thread, NULL, &worker_main, worker) != 0)
+            break;
+        ++pipeline.worker_num;
+    }
+
+    /* Writer runs on calling thread */
+    pthread_t reader;
+    if (pipeline.worker_num == 0 || pthread_create(&reader, NULL, &reader_main, &pipeline) != 0) {
+        fprintf(stderr, "Failed to start pipeline\n");
+        exit(EXIT_FAILURE);
+    }
+    bool ok = write_blocks(&pipeline, output);
+
+    pthread_join(reader, NULL);
+    for (int i = 0; i < pipeline.worker_num; ++i)
+        pthread_join(workers[i].thread, NULL);
+    for (int i = 0; i < worker_num; ++i) {
+        if (workers[i].context)
+            split_context_free(workers[i].context);
+        print_buffer_free(&workers[i].output);
+    }
+    free(workers);
+
+    if (input_stream_error(input)) {
+        fprintf(stderr, "Failed to read data: %s\n", input_stream_error(input));
+        ok = false;
+    }
+    if (pipeline.alloc_failed) {
+        fprintf(stderr, "%s\n", wkt_parse_error_to_string(WktParseError_MemAllocFailed));
+        ok = false;
+    }
+    pipeline_cleanup(&pipeline);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+bool pipeline_init(Pipeline* pipeline, int worker_num) {
+    *pipeline = (Pipeline){0};
+    pipeline->block_num = worker_num * BLOCKS_PER_WORKER + 2;
+    pipeline->done = calloc(pipeline->block_num, sizeof(Block*));
+    if (!pipeline->done
+        || !queue_init(&pipeline->free_blocks, pipeline->block_num)
+        || !queue_init(&pipeline->work, pipeline->block_num + worker_num))
+        return false;
+    pthread_mutex_init(&pipeline->done_mutex, NULL);
+    pthread_cond_init(&pipeline->done_cond, NULL);
+
+    for (int i = 0; i < pipeline->block_num; ++i) {
+        Block* block = calloc(1, sizeof(Block));
+        if (!block)
+            return false;
+        queue_push(&pipeline->free_blocks, block);
+    }
+    return true;
+}
+
+
+void pipeline_cleanup(Pipeline* pipeline) {
+    /* All blocks are back in free queue */
+    Block* block;
+    while (pipeline->free_blocks.num > 0) {
+        block = queue_pop(&pipeline->free_blocks);
+        free(block->input.data);
+        free(block->output.data);
+        free(block->errors.data);
+        free(block);
+    }
+    queue_cleanup(&pipeline->free_blocks);
+    queue_cleanup(&pipeline->work);
+    pthread_mutex_destroy(&pipeline->done_mutex);
+    pthread_cond_destroy(&pipeline->done_cond);
+    free(pipeline->done);
+}
+
+
+void* reader_main(void* arg) {
+    Pipeline* pipeline = arg;
+    size_t seq = 0;
+    size_t line_num = 1;
+    Block* block = queue_pop(&pipeline->free_blocks);
+    block->input.len = 0;
+
+    const char* data;
+    size_t len;
+    bool ok = true;
+    while (ok && input_stream_next(pipeline->input, &data, &len)) {
+        /* Lines up to last newline complete current block, it is passed on once large enough */
+        const char* last_newline = memrchr(data, '\n', len);
+        size_t head_len = last_newline ? (size_t) (last_newline + 1 - data) : 0;
+        ok = buffer_append(&block->input, data, head_len);
+        if (ok && head_len > 0 && block->input.len >= BATCH_BLOCK_SIZE) {
+            block->seq = seq++;
+            block->first_line = line_num;
+            line_num += count_lines(block->input.data, block->input.len);
+            queue_push(&pipeline->work, block);
+
+            block = queue_pop(&pipeline->free_blocks);
+            block->input.len = 0;
+        }
+        ok = ok && buffer_append(&block->input, data + head_len, len - head_len);
+    }
+
+    /* Last block, a partial one is dropped on failure */
+    if (ok && block->input.len > 0) {
+        block->seq = seq++;
+        block->first_line = line_num;
+        queue_push(&pipeline->work, block);
+    } else {
+        queue_push(&pipeline->free_blocks, block);
+    }
+
+    pthread_mutex_lock(&pipeline->done_mutex);
+    pipeline->is_read = true;
+    pipeline->block_total = seq;
+    pipeline->alloc_failed = !ok;
+    pthread_cond_broadcast(&pipeline->done_cond);
+    pthread_mutex_unlock(&pipeline->done_mutex);
+
+    for (int i = 0; i < pipeline->worker_num; ++i)
+        queue_push(&pipeline->work, NULL);
+    return NULL;
+}
+
+
+void* worker_main(void* arg) {
+    Worker* worker = arg;
+    Pipeline* pipeline = worker->pipeline;
+    Block* block;
+    while ((block = queue_pop(&pipeline->work))) {
+        process_block(worker, block);
+        done_push(pipeline, block);
+    }
+    return NULL;
+}
+
+
+bool write_blocks(Pipeline* pipeline, FILE* output) {
+    /* After write failure blocks are still taken, so reader and workers can finish */
+    bool ok = true;
+    bool write_failed = false;
+    Block* block;
+    for (size_t seq = 0; (block = done_pop(pipeline, seq)); ++seq) {
+        if (!write_failed && fwrite(block->output.data, 1, block->output.len, output) != block->output.len) {
+            fprintf(stderr, "Failed to write data\n");
+            write_failed = true;
+        }
+        if (block->errors.len > 0)
+            fwrite(block->errors.data, 1, block->errors.len, stderr);
+        if (block->failed || block->alloc_failed)
+            ok = false;
+        if (block->alloc_failed)
+            fprintf(stderr, "%s\n", wkt_parse_error_to_string(WktParseError_MemAllocFailed));
+        queue_push(&pipeline->free_blocks, block);
+    }
+    return ok && !write_failed;
+}
+
+
+void process_block(Worker* worker, Block* block) {
+    block->output.len = 0;
+    block->errors.len = 0;
+    block->failed = false;
+    block->alloc_failed = false;
+
+    const char* cur = block->input.data;
+    const char* end = cur + block->input.len;
+    size_t line_num = block->first_line;
+    while (cur < end) {
+        const char* line_end = memchr(cur, '\n', end - cur);
+        if (!line_end)
+            line_end = end;
+        process_line(worker, block, line_num++, cur, line_end - cur);
+        cur = (line_end < end) ? line_end + 1 : end;
+    }
+}
+
+
+void process_line(Worker* worker, Block* block, size_t line_num, const char* line, size_t len) {
+    bool ok = true;
+    ResultCache* cache = worker->pipeline->cache;
+    if (scan_ws(line, len) < len && !(cache && result_cache_get(cache, line, len, &append_cached_output, block))) {
+        SplitTransformResult result = split_context_transform(
+            worker->context, line, len, SplitFormat_Wkt, SplitFormat_Wkt,
+            worker->pipeline->options, &worker->output);
+        if (!result.error) {
+            ok = buffer_append(&block->output, worker->output.data, worker->output.len)
+                && (!cache || result_cache_put(cache, line, len, worker->output.data, worker->output.len));
+        } else {
+            /* Same message as command line, with line number */
+            if (result.error == SplitTransformError_Parse) {
+                snprintf(worker->error_message, sizeof(worker->error_message), "Line %zu: (at %d) %s%s%s\n",
+                         line_num, (int) result.error_pos, wkt_parse_error_to_string(result.parse_error),
+                         result.message ? "\n" : "", result.message ? result.message : "");
+            } else {
+                snprintf(worker->error_message, sizeof(worker->error_message), "Line %zu: %s\n",
+                         line_num, split_transform_error_to_string(result.error));
+            }
+            ok = buffer_append(&block->errors, worker->error_message, strlen(worker->error_message));
+            block->failed = true;
+        }
+    }
+
+    /* Every line has an output line */
+    ok = ok && buffer_append(&block->output, "\n", 1);
+    if (!ok)
+        block->alloc_failed = true;
+}
+
+
+void append_cached_output(const char* data, size_t len, void* user_data) {
+    Block* block = user_data;
+    if (!buffer_append(&block->output, data, len))
+        block->alloc_failed = true;
+}
+
+
+size_t count_lines(const char* data, size_t len) {
+    size_t num = 0;
+    const char* end = data + len;
+    while ((data = memchr(data, '\n', end - data))) {
+        ++num;
+        ++data;
+    }
+    return num;
+}
+
+
+bool queue_init(BlockQueue* queue, int size) {
+    *queue = (BlockQueue){0};
+    queue->blocks = calloc(size, sizeof(Block*));
+    if (!queue->blocks)
+        return false;
+    queue->size = size;
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    return true;
+}
+
+
+void queue_cleanup(BlockQueue* queue) {
+    if (!queue->blocks)
+        return;
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->cond);
+    free(queue->blocks);
+    *queue = (BlockQueue){0};
+}
+
+
+void queue_push(BlockQueue* queue, Block* block) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->num == queue->size)
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    queue->blocks[(queue->start + queue->num) % queue->size] = block;
+    ++queue->num;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+
+Block* queue_pop(BlockQueue* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->num == 0)
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    Block* block = queue->blocks[queue->start];
+    queue->start = (queue->start + 1) % queue->size;
+    --queue->num;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    return block;
+}
+
+
+void done_push(Pipeline* pipeline, Block* block) {
+    /* Reader waits for a free block, so blocks in flight have distinct seq % block_num */
+    pthread_mutex_lock(&pipeline->done_mutex);
+    pipeline->done[block->seq % pipeline->block_num] = block;
+    pthread_cond_broadcast(&pipeline->done_cond);
+    pthread_mutex_unlock(&pipeline->done_mutex);
+}
+
+
+Block* done_pop(Pipeline* pipeline, size_t seq) {
+    /* NULL once all blocks are taken */
+    pthread_mutex_lock(&pipeline->done_mutex);
+    Block** slot = &pipeline->done[seq % pipeline->block_num];
+    while (!*slot && !(pipeline->is_read && seq == pipeline->block_total))
+        pthread_cond_wait(&pipeline->done_cond, &pipeline->done_mutex);
+    Block* block = *slot;
+    *slot = NULL;
+    pthread_mutex_unlock(&pipeline->done_mutex);
+    return block;
+}
+
+
+bool buffer_append(Buffer* buffer, const char* data, size_t len) {
+    if (len == 0)
+        return true;
+    if (buffer->len + len > buffer->size) {
+        size_t size = buffer->size ? buffer->size : BATCH_BLOCK_SIZE;
+        while (size < buffer->len + len)
+            size *= 2;
+        char* new_data = realloc(buffer->data, size);
+        if (!new_data)
+            return false;
+        buffer->data = new_data;
+        buffer->size = size;
+    }
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+    return true;
+}
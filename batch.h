@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdio.h>
+#include <split/transform.h>
+#include "cache.h"
+#include "stream.h"
+
+/*
+  Batch mode: input has one WKT geometry per line, output has the result of
+  each line on the same line number. Lines are processed by a pipeline of
+  three stages connected by bounded queues:
+
+    reader   frames lines into blocks of whole lines
+    workers  parse, split and print every line of a block
+    writer   writes result blocks in input order
+
+  The number of blocks in flight is fixed, so a slow stage stops the others
+  instead of buffering input. Blank lines stay blank; a line that fails is
+  left empty and its error is printed to stderr with the line number.
+  With a result cache, workers look every line up first and store outputs
+  of lines that succeeded.
+ */
+
+#define BATCH_BLOCK_SIZE (256 * 1024)
+
+/* Returns process exit status, failure if any line or reading/writing failed. Cache can be NULL */
+int batch(
+    InputStream* input, FILE* output, const SplitTransformOptions* options, int worker_num,
+    ResultCache* cache);
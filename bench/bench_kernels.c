@@ -0,0 +1,590 @@
+/*
+  Micro-benchmark of geometric kernels, reports time and cycles per call
+  for typical and degenerate inputs. Inputs come from fixed seeds, so runs
+  are comparable between builds.
+
+  Kernels private to the library are declared in src/split_internal.h.
+
+  $ ./bench_kernels [<kernel name substring>]
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <h3/h3api.h>
+#include <split/alloc.h>
+#include <split/bbox3.h>
+#include <split/h3.h>
+#include <split/vect3.h>
+#include "../src/split_internal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+# define HAVE_TSC 1
+#else
+# define HAVE_TSC 0
+#endif
+
+#define INPUT_NUM (1024)
+#define OP_NUM (4000000)
+#define RING_VERTEX_NUM (64)
+#define LOOP_VERTEX_NUM (256)
+
+typedef struct {
+    struct timespec start_time;
+    uint64_t start_cycles;
+    double ns;
+    double cycles;
+} Timer;
+
+typedef struct {
+    double lat;
+    double lng;
+    double radius;
+} RingShape;
+
+static const char* filter = NULL;
+static volatile double sink = 0.0;
+
+static uint64_t rng_next(uint64_t* state);
+static double rng_range(uint64_t* state, double min, double max);
+static void random_latlng(uint64_t* state, LatLng* latlng);
+static void random_vect3(uint64_t* state, Vect3* vect);
+static void random_segment(uint64_t* state, double len, Vect3* v1, Vect3* v2);
+static void latlng_degs(double lat, double lng, LatLng* latlng);
+static void arc_point(const Vect3* v1, const Vect3* v2, double t, Vect3* p);
+static LinkedGeoLoop* create_ring(uint64_t* state, const RingShape* shape, int vertex_num);
+
+static uint64_t read_cycles();
+static void timer_start(Timer* timer);
+static void timer_stop(Timer* timer, long op_num);
+static bool is_selected(const char* kernel);
+static void report(const char* kernel, const char* input, const Timer* timer);
+
+static void bench_vect3_from_lat_lng(const char* input, const LatLng* coords, int num);
+static void bench_vect3_to_lat_lng(const char* input, const Vect3* vects, int num);
+static void bench_bbox3_from_segment_vect3(const char* input, const Vect3* v1s, const Vect3* v2s, int num);
+static void bench_bbox3_from_linked_loop(const char* input, const LinkedGeoLoop* loop, int vertex_num);
+static void bench_segment_intersect(
+    const char* input, const Vect3* v1s, const Vect3* v2s, const Vect3* u1s, const Vect3* u2s, int num);
+static void bench_point_between(
+    const char* input, const Vect3* v1s, const Vect3* v2s, const Vect3* ps, int num);
+static void bench_split_180_lat(const char* input, const LatLng* coords1, const LatLng* coords2, int num);
+static void bench_latlng_ring_pos(
+    const char* input, const LinkedGeoLoop* ring, const LatLng* latlngs, int num, int vertex_num);
+
+static void run_vect3();
+static void run_bbox3();
+static void run_segment_intersect();
+static void run_point_between();
+static void run_split_180_lat();
+static void run_latlng_ring_pos();
+
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        printf("Usage: %s [<kernel name substring>]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (argc == 2)
+        filter = argv[1];
+
+    printf("%-26s %-12s %10s %12s\n", "kernel", "input", "ns/op", "cycles/op");
+    run_vect3();
+    run_bbox3();
+    run_segment_intersect();
+    run_point_between();
+    run_split_180_lat();
+    run_latlng_ring_pos();
+#if !HAVE_TSC
+    printf("(cycle counter not available on this platform)\n");
+#endif
+}
+
+
+void run_vect3() {
+    static LatLng coords[INPUT_NUM];
+    static Vect3 vects[INPUT_NUM];
+    uint64_t seed = 1;
+
+    for (int i = 0; i < INPUT_NUM; ++i)
+        random_latlng(&seed, &coords[i]);
+    bench_vect3_from_lat_lng("typical", coords, INPUT_NUM);
+
+    /* Poles, antimeridian and zero */
+    const double values[][2] = {{90, 0}, {-90, 180}, {0, 180}, {0, -180}, {0, 0}, {-0.0, -0.0}};
+    const int value_num = sizeof(values) / sizeof(values[0]);
+    for (int i = 0; i < INPUT_NUM; ++i)
+        latlng_degs(values[i % value_num][0], values[i % value_num][1], &coords[i]);
+    bench_vect3_from_lat_lng("degenerate", coords, INPUT_NUM);
+
+    seed = 2;
+    for (int i = 0; i < INPUT_NUM; ++i)
+        random_vect3(&seed, &vects[i]);
+    bench_vect3_to_lat_lng("typical", vects, INPUT_NUM);
+
+    for (int i = 0; i < INPUT_NUM; ++i)
+        vect3_from_lat_lng(&coords[i], &vects[i]);
+    bench_vect3_to_lat_lng("degenerate", vects, INPUT_NUM);
+}
+
+
+void run_bbox3() {
+    static Vect3 v1s[INPUT_NUM];
+    static Vect3 v2s[INPUT_NUM];
+    uint64_t seed = 3;
+
+    /* Short segments, as in detailed input */
+    for (int i = 0; i < INPUT_NUM; ++i)
+        random_segment(&seed, 0.02, &v1s[i], &v2s[i]);
+    bench_bbox3_from_segment_vect3("typical", v1s, v2s, INPUT_NUM);
+
+    /* Long segments with extremes inside the arc */
+    for (int i = 0; i < INPUT_NUM; ++i)
+        random_segment(&seed, 2.5, &v1s[i], &v2s[i]);
+    bench_bbox3_from_segment_vect3("long", v1s, v2s, INPUT_NUM);
+
+    /* Equal endpoints and segments through a pole */
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        LatLng c1, c2;
+        if (i % 2 == 0) {
+            random_vect3(&seed, &v1s[i]);
+            v2s[i] = v1s[i];
+        } else {
+            latlng_degs(80, rng_range(&seed, -180, 180), &c1);
+            latlng_degs(80, c1.lng * 180 / M_PI + 180, &c2);
+            vect3_from_lat_lng(&c1, &v1s[i]);
+            vect3_from_lat_lng(&c2, &v2s[i]);
+        }
+    }
+    bench_bbox3_from_segment_vect3("degenerate", v1s, v2s, INPUT_NUM);
+
+    seed = 4;
+    RingShape shape = {10, 170, 8};
+    LinkedGeoLoop* loop = create_ring(&seed, &shape, LOOP_VERTEX_NUM);
+    bench_bbox3_from_linked_loop("typical", loop, LOOP_VERTEX_NUM);
+    free_linked_geo_loop(loop);
+
+    /* Every vertex repeated, zero length segments are skipped */
+    loop = create_ring(&seed, &shape, LOOP_VERTEX_NUM / 2);
+    for (LinkedLatLng* point = loop->first; point; point = point->next->next) {
+        LinkedLatLng* copy = split_malloc(sizeof(LinkedLatLng));
+        *copy = *point;
+        point->next = copy;
+        if (loop->last == point)
+            loop->last = copy;
+    }
+    bench_bbox3_from_linked_loop("degenerate", loop, LOOP_VERTEX_NUM);
+    free_linked_geo_loop(loop);
+}
+
+
+void run_segment_intersect() {
+    static Vect3 v1s[INPUT_NUM];
+    static Vect3 v2s[INPUT_NUM];
+    static Vect3 u1s[INPUT_NUM];
+    static Vect3 u2s[INPUT_NUM];
+    uint64_t seed = 5;
+
+    /* Short segments around the same point, about half of them intersect */
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        Vect3 center;
+        random_segment(&seed, 0.02, &v1s[i], &v2s[i]);
+        arc_point(&v1s[i], &v2s[i], 0.5, &center);
+        LatLng c, c1, c2;
+        vect3_to_lat_lng(&center, &c);
+        double angle = rng_range(&seed, 0, M_PI);
+        c1.lat = c.lat + 0.01 * cos(angle) + rng_range(&seed, -0.005, 0.005);
+        c1.lng = c.lng + 0.01 * sin(angle);
+        c2.lat = c.lat - 0.01 * cos(angle);
+        c2.lng = c.lng - 0.01 * sin(angle) + rng_range(&seed, -0.005, 0.005);
+        vect3_from_lat_lng(&c1, &u1s[i]);
+        vect3_from_lat_lng(&c2, &u2s[i]);
+    }
+    bench_segment_intersect("typical", v1s, v2s, u1s, u2s, INPUT_NUM);
+
+    /* Shared endpoints, endpoints on the other arc and overlapping arcs */
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        random_segment(&seed, 0.02, &v1s[i], &v2s[i]);
+        switch (i % 3) {
+            case 0:
+                u1s[i] = v2s[i];
+                random_vect3(&seed, &u2s[i]);
+                break;
+            case 1:
+                arc_point(&v1s[i], &v2s[i], rng_range(&seed, 0.1, 0.9), &u1s[i]);
+                random_vect3(&seed, &u2s[i]);
+                break;
+            default:
+                arc_point(&v1s[i], &v2s[i], 0.5, &u1s[i]);
+                arc_point(&v1s[i], &v2s[i], 1.5, &u2s[i]);
+                break;
+        }
+    }
+    bench_segment_intersect("degenerate", v1s, v2s, u1s, u2s, INPUT_NUM);
+}
+
+
+void run_point_between() {
+    static Vect3 v1s[INPUT_NUM];
+    static Vect3 v2s[INPUT_NUM];
+    static Vect3 ps[INPUT_NUM];
+    uint64_t seed = 6;
+
+    /* Points on the great circle, inside and outside the arc */
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        random_segment(&seed, 0.02, &v1s[i], &v2s[i]);
+        arc_point(&v1s[i], &v2s[i], rng_range(&seed, -1, 2), &ps[i]);
+    }
+    bench_point_between("typical", v1s, v2s, ps, INPUT_NUM);
+
+    /* Endpoints and points next to them */
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        random_segment(&seed, 0.02, &v1s[i], &v2s[i]);
+        switch (i % 3) {
+            case 0: ps[i] = v1s[i]; break;
+            case 1: ps[i] = v2s[i]; break;
+            default: arc_point(&v1s[i], &v2s[i], 1e-12, &ps[i]); break;
+        }
+    }
+    bench_point_between("degenerate", v1s, v2s, ps, INPUT_NUM);
+}
+
+
+void run_split_180_lat() {
+    static LatLng coords1[INPUT_NUM];
+    static LatLng coords2[INPUT_NUM];
+    uint64_t seed = 7;
+
+    /* Segments crossing antimeridian */
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        latlng_degs(rng_range(&seed, -80, 80), rng_range(&seed, 170, 180), &coords1[i]);
+        latlng_degs(rng_range(&seed, -80, 80), rng_range(&seed, -180, -170), &coords2[i]);
+    }
+    bench_split_180_lat("typical", coords1, coords2, INPUT_NUM);
+
+    /* Endpoints on antimeridian, near poles and on meridians */
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        switch (i % 3) {
+            case 0:
+                latlng_degs(rng_range(&seed, -80, 80), 180, &coords1[i]);
+                latlng_degs(rng_range(&seed, -80, 80), -179, &coords2[i]);
+                break;
+            case 1:
+                latlng_degs(89.999, 179, &coords1[i]);
+                latlng_degs(89.999, -179, &coords2[i]);
+                break;
+            default:
+                latlng_degs(10, 180, &coords1[i]);
+                latlng_degs(20, -180, &coords2[i]);
+                break;
+        }
+    }
+    bench_split_180_lat("degenerate", coords1, coords2, INPUT_NUM);
+}
+
+
+void run_latlng_ring_pos() {
+    static LatLng latlngs[INPUT_NUM];
+    uint64_t seed = 8;
+
+    /* Ring east of antimeridian, points inside and around it */
+    RingShape shape = {10, 170, 8};
+    LinkedGeoLoop* ring = create_ring(&seed, &shape, RING_VERTEX_NUM);
+    for (int i = 0; i < INPUT_NUM; ++i)
+        latlng_degs(shape.lat + rng_range(&seed, -8, 8), shape.lng + rng_range(&seed, -8, 8), &latlngs[i]);
+    bench_latlng_ring_pos("typical", ring, latlngs, INPUT_NUM, RING_VERTEX_NUM);
+
+    /* Ring vertices and points on ring segments */
+    const LinkedLatLng* point = ring->first;
+    for (int i = 0; i < INPUT_NUM; ++i) {
+        const LinkedLatLng* next = point->next ? point->next : ring->first;
+        if (i % 2 == 0) {
+            latlngs[i] = point->vertex;
+        } else {
+            Vect3 v1, v2, p;
+            vect3_from_lat_lng(&point->vertex, &v1);
+            vect3_from_lat_lng(&next->vertex, &v2);
+            arc_point(&v1, &v2, 0.5, &p);
+            vect3_to_lat_lng(&p, &latlngs[i]);
+        }
+        point = next;
+    }
+    bench_latlng_ring_pos("degenerate", ring, latlngs, INPUT_NUM, RING_VERTEX_NUM);
+    free_linked_geo_loop(ring);
+}
+
+
+void bench_vect3_from_lat_lng(const char* input, const LatLng* coords, int num) {
+    if (!is_selected("vect3_from_lat_lng"))
+        return;
+    Timer timer;
+    double sum = 0.0;
+    timer_start(&timer);
+    for (int round = 0; round < OP_NUM / num; ++round) {
+        for (int i = 0; i < num; ++i) {
+            Vect3 vect;
+            vect3_from_lat_lng(&coords[i], &vect);
+            sum += vect.x;
+        }
+    }
+    timer_stop(&timer, OP_NUM / num * num);
+    sink += sum;
+    report("vect3_from_lat_lng", input, &timer);
+}
+
+
+void bench_vect3_to_lat_lng(const char* input, const Vect3* vects, int num) {
+    if (!is_selected("vect3_to_lat_lng"))
+        return;
+    Timer timer;
+    double sum = 0.0;
+    timer_start(&timer);
+    for (int round = 0; round < OP_NUM / num; ++round) {
+        for (int i = 0; i < num; ++i) {
+            LatLng coord;
+            vect3_to_lat_lng(&vects[i], &coord);
+            sum += coord.lat;
+        }
+    }
+    timer_stop(&timer, OP_NUM / num * num);
+    sink += sum;
+    report("vect3_to_lat_lng", input, &timer);
+}
+
+
+void bench_bbox3_from_segment_vect3(const char* input, const Vect3* v1s, const Vect3* v2s, int num) {
+    if (!is_selected("bbox3_from_segment_vect3"))
+        return;
+    Timer timer;
+    double sum = 0.0;
+    timer_start(&timer);
+    for (int round = 0; round < OP_NUM / num; ++round) {
+        for (int i = 0; i < num; ++i) {
+            Bbox3 bbox;
+            bbox3_from_segment_vect3(&bbox, &v1s[i], &v2s[i]);
+            sum += bbox.zmax;
+        }
+    }
+    timer_stop(&timer, OP_NUM / num * num);
+    sink += sum;
+    report("bbox3_from_segment_vect3", input, &timer);
+}
+
+
+void bench_bbox3_from_linked_loop(const char* input, const LinkedGeoLoop* loop, int vertex_num) {
+    if (!is_selected("bbox3_from_linked_loop"))
+        return;
+
+    /* Reported per loop vertex */
+    Timer timer;
+    double sum = 0.0;
+    int round_num = OP_NUM / vertex_num;
+    timer_start(&timer);
+    for (int round = 0; round < round_num; ++round) {
+        Bbox3 bbox;
+        bbox3_from_linked_loop(&bbox, loop);
+        sum += bbox.zmax;
+    }
+    timer_stop(&timer, (long) round_num * vertex_num);
+    sink += sum;
+    report("bbox3_from_linked_loop", input, &timer);
+}
+
+
+void bench_segment_intersect(
+    const char* input, const Vect3* v1s, const Vect3* v2s, const Vect3* u1s, const Vect3* u2s, int num)
+{
+    if (!is_selected("segment_intersect"))
+        return;
+    Timer timer;
+    long sum = 0;
+    timer_start(&timer);
+    for (int round = 0; round < OP_NUM / num; ++round) {
+        for (int i = 0; i < num; ++i)
+            sum += segment_intersect(&v1s[i], &v2s[i], &u1s[i], &u2s[i]);
+    }
+    timer_stop(&timer, OP_NUM / num * num);
+    sink += sum;
+    report("segment_intersect", input, &timer);
+}
+
+
+void bench_point_between(
+    const char* input, const Vect3* v1s, const Vect3* v2s, const Vect3* ps, int num)
+{
+    if (!is_selected("point_between"))
+        return;
+    Timer timer;
+    long sum = 0;
+    timer_start(&timer);
+    for (int round = 0; round < OP_NUM / num; ++round) {
+        for (int i = 0; i < num; ++i)
+            sum += point_between(&v1s[i], &v2s[i], &ps[i]);
+    }
+    timer_stop(&timer, OP_NUM / num * num);
+    sink += sum;
+    report("point_between", input, &timer);
+}
+
+
+void bench_split_180_lat(const char* input, const LatLng* coords1, const LatLng* coords2, int num) {
+    if (!is_selected("split_180_lat"))
+        return;
+    Timer timer;
+    double sum = 0.0;
+    timer_start(&timer);
+    for (int round = 0; round < OP_NUM / num; ++round) {
+        for (int i = 0; i < num; ++i)
+            sum += split_180_lat(&coords1[i], &coords2[i]);
+    }
+    timer_stop(&timer, OP_NUM / num * num);
+    sink += sum;
+    report("split_180_lat", input, &timer);
+}
+
+
+void bench_latlng_ring_pos(
+    const char* input, const LinkedGeoLoop* ring, const LatLng* latlngs, int num, int vertex_num)
+{
+    if (!is_selected("latlng_ring_pos"))
+        return;
+
+    SplitLine line = {SplitLineType_180, 0.0};
+    Bbox3 bbox;
+    bbox3_from_linked_loop(&bbox, ring);
+
+    /* Each call walks the ring, fewer calls keep run time comparable */
+    Timer timer;
+    long sum = 0;
+    int round_num = OP_NUM / vertex_num / num;
+    if (round_num < 1)
+        round_num = 1;
+    timer_start(&timer);
+    for (int round = 0; round < round_num; ++round) {
+        for (int i = 0; i < num; ++i)
+            sum += latlng_ring_pos(&line, ring, 1, &bbox, &latlngs[i]);
+    }
+    timer_stop(&timer, (long) round_num * num);
+    sink += sum;
+    report("latlng_ring_pos", input, &timer);
+}
+
+
+uint64_t rng_next(uint64_t* state) {
+    /* splitmix64, good enough for inputs and reproducible everywhere */
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+double rng_range(uint64_t* state, double min, double max) {
+    return min + (max - min) * (rng_next(state) >> 11) * 0x1.0p-53;
+}
+
+
+void random_latlng(uint64_t* state, LatLng* latlng) {
+    /* Uniform on the sphere */
+    latlng->lat = asin(rng_range(state, -1, 1));
+    latlng->lng = rng_range(state, -M_PI, M_PI);
+}
+
+
+void random_vect3(uint64_t* state, Vect3* vect) {
+    LatLng latlng;
+    random_latlng(state, &latlng);
+    vect3_from_lat_lng(&latlng, vect);
+}
+
+
+void random_segment(uint64_t* state, double len, Vect3* v1, Vect3* v2) {
+    /* Segment of about len radians in random direction */
+    LatLng c1, c2;
+    random_latlng(state, &c1);
+    c1.lat *= 0.9;
+    double angle = rng_range(state, 0, 2 * M_PI);
+    c2.lat = c1.lat + len * cos(angle) * 0.5;
+    c2.lng = c1.lng + len * sin(angle);
+    if (c2.lng > M_PI) c2.lng -= 2 * M_PI;
+    if (c2.lng < -M_PI) c2.lng += 2 * M_PI;
+    vect3_from_lat_lng(&c1, v1);
+    vect3_from_lat_lng(&c2, v2);
+}
+
+
+void latlng_degs(double lat, double lng, LatLng* latlng) {
+    latlng->lat = degsToRads(lat);
+    latlng->lng = degsToRads(lng);
+}
+
+
+void arc_point(const Vect3* v1, const Vect3* v2, double t, Vect3* p) {
+    /* Point on the great circle of v1/v2, t = 0 and t = 1 are the endpoints */
+    Vect3 d;
+    vect3_diff(v2, v1, &d);
+    vect3_scale(&d, t);
+    vect3_sum(v1, &d, p);
+    vect3_normalize(p);
+}
+
+
+LinkedGeoLoop* create_ring(uint64_t* state, const RingShape* shape, int vertex_num) {
+    /* Star-shaped ring */
+    LinkedGeoLoop* ring = split_malloc(sizeof(LinkedGeoLoop));
+    *ring = (LinkedGeoLoop){0};
+    for (int i = 0; i < vertex_num; ++i) {
+        double angle = 2 * M_PI * (i + rng_range(state, 0, 0.9)) / vertex_num;
+        double r = shape->radius * rng_range(state, 0.5, 1);
+        LinkedLatLng* point = split_malloc(sizeof(LinkedLatLng));
+        *point = (LinkedLatLng){0};
+        latlng_degs(shape->lat + r * sin(angle), shape->lng + r * cos(angle), &point->vertex);
+        add_linked_latlng(ring, point);
+    }
+    return ring;
+}
+
+
+uint64_t read_cycles() {
+#if HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+void timer_start(Timer* timer) {
+    clock_gettime(CLOCK_MONOTONIC, &timer->start_time);
+    timer->start_cycles = read_cycles();
+}
+
+
+void timer_stop(Timer* timer, long op_num) {
+    uint64_t cycles = read_cycles() - timer->start_cycles;
+    struct timespec end_time;
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    double ns = (end_time.tv_sec - timer->start_time.tv_sec) * 1e9
+        + (end_time.tv_nsec - timer->start_time.tv_nsec);
+    timer->ns = ns / op_num;
+    timer->cycles = (double) cycles / op_num;
+}
+
+
+bool is_selected(const char* kernel) {
+    return !filter || strstr(kernel, filter);
+}
+
+
+void report(const char* kernel, const char* input, const Timer* timer) {
+    /* Cycles are reference (TSC) cycles, they do not follow frequency scaling */
+    if (HAVE_TSC)
+        printf("%-26s %-12s %10.2f %12.2f\n", kernel, input, timer->ns, timer->cycles);
+    else
+        printf("%-26s %-12s %10.2f %12s\n", kernel, input, timer->ns, "-");
+    fflush(stdout);
+}
@@ -0,0 +1,253 @@
+/*
+  Benchmark of whole polygon splits, reports time per operation. Inputs come
+  from fixed seeds, so runs are comparable between builds.
+
+    fast_path  split of small star-shaped rings crossing antimeridian or
+               a parallel, general path and single ring fast path
+    edit       SplitEdit of a ring with 2M vertices crossed twice: initial
+               split and replacement of 10 vertices away from crossings
+
+  $ ./bench_split [<benchmark name substring>]
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <h3/h3api.h>
+#include <split/h3.h>
+#include <split/split.h>
+
+#define POLYGON_NUM (2000)
+#define ROUND_NUM (20)
+#define EDIT_VERTEX_NUM (2000000)
+#define EDIT_NUM (1000)
+
+typedef enum {
+    SplitKind_180 = 0,
+    SplitKind_Parallel
+} SplitKind;
+
+typedef struct {
+    struct timespec start_time;
+    double ns;
+} Timer;
+
+static const double BandLat = 30.0;
+
+static const char* filter = NULL;
+
+static uint64_t rng_next(uint64_t* state);
+static double rng_range(uint64_t* state, double min, double max);
+static LinkedGeoPolygon* create_star_polygon(uint64_t* state, SplitKind kind);
+static const char* split_kind_name(SplitKind kind);
+static bool split_kind(
+    SplitContext* context, SplitKind kind, const LinkedGeoPolygon* polygon);
+static void free_polygon(LinkedGeoPolygon* polygon, void* user_data);
+
+static void timer_start(Timer* timer);
+static void timer_stop(Timer* timer, long op_num);
+static bool is_selected(const char* name);
+static void report(const char* name, const char* input, const Timer* timer);
+
+static void run_fast_path();
+static void bench_fast_path(SplitKind kind);
+static void run_edit();
+static LatLng edit_vertex(int idx, double radius);
+
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        printf("Usage: %s [<benchmark name substring>]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (argc == 2)
+        filter = argv[1];
+
+    printf("%-26s %-20s %12s\n", "benchmark", "input", "ns/op");
+    run_fast_path();
+    run_edit();
+}
+
+
+void run_fast_path() {
+    if (!is_selected("fast_path"))
+        return;
+    bench_fast_path(SplitKind_180);
+    bench_fast_path(SplitKind_Parallel);
+}
+
+
+void bench_fast_path(SplitKind kind) {
+    uint64_t seed = 1;
+    LinkedGeoPolygon* polygons[POLYGON_NUM];
+    for (int i = 0; i < POLYGON_NUM; ++i)
+        polygons[i] = create_star_polygon(&seed, kind);
+
+    SplitContext* context = split_context_new();
+    for (int fast = 0; fast <= 1; ++fast) {
+        split_context_set_fast_path(context, fast);
+        Timer timer;
+        timer_start(&timer);
+        for (int round = 0; round < ROUND_NUM; ++round) {
+            for (int i = 0; i < POLYGON_NUM; ++i) {
+                if (!split_kind(context, kind, polygons[i])) {
+                    printf("Failed to split polygon\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        timer_stop(&timer, (long) ROUND_NUM * POLYGON_NUM);
+
+        char input[32];
+        snprintf(input, sizeof(input), "%s %s", split_kind_name(kind), fast ? "fast" : "general");
+        report("fast_path", input, &timer);
+    }
+    split_context_free(context);
+
+    for (int i = 0; i < POLYGON_NUM; ++i)
+        free_linked_geo_polygon(polygons[i]);
+}
+
+
+void run_edit() {
+    if (!is_selected("edit"))
+        return;
+
+    /* Long ring around a point on antimeridian, crossed twice */
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    LinkedGeoLoop* ring = calloc(1, sizeof(LinkedGeoLoop));
+    add_linked_geo_loop(polygon, ring);
+    for (int i = 0; i < EDIT_VERTEX_NUM; ++i) {
+        LinkedLatLng* point = calloc(1, sizeof(LinkedLatLng));
+        point->vertex = edit_vertex(i, 30);
+        add_linked_latlng(ring, point);
+    }
+
+    Timer timer;
+    timer_start(&timer);
+    SplitEdit* edit = split_edit_new(polygon);
+    timer_stop(&timer, 1);
+    free_linked_geo_polygon(polygon);
+    if (!edit) {
+        printf("Failed to create split edit\n");
+        exit(EXIT_FAILURE);
+    }
+    report("edit", "init", &timer);
+
+    uint64_t seed = 2;
+    timer_start(&timer);
+    for (int i = 0; i < EDIT_NUM; ++i) {
+        int idx = EDIT_VERTEX_NUM / 4 + 100 + rng_next(&seed) % (EDIT_VERTEX_NUM / 2 - 200);
+        LatLng vertices[10];
+        for (int j = 0; j < 10; ++j)
+            vertices[j] = edit_vertex(idx + j, rng_range(&seed, 29.9, 30.1));
+        if (!split_edit_replace(edit, 0, idx, 10, vertices, 10)) {
+            printf("Failed to replace vertices\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    timer_stop(&timer, EDIT_NUM);
+    report("edit", "10-vertex replace", &timer);
+    split_edit_free(edit);
+}
+
+
+LatLng edit_vertex(int idx, double radius) {
+    double angle = 2 * M_PI * idx / EDIT_VERTEX_NUM;
+    double lng = 180 + radius * cos(angle);
+    if (lng > 180)
+        lng -= 360;
+    LatLng vertex = {degsToRads(radius * sin(angle)), degsToRads(lng)};
+    return vertex;
+}
+
+
+uint64_t rng_next(uint64_t* state) {
+    /* splitmix64, as in bench_kernels */
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+double rng_range(uint64_t* state, double min, double max) {
+    return min + (max - min) * (rng_next(state) >> 11) * 0x1.0p-53;
+}
+
+
+LinkedGeoPolygon* create_star_polygon(uint64_t* state, SplitKind kind) {
+    /* Star-shaped ring around a center near the split line */
+    double center_lat, center_lng;
+    if (kind == SplitKind_180) {
+        center_lat = rng_range(state, -60, 60);
+        center_lng = 180 + rng_range(state, -3, 3);
+    } else {
+        center_lat = BandLat + rng_range(state, -3, 3);
+        center_lng = rng_range(state, -160, 160);
+    }
+    double radius = rng_range(state, 0.5, 10);
+    int vertex_num = 3 + rng_next(state) % 62;
+
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    LinkedGeoLoop* ring = calloc(1, sizeof(LinkedGeoLoop));
+    add_linked_geo_loop(polygon, ring);
+    for (int i = 0; i < vertex_num; ++i) {
+        double angle = 2 * M_PI * (i + rng_range(state, 0, 0.9)) / vertex_num;
+        double r = radius * rng_range(state, 0.5, 1);
+        double lng = center_lng + r * cos(angle);
+        if (lng > 180) lng -= 360;
+
+        LinkedLatLng* point = calloc(1, sizeof(LinkedLatLng));
+        point->vertex.lat = degsToRads(center_lat + r * sin(angle));
+        point->vertex.lng = degsToRads(lng);
+        add_linked_latlng(ring, point);
+    }
+    return polygon;
+}
+
+
+const char* split_kind_name(SplitKind kind) {
+    return (kind == SplitKind_180) ? "antimeridian" : "parallel";
+}
+
+
+bool split_kind(SplitContext* context, SplitKind kind, const LinkedGeoPolygon* polygon) {
+    double lat = degsToRads(BandLat);
+    return (kind == SplitKind_180)
+        ? split_context_by_180(context, polygon, &free_polygon, NULL)
+        : split_context_by_parallels(context, polygon, &lat, 1, &free_polygon, NULL);
+}
+
+
+void free_polygon(LinkedGeoPolygon* polygon, void* user_data) {
+    free_linked_geo_polygon(polygon);
+}
+
+
+void timer_start(Timer* timer) {
+    clock_gettime(CLOCK_MONOTONIC, &timer->start_time);
+}
+
+
+void timer_stop(Timer* timer, long op_num) {
+    struct timespec end_time;
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    double ns = (end_time.tv_sec - timer->start_time.tv_sec) * 1e9
+        + (end_time.tv_nsec - timer->start_time.tv_nsec);
+    timer->ns = ns / op_num;
+}
+
+
+bool is_selected(const char* name) {
+    return !filter || strstr(name, filter);
+}
+
+
+void report(const char* name, const char* input, const Timer* timer) {
+    printf("%-26s %-20s %12.0f\n", name, input, timer->ns);
+    fflush(stdout);
+}
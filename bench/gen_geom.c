@@ -0,0 +1,409 @@
+/*
+  Synthetic geometry generator for scaling studies, prints one record per line.
+
+  Each member polygon is a comb: a strip west of antimeridian with teeth
+  reaching across it, so every tooth adds two crossings of the exterior ring.
+  Holes are stacked in the strip and, when there are teeth, inside teeth
+  across antimeridian. Edges are densified to the requested vertex count,
+  vertices near antimeridian can be jagged to add crossings.
+
+  $ ./gen_geom -n 1000 -m 4 -v 1000 -h 16 -c 6 -j 0.5 -p 0.5 > batch.txt
+ */
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CORNER_NUM_MAX (1024)
+#define MEMBER_NUM_MAX (10000)
+
+/* Member shape, degrees east of antimeridian */
+#define STRIP_WEST (-10.0)
+#define STRIP_EAST (-2.0)
+#define TOOTH_EAST (5.0)
+#define JAGGED_ZONE (5.0)
+
+/* Members are stacked in latitude */
+#define LAT_MIN (-70.0)
+#define LAT_MAX (70.0)
+
+typedef enum {
+    Format_Wkt = 0,
+    Format_Wkb
+} Format;
+
+typedef struct {
+    int record_num;
+    int member_num;
+    int vertex_num;
+    int hole_num;
+    int crossing_num;
+    double jaggedness;
+    double non_crossing_share;
+    uint64_t seed;
+    Format format;
+} Args;
+
+typedef struct {
+    double x; /* longitude offset from antimeridian */
+    double y; /* latitude */
+} Point;
+
+typedef struct {
+    Point* points;
+    int num;
+} Ring;
+
+typedef struct {
+    Ring* rings;
+    int ring_num;
+} Member;
+
+typedef struct {
+    double lat_min;
+    double lat_max;
+    double x_min;
+    double x_max;
+} Area;
+
+static void exit_usage(const char* name);
+static void parse_args(Args* args, int argc, char** argv);
+
+static uint64_t rng_next(uint64_t* state);
+static double rng_range(uint64_t* state, double min, double max);
+
+static void create_member(const Args* args, uint64_t* rng, double lat_min, double lat_max, Member* member);
+static int add_area_corners(Point* corners, const Area* area);
+static void densify_ring(
+    const Args* args, uint64_t* rng, const Point* corners, int corner_num, bool jagged, Ring* ring);
+static void free_member(Member* member);
+
+static double wrap_lng(double x, bool crossing);
+static void print_wkt(const Member* members, int member_num, bool crossing);
+static void print_wkb(const Member* members, int member_num, bool crossing);
+static void print_wkb_uint32(uint32_t value);
+static void print_wkb_double(double value);
+
+
+int main(int argc, char** argv) {
+    Args args;
+    parse_args(&args, argc, argv);
+
+    uint64_t rng = args.seed;
+    Member* members = calloc(args.member_num, sizeof(Member));
+    if (!members) {
+        fprintf(stderr, "Failed to allocate members\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double band = (LAT_MAX - LAT_MIN) / args.member_num;
+    for (int record = 0; record < args.record_num; ++record) {
+        for (int i = 0; i < args.member_num; ++i) {
+            /* Gap between members */
+            double lat_min = LAT_MIN + band * i + band * 0.1;
+            double lat_max = LAT_MIN + band * (i + 1) - band * 0.1;
+            create_member(&args, &rng, lat_min, lat_max, &members[i]);
+        }
+
+        bool crossing = rng_range(&rng, 0, 1) >= args.non_crossing_share;
+        if (args.format == Format_Wkt)
+            print_wkt(members, args.member_num, crossing);
+        else
+            print_wkb(members, args.member_num, crossing);
+
+        for (int i = 0; i < args.member_num; ++i)
+            free_member(&members[i]);
+    }
+    free(members);
+}
+
+
+void exit_usage(const char* name) {
+    printf("Usage:\n");
+    printf("$ %s[ -n <records>][ -m <members>][ -v <vertices>][ -h <holes>][ -c <crossings>]\n", name);
+    printf("    [ -j <degrees>][ -p <share>][ -s <seed>][ -f wkt|wkb]\n");
+    printf("  -n  number of records, one per line (1)\n");
+    printf("  -m  multipolygon members per record, 1 prints POLYGON (1)\n");
+    printf("  -v  vertices per ring, edges are densified up to it (corners only)\n");
+    printf("  -h  holes per member polygon (0)\n");
+    printf("  -c  antimeridian crossings of exterior ring, even (2)\n");
+    printf("  -j  jaggedness near antimeridian, degrees (0)\n");
+    printf("  -p  share of records moved to prime meridian, not crossing antimeridian (0)\n");
+    printf("  -s  random seed (1)\n");
+    printf("  -f  output format: wkt or hex encoded little endian wkb (wkt)\n");
+    exit(EXIT_FAILURE);
+}
+
+
+void parse_args(Args* args, int argc, char** argv) {
+    *args = (Args){0};
+    args->record_num = 1;
+    args->member_num = 1;
+    args->crossing_num = 2;
+    args->seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:m:v:h:c:j:p:s:f:")) != -1) {
+        switch (opt) {
+            case 'n':
+                args->record_num = atoi(optarg);
+                break;
+            case 'm':
+                args->member_num = atoi(optarg);
+                break;
+            case 'v':
+                args->vertex_num = atoi(optarg);
+                break;
+            case 'h':
+                args->hole_num = atoi(optarg);
+                break;
+            case 'c':
+                args->crossing_num = atoi(optarg);
+                break;
+            case 'j':
+                args->jaggedness = atof(optarg);
+                break;
+            case 'p':
+                args->non_crossing_share = atof(optarg);
+                break;
+            case 's':
+                args->seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'f':
+                if (strcmp(optarg, "wkt") == 0)
+                    args->format = Format_Wkt;
+                else if (strcmp(optarg, "wkb") == 0)
+                    args->format = Format_Wkb;
+                else
+                    exit_usage(argv[0]);
+                break;
+            default:
+                exit_usage(argv[0]);
+        }
+    }
+
+    int tooth_num = args->crossing_num / 2;
+    if (optind < argc
+        || args->record_num < 0
+        || args->member_num < 1 || args->member_num > MEMBER_NUM_MAX
+        || args->vertex_num < 0
+        || args->hole_num < 0
+        || args->crossing_num < 0 || args->crossing_num % 2 != 0
+        || 4 + 4 * tooth_num > CORNER_NUM_MAX
+        || args->jaggedness < 0
+        || args->non_crossing_share < 0 || args->non_crossing_share > 1)
+    {
+        exit_usage(argv[0]);
+    }
+}
+
+
+uint64_t rng_next(uint64_t* state) {
+    /* splitmix64, same sequence on every platform */
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+double rng_range(uint64_t* state, double min, double max) {
+    return min + (max - min) * (rng_next(state) >> 11) * 0x1.0p-53;
+}
+
+
+void create_member(const Args* args, uint64_t* rng, double lat_min, double lat_max, Member* member) {
+    member->ring_num = 1 + args->hole_num;
+    member->rings = calloc(member->ring_num, sizeof(Ring));
+
+    /* Teeth take odd slots of the latitude range */
+    int tooth_num = args->crossing_num / 2;
+    double slot = (lat_max - lat_min) / (2 * tooth_num + 1);
+
+    /* Exterior ring, counterclockwise */
+    Point corners[CORNER_NUM_MAX];
+    int corner_num = 0;
+    corners[corner_num++] = (Point){STRIP_WEST, lat_min};
+    corners[corner_num++] = (Point){STRIP_EAST, lat_min};
+    for (int i = 0; i < tooth_num; ++i) {
+        double tooth_min = lat_min + slot * (2 * i + 1);
+        double tooth_max = tooth_min + slot;
+        corners[corner_num++] = (Point){STRIP_EAST, tooth_min};
+        corners[corner_num++] = (Point){TOOTH_EAST, tooth_min};
+        corners[corner_num++] = (Point){TOOTH_EAST, tooth_max};
+        corners[corner_num++] = (Point){STRIP_EAST, tooth_max};
+    }
+    corners[corner_num++] = (Point){STRIP_EAST, lat_max};
+    corners[corner_num++] = (Point){STRIP_WEST, lat_max};
+    densify_ring(args, rng, corners, corner_num, true, &member->rings[0]);
+
+    /* Holes, alternating between strip and teeth */
+    int area_num = 1 + tooth_num;
+    for (int i = 0; i < args->hole_num; ++i) {
+        int area_idx = i % area_num;
+        int area_hole_num = args->hole_num / area_num + (area_idx < args->hole_num % area_num);
+        int area_hole_idx = i / area_num;
+
+        Area area;
+        if (area_idx == 0) {
+            area = (Area){lat_min, lat_max, STRIP_WEST, STRIP_EAST};
+        } else {
+            double tooth_min = lat_min + slot * (2 * area_idx - 1);
+            area = (Area){tooth_min, tooth_min + slot, STRIP_EAST, TOOTH_EAST};
+        }
+
+        /* Stacked in latitude, with margins to the area border and each other */
+        double hole_slot = (area.lat_max - area.lat_min) / area_hole_num;
+        double x_margin = (area.x_max - area.x_min) * 0.2;
+        Area hole = {
+            area.lat_min + hole_slot * area_hole_idx + hole_slot * 0.2,
+            area.lat_min + hole_slot * (area_hole_idx + 1) - hole_slot * 0.2,
+            area.x_min + x_margin,
+            area.x_max - x_margin
+        };
+        corner_num = add_area_corners(corners, &hole);
+        densify_ring(args, rng, corners, corner_num, false, &member->rings[1 + i]);
+    }
+}
+
+
+int add_area_corners(Point* corners, const Area* area) {
+    /* Clockwise, as holes are */
+    corners[0] = (Point){area->x_min, area->lat_min};
+    corners[1] = (Point){area->x_min, area->lat_max};
+    corners[2] = (Point){area->x_max, area->lat_max};
+    corners[3] = (Point){area->x_max, area->lat_min};
+    return 4;
+}
+
+
+void densify_ring(
+    const Args* args, uint64_t* rng, const Point* corners, int corner_num, bool jagged, Ring* ring)
+{
+    int num = (args->vertex_num > corner_num) ? args->vertex_num : corner_num;
+    ring->points = malloc(num * sizeof(Point));
+    ring->num = 0;
+    if (!ring->points) {
+        fprintf(stderr, "Failed to allocate ring\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Extra vertices are spread over edges by length */
+    double perimeter = 0;
+    for (int i = 0; i < corner_num; ++i) {
+        const Point* a = &corners[i];
+        const Point* b = &corners[(i + 1) % corner_num];
+        perimeter += hypot(b->x - a->x, b->y - a->y);
+    }
+
+    int extra_num = num - corner_num;
+    double done_len = 0;
+    int done_num = 0;
+    int sign = 1;
+    for (int i = 0; i < corner_num; ++i) {
+        const Point* a = &corners[i];
+        const Point* b = &corners[(i + 1) % corner_num];
+        double len = hypot(b->x - a->x, b->y - a->y);
+        done_len += len;
+        int edge_num = (int) round(extra_num * done_len / perimeter) - done_num;
+        done_num += edge_num;
+
+        ring->points[ring->num++] = *a;
+        for (int j = 1; j <= edge_num; ++j) {
+            double t = (double) j / (edge_num + 1);
+            Point p = {a->x + (b->x - a->x) * t, a->y + (b->y - a->y) * t};
+
+            /*
+              Zigzag across the edge near antimeridian. Offset is kept below half
+              of the distance to the edge ends, so adjacent edges do not intersect.
+             */
+            if (jagged && args->jaggedness > 0 && fabs(p.x) < JAGGED_ZONE) {
+                double dist = len * ((t < 0.5) ? t : 1 - t);
+                double amplitude = fmin(args->jaggedness, dist / 2) * rng_range(rng, 0.5, 1);
+                p.x += sign * amplitude * -(b->y - a->y) / len;
+                p.y += sign * amplitude * (b->x - a->x) / len;
+                sign = -sign;
+            }
+            ring->points[ring->num++] = p;
+        }
+    }
+}
+
+
+void free_member(Member* member) {
+    for (int i = 0; i < member->ring_num; ++i)
+        free(member->rings[i].points);
+    free(member->rings);
+    *member = (Member){0};
+}
+
+
+double wrap_lng(double x, bool crossing) {
+    if (!crossing)
+        return x;
+    double lng = 180 + x;
+    return (lng > 180) ? lng - 360 : lng;
+}
+
+
+void print_wkt(const Member* members, int member_num, bool crossing) {
+    bool multi = member_num > 1;
+    printf(multi ? "MULTIPOLYGON (" : "POLYGON ");
+    for (int i = 0; i < member_num; ++i) {
+        printf(i > 0 ? ", (" : "(");
+        for (int j = 0; j < members[i].ring_num; ++j) {
+            const Ring* ring = &members[i].rings[j];
+            printf(j > 0 ? ", (" : "(");
+            /* Closing point repeats the first one */
+            for (int k = 0; k <= ring->num; ++k) {
+                const Point* p = &ring->points[k % ring->num];
+                printf("%s%.7f %.7f", k > 0 ? ", " : "", wrap_lng(p->x, crossing), p->y);
+            }
+            printf(")");
+        }
+        printf(")");
+    }
+    printf(multi ? ")\n" : "\n");
+}
+
+
+void print_wkb(const Member* members, int member_num, bool crossing) {
+    bool multi = member_num > 1;
+    if (multi) {
+        printf("01");
+        print_wkb_uint32(6);
+        print_wkb_uint32(member_num);
+    }
+    for (int i = 0; i < member_num; ++i) {
+        printf("01");
+        print_wkb_uint32(3);
+        print_wkb_uint32(members[i].ring_num);
+        for (int j = 0; j < members[i].ring_num; ++j) {
+            const Ring* ring = &members[i].rings[j];
+            print_wkb_uint32(ring->num + 1);
+            for (int k = 0; k <= ring->num; ++k) {
+                const Point* p = &ring->points[k % ring->num];
+                print_wkb_double(wrap_lng(p->x, crossing));
+                print_wkb_double(p->y);
+            }
+        }
+    }
+    printf("\n");
+}
+
+
+void print_wkb_uint32(uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        printf("%02X", (unsigned) (value >> (8 * i)) & 0xFF);
+}
+
+
+void print_wkb_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+        printf("%02X", (unsigned) (bits >> (8 * i)) & 0xFF);
+}
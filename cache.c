@@ -0,0 +1,386 @@
+#include "cache.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define CACHE_MAGIC "SPLITCCH"
+#define CACHE_VERSION (1)
+#define CACHE_INITIAL_BUCKET_NUM (1024)
+
+#define HASH_MUL1 (0x9e3779b97f4a7c15ULL)
+#define HASH_MUL2 (0xbf58476d1ce4e5b9ULL)
+#define HASH_MUL3 (0x94d049bb133111ebULL)
+
+typedef struct CacheEntry {
+    struct CacheEntry* bucket_next;
+    struct CacheEntry* prev; /* more recently used */
+    struct CacheEntry* next; /* less recently used */
+    uint64_t hash;
+    size_t input_len;
+    size_t output_len;
+    char data[]; /* input, then output */
+} CacheEntry;
+
+struct ResultCache {
+    pthread_mutex_t mutex;
+    CacheEntry** buckets;
+    size_t bucket_num; /* power of 2 */
+    CacheEntry* first; /* most recently used */
+    CacheEntry* last;
+    uint64_t fingerprint;
+    ResultCacheStats stats;
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t zero;
+    uint64_t fingerprint;
+} CacheFileHeader;
+
+static CacheEntry* entry_new(uint64_t hash, const char* input, size_t input_len, const char* output, size_t output_len);
+static size_t entry_size(const CacheEntry* entry);
+static bool entry_fits(uint64_t input_len, uint64_t output_len, size_t limit);
+
+static CacheEntry* cache_find(ResultCache* cache, uint64_t hash, const char* input, size_t input_len);
+static void cache_insert(ResultCache* cache, CacheEntry* entry);
+static void cache_remove(ResultCache* cache, CacheEntry* entry);
+static void cache_touch(ResultCache* cache, CacheEntry* entry);
+static void cache_evict(ResultCache* cache);
+static void cache_grow_buckets(ResultCache* cache);
+
+static uint64_t hash_mix(uint64_t value);
+
+
+ResultCache* result_cache_new(size_t limit, uint64_t fingerprint) {
+    ResultCache* cache = calloc(1, sizeof(ResultCache));
+    if (!cache)
+        return NULL;
+    cache->buckets = calloc(CACHE_INITIAL_BUCKET_NUM, sizeof(CacheEntry*));
+    if (!cache->buckets) {
+        free(cache);
+        return NULL;
+    }
+    cache->bucket_num = CACHE_INITIAL_BUCKET_NUM;
+    cache->fingerprint = fingerprint;
+    cache->stats.limit = limit;
+    pthread_mutex_init(&cache->mutex, NULL);
+    return cache;
+}
+
+
+void result_cache_free(ResultCache* cache) {
+    CacheEntry* entry = cache->first;
+    while (entry) {
+        CacheEntry* next = entry->next;
+        free(entry);
+        entry = next;
+    }
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->buckets);
+    free(cache);
+}
+
+
+bool result_cache_get(
+    ResultCache* cache, const char* input, size_t input_len,
+    ResultCacheOutputCallback callback, void* user_data)
+{
+    uint64_t hash = result_cache_hash(input, input_len, 0);
+    pthread_mutex_lock(&cache->mutex);
+    CacheEntry* entry = cache_find(cache, hash, input, input_len);
+    if (entry) {
+        ++cache->stats.hit_num;
+        cache_touch(cache, entry);
+        callback(entry->data + entry->input_len, entry->output_len, user_data);
+    } else {
+        ++cache->stats.miss_num;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    return entry != NULL;
+}
+
+
+bool result_cache_put(
+    ResultCache* cache, const char* input, size_t input_len, const char* output, size_t output_len)
+{
+    if (!entry_fits(input_len, output_len, cache->stats.limit))
+        return true;
+
+    /* Copied before locking, dropped if another thread has stored the same input meanwhile */
+    uint64_t hash = result_cache_hash(input, input_len, 0);
+    CacheEntry* entry = entry_new(hash, input, input_len, output, output_len);
+    if (!entry)
+        return false;
+    pthread_mutex_lock(&cache->mutex);
+    if (!cache_find(cache, hash, input, input_len)) {
+        cache_insert(cache, entry);
+        entry = NULL;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+    free(entry);
+    return true;
+}
+
+
+bool result_cache_load(ResultCache* cache, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return errno == ENOENT;
+
+    CacheFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1
+        && memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0
+        && header.version == CACHE_VERSION;
+    struct stat st;
+    ok = ok && fstat(fileno(file), &st) == 0;
+    if (ok && header.fingerprint == cache->fingerprint) {
+        /*
+          Least recently used first, so inserting keeps the order. Lengths are
+          checked against the rest of the file before allocating, entries
+          larger than the limit are skipped.
+         */
+        uint64_t rest = (st.st_size > (off_t) sizeof(header)) ? st.st_size - sizeof(header) : 0;
+        uint64_t lens[2];
+        while (ok && fread(lens, sizeof(lens), 1, file) == 1) {
+            rest = (rest > sizeof(lens)) ? rest - sizeof(lens) : 0;
+            if (lens[0] > rest || lens[1] > rest - lens[0]) {
+                ok = false;
+                break;
+            }
+            rest -= lens[0] + lens[1];
+            if (!entry_fits(lens[0], lens[1], cache->stats.limit)) {
+                ok = fseeko(file, (off_t) (lens[0] + lens[1]), SEEK_CUR) == 0;
+                continue;
+            }
+            CacheEntry* entry = entry_new(0, NULL, lens[0], NULL, lens[1]);
+            if (!entry || fread(entry->data, 1, lens[0] + lens[1], file) != lens[0] + lens[1]) {
+                free(entry);
+                ok = false;
+                break;
+            }
+            entry->hash = result_cache_hash(entry->data, entry->input_len, 0);
+            pthread_mutex_lock(&cache->mutex);
+            if (cache_find(cache, entry->hash, entry->data, entry->input_len)) {
+                free(entry);
+            } else {
+                cache_insert(cache, entry);
+            }
+            pthread_mutex_unlock(&cache->mutex);
+        }
+        ok = ok && !ferror(file);
+    }
+    fclose(file);
+    return ok;
+}
+
+
+bool result_cache_save(ResultCache* cache, const char* path) {
+    size_t path_len = strlen(path);
+    char* tmp_path = malloc(path_len + sizeof(".tmp"));
+    if (!tmp_path)
+        return false;
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", sizeof(".tmp"));
+
+    FILE* file = fopen(tmp_path, "wb");
+    bool ok = file != NULL;
+    if (ok) {
+        CacheFileHeader header = {{0}, CACHE_VERSION, 0, cache->fingerprint};
+        memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+        ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        pthread_mutex_lock(&cache->mutex);
+        for (const CacheEntry* entry = cache->last; ok && entry; entry = entry->prev) {
+            uint64_t lens[2] = {entry->input_len, entry->output_len};
+            ok = fwrite(lens, sizeof(lens), 1, file) == 1
+                && fwrite(entry->data, 1, entry->input_len + entry->output_len, file)
+                    == entry->input_len + entry->output_len;
+        }
+        pthread_mutex_unlock(&cache->mutex);
+
+        ok = (fclose(file) == 0) && ok;
+        ok = ok && rename(tmp_path, path) == 0;
+        if (!ok)
+            remove(tmp_path);
+    }
+    free(tmp_path);
+    return ok;
+}
+
+
+void result_cache_get_stats(ResultCache* cache, ResultCacheStats* stats) {
+    pthread_mutex_lock(&cache->mutex);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+
+uint64_t result_cache_hash(const void* data, size_t len, uint64_t seed) {
+    /* 8 bytes at a time, multiply and rotate, finished with splitmix64 */
+    const unsigned char* cur = data;
+    uint64_t hash = seed ^ (len * HASH_MUL1);
+    for (; len >= 8; cur += 8, len -= 8) {
+        uint64_t value;
+        memcpy(&value, cur, 8);
+        hash ^= value * HASH_MUL2;
+        hash = ((hash << 27) | (hash >> 37)) * HASH_MUL1;
+    }
+    if (len > 0) {
+        uint64_t value = 0;
+        memcpy(&value, cur, len);
+        hash ^= value * HASH_MUL2;
+        hash = ((hash << 27) | (hash >> 37)) * HASH_MUL1;
+    }
+    return hash_mix(hash);
+}
+
+
+CacheEntry* entry_new(uint64_t hash, const char* input, size_t input_len, const char* output, size_t output_len) {
+    /* Data is left to the caller if input and output are NULL */
+    if (output_len > SIZE_MAX - sizeof(CacheEntry) || input_len > SIZE_MAX - sizeof(CacheEntry) - output_len)
+        return NULL;
+    CacheEntry* entry = malloc(sizeof(CacheEntry) + input_len + output_len);
+    if (!entry)
+        return NULL;
+    *entry = (CacheEntry){0};
+    entry->hash = hash;
+    entry->input_len = input_len;
+    entry->output_len = output_len;
+    if (input)
+        memcpy(entry->data, input, input_len);
+    if (output)
+        memcpy(entry->data + input_len, output, output_len);
+    return entry;
+}
+
+
+size_t entry_size(const CacheEntry* entry) {
+    return sizeof(CacheEntry) + entry->input_len + entry->output_len;
+}
+
+
+bool entry_fits(uint64_t input_len, uint64_t output_len, size_t limit) {
+    /* Entry size is not larger than limit, without overflow */
+    return limit >= sizeof(CacheEntry)
+        && input_len <= limit - sizeof(CacheEntry)
+        && output_len <= limit - sizeof(CacheEntry) - input_len;
+}
+
+
+CacheEntry* cache_find(ResultCache* cache, uint64_t hash, const char* input, size_t input_len) {
+    CacheEntry* entry = cache->buckets[hash & (cache->bucket_num - 1)];
+    for (; entry; entry = entry->bucket_next) {
+        if (entry->hash == hash && entry->input_len == input_len
+            && memcmp(entry->data, input, input_len) == 0)
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+
+void cache_insert(ResultCache* cache, CacheEntry* entry) {
+    /* Most recently used */
+    CacheEntry** bucket = &cache->buckets[entry->hash & (cache->bucket_num - 1)];
+    entry->bucket_next = *bucket;
+    *bucket = entry;
+    entry->prev = NULL;
+    entry->next = cache->first;
+    if (cache->first) {
+        cache->first->prev = entry;
+    } else {
+        cache->last = entry;
+    }
+    cache->first = entry;
+
+    ++cache->stats.entry_num;
+    cache->stats.bytes += entry_size(entry);
+    cache_evict(cache);
+    if (cache->stats.entry_num > cache->bucket_num)
+        cache_grow_buckets(cache);
+}
+
+
+void cache_remove(ResultCache* cache, CacheEntry* entry) {
+    CacheEntry** link = &cache->buckets[entry->hash & (cache->bucket_num - 1)];
+    while (*link != entry)
+        link = &(*link)->bucket_next;
+    *link = entry->bucket_next;
+
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        cache->first = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->last = entry->prev;
+    }
+
+    --cache->stats.entry_num;
+    cache->stats.bytes -= entry_size(entry);
+}
+
+
+void cache_touch(ResultCache* cache, CacheEntry* entry) {
+    if (entry == cache->first)
+        return;
+
+    /* Unlink, entry is not last */
+    entry->prev->next = entry->next;
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        cache->last = entry->prev;
+    }
+
+    entry->prev = NULL;
+    entry->next = cache->first;
+    cache->first->prev = entry;
+    cache->first = entry;
+}
+
+
+void cache_evict(ResultCache* cache) {
+    while (cache->stats.bytes > cache->stats.limit && cache->last) {
+        CacheEntry* entry = cache->last;
+        cache_remove(cache, entry);
+        free(entry);
+        ++cache->stats.evict_num;
+    }
+}
+
+
+void cache_grow_buckets(ResultCache* cache) {
+    /* Keeps the old table if allocation fails, chains just get longer */
+    size_t bucket_num = cache->bucket_num * 2;
+    CacheEntry** buckets = calloc(bucket_num, sizeof(CacheEntry*));
+    if (!buckets)
+        return;
+    for (size_t i = 0; i < cache->bucket_num; ++i) {
+        CacheEntry* entry = cache->buckets[i];
+        while (entry) {
+            CacheEntry* next = entry->bucket_next;
+            CacheEntry** bucket = &buckets[entry->hash & (bucket_num - 1)];
+            entry->bucket_next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_num = bucket_num;
+}
+
+
+uint64_t hash_mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * HASH_MUL2;
+    value = (value ^ (value >> 27)) * HASH_MUL3;
+    return value ^ (value >> 31);
+}
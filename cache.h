@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+  Result cache of batch mode: output of an input line is stored under a
+  64-bit hash of the line bytes, so repeated geometries skip parse, split and
+  print. Lines are compared in full on lookup, a hash collision is a miss.
+  Entries are evicted least recently used first once total size (lines,
+  outputs and entry overhead) exceeds the limit. Safe to use from several
+  threads, output is copied under a lock.
+
+  Cache file (host byte order), least recently used entry first:
+
+    0   "SPLITCCH"   magic
+    8   uint32       version, 1
+    12  uint32       zero
+    16  uint64       fingerprint of options the outputs were made with
+    24  entries      uint64 input length, uint64 output length, input, output
+ */
+
+typedef struct ResultCache ResultCache;
+
+typedef struct {
+    uint64_t hit_num;
+    uint64_t miss_num;
+    uint64_t evict_num;
+    size_t entry_num;
+    size_t bytes;
+    size_t limit;
+} ResultCacheStats;
+
+/* Receives cached output, called with the cache locked */
+typedef void (*ResultCacheOutputCallback)(const char* data, size_t len, void* user_data);
+
+/* Fingerprint is stored in cache file, entries of a file with other fingerprint are not loaded */
+ResultCache* result_cache_new(size_t limit, uint64_t fingerprint);
+
+void result_cache_free(ResultCache* cache);
+
+/* Passes cached output of input to callback, returns false if not cached */
+bool result_cache_get(
+    ResultCache* cache, const char* input, size_t input_len,
+    ResultCacheOutputCallback callback, void* user_data);
+
+/* Output larger than the limit is not stored, returns false on allocation failure */
+bool result_cache_put(
+    ResultCache* cache, const char* input, size_t input_len, const char* output, size_t output_len);
+
+/* Missing file is an empty cache. Returns false if file can't be read or is damaged */
+bool result_cache_load(ResultCache* cache, const char* path);
+
+/* Written to a temporary file next to path, then renamed */
+bool result_cache_save(ResultCache* cache, const char* path);
+
+void result_cache_get_stats(ResultCache* cache, ResultCacheStats* stats);
+
+uint64_t result_cache_hash(const void* data, size_t len, uint64_t seed);
@@ -3,99 +3,366 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
 #include <getopt.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <h3/h3api.h>
+#include <split/alloc.h>
+#include <split/column.h>
 #include <split/h3.h>
 #include <split/parse.h>
 #include <split/print.h>
 #include <split/split.h>
+#include "batch.h"
+#include "cache.h"
+#include "serve.h"
+#include "stream.h"
 
 static void exit_usage(const char* name);
+static void print_alloc_stats();
+static void print_cache_stats(ResultCache* cache);
+
+#define BAND_LAT_NUM_MAX (180)
+#define CACHE_SIZE_DEFAULT (256) /* MiB */
 
 typedef struct {
     const char* input_path;
+    const char* output_path; /* compressed by extension, stdout if not set */
+    bool column; /* columnar output (split/column.h) instead of WKT */
+    bool partition; /* pieces by base cell, one per line, instead of antimeridian split */
     bool verbose;
+    bool alloc_stats;
+    bool batch;
+    bool serve;
+    const char* socket_path; /* serve mode, stdin/stdout if not set */
+    int worker_num; /* batch and serve mode */
+    size_t cache_size; /* batch mode result cache, MiB, no cache if 0 */
+    const char* cache_path; /* cache is loaded from and saved to the file if set */
+    int parse_thread_num; /* whole input is read before parsing if set */
+    bool out_of_core; /* column file (mapped) or WKT in, column file out */
+    const char* temp_dir; /* out-of-core mode vertex file directory, TMPDIR if not set */
+    CoordMode coord_mode;
+    int band_lat_num;
+    double band_lats[BAND_LAT_NUM_MAX]; /* radians */
 } Args;
 
+#define WRITE_BUFFER_SIZE (64 * 1024)
+
+typedef struct {
+    LinkedGeoPolygon* first;
+    LinkedGeoPolygon* last;
+} Members;
+
+typedef struct {
+    const Args* args;
+    Members input; /* verbose mode: input is printed before processing */
+    PolygonPrinter printer;
+    SplitColumn column;
+
+    /* Separate contexts, band split runs from within antimeridian split callback */
+    SplitContext* split_180;
+    SplitContext* split_bands;
+} Context;
+
+typedef struct {
+    SplitLarge* large;
+    SplitColumnFile* column;
+    SplitPointWriter writer;
+} LargeContext;
+
 static void parse_args(Args* args, int argc, char** argv);
-static char* read_input(const char* path, size_t* size);
+static bool parse_band_lats(Args* args, const char* value);
+static InputStream* open_input(const Args* args);
+static int split_out_of_core(const Args* args, FILE* output);
+static void close_output(const Args* args, FILE* output);
+static void parse_input(
+    const Args* args, WktPolygonCallback callback, void* user_data);
+static void parse_input_parallel(
+    const Args* args, InputStream* input, WktPolygonCallback callback, void* user_data);
+static void exit_read_error(const Args* args, const InputStream* input);
+static void exit_parse_error(const WktParseResult* parse_result);
+
+static void add_member(LinkedGeoPolygon* polygon, void* user_data);
+static void process_member(LinkedGeoPolygon* polygon, void* user_data);
+static void output_polygon(LinkedGeoPolygon* polygon, void* user_data);
+static void print_output_polygon(LinkedGeoPolygon* polygon, void* user_data);
+static void print_cell_polygon(LinkedGeoPolygon* polygon, H3Index cell, void* user_data);
+static void split_large_member(LinkedGeoPolygon* polygon, void* user_data);
 
 
 int main(int argc, char** argv) {
     /* Parse arguments */
     Args args;
     parse_args(&args, argc, argv);
+    if (args.serve)
+        return serve(args.socket_path, args.worker_num);
+    split_alloc_stats_enable(args.alloc_stats);
 
-    /* Read data */
-    size_t size;
-    char* data = read_input(args.input_path, &size);
-    if (!data) {
-        printf("Failed to read data from `%s'\n", args.input_path);
+    /* Buffered output */
+    StreamCompression compression = args.output_path
+        ? stream_compression_from_path(args.output_path)
+        : StreamCompression_None;
+    if (!stream_compression_is_supported(compression)) {
+        printf("%s output is not supported by this build\n", stream_compression_to_string(compression));
         exit(EXIT_FAILURE);
     }
+    if (args.out_of_core && compression != StreamCompression_None) {
+        printf("Out-of-core output can't be compressed\n");
+        exit(EXIT_FAILURE);
+    }
+    FILE* output = output_stream_open(args.output_path, compression);
+    if (!output) {
+        printf("Failed to write data to `%s'\n", args.output_path);
+        exit(EXIT_FAILURE);
+    }
+    static char write_buffer[WRITE_BUFFER_SIZE];
+    setvbuf(output, write_buffer, _IOFBF, sizeof(write_buffer));
 
-    /* Parse */
-    WktParseResult parse_result = wkt_parse(data, size);
-    if (parse_result.error) {
-        printf(
-            "(at %d) %s\n",
-            (int) parse_result.error_pos,
-            wkt_parse_error_to_string(parse_result.error));
-        if (parse_result.message)
-            printf("%s\n", parse_result.message);
+    if (args.out_of_core) {
+        /* Polygons are split one at a time, vertices are read in place or kept in a temporary file */
+        int status = split_out_of_core(&args, output);
+        close_output(&args, output);
+        if (args.alloc_stats)
+            print_alloc_stats();
+        return status;
+    }
+
+    if (args.batch) {
+        /* Lines are read, split and written by a pipeline of threads */
+        InputStream* input = open_input(&args);
+        SplitTransformOptions options = {args.coord_mode, args.band_lats, args.band_lat_num};
+
+        /* Cached outputs are only valid for the same version and options */
+        ResultCache* cache = NULL;
+        if (args.cache_size > 0) {
+            uint64_t fingerprint = result_cache_hash(PACKAGE_VERSION, strlen(PACKAGE_VERSION), 0);
+            fingerprint = result_cache_hash(&args.coord_mode, sizeof(args.coord_mode), fingerprint);
+            fingerprint = result_cache_hash(args.band_lats, args.band_lat_num * sizeof(double), fingerprint);
+            cache = result_cache_new(args.cache_size * 1024 * 1024, fingerprint);
+            if (!cache) {
+                printf("Failed to allocate cache\n");
+                exit(EXIT_FAILURE);
+            }
+            if (args.cache_path && !result_cache_load(cache, args.cache_path))
+                fprintf(stderr, "Failed to load cache from `%s', some entries are not used\n", args.cache_path);
+        }
+
+        int status = batch(input, output, &options, args.worker_num, cache);
+        input_stream_close(input);
+        close_output(&args, output);
+        if (cache) {
+            if (args.cache_path && !result_cache_save(cache, args.cache_path)) {
+                fprintf(stderr, "Failed to save cache to `%s'\n", args.cache_path);
+                status = EXIT_FAILURE;
+            }
+            if (args.alloc_stats)
+                print_cache_stats(cache);
+            result_cache_free(cache);
+        }
+        if (args.alloc_stats)
+            print_alloc_stats();
+        return status;
+    }
+
+    Context context = {0};
+    context.args = &args;
+    polygon_printer_init(&context.printer);
+    context.printer.coord_mode = args.coord_mode;
+    context.printer.output = output;
+    context.split_180 = split_context_new();
+    context.split_bands = split_context_new();
+    if (!context.split_180 || !context.split_bands
+        || (args.column && !split_column_init(&context.column, args.coord_mode))) {
+        printf("Failed to allocate split context\n");
         exit(EXIT_FAILURE);
     }
-    LinkedGeoPolygon* polygon = parse_result.object;
 
-    if (args.verbose) {
+    if (!args.verbose) {
+        /* Read, parse, split and print member polygons one by one */
+        parse_input(&args, &process_member, &context);
+
+    } else {
+        /* Read and parse data */
+        parse_input(&args, &add_member, &context.input);
+
         /* Print input */
+        LinkedGeoPolygon empty = {0};
+        LinkedGeoPolygon* polygon = context.input.first;
         printf("Input:\n");
-        print_polygon(polygon);
+        print_polygon_mode(polygon ? polygon : &empty, args.coord_mode);
         printf("\n\n");
-    }
-
-    if (is_crossed_by_180(polygon)) {
-        if (args.verbose) printf("Split\n\n");
 
-        /* Split and print */
-        LinkedGeoPolygon* multi_polygon = split_by_180(polygon);
-        print_polygon(multi_polygon);
-        printf("\n");
-        free_linked_geo_polygon(multi_polygon);
+        if (polygon && is_crossed_by_180(polygon)) {
+            printf("Split\n\n");
+        } else {
+            printf("Not split\n\n");
+        }
 
-    } else {
-        if (args.verbose) printf("Not split\n\n");
+        /* Process member polygons */
+        while (polygon) {
+            LinkedGeoPolygon* next = polygon->next;
+            polygon->next = NULL;
+            process_member(polygon, &context);
+            polygon = next;
+        }
+    }
 
-        /* Not split, just print input */
-        print_polygon(polygon);
-        printf("\n");
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Output);
+    if (args.column) {
+        /* Whole result is a single geometry */
+        bool ok = !context.column.failed && split_column_end_geometry(&context.column);
+        SplitColumnView view = split_column_view(&context.column);
+        if (!ok || !split_column_write(&view, output)) {
+            printf("Failed to write columnar output\n");
+            exit(EXIT_FAILURE);
+        }
+        split_column_free(&context.column);
+    } else if (!args.partition) {
+        polygon_printer_finish(&context.printer);
+        fputc('\n', output);
     }
+    split_alloc_set_stage(prev_stage);
+    close_output(&args, output);
 
-    /* Cleanup */
-    if (polygon)
-        free(polygon);
-    if (data)
-        free(data);
+    split_context_free(context.split_180);
+    split_context_free(context.split_bands);
+
+    if (args.alloc_stats)
+        print_alloc_stats();
 }
 
 
 void exit_usage(const char* name) {
     printf("Usage:\n");
-    printf("$ %s <filename>[ -v]\n", name);
+    printf("$ %s <filename>[ -o <filename>][ -c][ -v][ -e][ -m][ -b <lat>[,<lat>...]][ -j <num>]\n", name);
+    printf("$ %s -p <filename>[ -o <filename>][ -e][ -m][ -j <num>]\n", name);
     printf("$ echo <wkt> | %s\n", name);
+    printf("$ %s --batch[ --workers=<num>][ --cache=<MiB>][ --cache-file=<filename>]"
+           "[ <filename>][ -o <filename>][ -e][ -m][ -b <lat>[,<lat>...]]\n", name);
+    printf("$ %s --serve[=<socket>][ --workers=<num>]\n", name);
+    printf("$ %s --out-of-core[=<dir>] <filename> -o <filename>[ -e][ -m]\n", name);
+    printf("  -o  write output to file, compressed if name ends with .gz or .zst\n");
+    printf("  -c  columnar output (split/column.h) instead of WKT\n");
+    printf("  -v  verbose output\n");
+    printf("  -e  fixed-point coordinates, rounded to 7 decimal places (E7)\n");
+    printf("  -m  print memory allocation stats per stage to stderr\n");
+    printf("  -b  also cut result into bands by parallels (degrees)\n");
+    printf("  -j  parse multipolygon members with <num> threads, whole input is read first\n");
+    printf("  -p  partition by H3 base cells, prints `<cell> <wkt>' line per piece\n");
+    printf("  --batch    input has one WKT per line, lines are split by a pool of workers\n");
+    printf("  --serve    answer framed requests on Unix domain socket or stdin/stdout\n");
+    printf("  --workers  number of batch or server workers, one per CPU by default\n");
+    printf("  --cache    batch mode: keep outputs of repeated lines, size limit in MiB\n");
+    printf("  --out-of-core  split a column file or WKT into a column file, vertices of a WKT\n"
+           "                 polygon are kept in a temporary file in <dir> (TMPDIR by default)\n");
+    printf("  --cache-file  batch mode: load cache from file and save it back, %d MiB by default\n",
+           CACHE_SIZE_DEFAULT);
     exit(EXIT_FAILURE);
 }
 
 
+void print_alloc_stats() {
+    SplitAllocStats stats;
+    split_alloc_stats_get(&stats);
+
+    fprintf(stderr, "%-8s %12s %14s %12s %14s %14s\n",
+            "stage", "allocs", "alloc bytes", "frees", "freed bytes", "peak bytes");
+    for (int i = 0; i < SplitAllocStage_Num; ++i) {
+        const SplitAllocStageStats* stage = &stats.stages[i];
+        fprintf(stderr, "%-8s %12llu %14llu %12llu %14llu %14llu\n",
+                split_alloc_stage_to_string(i),
+                (unsigned long long) stage->alloc_num,
+                (unsigned long long) stage->alloc_bytes,
+                (unsigned long long) stage->free_num,
+                (unsigned long long) stage->free_bytes,
+                (unsigned long long) stage->peak_bytes);
+    }
+    fprintf(stderr, "live bytes at exit: %llu, peak bytes: %llu\n",
+            (unsigned long long) stats.live_bytes,
+            (unsigned long long) stats.peak_bytes);
+}
+
+
+void print_cache_stats(ResultCache* cache) {
+    ResultCacheStats stats;
+    result_cache_get_stats(cache, &stats);
+    fprintf(stderr, "cache hits: %llu, misses: %llu, evictions: %llu, entries: %zu, bytes: %zu of %zu\n",
+            (unsigned long long) stats.hit_num,
+            (unsigned long long) stats.miss_num,
+            (unsigned long long) stats.evict_num,
+            stats.entry_num, stats.bytes, stats.limit);
+}
+
+
 void parse_args(Args* args, int argc, char** argv) {
     *args = (Args){0};
 
+    static const struct option long_options[] = {
+        {"batch", no_argument, NULL, 'B'},
+        {"serve", optional_argument, NULL, 'S'},
+        {"workers", required_argument, NULL, 'W'},
+        {"cache", required_argument, NULL, 'C'},
+        {"cache-file", required_argument, NULL, 'F'},
+        {"out-of-core", optional_argument, NULL, 'L'},
+        {NULL, 0, NULL, 0}
+    };
+
     int opt;
-    while ((opt = getopt(argc, argv, "vf:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "o:cvemb:j:p", long_options, NULL)) != -1) {
         switch (opt) {
+            case 'o':
+                args->output_path = optarg;
+                break;
+            case 'c':
+                args->column = true;
+                break;
             case 'v':
                 args->verbose = true;
                 break;
+            case 'e':
+                args->coord_mode = CoordMode_E7;
+                break;
+            case 'm':
+                args->alloc_stats = true;
+                break;
+            case 'b':
+                if (!parse_band_lats(args, optarg))
+                    exit_usage(argv[0]);
+                break;
+            case 'j':
+                args->parse_thread_num = atoi(optarg);
+                if (args->parse_thread_num < 1)
+                    exit_usage(argv[0]);
+                break;
+            case 'p':
+                args->partition = true;
+                break;
+            case 'B':
+                args->batch = true;
+                break;
+            case 'S':
+                args->serve = true;
+                args->socket_path = optarg;
+                break;
+            case 'W':
+                args->worker_num = atoi(optarg);
+                if (args->worker_num < 1)
+                    exit_usage(argv[0]);
+                break;
+            case 'C':
+                if (atoi(optarg) < 1)
+                    exit_usage(argv[0]);
+                args->cache_size = atoi(optarg);
+                break;
+            case 'F':
+                args->cache_path = optarg;
+                break;
+            case 'L':
+                args->out_of_core = true;
+                args->temp_dir = optarg;
+                break;
             default:
                 exit_usage(argv[0]);
         }
@@ -103,47 +370,334 @@ void parse_args(Args* args, int argc, char** argv) {
 
     if (optind < argc)
         args->input_path = argv[optind];
+
+    /* Request options are set per request in serve mode */
+    if (args->serve && (args->input_path || args->output_path || args->column || args->verbose || args->alloc_stats
+                        || args->coord_mode != CoordMode_Double || args->band_lat_num > 0
+                        || args->parse_thread_num > 0 || args->partition))
+        exit_usage(argv[0]);
+    if (args->column && args->verbose)
+        exit_usage(argv[0]);
+    if (args->batch && (args->serve || args->column || args->verbose || args->parse_thread_num > 0))
+        exit_usage(argv[0]);
+    if (args->cache_path && args->cache_size == 0)
+        args->cache_size = CACHE_SIZE_DEFAULT;
+    if (args->cache_size > 0 && !args->batch)
+        exit_usage(argv[0]);
+    if (args->partition && (args->batch || args->column || args->verbose || args->band_lat_num > 0))
+        exit_usage(argv[0]);
+    if (args->out_of_core && (!args->input_path || !args->output_path || args->batch || args->serve
+                              || args->verbose || args->partition || args->band_lat_num > 0
+                              || args->parse_thread_num > 0))
+        exit_usage(argv[0]);
+    if (args->worker_num == 0) {
+        long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+        args->worker_num = (cpu_num > 0) ? cpu_num : 1;
+    }
+}
+
+
+bool parse_band_lats(Args* args, const char* value) {
+    const char* cur = value;
+    while (*cur) {
+        char* end;
+        double lat = strtod(cur, &end);
+        if (end == cur || lat <= -90 || lat >= 90)
+            return false;
+        if (args->band_lat_num == BAND_LAT_NUM_MAX)
+            return false;
+        args->band_lats[args->band_lat_num++] = degsToRads(lat);
+
+        if (*end == ',') {
+            ++end;
+        } else if (*end) {
+            return false;
+        }
+        cur = end;
+    }
+    return args->band_lat_num > 0;
+}
+
+
+InputStream* open_input(const Args* args) {
+    /* Compressed data is recognized */
+    InputStream* input = input_stream_open(args->input_path);
+    if (!input) {
+        printf("Failed to read data from `%s'\n", args->input_path);
+        exit(EXIT_FAILURE);
+    }
+    return input;
+}
+
+
+int split_out_of_core(const Args* args, FILE* output) {
+    /*
+      Input column is used in place, other input is parsed as WKT. Output
+      column is written as polygons are split.
+     */
+    int fd = open(args->input_path, O_RDONLY);
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0)
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (fd >= 0)
+        close(fd);
+    SplitColumnView view;
+    SplitColumnError error = (data != MAP_FAILED)
+        ? split_column_open(&view, data, st.st_size)
+        : SplitColumnError_InvalidHeader;
+    if (error && error != SplitColumnError_InvalidHeader) {
+        printf("%s\n", split_column_error_to_string(error));
+        exit(EXIT_FAILURE);
+    }
+    if (error && data != MAP_FAILED) {
+        munmap(data, st.st_size);
+        data = MAP_FAILED;
+    }
+
+    SplitLarge* large = split_large_new(args->temp_dir);
+    SplitColumnFile column;
+    if (!large || !split_column_file_init(&column, output, args->coord_mode)) {
+        printf("Failed to start out-of-core split\n");
+        exit(EXIT_FAILURE);
+    }
+    bool ok;
+    if (data != MAP_FAILED) {
+        SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Split);
+        ok = split_by_180_large(large, &view, &column);
+        split_alloc_set_stage(prev_stage);
+        munmap(data, st.st_size);
+    } else {
+        /* Whole result is a single geometry, as with -c */
+        LargeContext context = {large, &column, split_column_file_writer(&column)};
+        parse_input(args, &split_large_member, &context);
+        ok = split_column_file_end_geometry(&column);
+    }
+    ok = ok && split_column_file_finish(&column);
+    if (!ok)
+        printf("Failed to split `%s'\n", args->input_path);
+
+    split_column_file_free(&column);
+    split_large_free(large);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 
-char* read_input(const char* path, size_t* size) {
-    *size = 0;
-
-    /* Open file stream */
-    FILE* input = path ? fopen(path, "r") : stdin;
-    if (!input)
-        return NULL;
-
-    /* Allocate initial data memory */
-    size_t alloc_size = 128;
-    char* data = malloc(alloc_size);
-    if (!data) {
-        if (path) fclose(input);
-        return NULL;
-    }
-
-    /* Read file data */
-    char buffer[128];
-    size_t bytes_read;
-    while ((bytes_read = fread(buffer, 1, sizeof(buffer), input)) > 0) {
-        /* Reallocate data memory */
-        while (*size + bytes_read > alloc_size) {
-            alloc_size *= 2;
-            data = realloc(data, alloc_size);
-            if (!data) {
-                /* Failed to reallocate */
-                if (path) fclose(input);
-                free(data);
-                *size = 0;
-                return NULL;
+void close_output(const Args* args, FILE* output) {
+    if (output != stdout && fclose(output) != 0) {
+        printf("Failed to write data to `%s'\n", args->output_path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void parse_input(const Args* args, WktPolygonCallback callback, void* user_data) {
+    InputStream* input = open_input(args);
+
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Parse);
+    if (args->parse_thread_num > 0) {
+        parse_input_parallel(args, input, callback, user_data);
+        split_alloc_set_stage(prev_stage);
+        return;
+    }
+    WktParser* parser = wkt_parser_new(callback, user_data);
+    if (!parser) {
+        printf("%s\n", wkt_parse_error_to_string(WktParseError_MemAllocFailed));
+        exit(EXIT_FAILURE);
+    }
+    wkt_parser_set_coord_mode(parser, args->coord_mode);
+
+    /* Parse data as it is read */
+    const char* data;
+    size_t len;
+    WktParseError error = WktParseError_Ok;
+    while (!error && input_stream_next(input, &data, &len))
+        error = wkt_parser_feed(parser, data, len);
+    if (!error && input_stream_error(input))
+        exit_read_error(args, input);
+    if (!error)
+        error = wkt_parser_finish(parser);
+    input_stream_close(input);
+
+    if (error) {
+        WktParseResult parse_result = wkt_parser_result(parser);
+        exit_parse_error(&parse_result);
+    }
+    wkt_parser_free(parser);
+    split_alloc_set_stage(prev_stage);
+}
+
+
+void parse_input_parallel(
+    const Args* args, InputStream* input, WktPolygonCallback callback, void* user_data)
+{
+    /* Read whole input */
+    size_t size = 0;
+    size_t len = 0;
+    char* data = NULL;
+    const char* block;
+    size_t block_len;
+    while (input_stream_next(input, &block, &block_len)) {
+        if (len + block_len > size) {
+            size_t new_size = size ? size : block_len;
+            while (new_size < len + block_len)
+                new_size *= 2;
+            char* new_data = realloc(data, new_size);
+            if (!new_data) {
+                printf("%s\n", wkt_parse_error_to_string(WktParseError_MemAllocFailed));
+                exit(EXIT_FAILURE);
             }
+            data = new_data;
+            size = new_size;
         }
+        memcpy(data + len, block, block_len);
+        len += block_len;
+    }
+    if (input_stream_error(input))
+        exit_read_error(args, input);
+    input_stream_close(input);
 
-        /* Copy data */
-        memcpy(data + *size, buffer, bytes_read);
-        *size += bytes_read;
+    /* Parse, then pass member polygons one by one */
+    WktParseResult parse_result = wkt_parse_parallel(
+        data ? data : "", len, args->coord_mode, args->parse_thread_num);
+    free(data);
+    if (parse_result.error)
+        exit_parse_error(&parse_result);
+
+    LinkedGeoPolygon* polygon = parse_result.object;
+    if (!polygon->first && !polygon->next) {
+        free_linked_geo_polygon(polygon);
+        return;
     }
+    while (polygon) {
+        LinkedGeoPolygon* next = polygon->next;
+        polygon->next = NULL;
+        callback(polygon, user_data);
+        polygon = next;
+    }
+}
+
 
-    if (path) fclose(input);
-    return data;
+void exit_read_error(const Args* args, const InputStream* input) {
+    const char* path = args->input_path;
+    printf("Failed to read data from `%s': %s\n", path ? path : "stdin", input_stream_error(input));
+    exit(EXIT_FAILURE);
+}
+
+
+void exit_parse_error(const WktParseResult* parse_result) {
+    printf(
+        "(at %d) %s\n",
+        (int) parse_result->error_pos,
+        wkt_parse_error_to_string(parse_result->error));
+    if (parse_result->message)
+        printf("%s\n", parse_result->message);
+    exit(EXIT_FAILURE);
+}
+
+
+void add_member(LinkedGeoPolygon* polygon, void* user_data) {
+    Members* members = user_data;
+    if (!members->first) {
+        members->first = polygon;
+    } else {
+        members->last->next = polygon;
+    }
+    members->last = polygon;
+}
+
+
+void process_member(LinkedGeoPolygon* polygon, void* user_data) {
+    Context* context = user_data;
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Split);
+
+    if (context->args->partition) {
+        /* Pieces are printed as they are clipped */
+        bool ok = split_context_by_base_cells(context->split_180, polygon, &print_cell_polygon, context);
+        free_linked_geo_polygon(polygon);
+        split_alloc_set_stage(prev_stage);
+        if (!ok) {
+            printf("Failed to partition polygon\n");
+            exit(EXIT_FAILURE);
+        }
+        return;
+    }
+
+    if (!is_crossed_by_180(polygon)) {
+        /* Not split */
+        output_polygon(polygon, context);
+        split_alloc_set_stage(prev_stage);
+        return;
+    }
+
+    /* Split */
+    bool ok = split_context_by_180(context->split_180, polygon, &output_polygon, context);
+    free_linked_geo_polygon(polygon);
+    split_alloc_set_stage(prev_stage);
+    if (!ok) {
+        printf("Failed to split polygon\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void output_polygon(LinkedGeoPolygon* polygon, void* user_data) {
+    Context* context = user_data;
+    const Args* args = context->args;
+
+    if (args->band_lat_num == 0) {
+        print_output_polygon(polygon, context);
+        return;
+    }
+
+    /* Cut into latitude bands */
+    bool ok = split_context_by_parallels(
+        context->split_bands, polygon, args->band_lats, args->band_lat_num, &print_output_polygon, context);
+    free_linked_geo_polygon(polygon);
+    if (!ok) {
+        printf("Failed to split polygon by parallels\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void print_output_polygon(LinkedGeoPolygon* polygon, void* user_data) {
+    Context* context = user_data;
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Output);
+    if (context->args->column) {
+        split_column_take_polygon(polygon, &context->column);
+    } else {
+        polygon_printer_add(&context->printer, polygon);
+    }
+    split_alloc_set_stage(prev_stage);
+}
+
+
+void print_cell_polygon(LinkedGeoPolygon* polygon, H3Index cell, void* user_data) {
+    Context* context = user_data;
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Output);
+    PolygonPrinter printer;
+    polygon_printer_init(&printer);
+    printer.coord_mode = context->args->coord_mode;
+    printer.output = context->printer.output;
+    fprintf(printer.output, "%llx ", (unsigned long long) cell);
+    polygon_printer_add(&printer, polygon);
+    polygon_printer_finish(&printer);
+    fputc('\n', printer.output);
+    split_alloc_set_stage(prev_stage);
+}
+
+
+void split_large_member(LinkedGeoPolygon* polygon, void* user_data) {
+    /* Member is split as soon as it is parsed, its vertices are moved to the temporary file */
+    LargeContext* context = user_data;
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Split);
+    bool ok = split_large_add_polygon(context->large, polygon);
+    free_linked_geo_polygon(polygon);
+    ok = ok && split_large_by_180(context->large, &context->writer) && !context->column->failed;
+    split_alloc_set_stage(prev_stage);
+    if (!ok) {
+        printf("Failed to split polygon\n");
+        exit(EXIT_FAILURE);
+    }
 }
@@ -0,0 +1,548 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <split/alloc.h>
+#include <split/h3.h>
+#include <split/split.h>
+#include <split/transform.h>
+
+/*
+  Python binding working on GeoArrow style arrays instead of WKT:
+  coordinates are float64 (lng, lat) pairs in degrees, rings, polygons
+  and geometries are given by offset arrays into the next level.
+  Input arrays are read in place when they are C-contiguous float64
+  (coordinates) and int32 or int64 (offsets). Splitting runs without GIL.
+ */
+
+#define ARRAY_SIZE_INIT (64)
+#define BAND_MAX (64)
+
+typedef struct {
+    const void* data;   /* NULL for identity offsets (item i is i) */
+    bool is_int32;
+    npy_intp num;       /* number of offsets, item count + 1 */
+} Offsets;
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t size;
+    size_t item_size;
+} Array;
+
+typedef struct {
+    /* Multipolygon column */
+    Array coords;          /* double, lng lat pairs in degrees */
+    Array ring_offsets;    /* int64 */
+    Array polygon_offsets; /* int64 */
+    Array geom_offsets;    /* int64 */
+    bool failed;
+} Output;
+
+typedef enum {
+    SplitStatus_Ok = 0,
+    SplitStatus_MemAllocFailed,
+    SplitStatus_SplitFailed
+} SplitStatus;
+
+static PyObject* h3split_split_polygon(PyObject* self, PyObject* args, PyObject* kwargs);
+static PyObject* h3split_split_polygons(PyObject* self, PyObject* args, PyObject* kwargs);
+
+static PyObject* split_column(
+    PyObject* coords_obj, PyObject* ring_offsets_obj,
+    PyObject* polygon_offsets_obj, PyObject* geom_offsets_obj, PyObject* bands_obj,
+    bool is_single);
+
+static PyArrayObject* coords_from_object(PyObject* obj);
+static PyArrayObject* offsets_from_object(PyObject* obj, const char* name, Offsets* offsets);
+static bool check_offsets(const Offsets* offsets, npy_intp item_num, const char* name);
+static int parse_bands(PyObject* obj, double* lats);
+
+static SplitStatus split_geometries(
+    const double* coords, const Offsets* ring_offsets,
+    const Offsets* polygon_offsets, const Offsets* geom_offsets,
+    const SplitTransformOptions* options, Output* output);
+static bool build_geometry(
+    const double* coords, const Offsets* ring_offsets, const Offsets* polygon_offsets,
+    int64_t polygon_start, int64_t polygon_end, LinkedGeoPolygon** result);
+static bool build_ring(LinkedGeoPolygon* polygon, const double* coords, int64_t start, int64_t end);
+static void add_output_polygon(LinkedGeoPolygon* polygon, void* user_data);
+
+static inline int64_t offset_at(const Offsets* offsets, npy_intp i);
+
+static bool output_init(Output* output);
+static void output_free(Output* output);
+static PyObject* output_to_tuple(Output* output, bool is_single);
+static bool array_init(Array* array, size_t item_size);
+static bool array_push(Array* array, const void* item);
+static PyObject* array_to_numpy(Array* array, int ndim, npy_intp width, int type);
+static void array_capsule_free(PyObject* capsule);
+
+static PyMethodDef H3SplitMethods[] = {
+    {
+        "split_polygon", (PyCFunction)(void(*)(void)) h3split_split_polygon,
+        METH_VARARGS | METH_KEYWORDS,
+        "split_polygon(coords, ring_offsets, bands=None)\n\n"
+        "Splits one polygon by antimeridian (and parallels in degrees, if bands are given).\n"
+        "coords is (n, 2) or flat float64 array of lng, lat pairs in degrees, first ring\n"
+        "is the shell. Returns (coords, ring_offsets, polygon_offsets) of result polygons."
+    },
+    {
+        "split_polygons", (PyCFunction)(void(*)(void)) h3split_split_polygons,
+        METH_VARARGS | METH_KEYWORDS,
+        "split_polygons(coords, ring_offsets, polygon_offsets, geom_offsets=None, bands=None)\n\n"
+        "Splits a column of polygons (geom_offsets is None) or multipolygons.\n"
+        "Returns (coords, ring_offsets, polygon_offsets, geom_offsets) multipolygon column."
+    },
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef H3SplitModule = {
+    PyModuleDef_HEAD_INIT, "h3split",
+    "Splits polygons by antimeridian, on GeoArrow coordinate and offset arrays.",
+    -1, H3SplitMethods
+};
+
+
+PyMODINIT_FUNC PyInit_h3split() {
+    import_array();
+    return PyModule_Create(&H3SplitModule);
+}
+
+
+PyObject* h3split_split_polygon(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = {"coords", "ring_offsets", "bands", NULL};
+    PyObject* coords_obj;
+    PyObject* ring_offsets_obj;
+    PyObject* bands_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O", keywords,
+            &coords_obj, &ring_offsets_obj, &bands_obj))
+        return NULL;
+    return split_column(coords_obj, ring_offsets_obj, Py_None, Py_None, bands_obj, true);
+}
+
+
+PyObject* h3split_split_polygons(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = {"coords", "ring_offsets", "polygon_offsets", "geom_offsets", "bands", NULL};
+    PyObject* coords_obj;
+    PyObject* ring_offsets_obj;
+    PyObject* polygon_offsets_obj;
+    PyObject* geom_offsets_obj = Py_None;
+    PyObject* bands_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|OO", keywords,
+            &coords_obj, &ring_offsets_obj, &polygon_offsets_obj, &geom_offsets_obj, &bands_obj))
+        return NULL;
+    return split_column(
+        coords_obj, ring_offsets_obj, polygon_offsets_obj, geom_offsets_obj, bands_obj, false);
+}
+
+
+PyObject* split_column(
+    PyObject* coords_obj, PyObject* ring_offsets_obj,
+    PyObject* polygon_offsets_obj, PyObject* geom_offsets_obj, PyObject* bands_obj,
+    bool is_single)
+{
+    double band_lats[BAND_MAX];
+    int band_lat_num = parse_bands(bands_obj, band_lats);
+    if (band_lat_num < 0)
+        return NULL;
+
+    PyArrayObject* coords = NULL;
+    PyArrayObject* ring_offsets = NULL;
+    PyArrayObject* polygon_offsets = NULL;
+    PyArrayObject* geom_offsets = NULL;
+    PyObject* result = NULL;
+
+    /* Single polygon is a column of one polygon made of all rings */
+    Offsets rings = {0};
+    Offsets polygons = {0};
+    Offsets geoms = {0};
+    int64_t single_polygon_offsets[2] = {0};
+
+    coords = coords_from_object(coords_obj);
+    if (!coords)
+        goto finish;
+    npy_intp coord_num = PyArray_SIZE(coords) / 2;
+
+    ring_offsets = offsets_from_object(ring_offsets_obj, "ring_offsets", &rings);
+    if (!ring_offsets || !check_offsets(&rings, coord_num, "ring_offsets"))
+        goto finish;
+    if (is_single) {
+        single_polygon_offsets[1] = rings.num - 1;
+        polygons = (Offsets){single_polygon_offsets, false, 2};
+        geoms = (Offsets){NULL, false, 2};
+    } else {
+        polygon_offsets = offsets_from_object(polygon_offsets_obj, "polygon_offsets", &polygons);
+        if (!polygon_offsets || !check_offsets(&polygons, rings.num - 1, "polygon_offsets"))
+            goto finish;
+        if (geom_offsets_obj == Py_None) {
+            geoms = (Offsets){NULL, false, polygons.num};
+        } else {
+            geom_offsets = offsets_from_object(geom_offsets_obj, "geom_offsets", &geoms);
+            if (!geom_offsets || !check_offsets(&geoms, polygons.num - 1, "geom_offsets"))
+                goto finish;
+        }
+    }
+
+    Output output;
+    if (!output_init(&output)) {
+        PyErr_NoMemory();
+        goto finish;
+    }
+    SplitTransformOptions options = {CoordMode_Double, band_lats, band_lat_num};
+    SplitStatus status;
+    Py_BEGIN_ALLOW_THREADS
+    status = split_geometries(
+        (const double*) PyArray_DATA(coords), &rings, &polygons, &geoms, &options, &output);
+    Py_END_ALLOW_THREADS
+
+    if (status == SplitStatus_MemAllocFailed) {
+        PyErr_NoMemory();
+    } else if (status == SplitStatus_SplitFailed) {
+        PyErr_SetString(PyExc_RuntimeError, "Failed to split polygon");
+    } else {
+        result = output_to_tuple(&output, is_single);
+    }
+    output_free(&output);
+
+finish:
+    Py_XDECREF(coords);
+    Py_XDECREF(ring_offsets);
+    Py_XDECREF(polygon_offsets);
+    Py_XDECREF(geom_offsets);
+    return result;
+}
+
+
+PyArrayObject* coords_from_object(PyObject* obj) {
+    /* No copy for C-contiguous float64 arrays */
+    PyArrayObject* array = (PyArrayObject*) PyArray_FROMANY(
+        obj, NPY_DOUBLE, 1, 2, NPY_ARRAY_IN_ARRAY);
+    if (!array)
+        return NULL;
+    bool is_valid = (PyArray_NDIM(array) == 2)
+        ? PyArray_DIM(array, 1) == 2
+        : PyArray_DIM(array, 0) % 2 == 0;
+    if (!is_valid) {
+        PyErr_SetString(PyExc_ValueError, "coords must be (n, 2) or flat array of lng, lat pairs");
+        Py_DECREF(array);
+        return NULL;
+    }
+    return array;
+}
+
+
+PyArrayObject* offsets_from_object(PyObject* obj, const char* name, Offsets* offsets) {
+    /* int32 and int64 arrays are used as they are, other integer types are converted */
+    PyArrayObject* array = (PyArrayObject*) PyArray_FROMANY(obj, NPY_NOTYPE, 1, 1, 0);
+    if (!array)
+        return NULL;
+    int type = PyArray_TYPE(array);
+    if (type != NPY_INT32 && type != NPY_INT64) {
+        if (!PyArray_ISINTEGER(array)) {
+            PyErr_Format(PyExc_TypeError, "%s must be an integer array", name);
+            Py_DECREF(array);
+            return NULL;
+        }
+        type = NPY_INT64;
+    }
+    PyArrayObject* result = (PyArrayObject*) PyArray_FROMANY(
+        (PyObject*) array, type, 1, 1, NPY_ARRAY_IN_ARRAY);
+    Py_DECREF(array);
+    if (!result)
+        return NULL;
+
+    offsets->data = PyArray_DATA(result);
+    offsets->is_int32 = (type == NPY_INT32);
+    offsets->num = PyArray_DIM(result, 0);
+    return result;
+}
+
+
+bool check_offsets(const Offsets* offsets, npy_intp item_num, const char* name) {
+    /* Offsets must be non-decreasing and point into the next level */
+    if (offsets->num < 1) {
+        PyErr_Format(PyExc_ValueError, "%s must not be empty", name);
+        return false;
+    }
+    int64_t prev = 0;
+    for (npy_intp i = 0; i < offsets->num; i++) {
+        int64_t offset = offset_at(offsets, i);
+        if (offset < prev || offset > item_num) {
+            PyErr_Format(PyExc_ValueError, "%s: invalid offset %lld at %lld",
+                name, (long long) offset, (long long) i);
+            return false;
+        }
+        prev = offset;
+    }
+    return true;
+}
+
+
+int parse_bands(PyObject* obj, double* lats) {
+    /* Returns number of band latitudes (radians) or -1 on error */
+    if (obj == Py_None)
+        return 0;
+    PyArrayObject* array = (PyArrayObject*) PyArray_FROMANY(obj, NPY_DOUBLE, 0, 1, NPY_ARRAY_IN_ARRAY);
+    if (!array)
+        return -1;
+    npy_intp num = PyArray_SIZE(array);
+    if (num > BAND_MAX) {
+        PyErr_Format(PyExc_ValueError, "too many band latitudes, %d at most", BAND_MAX);
+        Py_DECREF(array);
+        return -1;
+    }
+    const double* values = PyArray_DATA(array);
+    for (npy_intp i = 0; i < num; i++) {
+        if (!(values[i] > -90.0 && values[i] < 90.0)) {
+            PyErr_SetString(PyExc_ValueError, "band latitudes must be in (-90, 90)");
+            Py_DECREF(array);
+            return -1;
+        }
+        lats[i] = degsToRads(values[i]);
+    }
+    Py_DECREF(array);
+    return (int) num;
+}
+
+
+SplitStatus split_geometries(
+    const double* coords, const Offsets* ring_offsets,
+    const Offsets* polygon_offsets, const Offsets* geom_offsets,
+    const SplitTransformOptions* options, Output* output)
+{
+    /* Runs without GIL */
+    SplitContext* context = split_context_new();
+    if (!context)
+        return SplitStatus_MemAllocFailed;
+
+    SplitStatus status = SplitStatus_Ok;
+    for (npy_intp i = 0; i + 1 < geom_offsets->num; i++) {
+        int64_t start = offset_at(geom_offsets, i);
+        int64_t end = offset_at(geom_offsets, i + 1);
+        LinkedGeoPolygon* polygon;
+        if (!build_geometry(coords, ring_offsets, polygon_offsets, start, end, &polygon)) {
+            status = SplitStatus_MemAllocFailed;
+            break;
+        }
+        if (polygon) {
+            if (!split_context_members(context, polygon, options, &add_output_polygon, output)) {
+                status = SplitStatus_SplitFailed;
+                break;
+            }
+        }
+        int64_t polygon_num = output->polygon_offsets.len - 1;
+        if (output->failed || !array_push(&output->geom_offsets, &polygon_num)) {
+            status = SplitStatus_MemAllocFailed;
+            break;
+        }
+    }
+    if (output->failed)
+        status = SplitStatus_MemAllocFailed;
+
+    split_context_free(context);
+    return status;
+}
+
+
+bool build_geometry(
+    const double* coords, const Offsets* ring_offsets, const Offsets* polygon_offsets,
+    int64_t polygon_start, int64_t polygon_end, LinkedGeoPolygon** result)
+{
+    /* Builds list of member polygons the way parser does, empty polygons are skipped */
+    LinkedGeoPolygon* first = NULL;
+    LinkedGeoPolygon* last = NULL;
+    for (int64_t i = polygon_start; i < polygon_end; i++) {
+        int64_t ring_start = offset_at(polygon_offsets, i);
+        int64_t ring_end = offset_at(polygon_offsets, i + 1);
+        if (ring_start == ring_end)
+            continue;
+
+        LinkedGeoPolygon* polygon = split_malloc(sizeof(LinkedGeoPolygon));
+        if (!polygon)
+            goto failed;
+        *polygon = (LinkedGeoPolygon){0};
+        if (!first) {
+            first = polygon;
+        } else {
+            last->next = polygon;
+        }
+        last = polygon;
+
+        for (int64_t j = ring_start; j < ring_end; j++) {
+            int64_t start = offset_at(ring_offsets, j);
+            int64_t end = offset_at(ring_offsets, j + 1);
+            if (!build_ring(polygon, coords, start, end))
+                goto failed;
+        }
+    }
+    *result = first;
+    return true;
+
+failed:
+    if (first)
+        free_linked_geo_polygon(first);
+    return false;
+}
+
+
+bool build_ring(LinkedGeoPolygon* polygon, const double* coords, int64_t start, int64_t end) {
+    LinkedGeoLoop* ring = split_malloc(sizeof(LinkedGeoLoop));
+    if (!ring)
+        return false;
+    *ring = (LinkedGeoLoop){0};
+    add_linked_geo_loop(polygon, ring);
+
+    /* Closing point is skipped if it matches first point exactly */
+    if (end - start > 1
+        && coords[2 * start] == coords[2 * (end - 1)]
+        && coords[2 * start + 1] == coords[2 * (end - 1) + 1])
+    {
+        end--;
+    }
+    for (int64_t i = start; i < end; i++) {
+        LinkedLatLng* point = split_malloc(sizeof(LinkedLatLng));
+        if (!point)
+            return false;
+        *point = (LinkedLatLng){0};
+        point->vertex.lng = degsToRads(coords[2 * i]);
+        point->vertex.lat = degsToRads(coords[2 * i + 1]);
+        add_linked_latlng(ring, point);
+    }
+    return true;
+}
+
+
+void add_output_polygon(LinkedGeoPolygon* polygon, void* user_data) {
+    /* Rings are closed in output, as GeoArrow expects */
+    Output* output = user_data;
+    for (LinkedGeoLoop* ring = polygon->first; ring && !output->failed; ring = ring->next) {
+        for (LinkedLatLng* point = ring->first; point; point = point->next) {
+            double lng_lat[2] = {radsToDegs(point->vertex.lng), radsToDegs(point->vertex.lat)};
+            if (!array_push(&output->coords, lng_lat)) {
+                output->failed = true;
+                break;
+            }
+        }
+        if (ring->first) {
+            double lng_lat[2] = {radsToDegs(ring->first->vertex.lng), radsToDegs(ring->first->vertex.lat)};
+            if (!array_push(&output->coords, lng_lat))
+                output->failed = true;
+        }
+        int64_t coord_num = output->coords.len;
+        if (!array_push(&output->ring_offsets, &coord_num))
+            output->failed = true;
+    }
+    int64_t ring_num = output->ring_offsets.len - 1;
+    if (!array_push(&output->polygon_offsets, &ring_num))
+        output->failed = true;
+    free_linked_geo_polygon(polygon);
+}
+
+
+int64_t offset_at(const Offsets* offsets, npy_intp i) {
+    if (!offsets->data)
+        return i;
+    if (offsets->is_int32)
+        return ((const int32_t*) offsets->data)[i];
+    return ((const int64_t*) offsets->data)[i];
+}
+
+
+bool output_init(Output* output) {
+    *output = (Output){0};
+    int64_t zero = 0;
+    if (array_init(&output->coords, 2 * sizeof(double))
+        && array_init(&output->ring_offsets, sizeof(int64_t))
+        && array_init(&output->polygon_offsets, sizeof(int64_t))
+        && array_init(&output->geom_offsets, sizeof(int64_t))
+        && array_push(&output->ring_offsets, &zero)
+        && array_push(&output->polygon_offsets, &zero)
+        && array_push(&output->geom_offsets, &zero))
+    {
+        return true;
+    }
+    output_free(output);
+    return false;
+}
+
+
+void output_free(Output* output) {
+    /* Arrays handed over to numpy are NULL already */
+    free(output->coords.data);
+    free(output->ring_offsets.data);
+    free(output->polygon_offsets.data);
+    free(output->geom_offsets.data);
+}
+
+
+PyObject* output_to_tuple(Output* output, bool is_single) {
+    PyObject* coords = array_to_numpy(&output->coords, 2, 2, NPY_DOUBLE);
+    PyObject* ring_offsets = array_to_numpy(&output->ring_offsets, 1, 0, NPY_INT64);
+    PyObject* polygon_offsets = array_to_numpy(&output->polygon_offsets, 1, 0, NPY_INT64);
+    PyObject* geom_offsets = is_single ? NULL : array_to_numpy(&output->geom_offsets, 1, 0, NPY_INT64);
+    PyObject* result = NULL;
+    if (coords && ring_offsets && polygon_offsets && (is_single || geom_offsets)) {
+        result = is_single
+            ? PyTuple_Pack(3, coords, ring_offsets, polygon_offsets)
+            : PyTuple_Pack(4, coords, ring_offsets, polygon_offsets, geom_offsets);
+    }
+    Py_XDECREF(coords);
+    Py_XDECREF(ring_offsets);
+    Py_XDECREF(polygon_offsets);
+    Py_XDECREF(geom_offsets);
+    return result;
+}
+
+
+bool array_init(Array* array, size_t item_size) {
+    array->data = malloc(ARRAY_SIZE_INIT * item_size);
+    array->len = 0;
+    array->size = ARRAY_SIZE_INIT;
+    array->item_size = item_size;
+    return array->data != NULL;
+}
+
+
+bool array_push(Array* array, const void* item) {
+    if (array->len == array->size) {
+        char* data = realloc(array->data, 2 * array->size * array->item_size);
+        if (!data)
+            return false;
+        array->data = data;
+        array->size *= 2;
+    }
+    memcpy(array->data + array->len * array->item_size, item, array->item_size);
+    array->len++;
+    return true;
+}
+
+
+PyObject* array_to_numpy(Array* array, int ndim, npy_intp width, int type) {
+    /* Numpy array takes over array memory, freed with the array through capsule */
+    npy_intp dims[2] = {array->len, width};
+    PyObject* capsule = PyCapsule_New(array->data, NULL, &array_capsule_free);
+    if (!capsule)
+        return NULL;
+    array->data = NULL;
+    PyObject* result = PyArray_SimpleNewFromData(ndim, dims, type, PyCapsule_GetPointer(capsule, NULL));
+    if (!result) {
+        Py_DECREF(capsule);
+        return NULL;
+    }
+    if (PyArray_SetBaseObject((PyArrayObject*) result, capsule) < 0) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    return result;
+}
+
+
+void array_capsule_free(PyObject* capsule) {
+    free(PyCapsule_GetPointer(capsule, NULL));
+}
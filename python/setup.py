@@ -0,0 +1,28 @@
+# Builds h3split extension against installed split and h3 libraries:
+#   SPLIT_PREFIX=/path/to/install pip install ./python
+import os
+
+import numpy
+from setuptools import Extension, setup
+
+prefix = os.environ.get("SPLIT_PREFIX")
+include_dirs = [numpy.get_include()]
+library_dirs = []
+if prefix:
+    include_dirs.append(os.path.join(prefix, "include"))
+    library_dirs.append(os.path.join(prefix, "lib"))
+
+setup(
+    name="h3split",
+    version="1.0",
+    ext_modules=[
+        Extension(
+            "h3split",
+            sources=["h3split.c"],
+            include_dirs=include_dirs,
+            library_dirs=library_dirs,
+            runtime_library_dirs=library_dirs,
+            libraries=["split", "h3", "m"],
+        )
+    ],
+)
@@ -0,0 +1,74 @@
+# Run after building in place: python3 setup.py build_ext --inplace && python3 test_h3split.py
+import threading
+import unittest
+
+import numpy as np
+
+import h3split
+
+
+class TestSplit(unittest.TestCase):
+    crossing = np.array([[-170, 10], [170, 10], [170, -10], [-170, -10], [-170, 10]], dtype=np.float64)
+    not_crossing = np.array([[10, 10], [20, 10], [20, 20], [10, 10]], dtype=np.float64)
+
+    def test_split_polygon(self):
+        coords, ring_offsets, polygon_offsets = h3split.split_polygon(self.crossing, np.array([0, 5]))
+        self.assertEqual(list(polygon_offsets), [0, 1, 2])
+        self.assertEqual(list(ring_offsets), [0, 5, 10])
+        # Same as `MULTIPOLYGON(((-170 10, -180 10.151082, -180 -10.151082, -170 -10, ...' from split tool
+        np.testing.assert_allclose(coords[:5], [
+            [-170, 10], [-180, 10.151082], [-180, -10.151082], [-170, -10], [-170, 10]], atol=1e-6)
+        np.testing.assert_allclose(coords[5:], [
+            [170, 10], [170, -10], [180, -10.151082], [180, 10.151082], [170, 10]], atol=1e-6)
+
+    def test_not_crossing(self):
+        coords, ring_offsets, polygon_offsets = h3split.split_polygon(
+            self.not_crossing.ravel(), np.array([0, 4], dtype=np.int32))
+        np.testing.assert_allclose(coords, self.not_crossing, atol=1e-12)
+        self.assertEqual(list(ring_offsets), [0, 4])
+        self.assertEqual(list(polygon_offsets), [0, 1])
+
+    def test_column(self):
+        # Polygon column: crossing polygon, empty polygon, not crossing polygon
+        coords = np.concatenate([self.crossing, self.not_crossing])
+        result = h3split.split_polygons(coords, np.array([0, 5, 9]), np.array([0, 1, 1, 2]))
+        coords, ring_offsets, polygon_offsets, geom_offsets = result
+        self.assertEqual(list(geom_offsets), [0, 2, 2, 3])
+        self.assertEqual(list(polygon_offsets), [0, 1, 2, 3])
+        self.assertEqual(list(ring_offsets), [0, 5, 10, 14])
+
+        # Multipolygon column: one geometry of both polygons, cut into bands
+        result = h3split.split_polygons(
+            coords[:0 + 14], np.array([0, 5, 10, 14]), np.array([0, 1, 2, 3]), np.array([0, 3]), bands=[0])
+        self.assertEqual(list(result[3]), [0, 5])
+
+    def test_invalid(self):
+        with self.assertRaises(ValueError):
+            h3split.split_polygon(self.crossing, np.array([0, 6]))
+        with self.assertRaises(ValueError):
+            h3split.split_polygon(self.crossing[:, :1], np.array([0, 5]))
+        with self.assertRaises(TypeError):
+            h3split.split_polygon(self.crossing, np.array([0.0, 5.0]))
+
+    def test_threads(self):
+        n = 1000
+        coords = np.tile(self.crossing, (n, 1))
+        ring_offsets = np.arange(n + 1) * 5
+        polygon_offsets = np.arange(n + 1)
+        results = []
+        threads = [
+            threading.Thread(target=lambda: results.append(
+                h3split.split_polygons(coords, ring_offsets, polygon_offsets)))
+            for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(len(results), 4)
+        for result in results:
+            self.assertEqual(result[3][-1], 2 * n)
+            np.testing.assert_array_equal(result[0], results[0][0])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,427 @@
+#include "serve.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <h3/h3api.h>
+#include <split/parse.h>
+#include <split/print.h>
+#include <split/split.h>
+#include <split/transform.h>
+
+#define BAND_LAT_NUM_MAX (180)
+#define CONNECTION_QUEUE_SIZE (64)
+#define FRAME_HEADER_SIZE (4)
+#define ERROR_MESSAGE_SIZE (256)
+
+static const char Status_Ok[] = "OK\n";
+static const char Status_Error[] = "ERR\n";
+
+typedef struct {
+    CoordMode coord_mode;
+    int band_lat_num;
+    double band_lats[BAND_LAT_NUM_MAX]; /* radians */
+} RequestOptions;
+
+typedef struct {
+    /* Kept between requests */
+    SplitContext* context;
+    PrintBuffer output;
+    char* request;
+    size_t request_size;
+
+    /* Current request */
+    RequestOptions options;
+    const char* error;
+    char error_message[ERROR_MESSAGE_SIZE];
+} Worker;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int fds[CONNECTION_QUEUE_SIZE];
+    int start;
+    int num;
+} ConnectionQueue;
+
+static volatile sig_atomic_t stopped = 0;
+
+static int serve_socket(const char* socket_path, int worker_num);
+static void handle_stop_signal(int signum);
+static void* worker_main(void* user_data);
+
+static void queue_init(ConnectionQueue* queue);
+static void queue_push(ConnectionQueue* queue, int fd);
+static int queue_pop(ConnectionQueue* queue);
+
+static bool worker_init(Worker* worker);
+static void worker_cleanup(Worker* worker);
+static void serve_connection(Worker* worker, int in_fd, int out_fd);
+static bool handle_request(Worker* worker, const char* body, size_t len);
+static bool parse_request_options(RequestOptions* options, const char* line, size_t len);
+static bool parse_band_lats(RequestOptions* options, const char* value, size_t len);
+
+static int read_frame(int fd, Worker* worker, size_t* len);
+static bool write_frame(int fd, const char* status, const char* data, size_t len);
+static int read_all(int fd, void* data, size_t len);
+static bool write_all(int fd, const void* data, size_t len);
+
+
+int serve(const char* socket_path, int worker_num) {
+    /* Clients may disconnect at any time, write errors are handled */
+    signal(SIGPIPE, SIG_IGN);
+
+    if (socket_path)
+        return serve_socket(socket_path, worker_num);
+
+    /* Framed stdin/stdout, requests are answered in order by a single worker */
+    Worker worker;
+    if (!worker_init(&worker)) {
+        fprintf(stderr, "Failed to allocate worker\n");
+        return EXIT_FAILURE;
+    }
+    serve_connection(&worker, STDIN_FILENO, STDOUT_FILENO);
+    worker_cleanup(&worker);
+    return EXIT_SUCCESS;
+}
+
+
+int serve_socket(const char* socket_path, int worker_num) {
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path `%s' is too long\n", socket_path);
+        return EXIT_FAILURE;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    /* Replace socket left by previous run, but never other files */
+    struct stat path_stat;
+    if (stat(socket_path, &path_stat) == 0) {
+        if (!S_ISSOCK(path_stat.st_mode)) {
+            fprintf(stderr, "`%s' exists and is not a socket\n", socket_path);
+            return EXIT_FAILURE;
+        }
+        unlink(socket_path);
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0
+        || bind(listen_fd, (struct sockaddr*) &addr, sizeof(addr)) != 0
+        || listen(listen_fd, SOMAXCONN) != 0)
+    {
+        fprintf(stderr, "Failed to listen on `%s': %s\n", socket_path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    /* Stop signals are handled by this thread only, so they interrupt accept */
+    struct sigaction action = {0};
+    action.sa_handler = &handle_stop_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    sigset_t stop_signals, prev_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &prev_signals);
+
+    static ConnectionQueue queue;
+    queue_init(&queue);
+    for (int i = 0; i < worker_num; ++i) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, &worker_main, &queue) != 0) {
+            fprintf(stderr, "Failed to start worker\n");
+            unlink(socket_path);
+            return EXIT_FAILURE;
+        }
+        pthread_detach(thread);
+    }
+    pthread_sigmask(SIG_SETMASK, &prev_signals, NULL);
+
+    while (!stopped) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            fprintf(stderr, "Failed to accept connection: %s\n", strerror(errno));
+            break;
+        }
+        queue_push(&queue, fd);
+    }
+
+    /* Workers are detached, connections in progress end with the process */
+    close(listen_fd);
+    unlink(socket_path);
+    return stopped ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+void handle_stop_signal(int signum) {
+    stopped = 1;
+}
+
+
+void* worker_main(void* user_data) {
+    ConnectionQueue* queue = user_data;
+    Worker worker;
+    if (!worker_init(&worker)) {
+        fprintf(stderr, "Failed to allocate worker\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (;;) {
+        int fd = queue_pop(queue);
+        serve_connection(&worker, fd, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+
+void queue_init(ConnectionQueue* queue) {
+    *queue = (ConnectionQueue){0};
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+}
+
+
+void queue_push(ConnectionQueue* queue, int fd) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->num == CONNECTION_QUEUE_SIZE)
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    queue->fds[(queue->start + queue->num) % CONNECTION_QUEUE_SIZE] = fd;
+    ++queue->num;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+
+int queue_pop(ConnectionQueue* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->num == 0)
+        pthread_cond_wait(&queue->cond, &queue->mutex);
+    int fd = queue->fds[queue->start];
+    queue->start = (queue->start + 1) % CONNECTION_QUEUE_SIZE;
+    --queue->num;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    return fd;
+}
+
+
+bool worker_init(Worker* worker) {
+    *worker = (Worker){0};
+    print_buffer_init(&worker->output);
+    worker->context = split_context_new();
+    return worker->context != NULL;
+}
+
+
+void worker_cleanup(Worker* worker) {
+    if (worker->context)
+        split_context_free(worker->context);
+    print_buffer_free(&worker->output);
+    free(worker->request);
+    *worker = (Worker){0};
+}
+
+
+void serve_connection(Worker* worker, int in_fd, int out_fd) {
+    for (;;) {
+        size_t len;
+        int result = read_frame(in_fd, worker, &len);
+        if (result <= 0) {
+            if (result < 0) {
+                /* Frame length is not trusted, connection can't be resynchronized */
+                write_frame(out_fd, Status_Error, worker->error, strlen(worker->error));
+            }
+            return;
+        }
+
+        bool ok = handle_request(worker, worker->request, len);
+        bool written = ok
+            ? write_frame(out_fd, Status_Ok, worker->output.data, worker->output.len)
+            : write_frame(out_fd, Status_Error, worker->error, strlen(worker->error));
+        if (!written)
+            return;
+    }
+}
+
+
+bool handle_request(Worker* worker, const char* body, size_t len) {
+    /* Option line */
+    const char* line_end = (len > 0) ? memchr(body, '\n', len) : NULL;
+    if (!line_end || !parse_request_options(&worker->options, body, line_end - body)) {
+        worker->error = "Invalid request options";
+        return false;
+    }
+    const char* payload = line_end + 1;
+    size_t payload_len = len - (payload - body);
+
+    SplitTransformOptions options = {
+        worker->options.coord_mode, worker->options.band_lats, worker->options.band_lat_num
+    };
+    SplitTransformResult result = split_context_transform(
+        worker->context, payload, payload_len, SplitFormat_Wkt, SplitFormat_Wkt,
+        &options, &worker->output);
+    if (!result.error)
+        return true;
+
+    if (result.error == SplitTransformError_Parse) {
+        /* Same message as command line */
+        snprintf(worker->error_message, sizeof(worker->error_message), "(at %d) %s%s%s",
+                 (int) result.error_pos, wkt_parse_error_to_string(result.parse_error),
+                 result.message ? "\n" : "", result.message ? result.message : "");
+        worker->error = worker->error_message;
+    } else {
+        worker->error = split_transform_error_to_string(result.error);
+    }
+    return false;
+}
+
+
+bool parse_request_options(RequestOptions* options, const char* line, size_t len) {
+    *options = (RequestOptions){0};
+
+    const char* end = line + len;
+    const char* cur = line;
+    while (cur < end) {
+        if (*cur == ' ') {
+            ++cur;
+            continue;
+        }
+        const char* token_end = memchr(cur, ' ', end - cur);
+        if (!token_end)
+            token_end = end;
+        size_t token_len = token_end - cur;
+
+        if (token_len == 3 && memcmp(cur, "wkt", 3) == 0) {
+            /* Only format so far */
+        } else if (token_len == 2 && memcmp(cur, "e7", 2) == 0) {
+            options->coord_mode = CoordMode_E7;
+        } else if (token_len > 6 && memcmp(cur, "bands=", 6) == 0) {
+            if (!parse_band_lats(options, cur + 6, token_len - 6))
+                return false;
+        } else {
+            return false;
+        }
+        cur = token_end;
+    }
+    return true;
+}
+
+
+bool parse_band_lats(RequestOptions* options, const char* value, size_t len) {
+    /* Null-terminated copy for strtod */
+    char buffer[BAND_LAT_NUM_MAX * 32];
+    if (len >= sizeof(buffer))
+        return false;
+    memcpy(buffer, value, len);
+    buffer[len] = '\0';
+
+    const char* cur = buffer;
+    while (*cur) {
+        char* end;
+        double lat = strtod(cur, &end);
+        if (end == cur || lat <= -90 || lat >= 90)
+            return false;
+        if (options->band_lat_num == BAND_LAT_NUM_MAX)
+            return false;
+        options->band_lats[options->band_lat_num++] = degsToRads(lat);
+
+        if (*end == ',') {
+            ++end;
+        } else if (*end) {
+            return false;
+        }
+        cur = end;
+    }
+    return options->band_lat_num > 0;
+}
+
+
+int read_frame(int fd, Worker* worker, size_t* len) {
+    /* Returns 1 on frame, 0 on end of input, -1 on error */
+    unsigned char header[FRAME_HEADER_SIZE];
+    int result = read_all(fd, header, sizeof(header));
+    if (result <= 0) {
+        worker->error = "Failed to read request";
+        return result;
+    }
+
+    *len = (size_t) header[0] << 24 | (size_t) header[1] << 16
+        | (size_t) header[2] << 8 | (size_t) header[3];
+    if (*len > SERVE_REQUEST_SIZE_MAX) {
+        worker->error = "Request is too large";
+        return -1;
+    }
+
+    /* Request buffer only grows */
+    if (*len > worker->request_size) {
+        char* request = realloc(worker->request, *len);
+        if (!request) {
+            worker->error = "Memory allocation failure";
+            return -1;
+        }
+        worker->request = request;
+        worker->request_size = *len;
+    }
+
+    if (read_all(fd, worker->request, *len) <= 0) {
+        worker->error = "Failed to read request";
+        return -1;
+    }
+    return 1;
+}
+
+
+bool write_frame(int fd, const char* status, const char* data, size_t len) {
+    size_t status_len = strlen(status);
+    size_t body_len = status_len + len;
+    unsigned char header[FRAME_HEADER_SIZE] = {
+        body_len >> 24, body_len >> 16, body_len >> 8, body_len
+    };
+    return write_all(fd, header, sizeof(header))
+        && write_all(fd, status, status_len)
+        && write_all(fd, data, len);
+}
+
+
+int read_all(int fd, void* data, size_t len) {
+    /* Returns 1 when all data is read, 0 on end of input before any data, -1 on error */
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = read(fd, (char*) data + done, len - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            return (done == 0) ? 0 : -1;
+        done += n;
+    }
+    return 1;
+}
+
+
+bool write_all(int fd, const void* data, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(fd, (const char*) data + done, len - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
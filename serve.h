@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+  Server mode: requests are answered by workers that keep split context
+  and output buffer between requests.
+
+  Every message is a frame: 4 byte big endian body length, then body.
+  Request body is an option line followed by WKT payload:
+
+    [wkt][ e7][ bands=<lat>[,<lat>...]]\n<wkt>
+
+  Response body is `OK\n<wkt>' or `ERR\n<message>'. A connection can carry
+  any number of requests, answers come in request order.
+ */
+
+#define SERVE_REQUEST_SIZE_MAX (64 * 1024 * 1024)
+
+/*
+  Serves a Unix domain socket with a pool of workers, one connection per worker
+  at a time, until SIGINT or SIGTERM. With NULL path serves stdin/stdout until
+  end of input. Returns process exit status.
+ */
+int serve(const char* socket_path, int worker_num);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+  Library allocator. All memory allocated by the library (parsed and split
+  polygons, parser buffers, split contexts) goes through it, so polygons
+  passed to callbacks must be freed with free_linked_geo_polygon when
+  a custom allocator is set. Sizes passed to realloc and free are the sizes
+  the block was allocated with.
+
+  Allocator is process-wide and not synchronized: set it before any library
+  memory is allocated and keep it until all of it is freed.
+ */
+typedef struct {
+    void* (*malloc)(size_t size, void* user_data);
+    void* (*realloc)(void* ptr, size_t old_size, size_t size, void* user_data);
+    void (*free)(void* ptr, size_t size, void* user_data);
+    void* user_data;
+} SplitAllocator;
+
+/* NULL restores the default (libc) allocator */
+void split_set_allocator(const SplitAllocator* allocator);
+
+void* split_malloc(size_t size);
+
+void* split_realloc(void* ptr, size_t old_size, size_t size);
+
+void split_free(void* ptr, size_t size);
+
+/*
+  Allocation stats, disabled by default. Allocations and frees are attributed
+  to the stage that is current in the allocating thread when they happen,
+  peak is the highest number of live bytes (of all stages and threads) seen
+  by an allocation in the stage. Counters are atomic, so stats are exact with
+  any number of threads; stage is per thread and starts as Other, threads
+  working for a stage have to set it.
+ */
+typedef enum {
+    SplitAllocStage_Other = 0,
+    SplitAllocStage_Parse,
+    SplitAllocStage_Split,
+    SplitAllocStage_Output,
+    SplitAllocStage_Num
+} SplitAllocStage;
+
+typedef struct {
+    uint64_t alloc_num;
+    uint64_t alloc_bytes;
+    uint64_t free_num;
+    uint64_t free_bytes;
+    uint64_t peak_bytes;
+} SplitAllocStageStats;
+
+typedef struct {
+    SplitAllocStageStats stages[SplitAllocStage_Num];
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+} SplitAllocStats;
+
+void split_alloc_stats_enable(bool enabled);
+
+/* Sets stage of calling thread, returns previous stage, so nested stages can restore it */
+SplitAllocStage split_alloc_set_stage(SplitAllocStage stage);
+
+SplitAllocStage split_alloc_get_stage();
+
+void split_alloc_stats_get(SplitAllocStats* stats);
+
+/* Live bytes are kept, so blocks allocated before reset are freed correctly */
+void split_alloc_stats_reset();
+
+const char* split_alloc_stage_to_string(SplitAllocStage stage);
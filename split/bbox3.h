@@ -2,8 +2,9 @@
 
 #include <stdbool.h>
 #include <h3/h3api.h>
+#include <split/vect3.h>
 
-typedef struct Vect3 Vect3;
+/* Small kernels are static inline, bbox of loops and segments is in bbox3.c */
 
 typedef struct Bbox3 {
     double xmin;
@@ -14,13 +15,29 @@ typedef struct Bbox3 {
     double zmax;
 } Bbox3;
 
-void bbox3_from_vect3(Bbox3* bbox, const Vect3* vect);
-
-void bbox3_merge(Bbox3* bbox, const Bbox3* other);
+static inline void bbox3_from_vect3(Bbox3* bbox, const Vect3* vect) {
+    bbox->xmin = bbox->xmax = vect->x;
+    bbox->ymin = bbox->ymax = vect->y;
+    bbox->zmin = bbox->zmax = vect->z;
+}
+
+static inline void bbox3_merge(Bbox3* bbox, const Bbox3* other) {
+    if (other->xmin < bbox->xmin) bbox->xmin = other->xmin;
+    if (other->xmax > bbox->xmax) bbox->xmax = other->xmax;
+    if (other->ymin < bbox->ymin) bbox->ymin = other->ymin;
+    if (other->ymax > bbox->ymax) bbox->ymax = other->ymax;
+    if (other->zmin < bbox->zmin) bbox->zmin = other->zmin;
+    if (other->zmax > bbox->zmax) bbox->zmax = other->zmax;
+}
 
 void bbox3_from_linked_loop(Bbox3* bbox, const LinkedGeoLoop* loop);
 
-bool bbox3_contains_vect3(const Bbox3* bbox, const Vect3* vect);
+static inline bool bbox3_contains_vect3(const Bbox3* bbox, const Vect3* vect) {
+    return bbox->xmin <= vect->x && vect->x <= bbox->xmax
+        && bbox->ymin <= vect->y && vect->y <= bbox->ymax
+        && bbox->zmin <= vect->z && vect->z <= bbox->zmax;
+}
+
 bool bbox3_contains_latlng(const Bbox3* bbox, const LatLng* latlng);
 
 void bbox3_from_segment_vect3(Bbox3* bbox, const Vect3* v1, const Vect3* v2);
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <h3/h3api.h>
+#include <split/split.h>
+#include <split/types.h>
+
+/*
+  Columnar (GeoArrow style) multipolygon column: one coordinate buffer and
+  ring, polygon and geometry offset arrays. Coordinates are interleaved
+  lng/lat pairs, double degrees or int32 E7 in E7 mode. Rings are closed
+  (last point repeats first). Offsets are int64 indexes into the next level,
+  starting at 0; geometry i has polygons geom_offsets[i]..geom_offsets[i + 1].
+
+  Column file, host byte order (little endian on supported hosts):
+
+    0   "SPLITCOL"          magic
+    8   uint32              version, 1
+    12  uint32              coordinate type, 0 double degrees, 1 int32 E7
+    16  uint64 x 4          coord_num, ring_num, polygon_num, geom_num
+    64  coords              2 * coord_num values
+        ring_offsets        ring_num + 1 int64
+        polygon_offsets     polygon_num + 1 int64
+        geom_offsets        geom_num + 1 int64
+
+  Every buffer starts at a multiple of 64 bytes, gaps are zero. A mapped file
+  is used in place, buffers can be handed to Arrow or NumPy without copying.
+ */
+
+#define SPLIT_COLUMN_ALIGNMENT (64)
+
+typedef struct {
+    void* data;
+    size_t len;  /* items */
+    size_t size; /* allocated items */
+} SplitColumnArray;
+
+/* Growable column, memory is kept by clear */
+typedef struct {
+    CoordMode coord_mode;
+    SplitColumnArray coords;
+    SplitColumnArray ring_offsets;
+    SplitColumnArray polygon_offsets;
+    SplitColumnArray geom_offsets;
+    bool failed; /* set by split_column_take_polygon */
+} SplitColumn;
+
+/* Read-only column, of a builder or a file */
+typedef struct {
+    CoordMode coord_mode;
+    const void* coords; /* double or int32_t pairs */
+    const int64_t* ring_offsets;
+    const int64_t* polygon_offsets;
+    const int64_t* geom_offsets;
+    size_t coord_num;
+    size_t ring_num;
+    size_t polygon_num;
+    size_t geom_num;
+} SplitColumnView;
+
+typedef enum {
+    SplitColumnError_Ok = 0,
+    SplitColumnError_UnalignedData,
+    SplitColumnError_InvalidHeader,
+    SplitColumnError_UnsupportedVersion,
+    SplitColumnError_InvalidSize,
+    SplitColumnError_InvalidOffsets
+} SplitColumnError;
+
+bool split_column_init(SplitColumn* column, CoordMode coord_mode);
+
+void split_column_free(SplitColumn* column);
+
+void split_column_clear(SplitColumn* column);
+
+/* Adds one member polygon (next is not followed) to current geometry */
+bool split_column_add_polygon(SplitColumn* column, const LinkedGeoPolygon* polygon);
+
+/* Polygons added since previous call form a geometry, none is an empty geometry */
+bool split_column_end_geometry(SplitColumn* column);
+
+/* Split callback: adds polygon and frees it, failed is set on failure */
+void split_column_take_polygon(LinkedGeoPolygon* polygon, void* column);
+
+SplitColumnView split_column_view(const SplitColumn* column);
+
+bool split_column_write(const SplitColumnView* view, FILE* file);
+
+/* View of file data (8-byte aligned, e.g. mapped), offsets are checked */
+SplitColumnError split_column_open(SplitColumnView* view, const void* data, size_t len);
+
+/* Member polygon list of geometry i as parsed from WKT, NULL if empty. Returns false on failure */
+bool split_column_geometry(const SplitColumnView* view, size_t i, LinkedGeoPolygon** result);
+
+/*
+  Bulk antimeridian split: every geometry of in is appended to out as one
+  geometry. Crossing is checked on column coordinates, member polygons that
+  are not crossed are copied buffer to buffer (ring closed if it was not),
+  only crossed ones are built as linked polygons and split with the context.
+  Returns false on failure, out is then incomplete.
+ */
+bool split_by_180_batch(SplitContext* context, const SplitColumnView* in, SplitColumn* out);
+
+/*
+  Column file written while geometries are added, for output that doesn't fit
+  in memory: coordinates go straight to the file, offsets are kept and written
+  by finish, which then fills in the header. File must be seekable, the
+  column starts at its current position.
+ */
+typedef struct {
+    FILE* file;
+    CoordMode coord_mode;
+    off_t header_pos;
+    uint64_t coord_num;
+    SplitColumnArray ring_offsets;
+    SplitColumnArray polygon_offsets;
+    SplitColumnArray geom_offsets;
+    bool ring_started;
+    LatLng ring_first;
+    bool failed; /* set by writer callbacks */
+} SplitColumnFile;
+
+/* Writes a placeholder header */
+bool split_column_file_init(SplitColumnFile* column, FILE* file, CoordMode coord_mode);
+
+void split_column_file_free(SplitColumnFile* column);
+
+bool split_column_file_end_geometry(SplitColumnFile* column);
+
+/* Writes offsets and header, the file is left positioned after the column */
+bool split_column_file_finish(SplitColumnFile* column);
+
+/* Point writer adding polygons to current geometry, rings are closed */
+SplitPointWriter split_column_file_writer(SplitColumnFile* column);
+
+/*
+  Out-of-core split_by_180_batch: crossed polygons are split by the large
+  split state one at a time, so neither input nor output is held in memory
+  (the input view is usually a mapped file). Vertices are read from the view
+  in place, not copied to the temporary file. Output is the same as of
+  split_by_180_batch with the fast path disabled. Returns false on failure.
+ */
+bool split_by_180_large(SplitLarge* large, const SplitColumnView* in, SplitColumnFile* out);
+
+const char* split_column_error_to_string(SplitColumnError error);
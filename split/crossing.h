@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number of segments checked by one crossing mask call */
+#define CROSSING_BLOCK_SIZE (64)
+
+/*
+  Checks segments lngs[i] -> lngs[i + 1] for i < num (num <= CROSSING_BLOCK_SIZE),
+  so lngs must hold num + 1 values; append first longitude to check a ring
+  closing segment. Bit i of result is set if segment i crosses antimeridian,
+  bit i of *prime_mask (if not NULL) if it crosses prime meridian.
+  Longitudes are in radians, segments are assumed shorter than 180 degrees.
+ */
+uint64_t lng_crossing_mask(const double* lngs, int num, uint64_t* prime_mask);
+
+/* Same check without building masks: true if any segment crosses antimeridian */
+bool lng_crossing_any(const double* lngs, int num);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <h3/h3api.h>
+
+/*
+  Fixed-point coordinates: integer degrees * 10^7 (about 1cm at the equator).
+  Conversion from E7 to radians and back is exact, so values read
+  in E7 mode compare equal whenever their decimal input matches to 7 places.
+ */
+
+#define E7_SCALE (10000000)
+#define E7_LNG_MAX (180 * E7_SCALE)
+#define E7_LAT_MAX (90 * E7_SCALE)
+
+typedef struct {
+    int32_t lat;
+    int32_t lng;
+} LatLngE7;
+
+/*
+  Parses decimal degrees without going through double, digits after
+  7th decimal place are rounded half away from zero. Exponent notation
+  falls back to strtod. Returns false on invalid number or int32 overflow.
+ */
+bool e7_parse(const char* str, size_t len, int32_t* value);
+
+double e7_to_rads(int32_t value);
+
+int32_t e7_from_rads(double rads);
+
+void latlng_from_e7(const LatLngE7* e7, LatLng* latlng);
+
+void latlng_to_e7(const LatLng* latlng, LatLngE7* e7);
+
+bool latlng_eq_e7(const LatLng* latlng1, const LatLng* latlng2);
+
+/* Formats as decimal degrees with 7 decimal places, buffer must hold E7_FORMAT_SIZE chars */
+#define E7_FORMAT_SIZE (16)
+int e7_format(int32_t value, char* buffer);
@@ -27,4 +27,38 @@ typedef struct {
 
 WktParseResult wkt_parse(const char* wkt, size_t len);
 
+WktParseResult wkt_parse_mode(const char* wkt, size_t len, CoordMode coord_mode);
+
+/*
+  Parses multipolygon members with up to thread_num threads, result is the same
+  as of wkt_parse_mode. Small input and polygons are parsed by calling thread.
+  Allocations of worker threads are counted in the stage of the calling thread.
+ */
+WktParseResult wkt_parse_parallel(const char* wkt, size_t len, CoordMode coord_mode, int thread_num);
+
 const char* wkt_parse_error_to_string(WktParseError error);
+
+/* Incremental (push) parser */
+
+/* Receives ownership of each parsed member polygon */
+typedef void (*WktPolygonCallback)(LinkedGeoPolygon* polygon, void* user_data);
+
+typedef struct WktParser WktParser;
+
+WktParser* wkt_parser_new(WktPolygonCallback callback, void* user_data);
+
+/* Coordinates are read as double by default, set before feeding data */
+void wkt_parser_set_coord_mode(WktParser* parser, CoordMode coord_mode);
+
+/* Data can be split at any position, partial tokens are kept until next chunk */
+WktParseError wkt_parser_feed(WktParser* parser, const char* chunk, size_t len);
+
+WktParseError wkt_parser_finish(WktParser* parser);
+
+/* Error and object type; error_pos is a position in the whole input stream, object is not used */
+WktParseResult wkt_parser_result(const WktParser* parser);
+
+/* Starts a new input, buffer and coordinate mode are kept; polygons already emitted are not affected */
+void wkt_parser_reset(WktParser* parser);
+
+void wkt_parser_free(WktParser* parser);
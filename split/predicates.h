@@ -0,0 +1,16 @@
+#pragma once
+
+#include <split/vect3.h>
+
+/*
+  Exact sign predicates on 3D vectors (Shewchuk-style adaptive evaluation):
+  a floating point estimate is used when its error bound proves the sign,
+  otherwise the value is recomputed exactly with floating point expansions.
+  Vectors don't need to be normalized.
+ */
+
+/* Sign of (a x b) . c: 1 if c is on the left of great circle a->b, -1 on the right */
+short orient3(const Vect3* a, const Vect3* b, const Vect3* c);
+
+/* Sign of (a x b) . (c x d) */
+short cross_dot_sign(const Vect3* a, const Vect3* b, const Vect3* c, const Vect3* d);
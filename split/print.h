@@ -1,6 +1,43 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <h3/h3api.h>
 #include <split/types.h>
 
 void print_polygon(const LinkedGeoPolygon* polygon);
+
+void print_polygon_mode(const LinkedGeoPolygon* polygon, CoordMode coord_mode);
+
+/*
+  Growable output buffer, kept between uses to avoid reallocation. Data is
+  null-terminated once anything is printed, failed is set if growing failed.
+ */
+typedef struct {
+    char* data;
+    size_t len;
+    size_t size;
+    bool failed;
+} PrintBuffer;
+
+void print_buffer_init(PrintBuffer* buffer);
+
+void print_buffer_free(PrintBuffer* buffer);
+
+/* Streaming output, output type is known once second polygon is added */
+
+typedef struct {
+    LinkedGeoPolygon* pending; /* first polygon, printed once output type is known */
+    int polygon_num;
+    CoordMode coord_mode; /* set after init, double by default */
+    FILE* output;         /* set after init, stdout by default */
+    PrintBuffer* buffer;  /* set after init, used instead of output if set */
+} PolygonPrinter;
+
+void polygon_printer_init(PolygonPrinter* printer);
+
+/* Takes ownership, polygon is freed as soon as it is printed */
+void polygon_printer_add(PolygonPrinter* printer, LinkedGeoPolygon* polygon);
+
+void polygon_printer_finish(PolygonPrinter* printer);
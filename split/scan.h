@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+  WKT lexing helpers. Bytes are classified a block at a time into bitmasks
+  (whitespace, number characters, parentheses), so a token bound is found
+  with one count of trailing zeros instead of a test per byte. Classes match
+  isspace and isalnum of the C locale.
+ */
+
+/* Number of leading whitespace bytes */
+size_t scan_ws(const char* data, size_t len);
+
+/* Number of leading number token bytes: letters, digits, `+', `-' and `.' */
+size_t scan_number(const char* data, size_t len);
+
+/* Position of the first `(' or `)', len if there is none */
+size_t scan_paren(const char* data, size_t len);
+
+/* Number of `(' minus number of `)' */
+int scan_depth(const char* data, size_t len);
+
+/*
+  Decimal number of up to 19 digits with optional exponent, exact (same as
+  strtod) when digits fit in 53 bits and decimal exponent is within 22.
+  Returns false for anything else, including valid numbers strtod would parse.
+ */
+bool scan_double(const char* str, size_t len, double* value);
@@ -1,8 +1,160 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <h3/h3api.h>
 
+/* Receives ownership of each result polygon as soon as it is complete */
+typedef void (*SplitPolygonCallback)(LinkedGeoPolygon* polygon, void* user_data);
+
 bool is_crossed_by_180(const LinkedGeoPolygon* polygon);
 
 LinkedGeoPolygon* split_by_180(const LinkedGeoPolygon* polygon);
+
+/* Returns false on failure, polygons passed to callback before that are not freed */
+bool split_by_180_each(
+    const LinkedGeoPolygon* polygon, SplitPolygonCallback callback, void* user_data);
+
+/* Latitudes are in radians, polygons are expected not to cross antimeridian */
+
+bool is_crossed_by_parallel(const LinkedGeoPolygon* polygon, double lat);
+
+LinkedGeoPolygon* split_by_parallel(const LinkedGeoPolygon* polygon, double lat);
+
+LinkedGeoPolygon* split_by_parallels(const LinkedGeoPolygon* polygon, const double* lats, int lat_num);
+
+bool split_by_parallels_each(
+    const LinkedGeoPolygon* polygon, const double* lats, int lat_num,
+    SplitPolygonCallback callback, void* user_data);
+
+/*
+  Partition by H3 resolution 0 cells: the polygon is clipped to each base cell
+  it overlaps and every piece is passed with the cell index. Cell edges are
+  great circle arcs between cellToBoundary vertices, so pieces of a polygon
+  don't overlap, don't duplicate seams and can be polyfilled independently.
+  Polygons are expected to be smaller than a hemisphere and are not split by
+  antimeridian first (arcs are the shorter way, as in the input).
+ */
+typedef void (*SplitCellPolygonCallback)(LinkedGeoPolygon* polygon, H3Index cell, void* user_data);
+
+bool split_by_base_cells_each(
+    const LinkedGeoPolygon* polygon, SplitCellPolygonCallback callback, void* user_data);
+
+/*
+  Split context keeps working memory between calls, so splitting many polygons
+  does not allocate per call. A context must only be used by one thread at a time
+  (give each worker its own) and must not be reused from a callback of a call
+  that is using it.
+ */
+typedef struct SplitContext SplitContext;
+
+SplitContext* split_context_new();
+
+void split_context_free(SplitContext* context);
+
+/* Enabled by default; single ring polygons crossed twice skip the general split */
+void split_context_set_fast_path(SplitContext* context, bool enabled);
+
+bool split_context_by_180(
+    SplitContext* context, const LinkedGeoPolygon* polygon,
+    SplitPolygonCallback callback, void* user_data);
+
+bool split_context_by_parallels(
+    SplitContext* context, const LinkedGeoPolygon* polygon, const double* lats, int lat_num,
+    SplitPolygonCallback callback, void* user_data);
+
+/* Base cell table is built on first call and kept in the context */
+bool split_context_by_base_cells(
+    SplitContext* context, const LinkedGeoPolygon* polygon,
+    SplitCellPolygonCallback callback, void* user_data);
+
+/*
+  Incremental split by antimeridian of a polygon edited in place. The state
+  keeps ring vertices, intersections in ring and line order and result
+  polygons. Replacing a vertex range only recomputes intersections of changed
+  segments, and only result polygons whose boundary or holes changed are
+  rebuilt, so a small edit takes time proportional to the edit and the number
+  of intersections rather than the number of vertices. Results are those of
+  split_by_180 of the edited polygon (order and ring start vertices may differ).
+ */
+typedef struct SplitEdit SplitEdit;
+
+/* Copies a single polygon (next members are ignored), NULL on allocation failure or empty ring */
+SplitEdit* split_edit_new(const LinkedGeoPolygon* polygon);
+
+void split_edit_free(SplitEdit* edit);
+
+/*
+  Replaces remove_num vertices of a ring (0 is the outer ring) starting at
+  start with vertex_num given vertices. Returns false if the range is invalid
+  or the ring would be left empty (the state is unchanged), or on allocation
+  failure (the state can only be freed then). A hole that doesn't cross the
+  antimeridian is assumed to stay in the same result polygon unless it moves
+  to the other side.
+ */
+bool split_edit_replace(
+    SplitEdit* edit, int ring, int start, int remove_num, const LatLng* vertices, int vertex_num);
+
+int split_edit_ring_vertex_num(const SplitEdit* edit, int ring);
+
+int split_edit_polygon_num(const SplitEdit* edit);
+
+/* Owned by the state, kept while it doesn't change. Built on first request, NULL on allocation failure */
+const LinkedGeoPolygon* split_edit_polygon(SplitEdit* edit, int idx);
+
+/*
+  True if the polygon was rebuilt by the last replacement. Edits that change
+  intersections renumber polygons, unchanged ones keep their pointers.
+ */
+bool split_edit_polygon_changed(const SplitEdit* edit, int idx);
+
+/*
+  Out-of-core split by antimeridian of a single polygon too large for memory.
+  Vertices are appended to an unlinked temporary file and mapped read-only
+  while splitting, only ring offsets and intersections are kept in memory,
+  counts are 64-bit. Result rings are passed to the writer point by point and
+  read again from the file when needed, so no result polygon is built either.
+  Results are the same as of split_by_180 with the fast path disabled.
+ */
+typedef struct SplitLarge SplitLarge;
+
+/* Rings are not closed (first point is not repeated). Returning false stops the split */
+typedef struct {
+    bool (*add_point)(const LatLng* vertex, void* user_data);
+    bool (*end_ring)(void* user_data);
+    bool (*end_polygon)(void* user_data);
+    void* user_data;
+} SplitPointWriter;
+
+/* Temporary file is created in dir, TMPDIR or /tmp if NULL. NULL on failure */
+SplitLarge* split_large_new(const char* dir);
+
+void split_large_free(SplitLarge* large);
+
+/* Returns false on write failure, the next split fails then */
+bool split_large_add_vertex(SplitLarge* large, const LatLng* vertex);
+
+/* Outer ring first, then holes. Empty ring is an error */
+bool split_large_end_ring(SplitLarge* large);
+
+/* Adds rings of a parsed polygon with split_large_add_vertex */
+bool split_large_add_polygon(SplitLarge* large, const LinkedGeoPolygon* polygon);
+
+/*
+  Vertices already in memory or mapped (a column file, say) can be read in
+  place instead of being copied to the temporary file. Rings are then added
+  by vertex range, split_large_add_vertex fails. NULL reader restores file mode.
+ */
+typedef void (*SplitVertexReader)(int64_t idx, LatLng* vertex, void* user_data);
+
+/* Clears the state. Vertices must stay readable until the split */
+void split_large_set_reader(SplitLarge* large, SplitVertexReader reader, void* user_data);
+
+/* Ring of reader vertices start .. start + vertex_num - 1. Empty ring is an error */
+bool split_large_add_ring(SplitLarge* large, int64_t start, int64_t vertex_num);
+
+/* Splits the polygon added so far, then clears the state for the next one (also on failure) */
+bool split_large_by_180(SplitLarge* large, const SplitPointWriter* writer);
+
+/* Drops added vertices and rings, the file is truncated */
+void split_large_clear(SplitLarge* large);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <split/parse.h>
+#include <split/print.h>
+#include <split/split.h>
+#include <split/types.h>
+
+/* Parse, split and print in caller memory, nothing is written to stdout */
+
+typedef enum {
+    SplitFormat_Wkt = 0
+} SplitFormat;
+
+typedef struct {
+    CoordMode coord_mode;
+    const double* band_lats; /* radians, result is also cut into bands if set */
+    int band_lat_num;
+} SplitTransformOptions;
+
+typedef enum {
+    SplitTransformError_Ok = 0,
+    SplitTransformError_UnsupportedFormat,
+    SplitTransformError_Parse,
+    SplitTransformError_Split,
+    SplitTransformError_MemAllocFailed
+} SplitTransformError;
+
+/* Parse error details are set for SplitTransformError_Parse */
+typedef struct {
+    SplitTransformError error;
+    WktParseError parse_error;
+    size_t error_pos;
+    const char* message;
+} SplitTransformResult;
+
+/*
+  Output replaces buffer contents, buffer memory is reused between calls.
+  Options can be NULL. On error output is empty. Allocations are counted in
+  parse, split and output stages of the calling thread.
+ */
+SplitTransformResult split_transform(
+    const void* in, size_t in_len, SplitFormat in_format, SplitFormat out_format,
+    const SplitTransformOptions* options, PrintBuffer* out);
+
+/* Same, using working memory of the context */
+SplitTransformResult split_context_transform(
+    SplitContext* context,
+    const void* in, size_t in_len, SplitFormat in_format, SplitFormat out_format,
+    const SplitTransformOptions* options, PrintBuffer* out);
+
+/*
+  Splits every member of a polygon list (as parsed) with the options, coordinate
+  mode is not used. Takes ownership of the polygon list, result polygons are
+  passed to callback. Returns false on failure.
+ */
+bool split_context_members(
+    SplitContext* context, LinkedGeoPolygon* polygon, const SplitTransformOptions* options,
+    SplitPolygonCallback callback, void* user_data);
+
+const char* split_transform_error_to_string(SplitTransformError error);
@@ -4,3 +4,8 @@ typedef enum {
     H3Type_None = 0,
     H3Type_GeoPolygon
 } H3Type;
+
+typedef enum {
+    CoordMode_Double = 0, /* decimal degrees parsed and printed through double */
+    CoordMode_E7          /* decimal degrees snapped to fixed-point E7 grid */
+} CoordMode;
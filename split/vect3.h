@@ -1,7 +1,19 @@
 #pragma once
 
 #include <stdbool.h>
+#include <float.h>
+#include <math.h>
 #include <h3/h3api.h>
+#ifdef SPLIT_DEBUG_CHECKS
+# include <assert.h>
+#endif
+
+/*
+  Arithmetic kernels are static inline, so they are inlined into split and
+  bbox code without LTO; conversions with trigonometry are in vect3.c.
+  Unit length of dot product arguments costs two square roots per call,
+  it is only checked when built with SPLIT_DEBUG_CHECKS.
+ */
 
 typedef struct Vect3 {
     double x;
@@ -13,18 +25,82 @@ void vect3_from_lat_lng(const LatLng *coord, Vect3 *vect);
 
 void vect3_to_lat_lng(const Vect3 *vect, LatLng *coord);
 
-bool vect3_eq(const Vect3* v1, const Vect3* v2);
+static inline bool
+vect3_fp_equal(double v1, double v2)
+{
+    return v1 == v2 || fabs(v1 - v2) < DBL_EPSILON;
+}
+
+static inline bool
+vect3_eq(const Vect3* v1, const Vect3* v2)
+{
+    return vect3_fp_equal(v1->x, v2->x)
+        && vect3_fp_equal(v1->y, v2->y)
+        && vect3_fp_equal(v1->z, v2->z);
+}
 
-double vect3_len(const Vect3 *vect);
+static inline double
+vect3_len(const Vect3 *vect)
+{
+    return sqrt(
+        vect->x * vect->x
+        + vect->y * vect->y
+        + vect->z * vect->z);
+}
 
-void vect3_normalize(Vect3 *vect);
+static inline void
+vect3_normalize(Vect3* vect)
+{
+    double len = vect3_len(vect);
+    if (len > 0) {
+        vect->x = vect->x / len;
+        vect->y = vect->y / len;
+        vect->z = vect->z / len;
+    } else {
+        vect->x = 0;
+        vect->y = 0;
+        vect->z = 0;
+    }
+}
 
-void vect3_sum(const Vect3 *vect1, const Vect3 *vect2, Vect3 *sum);
+static inline void
+vect3_sum(const Vect3 *vect1, const Vect3 *vect2, Vect3 *sum)
+{
+    sum->x = vect1->x + vect2->x;
+    sum->y = vect1->y + vect2->y;
+    sum->z = vect1->z + vect2->z;
+}
 
-void vect3_diff(const Vect3 *vect1, const Vect3 *vect2, Vect3 *diff);
+static inline void
+vect3_diff(const Vect3 *vect1, const Vect3 *vect2, Vect3 *diff)
+{
+    diff->x = vect1->x - vect2->x;
+    diff->y = vect1->y - vect2->y;
+    diff->z = vect1->z - vect2->z;
+}
 
-void vect3_cross(const Vect3 *vect1, const Vect3 *vect2, Vect3 *prod);
+static inline void
+vect3_cross(const Vect3 *vect1, const Vect3 *vect2, Vect3 *prod)
+{
+    prod->x = vect1->y * vect2->z - vect1->z * vect2->y;
+    prod->y = vect1->z * vect2->x - vect1->x * vect2->z;
+    prod->z = vect1->x * vect2->y - vect1->y * vect2->x;
+}
 
-double vect3_dot(const Vect3 *vect1, const Vect3 *vect2);
+static inline double
+vect3_dot(const Vect3 *vect1, const Vect3 *vect2)
+{
+#ifdef SPLIT_DEBUG_CHECKS
+    assert(fabs(vect3_len(vect1) - 1.0) < 1e-10);
+    assert(fabs(vect3_len(vect2) - 1.0) < 1e-10);
+#endif
+    return (vect1->x * vect2->x) + (vect1->y * vect2->y) + (vect1->z * vect2->z);
+}
 
-void vect3_scale(Vect3 *vect, double fact);
+static inline void
+vect3_scale(Vect3 *vect, double fact)
+{
+    vect->x *= fact;
+    vect->y *= fact;
+    vect->z *= fact;
+}
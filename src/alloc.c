@@ -0,0 +1,188 @@
+#include <split/alloc.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+static void* libc_malloc(size_t size, void* user_data);
+static void* libc_realloc(void* ptr, size_t old_size, size_t size, void* user_data);
+static void libc_free(void* ptr, size_t size, void* user_data);
+
+/* Stats are updated by any thread without locks */
+typedef struct {
+    _Atomic uint64_t alloc_num;
+    _Atomic uint64_t alloc_bytes;
+    _Atomic uint64_t free_num;
+    _Atomic uint64_t free_bytes;
+    _Atomic uint64_t peak_bytes;
+} StageCounters;
+
+static void stats_add(size_t size);
+static void stats_remove(size_t size);
+static void counter_max(_Atomic uint64_t* counter, uint64_t value);
+
+static const SplitAllocator LibcAllocator = {
+    &libc_malloc, &libc_realloc, &libc_free, NULL
+};
+
+static SplitAllocator allocator = {
+    &libc_malloc, &libc_realloc, &libc_free, NULL
+};
+
+static atomic_bool stats_enabled = false;
+static _Thread_local SplitAllocStage stage = SplitAllocStage_Other;
+static StageCounters stage_counters[SplitAllocStage_Num];
+static _Atomic uint64_t live_bytes = 0;
+static _Atomic uint64_t peak_bytes = 0;
+
+
+void split_set_allocator(const SplitAllocator* new_allocator) {
+    if (new_allocator) {
+        assert(new_allocator->malloc && new_allocator->realloc && new_allocator->free);
+        allocator = *new_allocator;
+    } else {
+        allocator = LibcAllocator;
+    }
+}
+
+
+void* split_malloc(size_t size) {
+    void* ptr = allocator.malloc(size, allocator.user_data);
+    if (ptr && atomic_load_explicit(&stats_enabled, memory_order_relaxed))
+        stats_add(size);
+    return ptr;
+}
+
+
+void* split_realloc(void* ptr, size_t old_size, size_t size) {
+    if (!ptr)
+        return split_malloc(size);
+
+    void* new_ptr = allocator.realloc(ptr, old_size, size, allocator.user_data);
+    if (new_ptr && atomic_load_explicit(&stats_enabled, memory_order_relaxed)) {
+        /* Counted as free of the old block and allocation of the new one */
+        stats_remove(old_size);
+        stats_add(size);
+    }
+    return new_ptr;
+}
+
+
+void split_free(void* ptr, size_t size) {
+    if (!ptr)
+        return;
+    allocator.free(ptr, size, allocator.user_data);
+    if (atomic_load_explicit(&stats_enabled, memory_order_relaxed))
+        stats_remove(size);
+}
+
+
+void split_alloc_stats_enable(bool enabled) {
+    atomic_store(&stats_enabled, enabled);
+}
+
+
+SplitAllocStage split_alloc_set_stage(SplitAllocStage new_stage) {
+    assert(new_stage >= 0 && new_stage < SplitAllocStage_Num);
+    SplitAllocStage prev_stage = stage;
+    stage = new_stage;
+    return prev_stage;
+}
+
+
+SplitAllocStage split_alloc_get_stage() {
+    return stage;
+}
+
+
+void split_alloc_stats_get(SplitAllocStats* result) {
+    for (int i = 0; i < SplitAllocStage_Num; ++i) {
+        StageCounters* counters = &stage_counters[i];
+        SplitAllocStageStats* stage_stats = &result->stages[i];
+        stage_stats->alloc_num = atomic_load(&counters->alloc_num);
+        stage_stats->alloc_bytes = atomic_load(&counters->alloc_bytes);
+        stage_stats->free_num = atomic_load(&counters->free_num);
+        stage_stats->free_bytes = atomic_load(&counters->free_bytes);
+        stage_stats->peak_bytes = atomic_load(&counters->peak_bytes);
+    }
+    result->live_bytes = atomic_load(&live_bytes);
+    result->peak_bytes = atomic_load(&peak_bytes);
+}
+
+
+void split_alloc_stats_reset() {
+    for (int i = 0; i < SplitAllocStage_Num; ++i) {
+        StageCounters* counters = &stage_counters[i];
+        atomic_store(&counters->alloc_num, 0);
+        atomic_store(&counters->alloc_bytes, 0);
+        atomic_store(&counters->free_num, 0);
+        atomic_store(&counters->free_bytes, 0);
+        atomic_store(&counters->peak_bytes, 0);
+    }
+    atomic_store(&peak_bytes, atomic_load(&live_bytes));
+}
+
+
+const char* split_alloc_stage_to_string(SplitAllocStage stage) {
+    switch (stage) {
+        case SplitAllocStage_Other:
+            return "other";
+        case SplitAllocStage_Parse:
+            return "parse";
+        case SplitAllocStage_Split:
+            return "split";
+        case SplitAllocStage_Output:
+            return "output";
+        default:
+            assert(false);
+            return NULL;
+    }
+}
+
+
+void stats_add(size_t size) {
+    StageCounters* counters = &stage_counters[stage];
+    atomic_fetch_add_explicit(&counters->alloc_num, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->alloc_bytes, size, memory_order_relaxed);
+
+    uint64_t live = atomic_fetch_add_explicit(&live_bytes, size, memory_order_relaxed) + size;
+    counter_max(&peak_bytes, live);
+    counter_max(&counters->peak_bytes, live);
+}
+
+
+void stats_remove(size_t size) {
+    StageCounters* counters = &stage_counters[stage];
+    atomic_fetch_add_explicit(&counters->free_num, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->free_bytes, size, memory_order_relaxed);
+
+    /* Blocks allocated while stats were disabled are not counted as live */
+    uint64_t live = atomic_load_explicit(&live_bytes, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+               &live_bytes, &live, (live > size) ? live - size : 0,
+               memory_order_relaxed, memory_order_relaxed))
+    {}
+}
+
+
+void counter_max(_Atomic uint64_t* counter, uint64_t value) {
+    uint64_t current = atomic_load_explicit(counter, memory_order_relaxed);
+    while (current < value
+           && !atomic_compare_exchange_weak_explicit(
+               counter, &current, value, memory_order_relaxed, memory_order_relaxed))
+    {}
+}
+
+
+void* libc_malloc(size_t size, void* user_data) {
+    return malloc(size);
+}
+
+
+void* libc_realloc(void* ptr, size_t old_size, size_t size, void* user_data) {
+    return realloc(ptr, size);
+}
+
+
+void libc_free(void* ptr, size_t size, void* user_data) {
+    free(ptr);
+}
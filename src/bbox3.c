@@ -20,23 +20,6 @@ static void vect2_normalize(Vect2* vect);
 static short vect2_segment_side(const Vect2* v1, const Vect2* v2, const Vect2* v);
 
 
-void bbox3_from_vect3(Bbox3* bbox, const Vect3* vect) {
-    bbox->xmin = bbox->xmax = vect->x;
-    bbox->ymin = bbox->ymax = vect->y;
-    bbox->zmin = bbox->zmax = vect->z;
-}
-
-
-void bbox3_merge(Bbox3* bbox, const Bbox3* other) {
-    if (other->xmin < bbox->xmin) bbox->xmin = other->xmin;
-    if (other->xmax > bbox->xmax) bbox->xmax = other->xmax;
-    if (other->ymin < bbox->ymin) bbox->ymin = other->ymin;
-    if (other->ymax > bbox->ymax) bbox->ymax = other->ymax;
-    if (other->zmin < bbox->zmin) bbox->zmin = other->zmin;
-    if (other->zmax > bbox->zmax) bbox->zmax = other->zmax;
-}
-
-
 void bbox3_from_linked_loop(Bbox3* bbox, const LinkedGeoLoop* loop) {
     const LinkedLatLng* cur = loop->first;
     const LinkedLatLng* next = cur->next;
@@ -62,13 +45,6 @@ void bbox3_from_linked_loop(Bbox3* bbox, const LinkedGeoLoop* loop) {
 }
 
 
-bool bbox3_contains_vect3(const Bbox3* bbox, const Vect3* vect) {
-    return bbox->xmin <= vect->x && vect->x <= bbox->xmax
-        && bbox->ymin <= vect->y && vect->y <= bbox->ymax
-        && bbox->zmin <= vect->z && vect->z <= bbox->zmax;
-}
-
-
 bool bbox3_contains_latlng(const Bbox3* bbox, const LatLng* latlng) {
     Vect3 vect;
     vect3_from_lat_lng(latlng, &vect);
@@ -0,0 +1,688 @@
+#include <split/column.h>
+#include <assert.h>
+#include <string.h>
+#include <split/alloc.h>
+#include <split/crossing.h>
+#include <split/e7.h>
+#include <split/h3.h>
+
+static const char ColumnMagic[8] = {'S', 'P', 'L', 'I', 'T', 'C', 'O', 'L'};
+
+#define COLUMN_VERSION (1)
+#define COLUMN_ARRAY_SIZE_INIT (256)
+
+enum {
+    CoordType_Double = 0,
+    CoordType_E7
+};
+
+static size_t coord_item_size(CoordMode coord_mode);
+static bool push_point(SplitColumn* column, const LatLng* vertex);
+static void point_at(const SplitColumnView* view, int64_t i, LatLng* vertex);
+static void column_vertex_at(int64_t idx, LatLng* vertex, void* view);
+static LinkedGeoPolygon* build_polygon(const SplitColumnView* view, int64_t ring_start, int64_t ring_end);
+static bool build_ring(const SplitColumnView* view, LinkedGeoPolygon* polygon, int64_t start, int64_t end);
+static bool is_ring_crossed_by_180(const SplitColumnView* view, int64_t start, int64_t end);
+static void load_lngs(const SplitColumnView* view, int64_t start, int num, double* lngs);
+static bool copy_polygon(const SplitColumnView* view, int64_t ring_start, int64_t ring_end, SplitColumn* out);
+static bool copy_points(const SplitColumnView* view, int64_t start, int64_t end, SplitColumn* out);
+static bool column_file_add_polygon(
+    SplitLarge* large, const SplitColumnView* view, int64_t ring_start, int64_t ring_end);
+static bool column_file_copy_polygon(
+    const SplitColumnView* view, int64_t ring_start, int64_t ring_end, SplitColumnFile* out);
+static bool column_file_copy_points(const SplitColumnView* view, int64_t start, int64_t end, SplitColumnFile* out);
+static bool column_file_write_point(SplitColumnFile* column, const LatLng* vertex);
+static bool column_file_add_point(const LatLng* vertex, void* column);
+static bool column_file_end_ring(void* column);
+static bool column_file_end_polygon(void* column);
+static bool write_header(FILE* file, CoordMode coord_mode, const uint64_t* nums);
+static bool write_aligned(FILE* file, const void* data, size_t len);
+static size_t aligned_size(size_t len);
+static bool check_offsets(const int64_t* offsets, size_t num, size_t item_num);
+
+static void array_free(SplitColumnArray* array, size_t item_size);
+static bool array_push(SplitColumnArray* array, size_t item_size, const void* item);
+static bool array_append(SplitColumnArray* array, size_t item_size, const void* items, size_t num);
+
+
+bool split_column_init(SplitColumn* column, CoordMode coord_mode) {
+    *column = (SplitColumn){0};
+    column->coord_mode = coord_mode;
+    int64_t zero = 0;
+    if (array_push(&column->ring_offsets, sizeof(int64_t), &zero)
+        && array_push(&column->polygon_offsets, sizeof(int64_t), &zero)
+        && array_push(&column->geom_offsets, sizeof(int64_t), &zero))
+        return true;
+    split_column_free(column);
+    return false;
+}
+
+
+void split_column_free(SplitColumn* column) {
+    array_free(&column->coords, coord_item_size(column->coord_mode));
+    array_free(&column->ring_offsets, sizeof(int64_t));
+    array_free(&column->polygon_offsets, sizeof(int64_t));
+    array_free(&column->geom_offsets, sizeof(int64_t));
+    *column = (SplitColumn){0};
+}
+
+
+void split_column_clear(SplitColumn* column) {
+    /* Leading zero offsets are kept */
+    column->coords.len = 0;
+    column->ring_offsets.len = 1;
+    column->polygon_offsets.len = 1;
+    column->geom_offsets.len = 1;
+    column->failed = false;
+}
+
+
+bool split_column_add_polygon(SplitColumn* column, const LinkedGeoPolygon* polygon) {
+    for (const LinkedGeoLoop* ring = polygon->first; ring; ring = ring->next) {
+        for (const LinkedLatLng* point = ring->first; point; point = point->next) {
+            if (!push_point(column, &point->vertex))
+                return false;
+        }
+        if (ring->first && !push_point(column, &ring->first->vertex))
+            return false;
+
+        int64_t coord_num = column->coords.len;
+        if (!array_push(&column->ring_offsets, sizeof(int64_t), &coord_num))
+            return false;
+    }
+    int64_t ring_num = column->ring_offsets.len - 1;
+    return array_push(&column->polygon_offsets, sizeof(int64_t), &ring_num);
+}
+
+
+bool split_column_end_geometry(SplitColumn* column) {
+    int64_t polygon_num = column->polygon_offsets.len - 1;
+    return array_push(&column->geom_offsets, sizeof(int64_t), &polygon_num);
+}
+
+
+void split_column_take_polygon(LinkedGeoPolygon* polygon, void* column) {
+    SplitColumn* split_column = column;
+    if (!split_column->failed && !split_column_add_polygon(split_column, polygon))
+        split_column->failed = true;
+    free_linked_geo_polygon(polygon);
+}
+
+
+SplitColumnView split_column_view(const SplitColumn* column) {
+    SplitColumnView view = {
+        column->coord_mode,
+        column->coords.data,
+        column->ring_offsets.data,
+        column->polygon_offsets.data,
+        column->geom_offsets.data,
+        column->coords.len,
+        column->ring_offsets.len - 1,
+        column->polygon_offsets.len - 1,
+        column->geom_offsets.len - 1
+    };
+    return view;
+}
+
+
+bool split_column_write(const SplitColumnView* view, FILE* file) {
+    uint64_t nums[4] = {view->coord_num, view->ring_num, view->polygon_num, view->geom_num};
+    return write_header(file, view->coord_mode, nums)
+        && write_aligned(file, view->coords, view->coord_num * coord_item_size(view->coord_mode))
+        && write_aligned(file, view->ring_offsets, (view->ring_num + 1) * sizeof(int64_t))
+        && write_aligned(file, view->polygon_offsets, (view->polygon_num + 1) * sizeof(int64_t))
+        && write_aligned(file, view->geom_offsets, (view->geom_num + 1) * sizeof(int64_t));
+}
+
+
+SplitColumnError split_column_open(SplitColumnView* view, const void* data, size_t len) {
+    const unsigned char* bytes = data;
+    if ((uintptr_t) data % sizeof(int64_t) != 0)
+        return SplitColumnError_UnalignedData;
+    if (len < SPLIT_COLUMN_ALIGNMENT || memcmp(bytes, ColumnMagic, sizeof(ColumnMagic)) != 0)
+        return SplitColumnError_InvalidHeader;
+
+    uint32_t version;
+    uint32_t coord_type;
+    uint64_t nums[4];
+    memcpy(&version, bytes + 8, sizeof(version));
+    memcpy(&coord_type, bytes + 12, sizeof(coord_type));
+    memcpy(nums, bytes + 16, sizeof(nums));
+    if (version != COLUMN_VERSION)
+        return SplitColumnError_UnsupportedVersion;
+    if (coord_type != CoordType_Double && coord_type != CoordType_E7)
+        return SplitColumnError_InvalidHeader;
+    CoordMode coord_mode = (coord_type == CoordType_E7) ? CoordMode_E7 : CoordMode_Double;
+
+    /* Buffers follow header, padding after last one is optional */
+    const void* buffers[4];
+    size_t item_sizes[4] = {coord_item_size(coord_mode), sizeof(int64_t), sizeof(int64_t), sizeof(int64_t)};
+    size_t pos = SPLIT_COLUMN_ALIGNMENT;
+    for (int i = 0; i < 4; ++i) {
+        if (nums[i] >= len)
+            return SplitColumnError_InvalidSize;
+        size_t item_num = nums[i] + (i > 0); /* offsets have one more item */
+        if (pos > len || item_num > (len - pos) / item_sizes[i])
+            return SplitColumnError_InvalidSize;
+        buffers[i] = bytes + pos;
+        pos += aligned_size(item_num * item_sizes[i]);
+    }
+
+    SplitColumnView result = {
+        coord_mode, buffers[0], buffers[1], buffers[2], buffers[3], nums[0], nums[1], nums[2], nums[3]
+    };
+    if (!check_offsets(result.ring_offsets, result.ring_num, result.coord_num)
+        || !check_offsets(result.polygon_offsets, result.polygon_num, result.ring_num)
+        || !check_offsets(result.geom_offsets, result.geom_num, result.polygon_num))
+        return SplitColumnError_InvalidOffsets;
+    *view = result;
+    return SplitColumnError_Ok;
+}
+
+
+bool split_column_geometry(const SplitColumnView* view, size_t i, LinkedGeoPolygon** result) {
+    /* Empty polygons are skipped */
+    assert(i < view->geom_num);
+    LinkedGeoPolygon* first = NULL;
+    LinkedGeoPolygon* last = NULL;
+    for (int64_t j = view->geom_offsets[i]; j < view->geom_offsets[i + 1]; ++j) {
+        int64_t ring_start = view->polygon_offsets[j];
+        int64_t ring_end = view->polygon_offsets[j + 1];
+        if (ring_start == ring_end)
+            continue;
+
+        LinkedGeoPolygon* polygon = build_polygon(view, ring_start, ring_end);
+        if (!polygon) {
+            if (first)
+                free_linked_geo_polygon(first);
+            *result = NULL;
+            return false;
+        }
+        if (!first) {
+            first = polygon;
+        } else {
+            last->next = polygon;
+        }
+        last = polygon;
+    }
+    *result = first;
+    return true;
+}
+
+
+bool split_by_180_batch(SplitContext* context, const SplitColumnView* in, SplitColumn* out) {
+    for (size_t i = 0; i < in->geom_num; ++i) {
+        for (int64_t j = in->geom_offsets[i]; j < in->geom_offsets[i + 1]; ++j) {
+            int64_t ring_start = in->polygon_offsets[j];
+            int64_t ring_end = in->polygon_offsets[j + 1];
+            if (ring_start == ring_end)
+                continue;
+
+            /* Crossing is decided by outer ring, as by is_crossed_by_180 */
+            if (!is_ring_crossed_by_180(in, in->ring_offsets[ring_start], in->ring_offsets[ring_start + 1])) {
+                if (!copy_polygon(in, ring_start, ring_end, out))
+                    return false;
+                continue;
+            }
+            LinkedGeoPolygon* polygon = build_polygon(in, ring_start, ring_end);
+            if (!polygon)
+                return false;
+            bool ok = split_context_by_180(context, polygon, &split_column_take_polygon, out);
+            free_linked_geo_polygon(polygon);
+            if (!ok || out->failed)
+                return false;
+        }
+        if (!split_column_end_geometry(out))
+            return false;
+    }
+    return true;
+}
+
+
+bool split_column_file_init(SplitColumnFile* column, FILE* file, CoordMode coord_mode) {
+    *column = (SplitColumnFile){0};
+    column->file = file;
+    column->coord_mode = coord_mode;
+    column->header_pos = ftello(file);
+    int64_t zero = 0;
+    unsigned char header[SPLIT_COLUMN_ALIGNMENT] = {0};
+    if (column->header_pos >= 0
+        && array_push(&column->ring_offsets, sizeof(int64_t), &zero)
+        && array_push(&column->polygon_offsets, sizeof(int64_t), &zero)
+        && array_push(&column->geom_offsets, sizeof(int64_t), &zero)
+        && write_aligned(file, header, sizeof(header)))
+        return true;
+    split_column_file_free(column);
+    return false;
+}
+
+
+void split_column_file_free(SplitColumnFile* column) {
+    /* File is not closed */
+    array_free(&column->ring_offsets, sizeof(int64_t));
+    array_free(&column->polygon_offsets, sizeof(int64_t));
+    array_free(&column->geom_offsets, sizeof(int64_t));
+    *column = (SplitColumnFile){0};
+}
+
+
+bool split_column_file_end_geometry(SplitColumnFile* column) {
+    int64_t polygon_num = column->polygon_offsets.len - 1;
+    return array_push(&column->geom_offsets, sizeof(int64_t), &polygon_num);
+}
+
+
+bool split_column_file_finish(SplitColumnFile* column) {
+    /* Coordinates are padded, header is written over the placeholder */
+    static const char zeros[SPLIT_COLUMN_ALIGNMENT] = {0};
+    size_t coords_size = column->coord_num * coord_item_size(column->coord_mode);
+    size_t padding = aligned_size(coords_size) - coords_size;
+    uint64_t nums[4] = {
+        column->coord_num,
+        column->ring_offsets.len - 1,
+        column->polygon_offsets.len - 1,
+        column->geom_offsets.len - 1
+    };
+    if (column->failed
+        || (padding > 0 && fwrite(zeros, 1, padding, column->file) != padding)
+        || !write_aligned(column->file, column->ring_offsets.data, column->ring_offsets.len * sizeof(int64_t))
+        || !write_aligned(column->file, column->polygon_offsets.data, column->polygon_offsets.len * sizeof(int64_t))
+        || !write_aligned(column->file, column->geom_offsets.data, column->geom_offsets.len * sizeof(int64_t)))
+        return false;
+    off_t end_pos = ftello(column->file);
+    return end_pos >= 0
+        && fseeko(column->file, column->header_pos, SEEK_SET) == 0
+        && write_header(column->file, column->coord_mode, nums)
+        && fseeko(column->file, end_pos, SEEK_SET) == 0;
+}
+
+
+SplitPointWriter split_column_file_writer(SplitColumnFile* column) {
+    SplitPointWriter writer = {
+        &column_file_add_point,
+        &column_file_end_ring,
+        &column_file_end_polygon,
+        column
+    };
+    return writer;
+}
+
+
+bool split_by_180_large(SplitLarge* large, const SplitColumnView* in, SplitColumnFile* out) {
+    /* Same polygons and order as split_by_180_batch, vertices are read from the view in place */
+    SplitPointWriter writer = split_column_file_writer(out);
+    bool ok = true;
+    split_large_set_reader(large, &column_vertex_at, (void*) in);
+    for (size_t i = 0; ok && i < in->geom_num; ++i) {
+        for (int64_t j = in->geom_offsets[i]; ok && j < in->geom_offsets[i + 1]; ++j) {
+            int64_t ring_start = in->polygon_offsets[j];
+            int64_t ring_end = in->polygon_offsets[j + 1];
+            if (ring_start == ring_end)
+                continue;
+
+            if (!is_ring_crossed_by_180(in, in->ring_offsets[ring_start], in->ring_offsets[ring_start + 1])) {
+                ok = column_file_copy_polygon(in, ring_start, ring_end, out);
+            } else {
+                ok = column_file_add_polygon(large, in, ring_start, ring_end)
+                    && split_large_by_180(large, &writer)
+                    && !out->failed;
+            }
+        }
+        ok = ok && split_column_file_end_geometry(out);
+    }
+    split_large_set_reader(large, NULL, NULL);
+    return ok;
+}
+
+
+const char* split_column_error_to_string(SplitColumnError error) {
+    switch (error) {
+        case SplitColumnError_Ok:
+            return "Ok";
+        case SplitColumnError_UnalignedData:
+            return "Column data is not aligned";
+        case SplitColumnError_InvalidHeader:
+            return "Invalid column header";
+        case SplitColumnError_UnsupportedVersion:
+            return "Unsupported column version";
+        case SplitColumnError_InvalidSize:
+            return "Column data is truncated";
+        case SplitColumnError_InvalidOffsets:
+            return "Invalid column offsets";
+        default:
+            assert(false);
+            return NULL;
+    }
+}
+
+
+size_t coord_item_size(CoordMode coord_mode) {
+    return (coord_mode == CoordMode_E7) ? 2 * sizeof(int32_t) : 2 * sizeof(double);
+}
+
+
+bool push_point(SplitColumn* column, const LatLng* vertex) {
+    if (column->coord_mode == CoordMode_E7) {
+        int32_t lng_lat[2] = {e7_from_rads(vertex->lng), e7_from_rads(vertex->lat)};
+        return array_push(&column->coords, sizeof(lng_lat), lng_lat);
+    }
+    double lng_lat[2] = {radsToDegs(vertex->lng), radsToDegs(vertex->lat)};
+    return array_push(&column->coords, sizeof(lng_lat), lng_lat);
+}
+
+
+void point_at(const SplitColumnView* view, int64_t i, LatLng* vertex) {
+    if (view->coord_mode == CoordMode_E7) {
+        const int32_t* coords = view->coords;
+        vertex->lng = e7_to_rads(coords[2 * i]);
+        vertex->lat = e7_to_rads(coords[2 * i + 1]);
+    } else {
+        const double* coords = view->coords;
+        vertex->lng = degsToRads(coords[2 * i]);
+        vertex->lat = degsToRads(coords[2 * i + 1]);
+    }
+}
+
+
+void column_vertex_at(int64_t idx, LatLng* vertex, void* view) {
+    point_at(view, idx, vertex);
+}
+
+
+LinkedGeoPolygon* build_polygon(const SplitColumnView* view, int64_t ring_start, int64_t ring_end) {
+    LinkedGeoPolygon* polygon = split_malloc(sizeof(LinkedGeoPolygon));
+    if (!polygon)
+        return NULL;
+    *polygon = (LinkedGeoPolygon){0};
+    for (int64_t i = ring_start; i < ring_end; ++i) {
+        if (!build_ring(view, polygon, view->ring_offsets[i], view->ring_offsets[i + 1])) {
+            free_linked_geo_polygon(polygon);
+            return NULL;
+        }
+    }
+    return polygon;
+}
+
+
+bool build_ring(const SplitColumnView* view, LinkedGeoPolygon* polygon, int64_t start, int64_t end) {
+    LinkedGeoLoop* ring = split_malloc(sizeof(LinkedGeoLoop));
+    if (!ring)
+        return false;
+    *ring = (LinkedGeoLoop){0};
+    add_linked_geo_loop(polygon, ring);
+
+    /* Closing point is skipped, parsed rings don't repeat first point */
+    size_t item_size = coord_item_size(view->coord_mode);
+    const char* coords = view->coords;
+    if (end - start > 1
+        && memcmp(coords + start * item_size, coords + (end - 1) * item_size, item_size) == 0)
+    {
+        --end;
+    }
+    for (int64_t i = start; i < end; ++i) {
+        LinkedLatLng* point = split_malloc(sizeof(LinkedLatLng));
+        if (!point)
+            return false;
+        *point = (LinkedLatLng){0};
+        point_at(view, i, &point->vertex);
+        add_linked_latlng(ring, point);
+    }
+    return true;
+}
+
+
+bool is_ring_crossed_by_180(const SplitColumnView* view, int64_t start, int64_t end) {
+    /* Same segments as of the parsed ring: a closing point adds an empty segment */
+    if (end - start < 2)
+        return false;
+    double lngs[CROSSING_BLOCK_SIZE + 1];
+    load_lngs(view, start, 1, lngs);
+    double first_lng = lngs[0];
+    for (int64_t pos = start + 1;;) {
+        int num = (end - pos < CROSSING_BLOCK_SIZE) ? (int) (end - pos) : CROSSING_BLOCK_SIZE;
+        load_lngs(view, pos, num, lngs + 1);
+        pos += num;
+        bool closed = (num < CROSSING_BLOCK_SIZE);
+        if (closed)
+            lngs[++num] = first_lng;
+        if (lng_crossing_any(lngs, num))
+            return true;
+        if (closed)
+            return false;
+
+        /* Next block starts with last checked point */
+        lngs[0] = lngs[num];
+    }
+}
+
+
+void load_lngs(const SplitColumnView* view, int64_t start, int num, double* lngs) {
+    if (view->coord_mode == CoordMode_E7) {
+        const int32_t* coords = (const int32_t*) view->coords + 2 * start;
+        for (int i = 0; i < num; ++i)
+            lngs[i] = e7_to_rads(coords[2 * i]);
+    } else {
+        const double* coords = (const double*) view->coords + 2 * start;
+        for (int i = 0; i < num; ++i)
+            lngs[i] = degsToRads(coords[2 * i]);
+    }
+}
+
+
+bool copy_polygon(const SplitColumnView* view, int64_t ring_start, int64_t ring_end, SplitColumn* out) {
+    size_t item_size = coord_item_size(view->coord_mode);
+    const char* coords = view->coords;
+    for (int64_t i = ring_start; i < ring_end; ++i) {
+        int64_t start = view->ring_offsets[i];
+        int64_t end = view->ring_offsets[i + 1];
+        if (!copy_points(view, start, end, out))
+            return false;
+
+        /* Rings are closed as in split output */
+        bool is_closed = end - start > 1
+            && memcmp(coords + start * item_size, coords + (end - 1) * item_size, item_size) == 0;
+        if (end > start && !is_closed && !copy_points(view, start, start + 1, out))
+            return false;
+
+        int64_t coord_num = out->coords.len;
+        if (!array_push(&out->ring_offsets, sizeof(int64_t), &coord_num))
+            return false;
+    }
+    int64_t ring_num = out->ring_offsets.len - 1;
+    return array_push(&out->polygon_offsets, sizeof(int64_t), &ring_num);
+}
+
+
+bool copy_points(const SplitColumnView* view, int64_t start, int64_t end, SplitColumn* out) {
+    size_t item_size = coord_item_size(view->coord_mode);
+    if (view->coord_mode == out->coord_mode)
+        return array_append(&out->coords, item_size, (const char*) view->coords + start * item_size, end - start);
+
+    for (int64_t i = start; i < end; ++i) {
+        LatLng vertex;
+        point_at(view, i, &vertex);
+        if (!push_point(out, &vertex))
+            return false;
+    }
+    return true;
+}
+
+
+bool write_header(FILE* file, CoordMode coord_mode, const uint64_t* nums) {
+    unsigned char header[SPLIT_COLUMN_ALIGNMENT] = {0};
+    uint32_t version = COLUMN_VERSION;
+    uint32_t coord_type = (coord_mode == CoordMode_E7) ? CoordType_E7 : CoordType_Double;
+    memcpy(header, ColumnMagic, sizeof(ColumnMagic));
+    memcpy(header + 8, &version, sizeof(version));
+    memcpy(header + 12, &coord_type, sizeof(coord_type));
+    memcpy(header + 16, nums, 4 * sizeof(uint64_t));
+    return write_aligned(file, header, sizeof(header));
+}
+
+
+bool column_file_add_polygon(SplitLarge* large, const SplitColumnView* view, int64_t ring_start, int64_t ring_end) {
+    /* Closing points are skipped, as by build_ring */
+    size_t item_size = coord_item_size(view->coord_mode);
+    const char* coords = view->coords;
+    for (int64_t i = ring_start; i < ring_end; ++i) {
+        int64_t start = view->ring_offsets[i];
+        int64_t end = view->ring_offsets[i + 1];
+        if (end - start > 1
+            && memcmp(coords + start * item_size, coords + (end - 1) * item_size, item_size) == 0)
+        {
+            --end;
+        }
+        if (!split_large_add_ring(large, start, end - start))
+            return false;
+    }
+    return true;
+}
+
+
+bool column_file_copy_polygon(
+    const SplitColumnView* view, int64_t ring_start, int64_t ring_end, SplitColumnFile* out)
+{
+    /* Same as copy_polygon */
+    size_t item_size = coord_item_size(view->coord_mode);
+    const char* coords = view->coords;
+    for (int64_t i = ring_start; i < ring_end; ++i) {
+        int64_t start = view->ring_offsets[i];
+        int64_t end = view->ring_offsets[i + 1];
+        if (!column_file_copy_points(view, start, end, out))
+            return false;
+
+        bool is_closed = end - start > 1
+            && memcmp(coords + start * item_size, coords + (end - 1) * item_size, item_size) == 0;
+        if (end > start && !is_closed && !column_file_copy_points(view, start, start + 1, out))
+            return false;
+
+        int64_t coord_num = out->coord_num;
+        if (!array_push(&out->ring_offsets, sizeof(int64_t), &coord_num))
+            return false;
+    }
+    int64_t ring_num = out->ring_offsets.len - 1;
+    return array_push(&out->polygon_offsets, sizeof(int64_t), &ring_num);
+}
+
+
+bool column_file_copy_points(const SplitColumnView* view, int64_t start, int64_t end, SplitColumnFile* out) {
+    size_t item_size = coord_item_size(view->coord_mode);
+    if (view->coord_mode == out->coord_mode) {
+        size_t size = (end - start) * item_size;
+        if (size > 0 && fwrite((const char*) view->coords + start * item_size, 1, size, out->file) != size)
+            return false;
+        out->coord_num += end - start;
+        return true;
+    }
+
+    for (int64_t i = start; i < end; ++i) {
+        LatLng vertex;
+        point_at(view, i, &vertex);
+        if (!column_file_write_point(out, &vertex))
+            return false;
+    }
+    return true;
+}
+
+
+bool column_file_write_point(SplitColumnFile* column, const LatLng* vertex) {
+    /* Same conversion as push_point */
+    bool ok;
+    if (column->coord_mode == CoordMode_E7) {
+        int32_t lng_lat[2] = {e7_from_rads(vertex->lng), e7_from_rads(vertex->lat)};
+        ok = fwrite(lng_lat, sizeof(lng_lat), 1, column->file) == 1;
+    } else {
+        double lng_lat[2] = {radsToDegs(vertex->lng), radsToDegs(vertex->lat)};
+        ok = fwrite(lng_lat, sizeof(lng_lat), 1, column->file) == 1;
+    }
+    column->coord_num += ok;
+    return ok;
+}
+
+
+bool column_file_add_point(const LatLng* vertex, void* column) {
+    SplitColumnFile* column_file = column;
+    if (!column_file->ring_started) {
+        column_file->ring_first = *vertex;
+        column_file->ring_started = true;
+    }
+    column_file->failed = column_file->failed || !column_file_write_point(column_file, vertex);
+    return !column_file->failed;
+}
+
+
+bool column_file_end_ring(void* column) {
+    /* Ring is closed as by split_column_add_polygon */
+    SplitColumnFile* column_file = column;
+    if (column_file->ring_started && !column_file_write_point(column_file, &column_file->ring_first))
+        column_file->failed = true;
+    column_file->ring_started = false;
+
+    int64_t coord_num = column_file->coord_num;
+    if (!column_file->failed && !array_push(&column_file->ring_offsets, sizeof(int64_t), &coord_num))
+        column_file->failed = true;
+    return !column_file->failed;
+}
+
+
+bool column_file_end_polygon(void* column) {
+    SplitColumnFile* column_file = column;
+    int64_t ring_num = column_file->ring_offsets.len - 1;
+    if (!column_file->failed && !array_push(&column_file->polygon_offsets, sizeof(int64_t), &ring_num))
+        column_file->failed = true;
+    return !column_file->failed;
+}
+
+
+bool write_aligned(FILE* file, const void* data, size_t len) {
+    static const char zeros[SPLIT_COLUMN_ALIGNMENT] = {0};
+    size_t padding = aligned_size(len) - len;
+    return (len == 0 || fwrite(data, 1, len, file) == len)
+        && (padding == 0 || fwrite(zeros, 1, padding, file) == padding);
+}
+
+
+size_t aligned_size(size_t len) {
+    return (len + SPLIT_COLUMN_ALIGNMENT - 1) / SPLIT_COLUMN_ALIGNMENT * SPLIT_COLUMN_ALIGNMENT;
+}
+
+
+bool check_offsets(const int64_t* offsets, size_t num, size_t item_num) {
+    /* num + 1 offsets from 0 to item_num, not decreasing */
+    if (offsets[0] != 0 || offsets[num] != (int64_t) item_num)
+        return false;
+    for (size_t i = 0; i < num; ++i) {
+        if (offsets[i + 1] < offsets[i])
+            return false;
+    }
+    return true;
+}
+
+
+void array_free(SplitColumnArray* array, size_t item_size) {
+    split_free(array->data, array->size * item_size);
+    *array = (SplitColumnArray){0};
+}
+
+
+bool array_push(SplitColumnArray* array, size_t item_size, const void* item) {
+    return array_append(array, item_size, item, 1);
+}
+
+
+bool array_append(SplitColumnArray* array, size_t item_size, const void* items, size_t num) {
+    if (array->len + num > array->size) {
+        size_t size = array->size ? array->size : COLUMN_ARRAY_SIZE_INIT;
+        while (size < array->len + num)
+            size *= 2;
+        void* data = split_realloc(array->data, array->size * item_size, size * item_size);
+        if (!data)
+            return false;
+        array->data = data;
+        array->size = size;
+    }
+    if (num > 0)
+        memcpy((char*) array->data + array->len * item_size, items, num * item_size);
+    array->len += num;
+    return true;
+}
@@ -0,0 +1,142 @@
+#include <split/crossing.h>
+#include <assert.h>
+#include <math.h>
+#if defined(__AVX__)
+# include <immintrin.h>
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#define SIGN(x) (((x) < 0) ? -1 : ((x) > 0) ? 1 : 0)
+
+/*
+  A segment crosses one of the meridians when sign of longitude changes
+  (either endpoint may be 0). It's the antimeridian if the segment is longer
+  than 180 degrees the short way, i.e. |lng1| + |lng2| > PI.
+
+  Vector code is branch-free: both tests are lane masks, packed into bits
+  with movemask. Lanes compare lngs[i] with lngs[i + 1] using two
+  overlapping unaligned loads.
+ */
+
+static bool lng_crossing_any_scalar(const double* lngs, int start, int num);
+static void lng_crossing_scalar(
+    const double* lngs, int start, int num, uint64_t* mask, uint64_t* prime_mask);
+
+
+uint64_t lng_crossing_mask(const double* lngs, int num, uint64_t* prime_mask) {
+    assert(0 <= num && num <= CROSSING_BLOCK_SIZE);
+    uint64_t mask = 0;
+    uint64_t prime = 0;
+    int i = 0;
+
+#if defined(__AVX__)
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d pi = _mm256_set1_pd(M_PI);
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    for (; i + 4 <= num; i += 4) {
+        __m256d a = _mm256_loadu_pd(lngs + i);
+        __m256d b = _mm256_loadu_pd(lngs + i + 1);
+        __m256d sign_diff = _mm256_or_pd(
+            _mm256_xor_pd(_mm256_cmp_pd(a, zero, _CMP_GT_OQ), _mm256_cmp_pd(b, zero, _CMP_GT_OQ)),
+            _mm256_xor_pd(_mm256_cmp_pd(a, zero, _CMP_LT_OQ), _mm256_cmp_pd(b, zero, _CMP_LT_OQ)));
+        __m256d sum = _mm256_add_pd(_mm256_and_pd(a, abs_mask), _mm256_and_pd(b, abs_mask));
+        __m256d long_arc = _mm256_cmp_pd(sum, pi, _CMP_GT_OQ);
+        mask |= (uint64_t) _mm256_movemask_pd(_mm256_and_pd(sign_diff, long_arc)) << i;
+        prime |= (uint64_t) _mm256_movemask_pd(_mm256_andnot_pd(long_arc, sign_diff)) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d pi = _mm_set1_pd(M_PI);
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    for (; i + 2 <= num; i += 2) {
+        __m128d a = _mm_loadu_pd(lngs + i);
+        __m128d b = _mm_loadu_pd(lngs + i + 1);
+        __m128d sign_diff = _mm_or_pd(
+            _mm_xor_pd(_mm_cmpgt_pd(a, zero), _mm_cmpgt_pd(b, zero)),
+            _mm_xor_pd(_mm_cmplt_pd(a, zero), _mm_cmplt_pd(b, zero)));
+        __m128d sum = _mm_add_pd(_mm_and_pd(a, abs_mask), _mm_and_pd(b, abs_mask));
+        __m128d long_arc = _mm_cmpgt_pd(sum, pi);
+        mask |= (uint64_t) _mm_movemask_pd(_mm_and_pd(sign_diff, long_arc)) << i;
+        prime |= (uint64_t) _mm_movemask_pd(_mm_andnot_pd(long_arc, sign_diff)) << i;
+    }
+#endif
+
+    /* Remaining segments */
+    lng_crossing_scalar(lngs, i, num, &mask, &prime);
+
+    if (prime_mask)
+        *prime_mask = prime;
+    return mask;
+}
+
+
+bool lng_crossing_any(const double* lngs, int num) {
+    assert(0 <= num && num <= CROSSING_BLOCK_SIZE);
+    int i = 0;
+
+#if defined(__AVX__)
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d pi = _mm256_set1_pd(M_PI);
+    const __m256d abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    __m256d any = _mm256_setzero_pd();
+    for (; i + 4 <= num; i += 4) {
+        __m256d a = _mm256_loadu_pd(lngs + i);
+        __m256d b = _mm256_loadu_pd(lngs + i + 1);
+        __m256d sign_diff = _mm256_or_pd(
+            _mm256_xor_pd(_mm256_cmp_pd(a, zero, _CMP_GT_OQ), _mm256_cmp_pd(b, zero, _CMP_GT_OQ)),
+            _mm256_xor_pd(_mm256_cmp_pd(a, zero, _CMP_LT_OQ), _mm256_cmp_pd(b, zero, _CMP_LT_OQ)));
+        __m256d sum = _mm256_add_pd(_mm256_and_pd(a, abs_mask), _mm256_and_pd(b, abs_mask));
+        any = _mm256_or_pd(any, _mm256_and_pd(sign_diff, _mm256_cmp_pd(sum, pi, _CMP_GT_OQ)));
+    }
+    if (_mm256_movemask_pd(any))
+        return true;
+#elif defined(__SSE2__)
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d pi = _mm_set1_pd(M_PI);
+    const __m128d abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    __m128d any = _mm_setzero_pd();
+    for (; i + 2 <= num; i += 2) {
+        __m128d a = _mm_loadu_pd(lngs + i);
+        __m128d b = _mm_loadu_pd(lngs + i + 1);
+        __m128d sign_diff = _mm_or_pd(
+            _mm_xor_pd(_mm_cmpgt_pd(a, zero), _mm_cmpgt_pd(b, zero)),
+            _mm_xor_pd(_mm_cmplt_pd(a, zero), _mm_cmplt_pd(b, zero)));
+        __m128d sum = _mm_add_pd(_mm_and_pd(a, abs_mask), _mm_and_pd(b, abs_mask));
+        any = _mm_or_pd(any, _mm_and_pd(sign_diff, _mm_cmpgt_pd(sum, pi)));
+    }
+    if (_mm_movemask_pd(any))
+        return true;
+#endif
+
+    /* Remaining segments */
+    return lng_crossing_any_scalar(lngs, i, num);
+}
+
+
+bool lng_crossing_any_scalar(const double* lngs, int start, int num) {
+    for (int i = start; i < num; ++i) {
+        double lng = lngs[i];
+        double next_lng = lngs[i + 1];
+        if (SIGN(lng) != SIGN(next_lng) && fabs(lng) + fabs(next_lng) > M_PI)
+            return true;
+    }
+    return false;
+}
+
+
+void lng_crossing_scalar(
+    const double* lngs, int start, int num, uint64_t* mask, uint64_t* prime_mask)
+{
+    for (int i = start; i < num; ++i) {
+        double lng = lngs[i];
+        double next_lng = lngs[i + 1];
+        if (SIGN(lng) == SIGN(next_lng))
+            continue;
+        if (fabs(lng) + fabs(next_lng) > M_PI) {
+            *mask |= (uint64_t) 1 << i;
+        } else {
+            *prime_mask |= (uint64_t) 1 << i;
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include <split/e7.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define E7_DECIMAL_NUM (7)
+
+/* Radians per E7 unit and back, single multiplication each way */
+#define E7_TO_RADS (M_PI / (180.0 * E7_SCALE))
+#define RADS_TO_E7 ((180.0 * E7_SCALE) / M_PI)
+
+static bool e7_parse_strtod(const char* str, size_t len, int32_t* value);
+
+
+bool e7_parse(const char* str, size_t len, int32_t* value) {
+    size_t pos = 0;
+
+    /* Sign */
+    bool negative = false;
+    if (pos < len && (str[pos] == '+' || str[pos] == '-')) {
+        negative = (str[pos] == '-');
+        ++pos;
+    }
+
+    /* Integer and fractional digits, accumulated as E7 units */
+    int64_t units = 0;
+    int decimal_num = -1; /* no decimal point yet */
+    int digit_num = 0;
+    bool round_up = false;
+    for (; pos < len; ++pos) {
+        char c = str[pos];
+        if (c == '.') {
+            if (decimal_num >= 0)
+                return false;
+            decimal_num = 0;
+            continue;
+        }
+        if (c == 'e' || c == 'E')
+            return e7_parse_strtod(str, len, value);
+        if (c < '0' || c > '9')
+            return false;
+
+        ++digit_num;
+        if (decimal_num < 0) {
+            units = units * 10 + (c - '0');
+            if (units > INT32_MAX / E7_SCALE + 1)
+                return false;
+        } else if (decimal_num < E7_DECIMAL_NUM) {
+            units = units * 10 + (c - '0');
+            ++decimal_num;
+        } else if (decimal_num == E7_DECIMAL_NUM) {
+            /* First dropped digit decides rounding */
+            round_up = (c >= '5');
+            ++decimal_num;
+        }
+    }
+    if (digit_num == 0)
+        return false;
+
+    /* Scale to 7 decimal places */
+    for (int i = (decimal_num < 0) ? 0 : decimal_num; i < E7_DECIMAL_NUM; ++i)
+        units *= 10;
+    if (round_up)
+        ++units;
+
+    if (negative)
+        units = -units;
+    if (units < INT32_MIN || units > INT32_MAX)
+        return false;
+
+    *value = (int32_t) units;
+    return true;
+}
+
+
+bool e7_parse_strtod(const char* str, size_t len, int32_t* value) {
+    char buffer[64];
+    if (len >= sizeof(buffer))
+        return false;
+    memcpy(buffer, str, len);
+    buffer[len] = '\0';
+
+    char* end;
+    errno = 0;
+    double degs = strtod(buffer, &end);
+    if (errno || end != buffer + len)
+        return false;
+
+    double units = round(degs * E7_SCALE);
+    if (units < INT32_MIN || units > INT32_MAX)
+        return false;
+
+    *value = (int32_t) units;
+    return true;
+}
+
+
+double e7_to_rads(int32_t value) {
+    return value * E7_TO_RADS;
+}
+
+
+int32_t e7_from_rads(double rads) {
+    return (int32_t) lround(rads * RADS_TO_E7);
+}
+
+
+void latlng_from_e7(const LatLngE7* e7, LatLng* latlng) {
+    latlng->lat = e7_to_rads(e7->lat);
+    latlng->lng = e7_to_rads(e7->lng);
+}
+
+
+void latlng_to_e7(const LatLng* latlng, LatLngE7* e7) {
+    e7->lat = e7_from_rads(latlng->lat);
+    e7->lng = e7_from_rads(latlng->lng);
+}
+
+
+bool latlng_eq_e7(const LatLng* latlng1, const LatLng* latlng2) {
+    return e7_from_rads(latlng1->lat) == e7_from_rads(latlng2->lat)
+        && e7_from_rads(latlng1->lng) == e7_from_rads(latlng2->lng);
+}
+
+
+int e7_format(int32_t value, char* buffer) {
+    /* Integer formatting, no rounding through double */
+    int64_t units = value;
+    const char* sign = "";
+    if (units < 0) {
+        sign = "-";
+        units = -units;
+    }
+    return snprintf(
+        buffer, E7_FORMAT_SIZE, "%s%d.%07d",
+        sign, (int) (units / E7_SCALE), (int) (units % E7_SCALE));
+}
@@ -1,5 +1,6 @@
 #include <split/h3.h>
 #include <assert.h>
+#include <split/alloc.h>
 
 void add_linked_geo_loop(LinkedGeoPolygon* polygon, LinkedGeoLoop* loop) {
     LinkedGeoLoop* last = polygon->last;
@@ -37,7 +38,7 @@ void free_linked_geo_polygon(LinkedGeoPolygon* polygon) {
             loop = next_loop;
         }
 
-        free(polygon);
+        split_free(polygon, sizeof(LinkedGeoPolygon));
         polygon = next_polygon;
     }
 }
@@ -47,9 +48,9 @@ void free_linked_geo_loop(LinkedGeoLoop* loop) {
     LinkedLatLng* point = loop->first;
     while (point) {
         LinkedLatLng* next = point->next;
-        free(point);
+        split_free(point, sizeof(LinkedLatLng));
         point = next;
     }
-    free(loop);
+    split_free(loop, sizeof(LinkedGeoLoop));
     // no recursion
 }
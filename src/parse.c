@@ -2,16 +2,24 @@
 #include <assert.h>
 #include <ctype.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <split/alloc.h>
+#include <split/e7.h>
 #include <split/h3.h>
+#include <split/scan.h>
 
 #define DEBUG 0
 #if DEBUG
 # include <stdio.h>
 #endif
 
+#define WKT_PARSER_BUFFER_SIZE_INIT (4096)
+#define WKT_PARALLEL_BLOCK_SIZE_MIN (64 * 1024)
+#define WKT_NUMBER_SIZE_MAX (64) /* longer numbers are copied to heap for strtod */
+
 static const char WktTypeName_Polygon[] = "polygon";
 static const char WktTypeName_MultiPolygon[] = "multipolygon";
 
@@ -28,8 +36,60 @@ typedef enum {
 typedef struct {
     const char* data;
     size_t len;
+    CoordMode coord_mode;
 } WktData;
 
+typedef enum {
+    WktParserState_Type = 0,   /* type name expected */
+    WktParserState_Data,       /* polygon or multipolygon data start expected */
+    WktParserState_Member,     /* member separator or multipolygon data end expected */
+    WktParserState_MemberData, /* member polygon data expected */
+    WktParserState_Done
+} WktParserState;
+
+struct WktParser {
+    WktPolygonCallback callback;
+    void* user_data;
+
+    WktParseResult result;
+    WktObjectType type;
+    WktParserState state;
+    int member_num;
+    CoordMode coord_mode;
+
+    /* Unconsumed data */
+    char* buffer;
+    size_t size;
+    size_t len;
+    size_t start;    /* start of unconsumed data */
+    size_t offset;   /* stream position of buffer start */
+
+    /* Member data end lookup */
+    size_t scan_len; /* member data bytes scanned so far */
+    int depth;       /* parentheses depth at scan position */
+};
+
+/*
+  Parallel multipolygon parsing: member data is cut into blocks of equal size,
+  parenthesis depth at each block start is found by counting parentheses
+  of all blocks in parallel. Each worker then moves its block bounds forward
+  to the nearest member ends and parses whole members in between.
+ */
+typedef struct {
+    WktData data;          /* block, then chunk of whole members */
+    const char* data_end;  /* end of all input */
+    int depth;             /* depth change in block, then depth at block start */
+    const char* end;       /* block end, then chunk end */
+    int end_depth;         /* depth at block end */
+    bool is_first;
+    SplitAllocStage alloc_stage; /* of the calling thread */
+
+    WktParseResult result;
+    LinkedGeoPolygon* first;
+    LinkedGeoPolygon* last;
+    bool is_data_end;      /* multipolygon data end found */
+} WktChunk;
+
 static void result_init(WktParseResult* result);
 static void data_init(WktData* data, const char* wkt, size_t len);
 
@@ -39,7 +99,15 @@ static void skip_ws(WktData* data);
 static WktObjectType read_type(WktData* data, WktParseResult* result);
 
 static void parse_polygon(WktData* data, WktParseResult* result);
-static void parse_multi_polygon(WktData* data, WktParseResult* result);
+static void parse_multi_polygon(WktData* data, WktParseResult* result, int thread_num);
+static void parse_members_parallel(
+    WktData* data, WktParseResult* result, int thread_num,
+    LinkedGeoPolygon** multi_polygon, LinkedGeoPolygon** last_polygon);
+static void run_chunks(WktChunk* chunks, int chunk_num, void* (*func)(void*));
+static void* scan_chunk_depth(void* arg);
+static void* parse_chunk(void* arg);
+static void parse_chunk_members(WktChunk* chunk);
+static const char* find_member_end(const char* data, const char* end, int depth);
 
 static bool parse_next_polygon(
     WktData* data, WktParseResult* result,
@@ -51,7 +119,10 @@ static bool parse_next_ring(
 static LinkedLatLng* parse_next_point(
     WktData* data, WktParseResult* result, bool is_first);
 
-static double parse_coord(WktData* data, WktParseResult* result);
+static double parse_coord(WktData* data, WktParseResult* result, double max);
+static bool parse_double_strtod(const char* str, size_t len, double* value);
+static double parse_coord_e7(WktData* data, WktParseResult* result, int32_t max);
+static size_t find_coord_end(const WktData* data);
 
 static LinkedGeoPolygon* create_empty_polygon();
 static LinkedGeoLoop* create_empty_ring();
@@ -62,17 +133,35 @@ static void add_point(LinkedGeoLoop* ring, LinkedLatLng* point);
 static void free_polygon(LinkedGeoPolygon* polygon);
 static void free_ring(LinkedGeoLoop* ring);
 
+static void parser_process(WktParser* parser, bool is_final);
+static void parser_start_member(WktParser* parser);
+static bool parser_process_member(WktParser* parser, WktData* data, bool is_final);
+static void parser_consume(WktParser* parser, const WktData* data);
+
 WktParseResult wkt_parse(const char* wkt, size_t len) {
+    return wkt_parse_mode(wkt, len, CoordMode_Double);
+}
+
+
+WktParseResult wkt_parse_mode(const char* wkt, size_t len, CoordMode coord_mode) {
+    return wkt_parse_parallel(wkt, len, coord_mode, 1);
+}
+
+
+WktParseResult wkt_parse_parallel(const char* wkt, size_t len, CoordMode coord_mode, int thread_num) {
     WktParseResult result;
     result_init(&result);
 
     WktData data;
     data_init(&data, wkt, len);
+    data.coord_mode = coord_mode;
 
     /* Parse type */
     WktObjectType type = read_type(&data, &result);
-    if (result.error)
+    if (result.error) {
+        result.error_pos = data.data - wkt;
         return result;
+    }
 
     /* Parse data */
     switch (type) {
@@ -81,7 +170,7 @@ WktParseResult wkt_parse(const char* wkt, size_t len) {
             break;
 
         case WktObjectType_MultiPolygon:
-            parse_multi_polygon(&data, &result);
+            parse_multi_polygon(&data, &result, thread_num);
             break;
 
         default:
@@ -117,7 +206,274 @@ const char* wkt_parse_error_to_string(WktParseError error) {
             return "Memory allocation failure";
         default:
             assert(false);
+            return NULL;
+    }
+}
+
+
+WktParser* wkt_parser_new(WktPolygonCallback callback, void* user_data) {
+    assert(callback);
+    WktParser* parser = split_malloc(sizeof(WktParser));
+    if (!parser)
+        return NULL;
+    *parser = (WktParser){0};
+    parser->callback = callback;
+    parser->user_data = user_data;
+    result_init(&parser->result);
+
+    /* Allocate initial buffer */
+    parser->size = WKT_PARSER_BUFFER_SIZE_INIT;
+    parser->buffer = split_malloc(parser->size);
+    if (!parser->buffer) {
+        split_free(parser, sizeof(WktParser));
+        return NULL;
+    }
+    return parser;
+}
+
+
+void wkt_parser_set_coord_mode(WktParser* parser, CoordMode coord_mode) {
+    parser->coord_mode = coord_mode;
+}
+
+
+WktParseError wkt_parser_feed(WktParser* parser, const char* chunk, size_t len) {
+    if (parser->result.error)
+        return parser->result.error;
+
+    /* Drop consumed data */
+    if (parser->start > 0) {
+        memmove(parser->buffer, parser->buffer + parser->start, parser->len - parser->start);
+        parser->len -= parser->start;
+        parser->offset += parser->start;
+        parser->start = 0;
+    }
+
+    /* Append chunk */
+    if (parser->len + len > parser->size) {
+        size_t size = parser->size;
+        while (size < parser->len + len)
+            size *= 2;
+        char* buffer = split_realloc(parser->buffer, parser->size, size);
+        if (!buffer) {
+            parser->result.error = WktParseError_MemAllocFailed;
+            return parser->result.error;
+        }
+        parser->buffer = buffer;
+        parser->size = size;
+    }
+    memcpy(parser->buffer + parser->len, chunk, len);
+    parser->len += len;
+
+    parser_process(parser, false);
+    return parser->result.error;
+}
+
+
+WktParseError wkt_parser_finish(WktParser* parser) {
+    if (parser->result.error)
+        return parser->result.error;
+
+    parser_process(parser, true);
+    if (parser->result.error)
+        return parser->result.error;
+
+    switch (parser->state) {
+        case WktParserState_Type:
+            parser->result.error = WktParseError_TypeExpected;
+            break;
+
+        case WktParserState_MemberData:
+            /* Comma without member data */
+            parser->result.error = WktParseError_LeftParenExpected;
+            break;
+
+        case WktParserState_Member:
+            if (parser->type == WktObjectType_MultiPolygon) {
+                parser->result.error = WktParseError_RightParenExpected;
+                parser->result.message = Message_MemberPolygonDataEndExpected;
+            }
+            break;
+
+        default:
+            break;
+    }
+    if (parser->result.error)
+        parser->result.error_pos = parser->offset + parser->len;
+    return parser->result.error;
+}
+
+
+WktParseResult wkt_parser_result(const WktParser* parser) {
+    return parser->result;
+}
+
+
+void wkt_parser_reset(WktParser* parser) {
+    WktParser reset = {0};
+    reset.callback = parser->callback;
+    reset.user_data = parser->user_data;
+    reset.coord_mode = parser->coord_mode;
+    reset.buffer = parser->buffer;
+    reset.size = parser->size;
+    result_init(&reset.result);
+    *parser = reset;
+}
+
+
+void wkt_parser_free(WktParser* parser) {
+    split_free(parser->buffer, parser->size);
+    split_free(parser, sizeof(WktParser));
+}
+
+
+void parser_process(WktParser* parser, bool is_final) {
+    WktData data = {0};
+    while (!parser->result.error && parser->state != WktParserState_Done) {
+        data_init(&data, parser->buffer + parser->start, parser->len - parser->start);
+        skip_ws(&data);
+        parser_consume(parser, &data);
+        if (is_empty(&data) && parser->state != WktParserState_Data)
+            return; /* more data required */
+
+        switch (parser->state) {
+            case WktParserState_Type: {
+                /* Wait until type name is complete */
+                size_t pos = 0;
+                while (pos < data.len && isalpha(data.data[pos]))
+                    ++pos;
+                if (pos == data.len && !is_final)
+                    return;
+
+                parser->type = read_type(&data, &parser->result);
+                if (parser->result.error)
+                    break;
+                parser->result.type = H3Type_GeoPolygon;
+                parser_consume(parser, &data);
+                parser->state = WktParserState_Data;
+                break;
+            }
+
+            case WktParserState_Data:
+                if (is_empty(&data)) {
+                    if (is_final)
+                        parser->state = WktParserState_Done; /* no data, empty polygon */
+                    return;
+                }
+                if (parser->type == WktObjectType_MultiPolygon) {
+                    /* Multi polygon data start */
+                    if (data.data[0] != '(') {
+                        parser->result.error = WktParseError_LeftParenExpected;
+                        break;
+                    }
+                    advance(&data, 1);
+                    parser_consume(parser, &data);
+                    parser->state = WktParserState_Member;
+                } else {
+                    /* Polygon data is parsed as a single member */
+                    parser_start_member(parser);
+                }
+                break;
+
+            case WktParserState_Member:
+                if (parser->type != WktObjectType_MultiPolygon) {
+                    parser->state = WktParserState_Done;
+                    break;
+                }
+                if (data.data[0] == ')') {
+                    /* Multi polygon data end */
+                    advance(&data, 1);
+                    parser_consume(parser, &data);
+                    parser->state = WktParserState_Done;
+                    break;
+                }
+                if (parser->member_num > 0) {
+                    /* Not a first polygon, comma expected */
+                    if (data.data[0] != ',') {
+                        parser->result.error = WktParseError_CommaExpected;
+                        break;
+                    }
+                    advance(&data, 1);
+                    parser_consume(parser, &data);
+                }
+                parser_start_member(parser);
+                break;
+
+            case WktParserState_MemberData:
+                if (!parser_process_member(parser, &data, is_final))
+                    return;
+                break;
+
+            default:
+                assert(false);
+        }
+    }
+
+    if (parser->result.error)
+        parser->result.error_pos = parser->offset + (data.data - parser->buffer);
+}
+
+
+void parser_start_member(WktParser* parser) {
+    parser->state = WktParserState_MemberData;
+    parser->scan_len = 0;
+    parser->depth = 0;
+}
+
+
+bool parser_process_member(WktParser* parser, WktData* data, bool is_final) {
+    /* Polygon data start */
+    if (data->data[0] != '(') {
+        parser->result.error = WktParseError_LeftParenExpected;
+        return true;
+    }
+
+    /* Find end of member data, continue from previous position */
+    size_t pos = parser->scan_len;
+    bool found = false;
+    while ((pos += scan_paren(data->data + pos, data->len - pos)) < data->len) {
+        if (data->data[pos] == '(') {
+            ++parser->depth;
+        } else if (--parser->depth <= 0) {
+            found = true;
+            break;
+        }
+        ++pos;
+    }
+    parser->scan_len = pos;
+    if (!found && !is_final)
+        return false; /* more data required */
+
+    /* Parse member, incomplete data at the end of input is reported by the parser */
+    WktData member;
+    data_init(&member, data->data, found ? pos + 1 : data->len);
+    member.coord_mode = parser->coord_mode;
+    LinkedGeoPolygon* polygon = NULL;
+    LinkedGeoPolygon* dummy_last_polygon = NULL;
+    bool parsed = parse_next_polygon(&member, &parser->result, &polygon, &dummy_last_polygon);
+    if (parser->result.error) {
+        *data = member;
+        return true;
+    }
+    if (!parsed) {
+        /* No member data (polygon data end) */
+        parser->result.error = WktParseError_LeftParenExpected;
+        *data = member;
+        return true;
     }
+
+    /* Emit polygon */
+    advance(data, member.data - data->data);
+    parser_consume(parser, data);
+    ++parser->member_num;
+    parser->state = WktParserState_Member;
+    parser->callback(polygon, parser->user_data);
+    return true;
+}
+
+
+void parser_consume(WktParser* parser, const WktData* data) {
+    parser->start = data->data - parser->buffer;
 }
 
 
@@ -125,6 +481,7 @@ void data_init(WktData* data, const char* wkt, size_t len) {
     assert(wkt);
     data->data = wkt;
     data->len = len;
+    data->coord_mode = CoordMode_Double;
 }
 
 
@@ -132,6 +489,7 @@ void result_init(WktParseResult* result) {
     result->error = WktParseError_Ok;
     result->type = H3Type_None;
     result->object = NULL;
+    result->error_pos = 0;
     result->message = NULL;
 }
 
@@ -149,8 +507,9 @@ void advance(WktData* data, size_t step) {
 
 
 void skip_ws(WktData* data) {
-    while (data->len > 0 && isspace(data->data[0]))
-        advance(data, 1);
+    size_t pos = scan_ws(data->data, data->len);
+    if (pos > 0)
+        advance(data, pos);
 }
 
 
@@ -175,7 +534,7 @@ WktObjectType read_type(WktData* data, WktParseResult* result) {
     WktObjectType type = WktObjectType_None;
 
     /* Copy to null-terminated string, convert to lowercase */
-    char* typename = malloc(pos + 1); /* alloc. copy */
+    char* typename = split_malloc(pos + 1); /* alloc. copy */
     if (!typename) {
         result->error = WktParseError_MemAllocFailed;
         return WktObjectType_None;
@@ -191,7 +550,7 @@ WktObjectType read_type(WktData* data, WktParseResult* result) {
     else if (strncmp(typename, WktTypeName_MultiPolygon, pos) == 0)
         type = WktObjectType_MultiPolygon;
 
-    free(typename); /* free copy */
+    split_free(typename, pos + 1); /* free copy */
 
     /* Advance */
     advance(data, pos);
@@ -225,7 +584,7 @@ void parse_polygon(WktData* data, WktParseResult* result) {
 }
 
 
-void parse_multi_polygon(WktData* data, WktParseResult* result) {
+void parse_multi_polygon(WktData* data, WktParseResult* result, int thread_num) {
     /* Object type */
     result->type = H3Type_GeoPolygon;
 
@@ -250,7 +609,11 @@ void parse_multi_polygon(WktData* data, WktParseResult* result) {
     /* Parse  */
     LinkedGeoPolygon* multi_polygon = NULL;
     LinkedGeoPolygon* last_polygon = NULL;
-    while (parse_next_polygon(data, result, &multi_polygon, &last_polygon)) {}
+    if (thread_num > 1 && data->len >= 2 * WKT_PARALLEL_BLOCK_SIZE_MIN) {
+        parse_members_parallel(data, result, thread_num, &multi_polygon, &last_polygon);
+    } else {
+        while (parse_next_polygon(data, result, &multi_polygon, &last_polygon)) {}
+    }
     if (result->error) {
         if (multi_polygon)
             free_polygon(multi_polygon);
@@ -279,6 +642,171 @@ void parse_multi_polygon(WktData* data, WktParseResult* result) {
 }
 
 
+void parse_members_parallel(
+    WktData* data, WktParseResult* result, int thread_num,
+    LinkedGeoPolygon** multi_polygon, LinkedGeoPolygon** last_polygon)
+{
+    /* Leaves data and result as serial parsing of members would */
+    int chunk_num = thread_num;
+    if (data->len / WKT_PARALLEL_BLOCK_SIZE_MIN < (size_t) chunk_num)
+        chunk_num = (int) (data->len / WKT_PARALLEL_BLOCK_SIZE_MIN);
+    WktChunk* chunks = split_malloc(chunk_num * sizeof(WktChunk));
+    if (!chunks) {
+        result->error = WktParseError_MemAllocFailed;
+        return;
+    }
+
+    /* Count parentheses in blocks */
+    const char* data_end = data->data + data->len;
+    for (int i = 0; i < chunk_num; i++) {
+        WktChunk* chunk = &chunks[i];
+        *chunk = (WktChunk){0};
+        result_init(&chunk->result);
+        const char* start = data->data + data->len / chunk_num * i;
+        chunk->end = (i + 1 < chunk_num) ? data->data + data->len / chunk_num * (i + 1) : data_end;
+        data_init(&chunk->data, start, chunk->end - start);
+        chunk->data.coord_mode = data->coord_mode;
+        chunk->data_end = data_end;
+        chunk->is_first = (i == 0);
+        chunk->alloc_stage = split_alloc_get_stage();
+    }
+    run_chunks(chunks, chunk_num, &scan_chunk_depth);
+
+    /* Depth at block start and end, 0 is between members */
+    int depth = 0;
+    for (int i = 0; i < chunk_num; i++) {
+        int block_depth = chunks[i].depth;
+        chunks[i].depth = depth;
+        depth += block_depth;
+        chunks[i].end_depth = depth;
+    }
+
+    /* Parse whole members */
+    run_chunks(chunks, chunk_num, &parse_chunk);
+
+    /* Link members in order up to the first error or multipolygon data end */
+    bool is_done = false;
+    for (int i = 0; i < chunk_num; i++) {
+        WktChunk* chunk = &chunks[i];
+        if (is_done) {
+            if (chunk->first)
+                free_polygon(chunk->first);
+            continue;
+        }
+        if (chunk->first) {
+            if (!(*multi_polygon)) {
+                *multi_polygon = chunk->first;
+            } else {
+                (*last_polygon)->next = chunk->first;
+            }
+            *last_polygon = chunk->last;
+        }
+        if (chunk->result.error || chunk->is_data_end || i + 1 == chunk_num) {
+            result->error = chunk->result.error;
+            result->message = chunk->result.message;
+            advance(data, chunk->data.data - data->data);
+            is_done = true;
+        }
+    }
+    split_free(chunks, chunk_num * sizeof(WktChunk));
+}
+
+
+void run_chunks(WktChunk* chunks, int chunk_num, void* (*func)(void*)) {
+    /* First chunk is processed by calling thread, also chunks no thread was started for */
+    pthread_t threads[chunk_num];
+    bool is_started[chunk_num];
+    for (int i = 1; i < chunk_num; i++)
+        is_started[i] = (pthread_create(&threads[i], NULL, func, &chunks[i]) == 0);
+    func(&chunks[0]);
+    for (int i = 1; i < chunk_num; i++) {
+        if (is_started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            func(&chunks[i]);
+        }
+    }
+}
+
+
+void* scan_chunk_depth(void* arg) {
+    WktChunk* chunk = arg;
+    chunk->depth = scan_depth(chunk->data.data, chunk->data.len);
+    return NULL;
+}
+
+
+void* parse_chunk(void* arg) {
+    /* Allocations of worker threads are counted in the stage of the calling thread */
+    WktChunk* chunk = arg;
+    SplitAllocStage prev_stage = split_alloc_set_stage(chunk->alloc_stage);
+    parse_chunk_members(chunk);
+    split_alloc_set_stage(prev_stage);
+    return NULL;
+}
+
+
+void parse_chunk_members(WktChunk* chunk) {
+    /* Chunk starts after the first member end in block (first chunk at block start)
+       and ends after the first member end in next block */
+    WktData* data = &chunk->data;
+    CoordMode coord_mode = data->coord_mode;
+    const char* start = chunk->is_first
+        ? data->data
+        : find_member_end(data->data, chunk->data_end, chunk->depth);
+    chunk->end = (chunk->end == chunk->data_end)
+        ? chunk->data_end
+        : find_member_end(chunk->end, chunk->data_end, chunk->end_depth);
+    if (chunk->end < start)
+        chunk->end = start;
+    data_init(data, start, chunk->end - start);
+    data->coord_mode = coord_mode;
+
+    if (!chunk->is_first) {
+        /* Member separator, as parse_next_polygon expects it after first member */
+        skip_ws(data);
+        if (is_empty(data))
+            return;
+        if (data->data[0] == ')') {
+            chunk->is_data_end = true;
+            return;
+        }
+        if (data->data[0] != ',') {
+            chunk->result.error = WktParseError_CommaExpected;
+            return;
+        }
+        advance(data, 1);
+        skip_ws(data);
+        if (is_empty(data) || data->data[0] != '(') {
+            chunk->result.error = WktParseError_LeftParenExpected;
+            return;
+        }
+    }
+    while (parse_next_polygon(data, &chunk->result, &chunk->first, &chunk->last)) {}
+    chunk->is_data_end = !chunk->result.error && !is_empty(data);
+}
+
+
+const char* find_member_end(const char* data, const char* end, int depth) {
+    /* Position after `)' closing member, or of `)' closing multipolygon data */
+    if (depth < 0)
+        return data;
+    while ((data += scan_paren(data, end - data)) < end) {
+        if (*data == '(') {
+            depth++;
+        } else {
+            depth--;
+            if (depth == 0)
+                return data + 1;
+            if (depth < 0)
+                return data;
+        }
+        data++;
+    }
+    return end;
+}
+
+
 bool parse_next_polygon(
     WktData* data, WktParseResult* result,
     LinkedGeoPolygon** multi_polygon,
@@ -408,12 +936,12 @@ bool parse_next_ring(
 #if DEBUG
                 printf("  (ring closing point skipped)\n");
 #endif
-                free(prev_point);
+                split_free(prev_point, sizeof(LinkedLatLng));
             }
         }
     } else {
         if (prev_point)
-            free(prev_point);
+            split_free(prev_point, sizeof(LinkedLatLng));
         free_ring(ring);
         return false;
     }
@@ -453,34 +981,24 @@ LinkedLatLng* parse_next_point(
         advance(data, 1);
     }
 
-    /* Parse point coordinates */
+    /* Parse point coordinates (radians) */
     LatLng coords = {0};
-    /* lng */
-    coords.lng = parse_coord(data, result);
-    if (result->error)
-        return NULL;
-    /* check range */
-    if (-180 > coords.lng || coords.lng > 180) {
-        result->error = WktParseError_CoordinateOutOfRange;
-        return NULL;
+    if (data->coord_mode == CoordMode_E7) {
+        coords.lng = parse_coord_e7(data, result, E7_LNG_MAX);
+        if (result->error)
+            return NULL;
+        coords.lat = parse_coord_e7(data, result, E7_LAT_MAX);
+    } else {
+        coords.lng = parse_coord(data, result, 180);
+        if (result->error)
+            return NULL;
+        coords.lat = parse_coord(data, result, 90);
     }
-    /* to radians */
-    coords.lng = degsToRads(coords.lng);
-
-    /* lat */
-    coords.lat = parse_coord(data, result);
     if (result->error)
         return NULL;
-    /* check range */
-    if (-90 > coords.lat || coords.lat > 90) {
-        result->error = WktParseError_CoordinateOutOfRange;
-        return NULL;
-    }
-    /* to radians */
-    coords.lat = degsToRads(coords.lat);
 
     /* Create point */
-    LinkedLatLng* point = malloc(sizeof(LinkedLatLng));
+    LinkedLatLng* point = split_malloc(sizeof(LinkedLatLng));
     if (!point) {
         result->error = WktParseError_MemAllocFailed;
         return NULL;
@@ -492,45 +1010,98 @@ LinkedLatLng* parse_next_point(
 }
 
 
-double parse_coord(WktData* data, WktParseResult* result) {
+double parse_coord(WktData* data, WktParseResult* result, double max) {
     skip_ws(data);
 
     /* Find end of number */
-    size_t pos = 0;
-    while (pos < data->len
-           && (isalnum(data->data[pos]) || strchr("+-.", data->data[pos])))
-        ++pos;
-
+    size_t pos = find_coord_end(data);
     if (pos == 0) {
         result->error = WktParseError_NumberExpected;
         return 0.0;
     }
 
-    /* Copy to null-terminated string */
-    char* number = malloc(pos + 1);
-    if (!number) {
-        result->error = WktParseError_MemAllocFailed;
+    /* Parse number, plain decimals directly, other notations through strtod */
+    double value;
+    if (!scan_double(data->data, pos, &value)
+        && !parse_double_strtod(data->data, pos, &value))
+    {
+        result->error = WktParseError_InvalidNumber;
+    }
+
+    /* Advance */
+    advance(data, pos);
+    if (result->error)
+        return 0.0;
+
+    /* Check range */
+    if (-max > value || value > max) {
+        result->error = WktParseError_CoordinateOutOfRange;
         return 0.0;
     }
-    memcpy(number, data->data, pos);
-    number[pos] = '\0';
 
-    /* Parse number */
+    /* To radians */
+    return degsToRads(value);
+}
+
+
+bool parse_double_strtod(const char* str, size_t len, double* value) {
+    /* Null-terminated copy, data is not terminated at token end */
+    char buffer[WKT_NUMBER_SIZE_MAX];
+    char* number = (len < sizeof(buffer)) ? buffer : split_malloc(len + 1);
+    if (!number)
+        return false;
+    memcpy(number, str, len);
+    number[len] = '\0';
+
     char* end;
-    double value = strtod(data->data, &end);
-    if (errno || end != data->data + pos)
+    errno = 0;
+    *value = strtod(number, &end);
+    bool ok = !errno && end == number + len;
+
+    if (number != buffer)
+        split_free(number, len + 1);
+    return ok;
+}
+
+
+double parse_coord_e7(WktData* data, WktParseResult* result, int32_t max) {
+    skip_ws(data);
+
+    /* Find end of number */
+    size_t pos = find_coord_end(data);
+    if (pos == 0) {
+        result->error = WktParseError_NumberExpected;
+        return 0.0;
+    }
+
+    /* Parse number */
+    int32_t value;
+    if (!e7_parse(data->data, pos, &value)) {
         result->error = WktParseError_InvalidNumber;
+        return 0.0;
+    }
 
     /* Advance */
     advance(data, pos);
 
-    free(number); /* free copy */
-    return value;
+    /* Check range */
+    if (-max > value || value > max) {
+        result->error = WktParseError_CoordinateOutOfRange;
+        return 0.0;
+    }
+
+    /* To radians */
+    return e7_to_rads(value);
+}
+
+
+size_t find_coord_end(const WktData* data) {
+    return scan_number(data->data, data->len);
 }
 
 
 LinkedGeoPolygon* create_empty_polygon() {
-    LinkedGeoPolygon* polygon = malloc(sizeof(LinkedGeoPolygon));
+    LinkedGeoPolygon* polygon = split_malloc(sizeof(LinkedGeoPolygon));
     if (polygon)
         *polygon = (LinkedGeoPolygon){0};
     return polygon;
@@ -538,7 +1109,7 @@ LinkedGeoPolygon* create_empty_polygon() {
 
 
 LinkedGeoLoop* create_empty_ring() {
-    LinkedGeoLoop* ring = malloc(sizeof(LinkedGeoLoop));
+    LinkedGeoLoop* ring = split_malloc(sizeof(LinkedGeoLoop));
     if (ring)
         *ring = (LinkedGeoLoop){0};
     return ring;
@@ -0,0 +1,214 @@
+#include <split/predicates.h>
+#include <float.h>
+#include <math.h>
+
+/*
+  Expansion arithmetic follows J. R. Shewchuk, "Adaptive Precision
+  Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+  A value is represented as a sum of non-overlapping doubles in increasing
+  order of magnitude, so its sign is the sign of the last component.
+ */
+
+/* Half ulp of 1.0 */
+#define EPS (DBL_EPSILON / 2)
+
+/* Error bounds of the estimates relative to the sum of absolute values of the terms */
+#define ORIENT3_ERR_BOUND ((7.0 + 56.0 * EPS) * EPS)
+#define CROSS_DOT_ERR_BOUND ((12.0 + 128.0 * EPS) * EPS)
+
+/* Max expansion lengths */
+#define DOT_LEN (6)
+#define PRODUCT_LEN (2 * DOT_LEN * DOT_LEN)
+
+#define SIGN(x) (((x) < 0) ? -1 : ((x) > 0) ? 1 : 0)
+
+static short orient3_exact(const Vect3* a, const Vect3* b, const Vect3* c);
+static short cross_dot_sign_exact(const Vect3* a, const Vect3* b, const Vect3* c, const Vect3* d);
+
+static int dot_expansion(const Vect3* a, const Vect3* b, double* h);
+static int product_expansion(int elen, const double* e, int flen, const double* f, double* h);
+
+static void two_sum(double a, double b, double* x, double* y);
+static void two_product(double a, double b, double* x, double* y);
+static int grow_expansion(int elen, double* e, double b);
+static int expansion_sum(int elen, double* e, int flen, const double* f);
+static int scale_expansion(int elen, const double* e, double b, double* h);
+static short expansion_sign(int elen, const double* e);
+
+
+short orient3(const Vect3* a, const Vect3* b, const Vect3* c) {
+    double m1 = b->y * c->z - b->z * c->y;
+    double m2 = b->z * c->x - b->x * c->z;
+    double m3 = b->x * c->y - b->y * c->x;
+    double det = a->x * m1 + a->y * m2 + a->z * m3;
+
+    double permanent =
+        fabs(a->x) * (fabs(b->y * c->z) + fabs(b->z * c->y))
+        + fabs(a->y) * (fabs(b->z * c->x) + fabs(b->x * c->z))
+        + fabs(a->z) * (fabs(b->x * c->y) + fabs(b->y * c->x));
+    double err_bound = ORIENT3_ERR_BOUND * permanent;
+    if (det > err_bound || -det > err_bound)
+        return SIGN(det);
+
+    return orient3_exact(a, b, c);
+}
+
+
+short cross_dot_sign(const Vect3* a, const Vect3* b, const Vect3* c, const Vect3* d) {
+    /* Lagrange identity: (a x b) . (c x d) = (a . c)(b . d) - (a . d)(b . c) */
+    double ac = a->x * c->x + a->y * c->y + a->z * c->z;
+    double bd = b->x * d->x + b->y * d->y + b->z * d->z;
+    double ad = a->x * d->x + a->y * d->y + a->z * d->z;
+    double bc = b->x * c->x + b->y * c->y + b->z * c->z;
+    double value = ac * bd - ad * bc;
+
+    double ac_abs = fabs(a->x * c->x) + fabs(a->y * c->y) + fabs(a->z * c->z);
+    double bd_abs = fabs(b->x * d->x) + fabs(b->y * d->y) + fabs(b->z * d->z);
+    double ad_abs = fabs(a->x * d->x) + fabs(a->y * d->y) + fabs(a->z * d->z);
+    double bc_abs = fabs(b->x * c->x) + fabs(b->y * c->y) + fabs(b->z * c->z);
+    double err_bound = CROSS_DOT_ERR_BOUND * (ac_abs * bd_abs + ad_abs * bc_abs);
+    if (value > err_bound || -value > err_bound)
+        return SIGN(value);
+
+    return cross_dot_sign_exact(a, b, c, d);
+}
+
+
+short orient3_exact(const Vect3* a, const Vect3* b, const Vect3* c) {
+    /* Sum of a_i * (b_j * c_k - b_k * c_j) terms */
+    const double terms[3][5] = {
+        {a->x, b->y, c->z, b->z, c->y},
+        {a->y, b->z, c->x, b->x, c->z},
+        {a->z, b->x, c->y, b->y, c->x}
+    };
+    double det[24];
+    int det_len = 0;
+    for (int i = 0; i < 3; ++i) {
+        const double* t = terms[i];
+        double minor[4];
+        two_product(t[1], t[2], &minor[1], &minor[0]);
+        int minor_len = 2;
+        double p, q;
+        two_product(-t[3], t[4], &p, &q);
+        minor_len = grow_expansion(minor_len, minor, q);
+        minor_len = grow_expansion(minor_len, minor, p);
+
+        double scaled[8];
+        int scaled_len = scale_expansion(minor_len, minor, t[0], scaled);
+        det_len = expansion_sum(det_len, det, scaled_len, scaled);
+    }
+    return expansion_sign(det_len, det);
+}
+
+
+short cross_dot_sign_exact(const Vect3* a, const Vect3* b, const Vect3* c, const Vect3* d) {
+    double ac[DOT_LEN], bd[DOT_LEN], ad[DOT_LEN], bc[DOT_LEN];
+    int ac_len = dot_expansion(a, c, ac);
+    int bd_len = dot_expansion(b, d, bd);
+    int ad_len = dot_expansion(a, d, ad);
+    int bc_len = dot_expansion(b, c, bc);
+
+    /* (a . c)(b . d) - (a . d)(b . c) */
+    double value[2 * PRODUCT_LEN];
+    double product[PRODUCT_LEN];
+    int value_len = product_expansion(ac_len, ac, bd_len, bd, value);
+    for (int i = 0; i < ad_len; ++i)
+        ad[i] = -ad[i];
+    int product_len = product_expansion(ad_len, ad, bc_len, bc, product);
+    value_len = expansion_sum(value_len, value, product_len, product);
+    return expansion_sign(value_len, value);
+}
+
+
+int dot_expansion(const Vect3* a, const Vect3* b, double* h) {
+    double p, q;
+    two_product(a->x, b->x, &h[1], &h[0]);
+    int len = 2;
+    two_product(a->y, b->y, &p, &q);
+    len = grow_expansion(len, h, q);
+    len = grow_expansion(len, h, p);
+    two_product(a->z, b->z, &p, &q);
+    len = grow_expansion(len, h, q);
+    len = grow_expansion(len, h, p);
+    return len;
+}
+
+
+int product_expansion(int elen, const double* e, int flen, const double* f, double* h) {
+    int hlen = 0;
+    for (int i = 0; i < flen; ++i) {
+        double scaled[2 * DOT_LEN];
+        int scaled_len = scale_expansion(elen, e, f[i], scaled);
+        hlen = expansion_sum(hlen, h, scaled_len, scaled);
+    }
+    return hlen;
+}
+
+
+void two_sum(double a, double b, double* x, double* y) {
+    /* x + y = a + b exactly, y is the roundoff of x */
+    *x = a + b;
+    double b_virt = *x - a;
+    double a_virt = *x - b_virt;
+    *y = (a - a_virt) + (b - b_virt);
+}
+
+
+void two_product(double a, double b, double* x, double* y) {
+    /* x + y = a * b exactly */
+    *x = a * b;
+    *y = fma(a, b, -*x);
+}
+
+
+int grow_expansion(int elen, double* e, double b) {
+    /* e = e + b in place, zero components eliminated */
+    double q = b;
+    int hlen = 0;
+    for (int i = 0; i < elen; ++i) {
+        double sum, err;
+        two_sum(q, e[i], &sum, &err);
+        q = sum;
+        if (err != 0)
+            e[hlen++] = err;
+    }
+    if (q != 0 || hlen == 0)
+        e[hlen++] = q;
+    return hlen;
+}
+
+
+int expansion_sum(int elen, double* e, int flen, const double* f) {
+    /* e = e + f in place, e must have room for elen + flen components */
+    for (int i = 0; i < flen; ++i)
+        elen = grow_expansion(elen, e, f[i]);
+    return elen;
+}
+
+
+int scale_expansion(int elen, const double* e, double b, double* h) {
+    /* h = e * b, h must have room for 2 * elen components */
+    double q, err;
+    two_product(e[0], b, &q, &err);
+    int hlen = 0;
+    if (err != 0)
+        h[hlen++] = err;
+    for (int i = 1; i < elen; ++i) {
+        double product1, product0, sum;
+        two_product(e[i], b, &product1, &product0);
+        two_sum(q, product0, &sum, &err);
+        if (err != 0)
+            h[hlen++] = err;
+        two_sum(product1, sum, &q, &err);
+        if (err != 0)
+            h[hlen++] = err;
+    }
+    if (q != 0 || hlen == 0)
+        h[hlen++] = q;
+    return hlen;
+}
+
+
+short expansion_sign(int elen, const double* e) {
+    return (elen > 0) ? SIGN(e[elen - 1]) : 0;
+}
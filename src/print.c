@@ -1,17 +1,39 @@
 #include <split/print.h>
 #include <assert.h>
 #include <float.h>
+#include <stdarg.h>
 #include <stdio.h>
+#include <split/alloc.h>
+#include <split/e7.h>
+#include <split/h3.h>
 
 static const char WktPrintTypeNamePolygon[] = "POLYGON";
 static const char WktPrintTypeNameMultipolygon[] = "MULTIPOLYGON";
 
-static void print_polygon_data(const LinkedGeoPolygon* polygon);
-static void print_ring(const LinkedGeoLoop* ring);
-static void print_point(const LinkedLatLng* point);
-static void print_double(double value);
+#define PRINT_BUFFER_SIZE_INIT (4096)
+
+typedef struct {
+    FILE* file;
+    PrintBuffer* buffer; /* used instead of file if set */
+} PrintOutput;
+
+static PrintOutput printer_output(const PolygonPrinter* printer);
+static void print_format(PrintOutput* output, const char* format, ...);
+
+static void print_polygon_data(PrintOutput* output, const LinkedGeoPolygon* polygon, CoordMode coord_mode);
+static void print_ring(PrintOutput* output, const LinkedGeoLoop* ring, CoordMode coord_mode);
+static bool is_same_point(const LinkedLatLng* point1, const LinkedLatLng* point2, CoordMode coord_mode);
+static void print_point(PrintOutput* output, const LinkedLatLng* point, CoordMode coord_mode);
+static void print_double(PrintOutput* output, double value);
+static void print_e7(PrintOutput* output, double rads);
 
 void print_polygon(const LinkedGeoPolygon* polygon) {
+    print_polygon_mode(polygon, CoordMode_Double);
+}
+
+
+void print_polygon_mode(const LinkedGeoPolygon* polygon, CoordMode coord_mode) {
+    PrintOutput output = {stdout, NULL};
     if (polygon->next) {
         printf("%s(", WktPrintTypeNameMultipolygon);
     } else {
@@ -22,7 +44,7 @@ void print_polygon(const LinkedGeoPolygon* polygon) {
     while (cur) {
         if (cur != polygon)
             printf(", ");
-        print_polygon_data(cur);
+        print_polygon_data(&output, cur, coord_mode);
         cur = cur->next;
     }
 
@@ -32,55 +54,184 @@ void print_polygon(const LinkedGeoPolygon* polygon) {
 }
 
 
-void print_polygon_data(const LinkedGeoPolygon* polygon) {
+void polygon_printer_init(PolygonPrinter* printer) {
+    *printer = (PolygonPrinter){0};
+    printer->output = stdout;
+}
+
+
+void polygon_printer_add(PolygonPrinter* printer, LinkedGeoPolygon* polygon) {
+    assert(!polygon->next);
+    PrintOutput output = printer_output(printer);
+
+    if (printer->polygon_num == 0) {
+        /* Wait for next polygon */
+        printer->pending = polygon;
+        printer->polygon_num = 1;
+        return;
+    }
+
+    if (printer->polygon_num == 1) {
+        /* Multipolygon, print first polygon */
+        print_format(&output, "%s(", WktPrintTypeNameMultipolygon);
+        print_polygon_data(&output, printer->pending, printer->coord_mode);
+        free_linked_geo_polygon(printer->pending);
+        printer->pending = NULL;
+    }
+
+    print_format(&output, ", ");
+    print_polygon_data(&output, polygon, printer->coord_mode);
+    free_linked_geo_polygon(polygon);
+    ++printer->polygon_num;
+}
+
+
+void polygon_printer_finish(PolygonPrinter* printer) {
+    PrintOutput output = printer_output(printer);
+    if (printer->polygon_num < 2) {
+        print_format(&output, "%s", WktPrintTypeNamePolygon);
+        if (printer->pending) {
+            print_polygon_data(&output, printer->pending, printer->coord_mode);
+            free_linked_geo_polygon(printer->pending);
+        }
+    } else {
+        print_format(&output, ")");
+    }
+    printer->pending = NULL;
+    printer->polygon_num = 0;
+}
+
+
+void print_buffer_init(PrintBuffer* buffer) {
+    *buffer = (PrintBuffer){0};
+}
+
+
+void print_buffer_free(PrintBuffer* buffer) {
+    split_free(buffer->data, buffer->size);
+    *buffer = (PrintBuffer){0};
+}
+
+
+PrintOutput printer_output(const PolygonPrinter* printer) {
+    PrintOutput output = {printer->output, printer->buffer};
+    return output;
+}
+
+
+void print_format(PrintOutput* output, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (!output->buffer) {
+        vfprintf(output->file, format, args);
+        va_end(args);
+        return;
+    }
+
+    PrintBuffer* buffer = output->buffer;
+    if (buffer->failed) {
+        va_end(args);
+        return;
+    }
+
+    /* Print in place, grow and print again if it doesn't fit */
+    va_list retry_args;
+    va_copy(retry_args, args);
+    size_t free_size = buffer->size - buffer->len;
+    int len = vsnprintf(buffer->data ? buffer->data + buffer->len : NULL, free_size, format, args);
+    if (len >= 0 && (size_t) len >= free_size) {
+        size_t size = buffer->size ? buffer->size : PRINT_BUFFER_SIZE_INIT;
+        while (size - buffer->len <= (size_t) len)
+            size *= 2;
+        char* data = split_realloc(buffer->data, buffer->size, size);
+        if (data) {
+            buffer->data = data;
+            buffer->size = size;
+            len = vsnprintf(buffer->data + buffer->len, size - buffer->len, format, retry_args);
+        } else {
+            len = -1;
+        }
+    }
+    va_end(retry_args);
+    va_end(args);
+
+    if (len < 0)
+        buffer->failed = true;
+    else
+        buffer->len += len;
+}
+
+
+void print_polygon_data(PrintOutput* output, const LinkedGeoPolygon* polygon, CoordMode coord_mode) {
     if (polygon->first) {
-        printf("(");
+        print_format(output, "(");
         const LinkedGeoLoop* ring = polygon->first;
         while (ring) {
             if (ring != polygon->first)
-                printf(", ");
-            print_ring(ring);
+                print_format(output, ", ");
+            print_ring(output, ring, coord_mode);
             ring = ring->next;
         }
-        printf(")");
+        print_format(output, ")");
     }
 }
 
 
-void print_ring(const LinkedGeoLoop* ring) {
+void print_ring(PrintOutput* output, const LinkedGeoLoop* ring, CoordMode coord_mode) {
     assert(ring->first);
     assert(ring->last);
 
     const LinkedLatLng* first = ring->first;
-    const LinkedLatLng* last = ring->last;
-
-    printf("(");
-    const LinkedLatLng* point = first;
-    while (point) {
-        print_point(point);
-        point = point->next;
-        if (point)
-            printf(", ");
+    const LinkedLatLng* last = first;
+
+    print_format(output, "(");
+    print_point(output, first, coord_mode);
+    for (const LinkedLatLng* point = first->next; point != NULL; point = point->next) {
+        /* Skip points equal to previous one once snapped */
+        if (coord_mode != CoordMode_Double && is_same_point(point, last, coord_mode))
+            continue;
+        print_format(output, ", ");
+        print_point(output, point, coord_mode);
+        last = point;
     }
     /* Close ring */
-    if (first->vertex.lng != last->vertex.lng
-        || first->vertex.lat != last->vertex.lat)
-    {
-        printf(", ");
-        print_point(first);
+    if (!is_same_point(first, last, coord_mode)) {
+        print_format(output, ", ");
+        print_point(output, first, coord_mode);
     }
-    printf(")");
+    print_format(output, ")");
 }
 
 
-void print_point(const LinkedLatLng* point) {
-    print_double(radsToDegs(point->vertex.lng));
-    printf(" ");
-    print_double(radsToDegs(point->vertex.lat));
+bool is_same_point(const LinkedLatLng* point1, const LinkedLatLng* point2, CoordMode coord_mode) {
+    if (coord_mode == CoordMode_E7)
+        return latlng_eq_e7(&point1->vertex, &point2->vertex);
+    return point1->vertex.lng == point2->vertex.lng
+        && point1->vertex.lat == point2->vertex.lat;
 }
 
 
-void print_double(double value) {
+void print_point(PrintOutput* output, const LinkedLatLng* point, CoordMode coord_mode) {
+    if (coord_mode == CoordMode_E7) {
+        print_e7(output, point->vertex.lng);
+        print_format(output, " ");
+        print_e7(output, point->vertex.lat);
+        return;
+    }
+    print_double(output, radsToDegs(point->vertex.lng));
+    print_format(output, " ");
+    print_double(output, radsToDegs(point->vertex.lat));
+}
+
+
+void print_double(PrintOutput* output, double value) {
     /* printf("%.*f", DECIMAL_DIG, value); */
-    printf("%f", value);
+    print_format(output, "%f", value);
+}
+
+
+void print_e7(PrintOutput* output, double rads) {
+    char buffer[E7_FORMAT_SIZE];
+    e7_format(e7_from_rads(rads), buffer);
+    print_format(output, "%s", buffer);
 }
@@ -0,0 +1,259 @@
+#include <split/scan.h>
+#include <stdint.h>
+#if defined(__AVX2__)
+# include <immintrin.h>
+#elif defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+/*
+  Class masks of a block have bit i set for byte i. Ranges are tested
+  with a single unsigned compare: c is in [lo, lo + n] when (c - lo) is
+  not above n, i.e. min(c - lo, n) == c - lo.
+ */
+
+#if defined(__AVX2__)
+# define SCAN_BLOCK_SIZE (32)
+# define SCAN_BLOCK_MASK (0xffffffffu)
+#elif defined(__SSE2__)
+# define SCAN_BLOCK_SIZE (16)
+# define SCAN_BLOCK_MASK (0xffffu)
+#else
+# define SCAN_BLOCK_SIZE (0)
+#endif
+
+#define DOUBLE_EXACT_MANTISSA_MAX (1ULL << 53)
+#define DOUBLE_EXACT_EXP10_MAX (22)
+#define DIGIT_NUM_MAX (19)
+#define EXP10_LIMIT (10000)
+
+static const double Exp10s[DOUBLE_EXACT_EXP10_MAX + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool is_ws(char c);
+static inline bool is_number_char(char c);
+static inline int count_trailing_zeros(uint32_t mask);
+
+#if SCAN_BLOCK_SIZE
+static inline uint32_t ws_mask(const char* data);
+static inline uint32_t number_mask(const char* data);
+static inline void paren_masks(const char* data, uint32_t* open, uint32_t* close);
+#endif
+
+
+size_t scan_ws(const char* data, size_t len) {
+    /* Whitespace is mostly a single space, checked before block scan */
+    if (len == 0 || !is_ws(data[0]))
+        return 0;
+    size_t pos = 1;
+#if SCAN_BLOCK_SIZE
+    for (; pos + SCAN_BLOCK_SIZE <= len; pos += SCAN_BLOCK_SIZE) {
+        uint32_t mask = ~ws_mask(data + pos) & SCAN_BLOCK_MASK;
+        if (mask)
+            return pos + count_trailing_zeros(mask);
+    }
+#endif
+    while (pos < len && is_ws(data[pos]))
+        ++pos;
+    return pos;
+}
+
+
+size_t scan_number(const char* data, size_t len) {
+    size_t pos = 0;
+#if SCAN_BLOCK_SIZE
+    for (; pos + SCAN_BLOCK_SIZE <= len; pos += SCAN_BLOCK_SIZE) {
+        uint32_t mask = ~number_mask(data + pos) & SCAN_BLOCK_MASK;
+        if (mask)
+            return pos + count_trailing_zeros(mask);
+    }
+#endif
+    while (pos < len && is_number_char(data[pos]))
+        ++pos;
+    return pos;
+}
+
+
+size_t scan_paren(const char* data, size_t len) {
+    size_t pos = 0;
+#if SCAN_BLOCK_SIZE
+    for (; pos + SCAN_BLOCK_SIZE <= len; pos += SCAN_BLOCK_SIZE) {
+        uint32_t open, close;
+        paren_masks(data + pos, &open, &close);
+        if (open | close)
+            return pos + count_trailing_zeros(open | close);
+    }
+#endif
+    while (pos < len && data[pos] != '(' && data[pos] != ')')
+        ++pos;
+    return pos;
+}
+
+
+int scan_depth(const char* data, size_t len) {
+    int depth = 0;
+    size_t pos = 0;
+#if SCAN_BLOCK_SIZE
+    for (; pos + SCAN_BLOCK_SIZE <= len; pos += SCAN_BLOCK_SIZE) {
+        uint32_t open, close;
+        paren_masks(data + pos, &open, &close);
+        depth += __builtin_popcount(open) - __builtin_popcount(close);
+    }
+#endif
+    for (; pos < len; ++pos)
+        depth += (data[pos] == '(') - (data[pos] == ')');
+    return depth;
+}
+
+
+bool scan_double(const char* str, size_t len, double* value) {
+    /* One multiplication or division of two exact values is correctly rounded */
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < len && (str[pos] == '+' || str[pos] == '-')) {
+        negative = (str[pos] == '-');
+        ++pos;
+    }
+
+    /* Mantissa digits */
+    uint64_t mantissa = 0;
+    int digit_num = 0; /* significant */
+    int mantissa_len = 0;
+    int exp10 = 0;
+    bool has_point = false;
+    for (; pos < len; ++pos) {
+        char c = str[pos];
+        if (c == '.' && !has_point) {
+            has_point = true;
+            continue;
+        }
+        if (c < '0' || c > '9')
+            break;
+        ++mantissa_len;
+        if (digit_num == DIGIT_NUM_MAX)
+            return false;
+        if (mantissa || c != '0')
+            ++digit_num; /* leading zeros are not significant */
+        mantissa = mantissa * 10 + (c - '0');
+        if (has_point)
+            --exp10;
+    }
+    if (mantissa_len == 0)
+        return false;
+
+    /* Exponent */
+    if (pos < len && (str[pos] == 'e' || str[pos] == 'E')) {
+        ++pos;
+        bool exp_negative = false;
+        if (pos < len && (str[pos] == '+' || str[pos] == '-')) {
+            exp_negative = (str[pos] == '-');
+            ++pos;
+        }
+        if (pos == len)
+            return false;
+        int exp = 0;
+        for (; pos < len && str[pos] >= '0' && str[pos] <= '9'; ++pos) {
+            if (exp < EXP10_LIMIT)
+                exp = exp * 10 + (str[pos] - '0');
+        }
+        exp10 += exp_negative ? -exp : exp;
+    }
+    if (pos != len)
+        return false;
+
+    if (mantissa > DOUBLE_EXACT_MANTISSA_MAX)
+        return false;
+    double result = (double) mantissa;
+    if (mantissa != 0) {
+        if (exp10 < -DOUBLE_EXACT_EXP10_MAX || exp10 > DOUBLE_EXACT_EXP10_MAX)
+            return false;
+        result = (exp10 < 0) ? result / Exp10s[-exp10] : result * Exp10s[exp10];
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+
+bool is_ws(char c) {
+    return c == ' ' || (unsigned char) (c - '\t') <= '\r' - '\t';
+}
+
+
+bool is_number_char(char c) {
+    return (unsigned char) (c - '0') <= 9
+        || (unsigned char) ((c | 0x20) - 'a') <= 'z' - 'a'
+        || c == '+' || c == '-' || c == '.';
+}
+
+
+int count_trailing_zeros(uint32_t mask) {
+    return __builtin_ctz(mask);
+}
+
+
+#if defined(__AVX2__)
+
+uint32_t ws_mask(const char* data) {
+    __m256i c = _mm256_loadu_si256((const __m256i*) data);
+    __m256i control = _mm256_sub_epi8(c, _mm256_set1_epi8('\t'));
+    __m256i is_control = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(control, _mm256_set1_epi8('\r' - '\t')), control);
+    __m256i is_space = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' '));
+    return (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(is_control, is_space));
+}
+
+
+uint32_t number_mask(const char* data) {
+    __m256i c = _mm256_loadu_si256((const __m256i*) data);
+    __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i letter = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8('z' - 'a')), letter);
+    __m256i is_sign = _mm256_or_si256(
+        _mm256_cmpeq_epi8(c, _mm256_set1_epi8('+')), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-')));
+    __m256i is_point = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('.'));
+    return (uint32_t) _mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(is_digit, is_letter), _mm256_or_si256(is_sign, is_point)));
+}
+
+
+void paren_masks(const char* data, uint32_t* open, uint32_t* close) {
+    __m256i c = _mm256_loadu_si256((const __m256i*) data);
+    *open = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('(')));
+    *close = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(')')));
+}
+
+#elif defined(__SSE2__)
+
+uint32_t ws_mask(const char* data) {
+    __m128i c = _mm_loadu_si128((const __m128i*) data);
+    __m128i control = _mm_sub_epi8(c, _mm_set1_epi8('\t'));
+    __m128i is_control = _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8('\r' - '\t')), control);
+    __m128i is_space = _mm_cmpeq_epi8(c, _mm_set1_epi8(' '));
+    return (uint32_t) _mm_movemask_epi8(_mm_or_si128(is_control, is_space));
+}
+
+
+uint32_t number_mask(const char* data) {
+    __m128i c = _mm_loadu_si128((const __m128i*) data);
+    __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8('z' - 'a')), letter);
+    __m128i is_sign = _mm_or_si128(
+        _mm_cmpeq_epi8(c, _mm_set1_epi8('+')), _mm_cmpeq_epi8(c, _mm_set1_epi8('-')));
+    __m128i is_point = _mm_cmpeq_epi8(c, _mm_set1_epi8('.'));
+    return (uint32_t) _mm_movemask_epi8(
+        _mm_or_si128(_mm_or_si128(is_digit, is_letter), _mm_or_si128(is_sign, is_point)));
+}
+
+
+void paren_masks(const char* data, uint32_t* open, uint32_t* close) {
+    __m128i c = _mm_loadu_si128((const __m128i*) data);
+    *open = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8('(')));
+    *close = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8(')')));
+}
+
+#endif
@@ -2,9 +2,14 @@
 #include <assert.h>
 #include <float.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <split/alloc.h>
 #include <split/bbox3.h>
 #include <split/h3.h>
+#include <split/predicates.h>
 #include <split/vect3.h>
+#include "split_internal.h"
 
 /*
 
@@ -64,6 +69,44 @@ Algorithm overview:
     - check which non-split holes are inside the exterior ring and add them to polygon
     - add polygon to result
 
+
+Splitting by parallels:
+
+The same traversal is used to cut polygons along a parallel (constant latitude
+small circle). Vertex sign is the side of the parallel (north is positive),
+intersections are sorted by longitude. Unlike meridians, a great circle arc
+with both endpoints on the same side may cross the parallel twice (the arc
+bulges towards the pole), such segments are split by inserting the point
+of extreme latitude first, so every segment crosses the parallel at most once.
+For the same reason an edge between paired intersections would not follow
+the parallel, so points are added along it, at most a degree of longitude
+apart (the equator is a great circle and needs none).
+
+
+Fast path:
+
+Most crossed polygons are small cells or tiles: a single ring crossed exactly
+twice, with no vertices on the split line. For such a ring the traversal
+above always yields the same two parts, so they are built directly in one
+more pass over the ring, without filling the vertex and intersection arrays:
+
+  v0 .. va, A, B, vb+1 .. vn-1   (part containing the first vertex)
+  va+1 .. vb, B, A
+
+where A is the intersection after vertex a and B the one after vertex b.
+
+
+Partition by base cells:
+
+H3 resolution 0 cells are convex spherical polygons, edges are taken as great
+circle arcs between boundary vertices, so a cell is the intersection of the
+hemispheres on the left of its edges. A polygon is clipped to a cell by
+splitting it with each edge circle in turn and dropping parts on the right
+side. Intersections on a great circle are sorted by angle from the circle
+point closest to the polygon, so polygons smaller than a hemisphere never
+wrap around the sort order. Cells are tested first against a bounding cap of
+the polygon, so a polygon is only copied and clipped for cells it may overlap.
+
  */
 
 #define DEBUG 0
@@ -75,21 +118,13 @@ Algorithm overview:
 
 #define FP_EQUAL(v1, v2) ((v1) == (v2) || fabs((v1) - (v2)) < DBL_EPSILON)
 
-#define MAX_INTERSECT_NUM_INIT (4)
-
-typedef enum {
-    SplitIntersectDir_None = 0,
-    SplitIntersectDir_WE,
-    SplitIntersectDir_EW
-} SplitIntersectDir;
+/* Inline storage sizes, polygons fitting into them are split without allocations */
+#define SPLIT_INLINE_VERTEX_NUM (64)
+#define SPLIT_INLINE_INTERSECT_NUM (16)
+#define SPLIT_INLINE_HOLE_NUM (8)
 
-typedef struct {
-    short dir;
-    bool is_prime;
-    double lat;
-    int index;
-    int sort_order;
-} SplitIntersect;
+/* Longitude step of result edges along a parallel, a 1 degree arc strays from it by < 0.0011 degree */
+#define PARALLEL_EDGE_LNG_STEP (M_PI / 180)
 
 typedef struct {
     const LatLng* latlng_p;
@@ -99,7 +134,24 @@ typedef struct {
 } SplitVertex;
 
 typedef struct {
+    LinkedGeoPolygon* first;
+    LinkedGeoPolygon* last;
+} SplitCollect;
+
+typedef struct {
+    H3Index cell;
+    int vertex_num;
+    Vect3 vertices[MAX_CELL_BNDRY_VERTS]; /* counter-clockwise */
+    Vect3 center; /* bounding cap */
+    double radius;
+} SplitBaseCell;
+
+typedef struct {
+    /* Split line */
+    SplitLine line;
+
     /* Vertices */
+    int max_vertex_num;
     int vertex_num;
     SplitVertex* vertices;
 
@@ -110,53 +162,104 @@ typedef struct {
     SplitIntersect** sorted_intersects;
 
     /* Non-split holes */
+    int max_hole_num;
     int hole_num;
     const LinkedGeoLoop** holes;
 } Split;
 
-static bool is_polygon_crossed_by_180(const LinkedGeoPolygon* polygon);
-static LinkedGeoPolygon* split_polygon_by_180(const LinkedGeoPolygon* polygon);
-
-static bool is_ring_crossed(const LinkedGeoLoop* ring);
-static double split_180_lat(const LatLng *coord1, const LatLng *coord2);
-
-static bool split_init(Split* split, int ring_num, int vertex_num);
-static void split_cleanup(Split* split);
-
-static void split_process_ring(Split* split, const LinkedGeoLoop* ring);
+struct SplitContext {
+    Split split;
+    bool fast_path; /* single ring with two crossings is split directly */
+
+    /* Inline storage */
+    SplitVertex vertices[SPLIT_INLINE_VERTEX_NUM];
+    SplitIntersect intersects[SPLIT_INLINE_INTERSECT_NUM];
+    SplitIntersect* sorted_intersects[SPLIT_INLINE_INTERSECT_NUM];
+    const LinkedGeoLoop* holes[SPLIT_INLINE_HOLE_NUM];
+
+    /* Base cell table, built on first partition */
+    int base_cell_num;
+    SplitBaseCell* base_cells;
+};
+
+static bool split_owned_polygon_by_parallels(
+    SplitContext* context, LinkedGeoPolygon* polygon, const double* lats, int lat_num,
+    SplitPolygonCallback callback, void* user_data);
+static void split_collect_polygon(LinkedGeoPolygon* polygon, void* user_data);
+
+static bool split_context_load_base_cells(SplitContext* context);
+static bool split_owned_polygon_by_cell(
+    SplitContext* context, LinkedGeoPolygon* polygon, const SplitBaseCell* base_cell,
+    const Vect3* polygon_center, int edge, SplitCellPolygonCallback callback, void* user_data);
+static void ring_bounding_cap(const LinkedGeoLoop* ring, Vect3* center, double* radius);
+
+static void split_context_init(SplitContext* context);
+static void split_context_cleanup(SplitContext* context);
+
+static bool is_crossed_by_line(const SplitLine* line, const LinkedGeoPolygon* polygon);
+
+static bool is_polygon_crossed(const SplitLine* line, const LinkedGeoPolygon* polygon);
+static bool split_polygon(
+    SplitContext* context, const SplitLine* line, const LinkedGeoPolygon* polygon,
+    SplitPolygonCallback callback, void* user_data);
+
+static bool split_simple_ring_scan(
+    const SplitLine* line, const LinkedGeoLoop* ring,
+    const LinkedLatLng** after_a, const LinkedLatLng** after_b);
+static bool split_simple_ring(
+    const SplitLine* line, const LinkedGeoLoop* ring,
+    const LinkedLatLng* after_a, const LinkedLatLng* after_b,
+    SplitPolygonCallback callback, void* user_data);
+static bool add_ring_part(
+    LinkedGeoLoop* loop, const LinkedLatLng* first, const LinkedLatLng* last);
+
+static bool is_ring_crossed(const SplitLine* line, const LinkedGeoLoop* ring);
+static double split_parallel_lng(const LatLng *coord1, const LatLng *coord2, double lat);
+static bool split_parallel_apex(
+    const LatLng *coord1, const LatLng *coord2, double lat, LatLng* apex);
+
+static void split_line_init_great_circle(
+    SplitLine* line, const Vect3* v1, const Vect3* v2, const Vect3* ref);
+static bool split_line_keeps(const SplitLine* line, short sign);
+static short split_ring_side(const SplitLine* line, const LinkedGeoLoop* ring);
+static double split_great_circle_pos(const SplitLine* line, const LatLng *coord1, const LatLng *coord2);
+
+static bool densify_polygon_parallel(LinkedGeoPolygon* polygon, double lat);
+static bool add_parallel_edge(
+    LinkedGeoLoop* loop, const SplitLine* line, const LatLng* from, const LatLng* to);
+
+static Split* split_init(SplitContext* context, const SplitLine* line, int ring_num, int vertex_num);
+static void* split_grow(
+    void* data, const void* inline_data, int old_max_num, int max_num, int copy_num, size_t item_size);
+
+static bool split_process_ring(Split* split, const LinkedGeoLoop* ring);
 static void split_prepare(Split* split);
-static LinkedGeoPolygon* split_create_multi_polygon(Split* split);
+static bool split_create_multi_polygon(
+    Split* split, SplitPolygonCallback callback, void* user_data);
 
 static int split_add_vertex(Split* split, const LatLng* latlng);
-static void split_add_intersect_after(
-    Split* split, int after, SplitIntersectDir dir, bool is_prime, double lat);
+static bool split_add_intersect_after(
+    Split* split, int after, SplitIntersectDir dir, bool is_prime, double pos);
 static int split_add_intersect(
-    Split* split, SplitIntersectDir dir, bool is_prime, double lat);
+    Split* split, SplitIntersectDir dir, bool is_prime, double pos);
 static void split_link_vertices(Split* split, int idx1, int idx2);
 static void split_add_hole(Split* split, const LinkedGeoLoop* hole);
 
 static void split_sort_intersects(Split* split);
-static int split_intersect_ptr_cmp(const void* a, const void* b);
 
 static int split_find_next_vertex(Split* split, int* start);
 static LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx);
 static const SplitIntersect* split_get_intersect_after(const Split* split, int idx);
 
-static void split_intersect_get_latlng(const SplitIntersect* intersect, short sign, LatLng* latlng);
 
 static int count_polygon_vertices(const LinkedGeoPolygon* polygon, int* ring_num);
-static int count_ring_vertices(const LinkedGeoLoop* ring);
 
-static short latlng_ring_pos(
-    const LinkedGeoLoop* ring, short sign, const Bbox3* bbox, const LatLng* latlng);
-static short segment_intersect(const Vect3* v1, const Vect3* v2, const Vect3* u1, const Vect3* u2);
-static short point_between(const Vect3* v1, const Vect3* v2, const Vect3* p);
+static void ring_pos_add_segment(SplitRingPos* pos, const Vect3* v1, const Vect3* v2);
 
 static LinkedGeoPolygon* copy_linked_geo_polygon(const LinkedGeoPolygon* polygon);
 static LinkedGeoLoop* copy_linked_geo_loop(const LinkedGeoLoop* loop);
 static LinkedLatLng* copy_linked_latlng(const LinkedLatLng* latlng);
 
-static LinkedLatLng* add_latlng_unique(LinkedGeoLoop* loop, const LatLng* latlng, bool* skipped);
 
 #if DEBUG
 static void dbg_print_split(const Split* split);
@@ -167,102 +270,593 @@ static void dbg_print_double(double value);
 #endif
 
 bool is_crossed_by_180(const LinkedGeoPolygon* multi_polygon) {
+    SplitLine line = {SplitLineType_180, 0.0};
+    return is_crossed_by_line(&line, multi_polygon);
+}
+
+
+LinkedGeoPolygon* split_by_180(const LinkedGeoPolygon* multi_polygon) {
+    SplitCollect collect = {0};
+    if (!split_by_180_each(multi_polygon, &split_collect_polygon, &collect)) {
+        if (collect.first)
+            free_linked_geo_polygon(collect.first);
+        return NULL;
+    }
+    return collect.first;
+}
+
+
+bool split_by_180_each(
+    const LinkedGeoPolygon* multi_polygon, SplitPolygonCallback callback, void* user_data)
+{
+    SplitContext context;
+    split_context_init(&context);
+    bool ok = split_context_by_180(&context, multi_polygon, callback, user_data);
+    split_context_cleanup(&context);
+    return ok;
+}
+
+
+bool is_crossed_by_parallel(const LinkedGeoPolygon* multi_polygon, double lat) {
+    assert(-M_PI_2 < lat && lat < M_PI_2);
+    SplitLine line = {SplitLineType_Parallel, lat};
+    return is_crossed_by_line(&line, multi_polygon);
+}
+
+
+LinkedGeoPolygon* split_by_parallel(const LinkedGeoPolygon* multi_polygon, double lat) {
+    return split_by_parallels(multi_polygon, &lat, 1);
+}
+
+
+LinkedGeoPolygon* split_by_parallels(
+    const LinkedGeoPolygon* multi_polygon, const double* lats, int lat_num)
+{
+    SplitCollect collect = {0};
+    if (!split_by_parallels_each(multi_polygon, lats, lat_num, &split_collect_polygon, &collect)) {
+        if (collect.first)
+            free_linked_geo_polygon(collect.first);
+        return NULL;
+    }
+    return collect.first;
+}
+
+
+bool split_by_parallels_each(
+    const LinkedGeoPolygon* multi_polygon, const double* lats, int lat_num,
+    SplitPolygonCallback callback, void* user_data)
+{
+    SplitContext context;
+    split_context_init(&context);
+    bool ok = split_context_by_parallels(
+        &context, multi_polygon, lats, lat_num, callback, user_data);
+    split_context_cleanup(&context);
+    return ok;
+}
+
+
+bool split_by_base_cells_each(
+    const LinkedGeoPolygon* multi_polygon, SplitCellPolygonCallback callback, void* user_data)
+{
+    SplitContext context;
+    split_context_init(&context);
+    bool ok = split_context_by_base_cells(&context, multi_polygon, callback, user_data);
+    split_context_cleanup(&context);
+    return ok;
+}
+
+
+SplitContext* split_context_new() {
+    SplitContext* context = split_malloc(sizeof(SplitContext));
+    if (context)
+        split_context_init(context);
+    return context;
+}
+
+
+void split_context_free(SplitContext* context) {
+    split_context_cleanup(context);
+    split_free(context, sizeof(SplitContext));
+}
+
+
+void split_context_set_fast_path(SplitContext* context, bool enabled) {
+    context->fast_path = enabled;
+}
+
+
+bool split_context_by_180(
+    SplitContext* context, const LinkedGeoPolygon* multi_polygon,
+    SplitPolygonCallback callback, void* user_data)
+{
+    SplitLine line = {SplitLineType_180, 0.0};
     for (const LinkedGeoPolygon* polygon = multi_polygon;
          polygon != NULL;
          polygon = polygon->next)
     {
-        if (is_polygon_crossed_by_180(polygon))
-            return true;
+        if (is_polygon_crossed(&line, polygon)) {
+            /* Split */
+            if (!split_polygon(context, &line, polygon, callback, user_data))
+                return false;
+        } else {
+            /* Copy */
+            LinkedGeoPolygon* copy = copy_linked_geo_polygon(polygon);
+            if (!copy)
+                return false;
+            callback(copy, user_data);
+        }
     }
-    return false;
+    return true;
 }
 
 
-LinkedGeoPolygon* split_by_180(const LinkedGeoPolygon* multi_polygon) {
-    LinkedGeoPolygon* result = NULL;
-    LinkedGeoPolygon* last = NULL;
+bool split_context_by_parallels(
+    SplitContext* context, const LinkedGeoPolygon* multi_polygon, const double* lats, int lat_num,
+    SplitPolygonCallback callback, void* user_data)
+{
+    for (const LinkedGeoPolygon* polygon = multi_polygon;
+         polygon != NULL;
+         polygon = polygon->next)
+    {
+        LinkedGeoPolygon* copy = copy_linked_geo_polygon(polygon);
+        if (!copy)
+            return false;
+        if (!split_owned_polygon_by_parallels(context, copy, lats, lat_num, callback, user_data))
+            return false;
+    }
+    return true;
+}
+
+
+bool split_owned_polygon_by_parallels(
+    SplitContext* context, LinkedGeoPolygon* polygon, const double* lats, int lat_num,
+    SplitPolygonCallback callback, void* user_data)
+{
+    /* Find first parallel crossing the polygon */
+    SplitLine line = {SplitLineType_Parallel, 0.0};
+    int i = 0;
+    for (; i < lat_num; ++i) {
+        assert(-M_PI_2 < lats[i] && lats[i] < M_PI_2);
+        line.lat = lats[i];
+        if (is_polygon_crossed(&line, polygon))
+            break;
+    }
+    if (i == lat_num) {
+        /* Not crossed, pass as is */
+        callback(polygon, user_data);
+        return true;
+    }
+
+    /* Make sure each segment crosses the parallel at most once */
+    if (!densify_polygon_parallel(polygon, line.lat)) {
+        free_linked_geo_polygon(polygon);
+        return false;
+    }
+
+    /* Split, collect parts so that the context is free for cutting them further */
+    SplitCollect collect = {0};
+    bool ok = split_polygon(context, &line, polygon, &split_collect_polygon, &collect);
+    free_linked_geo_polygon(polygon);
+
+    /* Cut each part by remaining parallels */
+    LinkedGeoPolygon* part = collect.first;
+    while (part) {
+        LinkedGeoPolygon* next = part->next;
+        part->next = NULL;
+        if (ok) {
+            ok = split_owned_polygon_by_parallels(
+                context, part, lats + i + 1, lat_num - i - 1, callback, user_data);
+        } else {
+            free_linked_geo_polygon(part);
+        }
+        part = next;
+    }
+    return ok;
+}
+
+
+bool split_context_by_base_cells(
+    SplitContext* context, const LinkedGeoPolygon* multi_polygon,
+    SplitCellPolygonCallback callback, void* user_data)
+{
+    if (!split_context_load_base_cells(context))
+        return false;
 
     for (const LinkedGeoPolygon* polygon = multi_polygon;
          polygon != NULL;
          polygon = polygon->next)
     {
-        /* Split or copy next polygon */
-        LinkedGeoPolygon* next_result = is_polygon_crossed_by_180(polygon)
-            ? split_polygon_by_180(polygon)
-            : copy_linked_geo_polygon(polygon);
-        if (!next_result) {
-            if (result)
-                free_linked_geo_polygon(result);
-            return NULL;
+        if (!polygon->first || !polygon->first->first)
+            continue;
+
+        Vect3 center;
+        double radius;
+        ring_bounding_cap(polygon->first, &center, &radius);
+
+        for (int i = 0; i < context->base_cell_num; ++i) {
+            /* Skip cells whose bounding cap is apart from the polygon's */
+            const SplitBaseCell* base_cell = &context->base_cells[i];
+            if (radius < M_PI_2) {
+                double cos_dist = vect3_dot(&center, &base_cell->center);
+                if (cos_dist < 1 && acos(cos_dist) > radius + base_cell->radius)
+                    continue;
+            }
+
+            LinkedGeoPolygon* copy = copy_linked_geo_polygon(polygon);
+            if (!copy)
+                return false;
+            if (!split_owned_polygon_by_cell(context, copy, base_cell, &center, 0, callback, user_data))
+                return false;
+        }
+    }
+    return true;
+}
+
+
+bool split_context_load_base_cells(SplitContext* context) {
+    if (context->base_cells)
+        return true;
+
+    int cell_num = res0CellCount();
+    H3Index* cells = split_malloc(cell_num * sizeof(H3Index));
+    SplitBaseCell* base_cells = split_malloc(cell_num * sizeof(SplitBaseCell));
+    bool ok = cells && base_cells && getRes0Cells(cells) == E_SUCCESS;
+    for (int i = 0; ok && i < cell_num; ++i) {
+        SplitBaseCell* base_cell = &base_cells[i];
+        CellBoundary boundary;
+        if (cellToBoundary(cells[i], &boundary) != E_SUCCESS || boundary.numVerts < 3) {
+            ok = false;
+            break;
+        }
+        base_cell->cell = cells[i];
+        base_cell->vertex_num = boundary.numVerts;
+
+        /* Vertices and bounding cap, vertex distances bound the edges of a small convex cell */
+        Vect3 center = {0};
+        for (int j = 0; j < boundary.numVerts; ++j) {
+            vect3_from_lat_lng(&boundary.verts[j], &base_cell->vertices[j]);
+            vect3_sum(&center, &base_cell->vertices[j], &center);
+        }
+        vect3_normalize(&center);
+        base_cell->center = center;
+        base_cell->radius = 0;
+        for (int j = 0; j < boundary.numVerts; ++j) {
+            double dist = acos(fmin(vect3_dot(&center, &base_cell->vertices[j]), 1));
+            if (dist > base_cell->radius)
+                base_cell->radius = dist;
+        }
+
+        /* Make sure the cell is on the left of its edges */
+        if (orient3(&base_cell->vertices[0], &base_cell->vertices[1], &center) < 0) {
+            for (int j = 0, k = boundary.numVerts - 1; j < k; ++j, --k) {
+                Vect3 vertex = base_cell->vertices[j];
+                base_cell->vertices[j] = base_cell->vertices[k];
+                base_cell->vertices[k] = vertex;
+            }
+        }
+    }
+    if (cells)
+        split_free(cells, cell_num * sizeof(H3Index));
+    if (!ok) {
+        if (base_cells)
+            split_free(base_cells, cell_num * sizeof(SplitBaseCell));
+        return false;
+    }
+
+    context->base_cell_num = cell_num;
+    context->base_cells = base_cells;
+    return true;
+}
+
+
+bool split_owned_polygon_by_cell(
+    SplitContext* context, LinkedGeoPolygon* polygon, const SplitBaseCell* base_cell,
+    const Vect3* polygon_center, int edge, SplitCellPolygonCallback callback, void* user_data)
+{
+    /* Find first edge circle crossing the polygon, drop the polygon if it's outside of an edge */
+    SplitLine line = {SplitLineType_GreatCircle, 0.0, 1};
+    for (; edge < base_cell->vertex_num; ++edge) {
+        split_line_init_great_circle(
+            &line,
+            &base_cell->vertices[edge],
+            &base_cell->vertices[(edge + 1) % base_cell->vertex_num],
+            polygon_center);
+        if (is_polygon_crossed(&line, polygon))
+            break;
+        if (split_ring_side(&line, polygon->first) < 0) {
+            free_linked_geo_polygon(polygon);
+            return true;
         }
+    }
+    if (edge == base_cell->vertex_num) {
+        /* Inside the cell */
+        callback(polygon, base_cell->cell, user_data);
+        return true;
+    }
 
-         if (!result) {
-            result = next_result;
-            last = next_result;
+    /* Split, parts outside of the edge are dropped */
+    SplitCollect collect = {0};
+    bool ok = split_polygon(context, &line, polygon, &split_collect_polygon, &collect);
+    free_linked_geo_polygon(polygon);
+
+    /* Clip each part by remaining edges */
+    LinkedGeoPolygon* part = collect.first;
+    while (part) {
+        LinkedGeoPolygon* next = part->next;
+        part->next = NULL;
+        if (ok) {
+            ok = split_owned_polygon_by_cell(
+                context, part, base_cell, polygon_center, edge + 1, callback, user_data);
         } else {
-            last->next = next_result;
+            free_linked_geo_polygon(part);
         }
-        while (last->next)
-            last = last->next;
+        part = next;
     }
+    return ok;
+}
 
-    return result;
+
+void ring_bounding_cap(const LinkedGeoLoop* ring, Vect3* center, double* radius) {
+    /*
+      Cap around the mean of ring vertices. If all vertices are within 90 degrees
+      of the center, so are the arcs between them, and a polygon smaller than
+      a hemisphere is inside the cap; a wider ring gets radius of at least 90.
+     */
+    *center = (Vect3){0};
+    for (const LinkedLatLng* cur = ring->first; cur != NULL; cur = cur->next) {
+        Vect3 vect;
+        vect3_from_lat_lng(&cur->vertex, &vect);
+        vect3_sum(center, &vect, center);
+    }
+    vect3_normalize(center);
+
+    *radius = 0;
+    for (const LinkedLatLng* cur = ring->first; cur != NULL; cur = cur->next) {
+        Vect3 vect;
+        vect3_from_lat_lng(&cur->vertex, &vect);
+        double cos_dist = center->x * vect.x + center->y * vect.y + center->z * vect.z;
+        double dist = acos(fmax(fmin(cos_dist, 1), -1));
+        if (dist > *radius)
+            *radius = dist;
+    }
 }
 
 
-bool is_polygon_crossed_by_180(const LinkedGeoPolygon* polygon) {
+void split_collect_polygon(LinkedGeoPolygon* polygon, void* user_data) {
+    SplitCollect* collect = user_data;
+    if (!collect->first) {
+        collect->first = polygon;
+    } else {
+        collect->last->next = polygon;
+    }
+    collect->last = polygon;
+}
+
+
+bool is_crossed_by_line(const SplitLine* line, const LinkedGeoPolygon* multi_polygon) {
+    for (const LinkedGeoPolygon* polygon = multi_polygon;
+         polygon != NULL;
+         polygon = polygon->next)
+    {
+        if (is_polygon_crossed(line, polygon))
+            return true;
+    }
+    return false;
+}
+
+
+bool is_polygon_crossed(const SplitLine* line, const LinkedGeoPolygon* polygon) {
     return (polygon->first && polygon->first->first)
-        ? is_ring_crossed(polygon->first)
+        ? is_ring_crossed(line, polygon->first)
         : false;
 }
 
 
-LinkedGeoPolygon* split_polygon_by_180(const LinkedGeoPolygon* polygon) {
+bool split_polygon(
+    SplitContext* context, const SplitLine* line, const LinkedGeoPolygon* polygon,
+    SplitPolygonCallback callback, void* user_data)
+{
 #if DEBUG
     printf("Splitting polygon\n");
 #endif
 
+    /* Single ring crossed twice */
+    const LinkedLatLng* after_a;
+    const LinkedLatLng* after_b;
+    if (context->fast_path
+        && !polygon->first->next
+        && split_simple_ring_scan(line, polygon->first, &after_a, &after_b))
+    {
+        return split_simple_ring(line, polygon->first, after_a, after_b, callback, user_data);
+    }
+
     int ring_num = 0;
     int vertex_num = count_polygon_vertices(polygon, &ring_num);
 
     /* Init data */
-    Split split;
-    split_init(&split, ring_num, vertex_num);
+    Split* split = split_init(context, line, ring_num, vertex_num);
+    if (!split)
+        return false;
 
     /* Process ring */
     const LinkedGeoLoop* ring = polygon->first;
     do {
-        if (ring == polygon->first || is_ring_crossed(ring)) {
-            split_process_ring(&split, ring);
+        if (ring == polygon->first || is_ring_crossed(line, ring)) {
+            if (!split_process_ring(split, ring))
+                return false;
         } else {
-            split_add_hole(&split, ring);
+            split_add_hole(split, ring);
         }
         ring = ring->next;
     } while (ring);
 
     /* Prepare data */
-    split_prepare(&split);
+    split_prepare(split);
 
 #if DEBUG
-    dbg_print_split(&split);
+    dbg_print_split(split);
 #endif
 
     /* Construct result */
-    LinkedGeoPolygon* result = split_create_multi_polygon(&split);
+    return split_create_multi_polygon(split, callback, user_data);
+}
 
-    /* Cleanup */
-    split_cleanup(&split);
 
-    return result;
+bool split_simple_ring_scan(
+    const SplitLine* line, const LinkedGeoLoop* ring,
+    const LinkedLatLng** after_a, const LinkedLatLng** after_b)
+{
+    *after_a = *after_b = NULL;
+    const LinkedLatLng* first = ring->first;
+    if (!first || !first->next)
+        return false;
+
+    int crossing_num = 0;
+    short first_side = split_line_side(line, &first->vertex);
+    short side = first_side;
+    for (const LinkedLatLng* cur = first; cur != NULL; cur = cur->next) {
+        short next_side = cur->next ? split_line_side(line, &cur->next->vertex) : first_side;
+        if (next_side == 0)
+            return false; /* vertex on split line */
+        if (next_side != side) {
+            if (++crossing_num > 2)
+                return false;
+            if (crossing_num == 1) {
+                *after_a = cur;
+            } else {
+                *after_b = cur;
+            }
+            side = next_side;
+        }
+    }
+    return crossing_num == 2;
 }
 
 
-bool is_ring_crossed(const LinkedGeoLoop* ring) {
+bool split_simple_ring(
+    const SplitLine* line, const LinkedGeoLoop* ring,
+    const LinkedLatLng* after_a, const LinkedLatLng* after_b,
+    SplitPolygonCallback callback, void* user_data)
+{
+    const LinkedLatLng* first = ring->first;
+    const LinkedLatLng* next_a = after_a->next;
+    const LinkedLatLng* next_b = after_b->next ? after_b->next : first;
+    short sign = split_line_side(line, &first->vertex);
+
+    /* Intersections, computed from the same endpoints as in general path */
+    SplitIntersect intersect_a = {0};
+    SplitIntersect intersect_b = {0};
+    intersect_a.pos = split_line_intersect(line, &after_a->vertex, &next_a->vertex, &intersect_a.is_prime);
+    intersect_b.pos = split_line_intersect(line, &after_b->vertex, &next_b->vertex, &intersect_b.is_prime);
+
+    /* Part containing first vertex */
+    LinkedGeoPolygon* polygon;
+    LinkedGeoLoop* loop;
+    LatLng latlng_a, latlng_b;
+    bool skipped;
+    if (split_line_keeps(line, sign)) {
+        polygon = create_split_polygon();
+        if (!polygon)
+            return false;
+        loop = polygon->first;
+        split_intersect_get_latlng(line, &intersect_a, sign, &latlng_a);
+        split_intersect_get_latlng(line, &intersect_b, sign, &latlng_b);
+        if (!add_ring_part(loop, first, after_a)
+            || (!add_latlng_unique(loop, &latlng_a, &skipped) && !skipped)
+            || !add_parallel_edge(loop, line, &latlng_a, &latlng_b)
+            || (!add_latlng_unique(loop, &latlng_b, &skipped) && !skipped)
+            || (next_b != first && !add_ring_part(loop, next_b, NULL)))
+        {
+            free_linked_geo_polygon(polygon);
+            return false;
+        }
+        callback(polygon, user_data);
+    }
+
+    /* Other part */
+    if (split_line_keeps(line, -sign)) {
+        polygon = create_split_polygon();
+        if (!polygon)
+            return false;
+        loop = polygon->first;
+        split_intersect_get_latlng(line, &intersect_b, -sign, &latlng_b);
+        split_intersect_get_latlng(line, &intersect_a, -sign, &latlng_a);
+        if (!add_ring_part(loop, next_a, after_b)
+            || (!add_latlng_unique(loop, &latlng_b, &skipped) && !skipped)
+            || !add_parallel_edge(loop, line, &latlng_b, &latlng_a)
+            || (!add_latlng_unique(loop, &latlng_a, &skipped) && !skipped))
+        {
+            free_linked_geo_polygon(polygon);
+            return false;
+        }
+        callback(polygon, user_data);
+    }
+
+    return true;
+}
+
+
+LinkedGeoPolygon* create_split_polygon() {
+    /* Polygon with empty outer shell loop */
+    LinkedGeoPolygon* polygon = split_malloc(sizeof(LinkedGeoPolygon));
+    if (!polygon)
+        return NULL;
+    *polygon = (LinkedGeoPolygon){0};
+
+    LinkedGeoLoop* loop = split_malloc(sizeof(LinkedGeoLoop));
+    if (!loop) {
+        free_linked_geo_polygon(polygon);
+        return NULL;
+    }
+    *loop = (LinkedGeoLoop){0};
+    add_linked_geo_loop(polygon, loop);
+
+    return polygon;
+}
+
+
+bool add_ring_part(LinkedGeoLoop* loop, const LinkedLatLng* first, const LinkedLatLng* last) {
+    /* Vertices from first to last inclusive, to the end of ring if last is NULL */
+    for (const LinkedLatLng* cur = first; cur != NULL; cur = cur->next) {
+        bool skipped;
+        if (!add_latlng_unique(loop, &cur->vertex, &skipped) && !skipped)
+            return false;
+        if (cur == last)
+            break;
+    }
+    return true;
+}
+
+
+bool is_ring_crossed(const SplitLine* line, const LinkedGeoLoop* ring) {
     const LinkedLatLng* cur = ring->first;
     const LinkedLatLng* next = cur->next;
     if (!next)
         return false; /* ring contains a single point */
 
+    if (line->type != SplitLineType_180) {
+        short sign = 0;
+        for(; cur != NULL; cur = cur->next, next = next->next ? next->next : ring->first) {
+            /* Check if ring changes side of the line, vertices on the line are skipped */
+            short cur_sign = split_line_side(line, &cur->vertex);
+            if (cur_sign != 0) {
+                if (sign != 0 && cur_sign != sign)
+                    return true;
+                sign = cur_sign;
+            }
+
+            /* Check if segment bulges across the parallel, arcs cross a great circle at most once */
+            LatLng apex;
+            if (line->type == SplitLineType_Parallel
+                && split_parallel_apex(&cur->vertex, &next->vertex, line->lat, &apex))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Segment by segment, the block kernel gains nothing while walking linked vertices */
     for(; cur != NULL; cur = cur->next, next = next->next ? next->next : ring->first) {
         /* Check if segment is split by antimeridian */
         double lng = cur->vertex.lng;
@@ -299,71 +893,318 @@ double split_180_lat(const LatLng *coord1, const LatLng *coord2) {
 }
 
 
-bool split_init(Split* split, int ring_num, int vertex_num) {
-    *split = (Split){0};
+double split_parallel_lng(const LatLng *coord1, const LatLng *coord2, double lat) {
+    Vect3 p1, p2, normal, u, s;
 
-    split->vertices = malloc(vertex_num * sizeof(SplitVertex));
-    if (!split->vertices) {
-        split_cleanup(split);
-        return false;
+    /* Arc parametrization: s(t) = p1 * cos(t) + u * sin(t), t in [0, angle] */
+    vect3_from_lat_lng(coord1, &p1);
+    vect3_from_lat_lng(coord2, &p2);
+    vect3_cross(&p1, &p2, &normal);
+    double angle = atan2(vect3_len(&normal), p1.x * p2.x + p1.y * p2.y + p1.z * p2.z);
+    vect3_normalize(&normal);
+    vect3_cross(&normal, &p1, &u);
+
+    /* s(t).z = r * cos(t - alpha) */
+    double r = hypot(p1.z, u.z);
+    double alpha = atan2(u.z, p1.z);
+    double ratio = (r > 0) ? sin(lat) / r : 0;
+    if (ratio > 1) ratio = 1;
+    if (ratio < -1) ratio = -1;
+    double delta = acos(ratio);
+
+    /* Pick the solution closest to the arc */
+    double best_t = 0;
+    double best_dist = INFINITY;
+    double candidates[2] = {alpha - delta, alpha + delta};
+    for (int i = 0; i < 2; ++i) {
+        double t = fmod(candidates[i], 2 * M_PI);
+        if (t < 0) t += 2 * M_PI;
+        if (t > M_PI + angle / 2) t -= 2 * M_PI;
+        double dist = (t < 0) ? -t : (t > angle) ? t - angle : 0;
+        if (dist < best_dist) {
+            best_dist = dist;
+            best_t = t;
+        }
     }
 
-    split->max_intersect_num = MAX_INTERSECT_NUM_INIT;
-    split->intersects = malloc(split->max_intersect_num * sizeof(SplitIntersect));
-    if (!split->intersects) {
-        split_cleanup(split);
+    s.x = p1.x * cos(best_t) + u.x * sin(best_t);
+    s.y = p1.y * cos(best_t) + u.y * sin(best_t);
+    s.z = p1.z * cos(best_t) + u.z * sin(best_t);
+    return atan2(s.y, s.x); /* longitude */
+}
+
+
+bool split_parallel_apex(const LatLng *coord1, const LatLng *coord2, double lat, LatLng* apex) {
+    SplitLine line = {SplitLineType_Parallel, lat};
+    short sign = split_line_side(&line, coord1);
+    if (sign == 0 || sign != split_line_side(&line, coord2))
         return false;
+
+    Vect3 p1, p2, normal, u, s;
+    vect3_from_lat_lng(coord1, &p1);
+    vect3_from_lat_lng(coord2, &p2);
+    vect3_cross(&p1, &p2, &normal);
+    double normal_len = vect3_len(&normal);
+    if (normal_len < DBL_EPSILON)
+        return false; /* same or antipodal points */
+    double angle = atan2(normal_len, p1.x * p2.x + p1.y * p2.y + p1.z * p2.z);
+    vect3_normalize(&normal);
+    vect3_cross(&normal, &p1, &u);
+
+    /* Latitude extremum towards the parallel: maximum if south of it, minimum if north */
+    double t = atan2(u.z, p1.z) + ((sign < 0) ? 0 : M_PI);
+    t = fmod(t, 2 * M_PI);
+    if (t < 0) t += 2 * M_PI;
+    if (t <= 0 || t >= angle)
+        return false; /* extremum is not on the arc */
+
+    s.x = p1.x * cos(t) + u.x * sin(t);
+    s.y = p1.y * cos(t) + u.y * sin(t);
+    s.z = p1.z * cos(t) + u.z * sin(t);
+    vect3_to_lat_lng(&s, apex);
+    return split_line_side(&line, apex) == -sign;
+}
+
+
+void split_line_init_great_circle(
+    SplitLine* line, const Vect3* v1, const Vect3* v2, const Vect3* ref)
+{
+    line->type = SplitLineType_GreatCircle;
+    line->v1 = *v1;
+    line->v2 = *v2;
+    vect3_cross(v1, v2, &line->normal);
+    vect3_normalize(&line->normal);
+
+    /* Projection of reference point, edge midpoint if the reference is a pole of the circle */
+    Vect3 shift = line->normal;
+    vect3_scale(&shift, vect3_dot(&line->normal, ref));
+    vect3_diff(ref, &shift, &line->a);
+    if (vect3_len(&line->a) < 1e-9)
+        vect3_sum(v1, v2, &line->a);
+    vect3_normalize(&line->a);
+
+    /* Positions grow in the same direction relative to the positive side as on other lines */
+    vect3_cross(&line->normal, &line->a, &line->b);
+}
+
+
+bool split_line_keeps(const SplitLine* line, short sign) {
+    return line->side == 0 || line->side == sign;
+}
+
+
+short split_line_side(const SplitLine* line, const LatLng* latlng) {
+    if (line->type == SplitLineType_GreatCircle) {
+        Vect3 vect;
+        vect3_from_lat_lng(latlng, &vect);
+        return orient3(&line->v1, &line->v2, &vect);
     }
+    return (line->type == SplitLineType_Parallel)
+        ? SIGN(latlng->lat - line->lat)
+        : SIGN(latlng->lng);
+}
 
-    split->sorted_intersects = malloc(vertex_num * sizeof(SplitIntersect*));
-    if (!split->sorted_intersects) {
-        split_cleanup(split);
-        return false;
+
+short split_ring_side(const SplitLine* line, const LinkedGeoLoop* ring) {
+    /* Side of first vertex off the line, 0 if the whole ring is on it */
+    for (const LinkedLatLng* cur = ring->first; cur != NULL; cur = cur->next) {
+        short side = split_line_side(line, &cur->vertex);
+        if (side != 0)
+            return side;
     }
+    return 0;
+}
 
-    if (ring_num > 1) {
-        split->holes = malloc((ring_num - 1) * sizeof(LinkedGeoLoop*));
-        if (!split->holes) {
-            split_cleanup(split);
-            return false;
+
+double split_great_circle_pos(const SplitLine* line, const LatLng *coord1, const LatLng *coord2) {
+    Vect3 p1, p2, normal, s;
+    vect3_from_lat_lng(coord1, &p1);
+    vect3_from_lat_lng(coord2, &p2);
+    vect3_cross(&p1, &p2, &normal);
+
+    /* Circle planes intersection, one of two antipodal points that is on the arc */
+    vect3_cross(&normal, &line->normal, &s);
+    vect3_normalize(&s);
+    if (s.x * (p1.x + p2.x) + s.y * (p1.y + p2.y) + s.z * (p1.z + p2.z) < 0)
+        vect3_scale(&s, -1);
+
+    return atan2(vect3_dot(&s, &line->b), vect3_dot(&s, &line->a));
+}
+
+
+double split_line_intersect(
+    const SplitLine* line, const LatLng* coord1, const LatLng* coord2, bool* is_prime)
+{
+    if (line->type == SplitLineType_Parallel) {
+        *is_prime = false;
+        return split_parallel_lng(coord1, coord2, line->lat);
+    }
+    if (line->type == SplitLineType_GreatCircle) {
+        *is_prime = false;
+        return split_great_circle_pos(line, coord1, coord2);
+    }
+    *is_prime = (fabs(coord1->lng) + fabs(coord2->lng) < M_PI);
+    return split_180_lat(coord1, coord2);
+}
+
+
+bool densify_polygon_parallel(LinkedGeoPolygon* polygon, double lat) {
+    /* Insert extreme latitude point into segments crossing the parallel twice */
+    for (LinkedGeoLoop* loop = polygon->first; loop != NULL; loop = loop->next) {
+        if (!loop->first || !loop->first->next)
+            continue;
+
+        for (LinkedLatLng* cur = loop->first; cur != NULL; cur = cur->next) {
+            const LinkedLatLng* next = cur->next ? cur->next : loop->first;
+            LatLng apex;
+            if (!split_parallel_apex(&cur->vertex, &next->vertex, lat, &apex))
+                continue;
+
+            LinkedLatLng* inserted = split_malloc(sizeof(LinkedLatLng));
+            if (!inserted)
+                return false;
+            inserted->vertex = apex;
+            inserted->next = cur->next;
+            cur->next = inserted;
+            if (loop->last == cur)
+                loop->last = inserted;
+            cur = inserted;
         }
     }
+    return true;
+}
 
+
+bool add_parallel_edge(LinkedGeoLoop* loop, const SplitLine* line, const LatLng* from, const LatLng* to) {
+    /* Points between paired intersections, polygons don't cross antimeridian so neither does the edge */
+    if (line->type != SplitLineType_Parallel || line->lat == 0)
+        return true;
+    double span = to->lng - from->lng;
+    int num = (int) ceil(fabs(span) / PARALLEL_EDGE_LNG_STEP);
+    for (int i = 1; i < num; ++i) {
+        LatLng latlng = {line->lat, from->lng + span * i / num};
+        bool skipped;
+        if (!add_latlng_unique(loop, &latlng, &skipped) && !skipped)
+            return false;
+    }
     return true;
 }
 
 
-void split_cleanup(Split* split) {
-    if (split->vertices)
-        free(split->vertices);
-    if (split->intersects)
-        free(split->intersects);
-    if (split->sorted_intersects)
-        free(split->sorted_intersects);
-    if (split->holes)
-        free(split->holes);
+void split_context_init(SplitContext* context) {
+    Split* split = &context->split;
     *split = (Split){0};
+
+    split->max_vertex_num = SPLIT_INLINE_VERTEX_NUM;
+    split->vertices = context->vertices;
+
+    split->max_intersect_num = SPLIT_INLINE_INTERSECT_NUM;
+    split->intersects = context->intersects;
+    split->sorted_intersects = context->sorted_intersects;
+
+    split->max_hole_num = SPLIT_INLINE_HOLE_NUM;
+    split->holes = context->holes;
+
+    context->fast_path = true;
+    context->base_cell_num = 0;
+    context->base_cells = NULL;
 }
 
 
-void split_process_ring(Split* split, const LinkedGeoLoop* ring) {
-    const LinkedLatLng* cur = ring->first;
-    const LinkedLatLng* next = cur->next;
-    assert(next);
+void split_context_cleanup(SplitContext* context) {
+    Split* split = &context->split;
+    if (split->vertices != context->vertices)
+        split_free(split->vertices, split->max_vertex_num * sizeof(SplitVertex));
+    if (split->intersects != context->intersects)
+        split_free(split->intersects, split->max_intersect_num * sizeof(SplitIntersect));
+    if (split->sorted_intersects != context->sorted_intersects)
+        split_free(split->sorted_intersects, split->max_intersect_num * sizeof(SplitIntersect*));
+    if (split->holes != context->holes)
+        split_free(split->holes, split->max_hole_num * sizeof(LinkedGeoLoop*));
+    if (context->base_cells)
+        split_free(context->base_cells, context->base_cell_num * sizeof(SplitBaseCell));
+    split_context_init(context);
+}
+
+
+Split* split_init(SplitContext* context, const SplitLine* line, int ring_num, int vertex_num) {
+    Split* split = &context->split;
+    split->line = *line;
+    split->vertex_num = 0;
+    split->intersect_num = 0;
+    split->hole_num = 0;
+
+    /* Reserve memory for vertices, intersections are reserved as they are added */
+    if (vertex_num > split->max_vertex_num) {
+        int max_vertex_num = split_grow_num(split->max_vertex_num, vertex_num);
+        SplitVertex* vertices = split_grow(
+            split->vertices, context->vertices, split->max_vertex_num, max_vertex_num, 0, sizeof(SplitVertex));
+        if (!vertices)
+            return NULL;
+        split->vertices = vertices;
+        split->max_vertex_num = max_vertex_num;
+    }
+
+    if (ring_num - 1 > split->max_hole_num) {
+        int max_hole_num = split_grow_num(split->max_hole_num, ring_num - 1);
+        const LinkedGeoLoop** holes = split_grow(
+            split->holes, context->holes, split->max_hole_num, max_hole_num, 0, sizeof(LinkedGeoLoop*));
+        if (!holes)
+            return NULL;
+        split->holes = holes;
+        split->max_hole_num = max_hole_num;
+    }
+
+    return split;
+}
+
+
+int split_grow_num(int max_num, int num) {
+    /* At least double the size, so repeated growth is amortized */
+    return (num > max_num * 2) ? num : max_num * 2;
+}
+
+
+void* split_grow(
+    void* data, const void* inline_data, int old_max_num, int max_num, int copy_num, size_t item_size)
+{
+    if (data != inline_data)
+        return split_realloc(data, old_max_num * item_size, max_num * item_size);
+
+    /* Move from inline storage to heap */
+    void* new_data = split_malloc(max_num * item_size);
+    if (new_data && copy_num > 0)
+        memcpy(new_data, data, copy_num * item_size);
+    return new_data;
+}
+
+
+bool split_process_ring(Split* split, const LinkedGeoLoop* ring) {
+    /*
+      Start from a vertex off the split line, so the closing segment
+      ends at a vertex with known side and no crossing is missed
+     */
+    const LinkedLatLng* start = ring->first;
+    while (start && split_line_side(&split->line, &start->vertex) == 0)
+        start = start->next;
+    if (!start)
+        start = ring->first;
+
+    const LinkedLatLng* cur = start;
+    const LinkedLatLng* next = cur->next ? cur->next : ring->first;
+    assert(next != cur);
     short sign = 0;
     int first_vertex_idx = -1;
     int vertex_idx = -1;
-    for (; cur != NULL; cur = cur->next, next = next->next ? next->next : ring->first) {
+    do {
         /* Add vertex */
         vertex_idx = split_add_vertex(split, &cur->vertex);
         if (first_vertex_idx < 0)
             first_vertex_idx = vertex_idx;
 
-        double lng = cur->vertex.lng;
-        double next_lng = next->vertex.lng;
-        short next_sign = SIGN(next_lng);
+        short next_sign = split_line_side(&split->line, &next->vertex);
         if (sign == 0) {
-            sign = SIGN(lng);
+            sign = split_line_side(&split->line, &cur->vertex);
 
             if (sign != 0) {
                 /* Set sign for vertices traversed so far */
@@ -376,20 +1217,25 @@ void split_process_ring(Split* split, const LinkedGeoLoop* ring) {
         }
 
         if (sign != 0 && next_sign != 0 && next_sign != sign) {
-            /* Prime or antimeridian crossed */
+            /* Prime or antimeridian (or parallel) crossed */
 
             /* Add intersection after current vertex */
             SplitIntersectDir dir = (sign < 0) ? SplitIntersectDir_WE : SplitIntersectDir_EW;
-            bool is_prime = (fabs(lng) + fabs(next_lng) < M_PI);
-            double lat = split_180_lat(&cur->vertex, &next->vertex);
-            split_add_intersect_after(split, vertex_idx, dir, is_prime, lat);
+            bool is_prime;
+            double pos = split_line_intersect(&split->line, &cur->vertex, &next->vertex, &is_prime);
+            if (!split_add_intersect_after(split, vertex_idx, dir, is_prime, pos))
+                return false;
 
             sign = next_sign;
         }
-    }
+
+        cur = next;
+        next = next->next ? next->next : ring->first;
+    } while (cur != start);
 
     /* Link first and last vertices */
     split_link_vertices(split, first_vertex_idx, vertex_idx);
+    return true;
 }
 
 
@@ -398,9 +1244,7 @@ void split_prepare(Split* split) {
 }
 
 
-LinkedGeoPolygon* split_create_multi_polygon(Split* split) {
-    LinkedGeoPolygon* multi_polygon = NULL;
-    LinkedGeoPolygon* last = NULL;
+bool split_create_multi_polygon(Split* split, SplitPolygonCallback callback, void* user_data) {
     int vertex_idx_start = 0;
     while (true) {
         /* Get next starting vertex */
@@ -408,25 +1252,24 @@ LinkedGeoPolygon* split_create_multi_polygon(Split* split) {
         if (vertex_idx < 0) break; /* done */
 
         /* Create next polygon */
+        short sign = split->vertices[vertex_idx].sign;
         LinkedGeoPolygon* polygon = split_create_polygon_vertex(split, vertex_idx);
-        if (!polygon) {
-            free_linked_geo_polygon(multi_polygon);
-            return NULL;
+        if (!polygon)
+            return false;
+        if (!split_line_keeps(&split->line, sign)) {
+            free_linked_geo_polygon(polygon);
+            continue;
         }
 
-        /* Add polygon */
-        if (!multi_polygon) {
-            multi_polygon = polygon;
-        } else {
-            last->next = polygon;
-        }
-        last = polygon;
+        /* Polygon is complete, pass to consumer */
+        callback(polygon, user_data);
     }
-    return multi_polygon;
+    return true;
 }
 
 
 int split_add_vertex(Split* split, const LatLng* latlng) {
+    assert(split->vertex_num < split->max_vertex_num);
     int index = split->vertex_num;
     SplitVertex* vertex = &split->vertices[split->vertex_num++];
     vertex->latlng_p = latlng;
@@ -437,35 +1280,48 @@ int split_add_vertex(Split* split, const LatLng* latlng) {
 }
 
 
-void split_add_intersect_after(
-    Split* split, int after, SplitIntersectDir dir, bool is_prime, double lat)
+bool split_add_intersect_after(
+    Split* split, int after, SplitIntersectDir dir, bool is_prime, double pos)
 {
-    int idx = split_add_intersect(split, dir, is_prime, lat);
+    int idx = split_add_intersect(split, dir, is_prime, pos);
+    if (idx < 0)
+        return false;
     SplitIntersect* intersect = &split->intersects[idx];
     intersect->index = after;
     split->vertices[after].intersect_idx = idx;
+    return true;
 }
 
 
-int split_add_intersect(Split* split, SplitIntersectDir dir, bool is_prime, double lat)
+int split_add_intersect(Split* split, SplitIntersectDir dir, bool is_prime, double pos)
 {
     if (split->intersect_num == split->max_intersect_num) {
         /* Reallocate memory for intersections */
-        /* NOTE: ignoring possible reallocation error */
-        split->max_intersect_num *= 2;
-        if (split->max_intersect_num > split->vertex_num)
-            split->max_intersect_num = split->vertex_num;
-        split->intersects = realloc(
-            split->intersects,
-            split->max_intersect_num * sizeof(SplitIntersect));
+        SplitContext* context = (SplitContext*) split;
+        int max_intersect_num = split_grow_num(split->max_intersect_num, split->intersect_num + 1);
+        SplitIntersect* intersects = split_grow(
+            split->intersects, context->intersects,
+            split->max_intersect_num, max_intersect_num, split->intersect_num, sizeof(SplitIntersect));
+        if (!intersects)
+            return -1;
+        split->intersects = intersects;
+
+        /* Sorted intersection pointers are set after all intersections are added */
+        SplitIntersect** sorted_intersects = split_grow(
+            split->sorted_intersects, context->sorted_intersects,
+            split->max_intersect_num, max_intersect_num, 0, sizeof(SplitIntersect*));
+        if (!sorted_intersects)
+            return -1;
+        split->sorted_intersects = sorted_intersects;
+
+        split->max_intersect_num = max_intersect_num;
     }
-    assert(split->intersects);
 
     int idx = split->intersect_num++;
     SplitIntersect* intersect = &split->intersects[idx];
     intersect->dir = dir;
     intersect->is_prime = is_prime;
-    intersect->lat = lat;
+    intersect->pos = pos;
     intersect->index = -1;
     intersect->sort_order = -1;
     return idx;
@@ -481,11 +1337,13 @@ void split_link_vertices(Split* split, int idx1, int idx2) {
 
 
 void split_add_hole(Split* split, const LinkedGeoLoop* hole) {
+    assert(split->hole_num < split->max_hole_num);
     split->holes[split->hole_num++] = hole;
 }
 
 
 void split_sort_intersects(Split* split) {
+    assert(split->intersect_num % 2 == 0); /* intersections are paired */
     for (int i = 0; i < split->intersect_num; ++i) {
         SplitIntersect* intersect = &split->intersects[i];
         assert(intersect->dir != SplitIntersectDir_None);
@@ -503,7 +1361,8 @@ void split_sort_intersects(Split* split) {
 
 
 /**
-   Sort intersections by latitude.
+   Sort intersections by position on split line: latitude for meridian,
+   longitude for parallel.
 
    For points on prime meridian sort value is:
    * 180deg - lat, if lat >= 0
@@ -513,24 +1372,28 @@ void split_sort_intersects(Split* split) {
     ------*-----------+------------*------>
     prime       antimeridian         prime
    -180-lat          lat            180-lat
+
+   Intersections at the same point (ring touching the line at a vertex) keep
+   the order they were added in, intersections are elements of one array.
  */
 int split_intersect_ptr_cmp(const void* a, const void* b) {
     const SplitIntersect* i1 = *((const SplitIntersect**) a);
     const SplitIntersect* i2 = *((const SplitIntersect**) b);
+    double v1 = split_intersect_sort_value(i1);
+    double v2 = split_intersect_sort_value(i2);
+    if (v1 != v2)
+        return (v1 < v2) ? -1 : 1;
+    if (i1 == i2)
+        return 0;
+    return (i1 < i2) ? -1 : 1;
+}
 
-    double v1 = i1->lat;
-    if (i1->is_prime)
-        v1 = ((v1 < 0) ? -M_PI : M_PI) - v1;
-
-    double v2 = i2->lat;
-    if (i2->is_prime)
-        v2 = ((v2 < 0) ? -M_PI : M_PI) - v2;
 
-    if (v1 == v2)
-        return 0;
-    if (v1 < v2)
-        return -1;
-    return 1;
+double split_intersect_sort_value(const SplitIntersect* intersect) {
+    double value = intersect->pos;
+    if (intersect->is_prime)
+        value = ((value < 0) ? -M_PI : M_PI) - value;
+    return value;
 }
 
 
@@ -546,20 +1409,11 @@ int split_find_next_vertex(Split* split, int* start) {
 
 
 LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx) {
-    /* Create result polygon */
-    LinkedGeoPolygon* polygon = malloc(sizeof(LinkedGeoPolygon));
+    /* Create result polygon with outer shell loop */
+    LinkedGeoPolygon* polygon = create_split_polygon();
     if (!polygon)
         return NULL;
-    *polygon = (LinkedGeoPolygon){0};
-
-    /* Create outer shell loop */
-    LinkedGeoLoop* loop = malloc(sizeof(LinkedGeoLoop));
-    if (!loop) {
-        free_linked_geo_polygon(polygon);
-        return NULL;
-    }
-    *loop = (LinkedGeoLoop){0};
-    add_linked_geo_loop(polygon, loop);
+    LinkedGeoLoop* loop = polygon->first;
 
     int idx = vertex_idx;
     SplitVertex* vertex = &split->vertices[idx];
@@ -576,7 +1430,8 @@ LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx) {
         int next_idx, intersect_idx;
 
         assert(vertex->sign == sign);
-        assert(vertex->latlng_p->lng == 0 || ((sign > 0) == (vertex->latlng_p->lng > 0)));
+        assert(split_line_side(&split->line, vertex->latlng_p) == 0
+               || split_line_side(&split->line, vertex->latlng_p) == sign);
 #if DEBUG
         printf("\nstep: %d\n", step);
 #endif
@@ -610,10 +1465,10 @@ LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx) {
         printf("intersect idx: %d (%s)\n", intersect_idx, (intersect ? "intersect" : "no intersect"));
 #endif
         if (intersect) {
-            LatLng latlng;
+            LatLng latlng, next_latlng;
 
             /* Get intersection coordinates */
-            split_intersect_get_latlng(intersect, sign, &latlng);
+            split_intersect_get_latlng(&split->line, intersect, sign, &latlng);
 
             /* Add intersection vertex */
             if (!add_latlng_unique(loop, &latlng, &skipped) && !skipped) {
@@ -629,10 +1484,12 @@ LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx) {
             intersect_idx = intersect->index;
 
             /* Get next intersection coordinates */
-            split_intersect_get_latlng(intersect, sign, &latlng);
+            split_intersect_get_latlng(&split->line, intersect, sign, &next_latlng);
 
-            /* Add next intersection vertex */
-            if (!add_latlng_unique(loop, &latlng, &skipped) && !skipped) {
+            /* Add points along the line and next intersection vertex */
+            if (!add_parallel_edge(loop, &split->line, &latlng, &next_latlng)
+                || (!add_latlng_unique(loop, &next_latlng, &skipped) && !skipped))
+            {
                 free_linked_geo_polygon(polygon);
                 return NULL;
             }
@@ -668,6 +1525,8 @@ LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx) {
     /* Assign holes */
     Bbox3 bbox;
     bbox3_from_linked_loop(&bbox, loop);
+    if (split->hole_num > 0)
+        ring_region_bbox(&split->line, loop, sign, &bbox);
 #if DEBUG
     printf("Assigning holes: %d total\n", split->hole_num);
     dbg_print_bbox_polygon(&bbox);
@@ -680,7 +1539,7 @@ LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx) {
         /* Check if hole vertices are inside the polygon */
         short pos = 0;
         for (const LinkedLatLng* cur = hole->first; cur != NULL; cur = cur->next) {
-            pos = latlng_ring_pos(loop, sign, &bbox, &cur->vertex);
+            pos = latlng_ring_pos(&split->line, loop, sign, &bbox, &cur->vertex);
             if (pos != 0) break; /* the vertex is either inside or outside */
         }
 
@@ -691,7 +1550,7 @@ LinkedGeoPolygon* split_create_polygon_vertex(Split* split, int vertex_idx) {
             /* Copy hole */
             LinkedGeoLoop* hole_copy = copy_linked_geo_loop(hole);
             if (!hole_copy) {
-                free_linked_geo_loop(hole_copy);
+                free_linked_geo_polygon(polygon);
                 return NULL;
             }
 
@@ -715,8 +1574,26 @@ const SplitIntersect* split_get_intersect_after(const Split* split, int idx) {
 }
 
 
-void split_intersect_get_latlng(const SplitIntersect* intersect, short sign, LatLng* latlng) {
-    latlng->lat = intersect->lat;
+void split_intersect_get_latlng(
+    const SplitLine* line, const SplitIntersect* intersect, short sign, LatLng* latlng)
+{
+    if (line->type == SplitLineType_Parallel) {
+        latlng->lat = line->lat;
+        latlng->lng = intersect->pos;
+        return;
+    }
+    if (line->type == SplitLineType_GreatCircle) {
+        Vect3 a = line->a;
+        Vect3 b = line->b;
+        Vect3 s;
+        vect3_scale(&a, cos(intersect->pos));
+        vect3_scale(&b, sin(intersect->pos));
+        vect3_sum(&a, &b, &s);
+        vect3_to_lat_lng(&s, latlng);
+        return;
+    }
+
+    latlng->lat = intersect->pos;
     if (intersect->is_prime) {
         latlng->lng = 0;
     } else {
@@ -753,77 +1630,163 @@ int count_ring_vertices(const LinkedGeoLoop* ring) {
 }
 
 
-short latlng_ring_pos(const LinkedGeoLoop* ring, short sign, const Bbox3* bbox, const LatLng* latlng) {
-    /* Check longitude sign */
+void ring_region_bbox(const SplitLine* line, const LinkedGeoLoop* ring, short sign, Bbox3* bbox) {
+    /*
+      Bbox of the ring misses the bulge of a wide polygon. Inside of the
+      polygon a coordinate only has its extreme at an axis point, so the bbox
+      is extended by axis points inside the ring.
+     */
+    static const Vect3 axes[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (int i = 0; i < 6; ++i) {
+        if (bbox3_contains_vect3(bbox, &axes[i]))
+            continue;
+        LatLng latlng;
+        vect3_to_lat_lng(&axes[i], &latlng);
+        if (latlng_ring_pos(line, ring, sign, NULL, &latlng) != -1) {
+            Bbox3 axis_bbox;
+            bbox3_from_vect3(&axis_bbox, &axes[i]);
+            bbox3_merge(bbox, &axis_bbox);
+        }
+    }
+}
+
+
+short latlng_ring_pos(
+    const SplitLine* line, const LinkedGeoLoop* ring, short sign,
+    const Bbox3* bbox, const LatLng* latlng)
+{
+    SplitRingPos pos;
+    if (!ring_pos_init(&pos, line, sign, bbox, latlng))
+        return -1;
+    if (!ring->first->next)
+        return true; /* single ring vertex exactly matches the point */
+
+    /* Count a number of intersections between the ring and (latlng, out) segment */
+    for (const LinkedLatLng* cur = ring->first; cur != NULL && !pos.on_ring; cur = cur->next)
+        ring_pos_add(&pos, &cur->vertex);
+    return ring_pos_finish(&pos);
+}
+
+
+bool ring_pos_init(
+    SplitRingPos* pos, const SplitLine* line, short sign, const Bbox3* bbox, const LatLng* latlng)
+{
+    /* Check split line side */
     assert(sign != 0);
-    short sign_latlng = SIGN(latlng->lng);
+    short sign_latlng = split_line_side(line, latlng);
     if (sign_latlng != 0 && sign_latlng != sign)
-        return -1;
+        return false;
 
     /* Point to vector */
-    Vect3 vect;
-    vect3_from_lat_lng(latlng, &vect);
+    vect3_from_lat_lng(latlng, &pos->vect);
 
-    /* Check bbox */
-    if (!bbox3_contains_vect3(bbox, &vect)) {
+    /* Check bbox, if given */
+    if (bbox && !bbox3_contains_vect3(bbox, &pos->vect)) {
 #if DEBUG
         printf("hole is not in bbox\n");
 #endif
-        return -1;
+        return false;
     }
 
     /* Create a point that's guaranteed to be outside the polygon */
-    LatLng out;
-    out.lng = (latlng->lng == 0) ? -sign * 1e-10 : -latlng->lng;
-    out.lat = latlng->lat;
-    Vect3 out_vect;
-    vect3_from_lat_lng(&out, &out_vect);
+    latlng_out_point(line, sign, latlng, &pos->vect, &pos->out_vect);
+    pos->vertex_num = 0;
+    pos->intersect_num = 0;
+    pos->on_ring = false;
+    return true;
+}
 
-    /* Count a number of intersections between the ring and (latlng, out) segment */
-    int intersect_num = 0;
-    const LinkedLatLng* cur = ring->first;
-    const LinkedLatLng* next = cur->next;
-    if (!next)
-        return true; /* single ring vertex exactly matches the point */
 
-    Vect3 cur_vect, next_vect;
-    vect3_from_lat_lng(&cur->vertex, &cur_vect);
-    for (; cur != NULL; cur = cur->next, next = next->next ? next->next : ring->first) {
-        /* Check if point matches ring vertex */
-        if (vect3_eq(&vect, &cur_vect))
-            return 0;
+void ring_pos_add(SplitRingPos* pos, const LatLng* vertex) {
+    if (pos->on_ring)
+        return;
+    Vect3 vect;
+    vect3_from_lat_lng(vertex, &vect);
 
-        /* Next vertex */
-        vect3_from_lat_lng(&next->vertex, &next_vect);
+    /* Check if point matches ring vertex */
+    if (vect3_eq(&pos->vect, &vect)) {
+        pos->on_ring = true;
+        return;
+    }
 
-        /* Check if segment endpoints match */
-        if (!vect3_eq(&cur_vect, &next_vect)) {
-            short intersect = segment_intersect(&cur_vect, &next_vect, &vect, &out_vect);
-            if (intersect == 0)
-                return 0; /* point on ring segment */
+    if (pos->vertex_num++ == 0) {
+        pos->first = vect;
+    } else {
+        ring_pos_add_segment(pos, &pos->last, &vect);
+    }
+    pos->last = vect;
+}
 
-            if (intersect > 0)
-                ++intersect_num;
-        }
 
-        cur_vect = next_vect;
+short ring_pos_finish(SplitRingPos* pos) {
+    /* Closing segment */
+    if (!pos->on_ring && pos->vertex_num > 1)
+        ring_pos_add_segment(pos, &pos->last, &pos->first);
+    if (pos->on_ring)
+        return 0;
+    return (pos->intersect_num % 2 == 0) ? -1 : 1;
+}
+
+
+void ring_pos_add_segment(SplitRingPos* pos, const Vect3* v1, const Vect3* v2) {
+    /* Check if segment endpoints match */
+    if (vect3_eq(v1, v2))
+        return;
+    short intersect = segment_intersect(v1, v2, &pos->vect, &pos->out_vect);
+    if (intersect == 0) {
+        pos->on_ring = true; /* point on ring segment */
+    } else if (intersect > 0) {
+        ++pos->intersect_num;
     }
+}
 
-    return (intersect_num % 2 == 0) ? -1 : 1;
+
+void latlng_out_point(
+    const SplitLine* line, short sign, const LatLng* latlng, const Vect3* vect, Vect3* out_vect)
+{
+    /* Point on the other side of the line, segment from the point to it leaves polygons on the point side */
+    LatLng out;
+    if (line->type == SplitLineType_Parallel) {
+        /* Halfway between the parallel and the opposite pole */
+        out.lng = latlng->lng;
+        out.lat = (line->lat + ((sign > 0) ? -M_PI_2 : M_PI_2)) / 2;
+    } else if (line->type == SplitLineType_GreatCircle) {
+        /* Mirror image across the circle plane, moved off the circle */
+        Vect3 shift = line->normal;
+        Vect3 mirror;
+        vect3_scale(&shift, 2 * vect3_dot(&line->normal, vect) + sign * 1e-10);
+        vect3_diff(vect, &shift, &mirror);
+        vect3_normalize(&mirror);
+        vect3_to_lat_lng(&mirror, &out);
+    } else {
+        out.lng = (latlng->lng == 0) ? -sign * 1e-10 : -latlng->lng;
+        out.lat = latlng->lat;
+    }
+    vect3_from_lat_lng(&out, out_vect);
 }
 
 
 short segment_intersect(const Vect3* v1, const Vect3* v2, const Vect3* u1, const Vect3* u2) {
-    /* Normals of V and U planes */
-    Vect3 vn, un;
-    vect3_cross(v1, v2, &vn);
-    vect3_normalize(&vn);
-    vect3_cross(u1, u2, &un);
-    vect3_normalize(&un);
+    /*
+      Arcs are shorter than 180 degrees. Endpoint sides of the other arc's great
+      circle are exact orientation signs, so near-degenerate cases are decided
+      consistently, and no normalization is needed.
+     */
+
+    /* u1 and u2 are on the same side of V plane */
+    short u1_side = orient3(v1, v2, u1);
+    short u2_side = orient3(v1, v2, u2);
+    if (u1_side == u2_side && u1_side != 0)
+        return -1;
+
+    /* v1 and v2 are on the same side of U plane */
+    short v1_side = orient3(u1, u2, v1);
+    short v2_side = orient3(u1, u2, v2);
+    if (v1_side == v2_side && v1_side != 0)
+        return -1;
 
     /* Are the planes the same? */
-    double normal_dot = vect3_dot(&vn, &un);
-    if (FP_EQUAL(fabs(normal_dot), 1.0)) {
+    if (u1_side == 0 && u2_side == 0) {
         short ret = point_between(v1, v2, u1);
         if (ret == -1)
             ret = point_between(v1, v2, u2);
@@ -834,75 +1797,37 @@ short segment_intersect(const Vect3* v1, const Vect3* v2, const Vect3* u1, const
         return ret;
     }
 
-    short v1_side = SIGN(vect3_dot(&un, v1));
-    short v2_side = SIGN(vect3_dot(&un, v2));
-    short u1_side = SIGN(vect3_dot(&vn, u1));
-    short u2_side = SIGN(vect3_dot(&vn, u2));
-
-    /* v1 and v2 are on the same side of U plane */
-    if (v1_side == v2_side && v1_side != 0)
-        return -1;
-
-    /* u1 and u2 are on the same side of V plane */
-    if (u1_side == u2_side && u1_side != 0)
-        return -1;
+    if (u1_side != 0 && u2_side != 0 && v1_side != 0 && v2_side != 0) {
+        /*
+          Arcs cross the other plane, great circles meet at two antipodal
+          points. It's the same point for both arcs if orientations agree
+          (v1 -> v2 passes u2 on the same side as u1 -> u2 passes v1).
+         */
+        return (u2_side == v1_side) ? 1 : -1;
+    }
 
-    if (v1_side != v2_side && (v1_side + v2_side) == 0
-        && u1_side != u2_side && (u1_side + u2_side) == 0)
+    /*
+      Some endpoint lies on the other arc's great circle: the arcs can only
+      meet at such endpoint, they touch if it's within the other arc.
+     */
+    if ((u1_side == 0 && point_between(v1, v2, u1) != -1)
+        || (u2_side == 0 && point_between(v1, v2, u2) != -1)
+        || (v1_side == 0 && point_between(u1, u2, v1) != -1)
+        || (v2_side == 0 && point_between(u1, u2, v2) != -1))
     {
-        /* Intersection point */
-        Vect3 intersect;
-        vect3_cross(&vn, &un, &intersect);
-        vect3_normalize(&intersect);
-
-        /* Is intersection point inside both arcs? */
-        if (point_between(v1, v2, &intersect) != -1 && point_between(u1, u2, &intersect) != -1)
-            return 1;
-
-        /* Try antipodal intersection point */
-        vect3_scale(&intersect, -1.0);
-        if (point_between(v1, v2, &intersect) != -1 && point_between(u1, u2, &intersect) != -1)
-            return 1;
-
-        return -1;
+        return 0;
     }
-
-    assert(v1_side == 0 || v2_side == 0 || u1_side == 0 || u2_side == 0);
-    return 0;
+    return -1;
 }
 
 
 short point_between(const Vect3* v1, const Vect3* v2, const Vect3* p) {
+    /* p is on the great circle of v1 and v2 */
     if (vect3_eq(p, v1) || vect3_eq(p, v2))
         return 0;
 
-    /* Vector bisecting angle between v1 and v2 */
-    Vect3 middle;
-    vect3_sum(v1, v2, &middle);
-    vect3_normalize(&middle);
-
-    /* How similar is v1 (or v2) to middle */
-    double min_similarity = vect3_dot(v1, &middle);
-
-    if (fabs(1.0 - min_similarity) > 1e-10) {
-        /* Edge is sufficiently curved, use dot product test */
-        /*
-          If projection length is larger than the projection of bounding vectors,
-          then point vector must be closer to center.
-         */
-        return (vect3_dot(p, &middle) > min_similarity) ? 1 : -1;
-
-    } else {
-        /* Edge is very narrow, dot product test fails. */
-        /* Check if vectors from bounds to point are in opposite directions */
-        /* TODO: is this test applicable for both cases for coplanar vectors ?? */
-        Vect3 d1, d2;
-        vect3_diff(p, v1, &d1);
-        vect3_normalize(&d1);
-        vect3_diff(p, v2, &d2);
-        vect3_normalize(&d2);
-        return (vect3_dot(&d1, &d2) < 0.0) ? 1 : -1;
-    }
+    /* p is inside the arc if both v1 -> p and p -> v2 turn the same way as v1 -> v2 */
+    return (cross_dot_sign(v1, p, v1, v2) > 0 && cross_dot_sign(p, v2, v1, v2) > 0) ? 1 : -1;
 }
 
 
@@ -911,7 +1836,7 @@ LinkedGeoPolygon* copy_linked_geo_polygon(const LinkedGeoPolygon* polygon) {
     printf("Copying polygon\n");
 #endif
 
-    LinkedGeoPolygon *copy = malloc(sizeof(LinkedGeoPolygon));
+    LinkedGeoPolygon *copy = split_malloc(sizeof(LinkedGeoPolygon));
     if (!copy)
         return NULL;
     *copy = (LinkedGeoPolygon){0};
@@ -933,7 +1858,7 @@ LinkedGeoPolygon* copy_linked_geo_polygon(const LinkedGeoPolygon* polygon) {
 
 
 LinkedGeoLoop* copy_linked_geo_loop(const LinkedGeoLoop* loop) {
-    LinkedGeoLoop* copy = malloc(sizeof(LinkedGeoLoop));
+    LinkedGeoLoop* copy = split_malloc(sizeof(LinkedGeoLoop));
     if (!copy)
         return NULL;
     *copy = (LinkedGeoLoop){0};
@@ -956,7 +1881,7 @@ LinkedGeoLoop* copy_linked_geo_loop(const LinkedGeoLoop* loop) {
 
 
 LinkedLatLng* copy_linked_latlng(const LinkedLatLng* latlng) {
-    LinkedLatLng* copy = malloc(sizeof(LinkedLatLng));
+    LinkedLatLng* copy = split_malloc(sizeof(LinkedLatLng));
     if (!copy)
         return NULL;
     *copy = (LinkedLatLng){0};
@@ -983,7 +1908,7 @@ LinkedLatLng* add_latlng_unique(LinkedGeoLoop* loop, const LatLng* latlng, bool*
         }
     }
 
-    LinkedLatLng* linked = malloc(sizeof(LinkedLatLng));
+    LinkedLatLng* linked = split_malloc(sizeof(LinkedLatLng));
     if (!linked)
         return NULL;
     *linked = (LinkedLatLng){0};
@@ -1009,8 +1934,8 @@ void dbg_print_split(const Split* split) {
             printf(" x ");
             printf("[%d] ", intersect->sort_order);
             printf("%s ", (intersect->dir == SplitIntersectDir_EW) ? "E>W" : "W>E");
-            printf("lat: ");
-            dbg_print_double(radsToDegs(intersect->lat));
+            printf("pos: ");
+            dbg_print_double(radsToDegs(intersect->pos));
         }
         if (vertex->link >= 0)
             printf(" link: [%d]", vertex->link);
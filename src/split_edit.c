@@ -0,0 +1,1151 @@
+#include <split/split.h>
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <split/alloc.h>
+#include <split/bbox3.h>
+#include <split/h3.h>
+#include <split/vect3.h>
+#include "split_internal.h"
+
+/*
+
+Incremental split:
+
+An edited polygon keeps its vertices in blocks, so a vertex range is replaced
+by rebuilding a few blocks, and its intersections in ring order (per ring)
+and in line order. Each result shell is a cycle of intersections: from an
+intersection the traversal follows its ring into the shell side up to the
+next intersection, then jumps to the paired one along the line. After a
+replacement only segments from the vertex before the range to the vertex
+after it are checked again (and following vertices on the line, which take
+their side from them), and new intersections are inserted into both orders.
+If no intersection changed, the only shell changed is the one containing the
+edited run, and a non-split hole changes its shell only if its point is
+between old and new vertices. Otherwise cycles are walked again, shells with
+the same intersections on the boundary are kept, holes of dropped shells are
+assigned to new ones.
+ */
+
+/* Vertices per block of an edited ring */
+#define SPLIT_EDIT_BLOCK_SIZE (1024)
+
+typedef struct {
+    int start; /* index of first vertex in the ring */
+    int num;
+    LatLng* vertices; /* SPLIT_EDIT_BLOCK_SIZE */
+} SplitEditBlock;
+
+typedef struct {
+    /* Vertices, blocks are never empty */
+    int vertex_num;
+    int block_num;
+    int max_block_num;
+    SplitEditBlock* blocks;
+
+    /* Intersection ids ordered by vertex index */
+    int intersect_num;
+    int max_intersect_num;
+    int* intersects;
+    int crossing_num; /* antimeridian crossings, holes without them are not split */
+
+    int shell; /* shell a non-split hole is assigned to, -1 if none */
+} SplitEditRing;
+
+typedef struct {
+    SplitIntersect intersect; /* index is vertex before the intersection, next free id if unused */
+    int ring; /* -1 if unused */
+    int ring_order;
+    bool is_180;
+    int shells[2]; /* shells on negative and positive side */
+} SplitEditIntersect;
+
+typedef struct {
+    int first; /* intersection traversal starts from, -1 if polygon is not split */
+    short sign;
+    uint64_t key; /* hash of the cycle, identifies the shell across edits */
+    bool changed;
+    bool has_holes; /* holes are added to polygon */
+    LinkedGeoPolygon* polygon; /* built on request */
+} SplitEditShell;
+
+typedef struct {
+    uint64_t key;
+    int idx;
+} SplitEditShellKey;
+
+typedef struct {
+    const SplitEditRing* ring;
+    int block;
+    int offset;
+} SplitEditCursor;
+
+struct SplitEdit {
+    SplitLine line;
+
+    int ring_num;
+    SplitEditRing* rings;
+
+    /* Intersections, unused entries are chained */
+    int intersect_num;
+    int max_intersect_num;
+    SplitEditIntersect* intersects;
+    int free_intersect;
+
+    /* Intersections of split rings in line order */
+    int sorted_num;
+    int max_sorted_num;
+    int* sorted;
+
+    /* Result shells */
+    int shell_num;
+    int max_shell_num;
+    SplitEditShell* shells;
+
+    /* Intersections removed and added by current replacement */
+    int removed_num;
+    int max_removed_num;
+    int* removed;
+    int added_num;
+    int max_added_num;
+    int* added;
+};
+
+static bool split_edit_reserve(void** data, int* max_num, int num, size_t item_size);
+static bool split_edit_ring_init(SplitEditRing* ring, const LinkedGeoLoop* loop);
+static void split_edit_ring_cleanup(SplitEditRing* ring);
+static bool split_edit_ring_splice(
+    SplitEditRing* ring, int start, int remove_num, const LatLng* vertices, int vertex_num);
+static int split_edit_ring_block(const SplitEditRing* ring, int idx);
+static LinkedGeoLoop* split_edit_ring_loop(const SplitEditRing* ring);
+static bool split_edit_is_split_ring(const SplitEdit* edit, int ring_idx);
+static void split_edit_cursor_init(SplitEditCursor* cursor, const SplitEditRing* ring, int idx);
+static const LatLng* split_edit_cursor_get(const SplitEditCursor* cursor);
+static void split_edit_cursor_move(SplitEditCursor* cursor, short step);
+static int split_edit_new_intersect(SplitEdit* edit);
+static void split_edit_free_intersect(SplitEdit* edit, int id);
+static bool split_edit_find_intersects(SplitEdit* edit, int ring_idx, int first, int num);
+static bool split_edit_ring_insert(SplitEdit* edit, int ring_idx, int id);
+static void split_edit_ring_remove(SplitEdit* edit, int ring_idx, int old_num, int first, int num, int delta);
+static bool split_edit_update_ring(SplitEdit* edit, int ring_idx, int start, int remove_num, int vertex_num);
+static bool split_edit_sort(SplitEdit* edit);
+static int split_edit_intersect_cmp(const SplitEditIntersect* a, const SplitEditIntersect* b);
+static int split_edit_intersect_ptr_cmp(const void* a, const void* b);
+static bool split_edit_update_sorted(SplitEdit* edit, int ring_idx, bool was_split_ring);
+static bool split_edit_update_shells(SplitEdit* edit);
+static void split_edit_walk_shell(SplitEdit* edit, int shell_idx);
+static int split_edit_next_on_ring(const SplitEdit* edit, int id, short sign);
+static short split_edit_step(const SplitEditIntersect* intersect, short sign);
+static uint64_t split_edit_hash(uint64_t value);
+static int split_edit_shell_key_cmp(const void* a, const void* b);
+static bool split_edit_assign_holes(SplitEdit* edit, bool changed_only);
+static bool split_edit_local_change(
+    SplitEdit* edit, int ring_idx, int start, const Vect3* chain, int old_chain_num, int chain_num);
+static bool split_edit_hole_flips(
+    const SplitEdit* edit, int ring_idx, short sign, const Vect3* chain, int old_chain_num, int chain_num);
+static void split_edit_shell_changed(SplitEditShell* shell);
+static LinkedGeoPolygon* split_edit_shell_polygon(SplitEdit* edit, int shell_idx);
+static LinkedGeoPolygon* split_edit_build_shell(const SplitEdit* edit, const SplitEditShell* shell);
+static bool split_edit_add_latlng(LinkedGeoLoop* loop, const LatLng* latlng);
+
+
+SplitEdit* split_edit_new(const LinkedGeoPolygon* polygon) {
+    SplitEdit* edit = split_malloc(sizeof(SplitEdit));
+    if (!edit)
+        return NULL;
+    *edit = (SplitEdit){0};
+    edit->line.type = SplitLineType_180;
+    edit->free_intersect = -1;
+
+    int ring_num = 0;
+    for (const LinkedGeoLoop* loop = polygon->first; loop != NULL; loop = loop->next)
+        ++ring_num;
+    edit->rings = (ring_num > 0) ? split_malloc(ring_num * sizeof(SplitEditRing)) : NULL;
+    if (!edit->rings) {
+        split_edit_free(edit);
+        return NULL;
+    }
+    edit->ring_num = ring_num;
+    for (int i = 0; i < ring_num; ++i) {
+        edit->rings[i] = (SplitEditRing){0};
+        edit->rings[i].shell = -1;
+    }
+
+    /* Copy rings, find intersections */
+    int ring_idx = 0;
+    for (const LinkedGeoLoop* loop = polygon->first; loop != NULL; loop = loop->next, ++ring_idx) {
+        if (!split_edit_ring_init(&edit->rings[ring_idx], loop)
+            || !split_edit_find_intersects(edit, ring_idx, 0, edit->rings[ring_idx].vertex_num))
+        {
+            split_edit_free(edit);
+            return NULL;
+        }
+    }
+    edit->added_num = 0;
+
+    /* All shells are new */
+    if (!split_edit_sort(edit) || !split_edit_update_shells(edit)) {
+        split_edit_free(edit);
+        return NULL;
+    }
+    return edit;
+}
+
+
+void split_edit_free(SplitEdit* edit) {
+    for (int i = 0; i < edit->ring_num; ++i)
+        split_edit_ring_cleanup(&edit->rings[i]);
+    split_free(edit->rings, edit->ring_num * sizeof(SplitEditRing));
+    split_free(edit->intersects, edit->max_intersect_num * sizeof(SplitEditIntersect));
+    split_free(edit->sorted, edit->max_sorted_num * sizeof(int));
+    for (int i = 0; i < edit->shell_num; ++i) {
+        if (edit->shells[i].polygon)
+            free_linked_geo_polygon(edit->shells[i].polygon);
+    }
+    split_free(edit->shells, edit->max_shell_num * sizeof(SplitEditShell));
+    split_free(edit->removed, edit->max_removed_num * sizeof(int));
+    split_free(edit->added, edit->max_added_num * sizeof(int));
+    split_free(edit, sizeof(SplitEdit));
+}
+
+
+bool split_edit_replace(
+    SplitEdit* edit, int ring_idx, int start, int remove_num, const LatLng* vertices, int vertex_num)
+{
+    if (ring_idx < 0 || ring_idx >= edit->ring_num)
+        return false;
+    SplitEditRing* ring = &edit->rings[ring_idx];
+    int old_num = ring->vertex_num;
+    if (start < 0 || remove_num < 0 || vertex_num < 0 || start + remove_num > old_num
+        || old_num - remove_num + vertex_num < 1 || (vertex_num > 0 && !vertices))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < edit->shell_num; ++i)
+        edit->shells[i].changed = false;
+    edit->removed_num = 0;
+    edit->added_num = 0;
+
+    /*
+      Old and new vertices with their neighbours, holes are checked against
+      them if no intersection changes
+     */
+    bool was_split_ring = split_edit_is_split_ring(edit, ring_idx);
+    bool has_free_holes = false;
+    for (int i = 1; i < edit->ring_num && !has_free_holes; ++i)
+        has_free_holes = !split_edit_is_split_ring(edit, i);
+    Vect3* chain = NULL;
+    int old_chain_num = remove_num + 2;
+    int chain_num = old_chain_num + vertex_num + 2;
+    if (edit->rings[0].crossing_num > 0 && was_split_ring && has_free_holes) {
+        chain = split_malloc(chain_num * sizeof(Vect3));
+        if (!chain)
+            return false;
+        SplitEditCursor cursor;
+        split_edit_cursor_init(&cursor, ring, (start + old_num - 1) % old_num);
+        for (int i = 0; i < old_chain_num; ++i) {
+            vect3_from_lat_lng(split_edit_cursor_get(&cursor), &chain[i]);
+            split_edit_cursor_move(&cursor, 1);
+        }
+        chain[old_chain_num] = chain[0];
+        for (int i = 0; i < vertex_num; ++i)
+            vect3_from_lat_lng(&vertices[i], &chain[old_chain_num + 1 + i]);
+        chain[chain_num - 1] = chain[old_chain_num - 1];
+    }
+
+    bool ok = split_edit_ring_splice(ring, start, remove_num, vertices, vertex_num)
+        && split_edit_update_ring(edit, ring_idx, start, remove_num, vertex_num)
+        && split_edit_update_sorted(edit, ring_idx, was_split_ring);
+    if (ok) {
+        if (edit->removed_num > 0 || edit->added_num > 0) {
+            ok = split_edit_update_shells(edit);
+        } else {
+            ok = split_edit_local_change(edit, ring_idx, start, chain, old_chain_num, chain_num);
+        }
+    }
+
+    /* Removed ids are only reused after new intersections got theirs, so shell keys don't mix them up */
+    for (int i = 0; i < edit->removed_num; ++i)
+        split_edit_free_intersect(edit, edit->removed[i]);
+    edit->removed_num = 0;
+    if (chain)
+        split_free(chain, chain_num * sizeof(Vect3));
+    return ok;
+}
+
+
+int split_edit_ring_vertex_num(const SplitEdit* edit, int ring) {
+    return edit->rings[ring].vertex_num;
+}
+
+
+int split_edit_polygon_num(const SplitEdit* edit) {
+    return edit->shell_num;
+}
+
+
+const LinkedGeoPolygon* split_edit_polygon(SplitEdit* edit, int idx) {
+    SplitEditShell* shell = &edit->shells[idx];
+    LinkedGeoPolygon* polygon = split_edit_shell_polygon(edit, idx);
+    if (!polygon || shell->has_holes)
+        return polygon;
+
+    /* Copies of non-split holes */
+    for (int i = 1; i < edit->ring_num; ++i) {
+        if (edit->rings[i].shell != idx || split_edit_is_split_ring(edit, i))
+            continue;
+        LinkedGeoLoop* hole = split_edit_ring_loop(&edit->rings[i]);
+        if (!hole) {
+            /* Rebuilt on next request */
+            free_linked_geo_polygon(polygon);
+            shell->polygon = NULL;
+            return NULL;
+        }
+        add_linked_geo_loop(polygon, hole);
+    }
+    shell->has_holes = true;
+    return polygon;
+}
+
+
+bool split_edit_polygon_changed(const SplitEdit* edit, int idx) {
+    return edit->shells[idx].changed;
+}
+
+
+bool split_edit_reserve(void** data, int* max_num, int num, size_t item_size) {
+    if (num <= *max_num)
+        return true;
+    int new_max_num = split_grow_num((*max_num > 0) ? *max_num : 4, num);
+    void* new_data = split_realloc(*data, *max_num * item_size, new_max_num * item_size);
+    if (!new_data)
+        return false;
+    *data = new_data;
+    *max_num = new_max_num;
+    return true;
+}
+
+
+bool split_edit_ring_init(SplitEditRing* ring, const LinkedGeoLoop* loop) {
+    int vertex_num = count_ring_vertices(loop);
+    if (vertex_num == 0)
+        return false;
+    LatLng* vertices = split_malloc(vertex_num * sizeof(LatLng));
+    if (!vertices)
+        return false;
+    int i = 0;
+    for (const LinkedLatLng* cur = loop->first; cur != NULL; cur = cur->next)
+        vertices[i++] = cur->vertex;
+    bool ok = split_edit_ring_splice(ring, 0, 0, vertices, vertex_num);
+    split_free(vertices, vertex_num * sizeof(LatLng));
+    return ok;
+}
+
+
+void split_edit_ring_cleanup(SplitEditRing* ring) {
+    for (int i = 0; i < ring->block_num; ++i)
+        split_free(ring->blocks[i].vertices, SPLIT_EDIT_BLOCK_SIZE * sizeof(LatLng));
+    split_free(ring->blocks, ring->max_block_num * sizeof(SplitEditBlock));
+    split_free(ring->intersects, ring->max_intersect_num * sizeof(int));
+}
+
+
+bool split_edit_ring_splice(
+    SplitEditRing* ring, int start, int remove_num, const LatLng* vertices, int vertex_num)
+{
+    /* Blocks with removed vertices (or the one to insert into) are replaced */
+    int first_block = 0;
+    int last_block = -1;
+    int prefix_num = 0;
+    int suffix_num = 0;
+    if (ring->block_num > 0) {
+        first_block = split_edit_ring_block(ring, (start < ring->vertex_num) ? start : start - 1);
+        last_block = (remove_num > 0) ? split_edit_ring_block(ring, start + remove_num - 1) : first_block;
+        prefix_num = start - ring->blocks[first_block].start;
+        suffix_num = ring->blocks[last_block].start + ring->blocks[last_block].num - start - remove_num;
+
+        /* Small remainder is merged with the next block */
+        if (prefix_num + vertex_num + suffix_num < SPLIT_EDIT_BLOCK_SIZE / 2
+            && last_block + 1 < ring->block_num)
+        {
+            ++last_block;
+            suffix_num += ring->blocks[last_block].num;
+        }
+    }
+    int num = prefix_num + vertex_num + suffix_num;
+    int new_block_num = (num + SPLIT_EDIT_BLOCK_SIZE - 1) / SPLIT_EDIT_BLOCK_SIZE;
+    int block_num = ring->block_num - (last_block - first_block + 1) + new_block_num;
+    if (!split_edit_reserve((void**) &ring->blocks, &ring->max_block_num, block_num, sizeof(SplitEditBlock)))
+        return false;
+
+    /* New blocks are filled before the ring is changed */
+    LatLng* buffer = (num > 0) ? split_malloc(num * sizeof(LatLng)) : NULL;
+    SplitEditBlock* new_blocks = (new_block_num > 0)
+        ? split_malloc(new_block_num * sizeof(SplitEditBlock))
+        : NULL;
+    bool ok = (num == 0) || (buffer && new_blocks);
+    for (int i = 0; ok && i < new_block_num; ++i) {
+        new_blocks[i].vertices = split_malloc(SPLIT_EDIT_BLOCK_SIZE * sizeof(LatLng));
+        if (!new_blocks[i].vertices) {
+            for (int j = 0; j < i; ++j)
+                split_free(new_blocks[j].vertices, SPLIT_EDIT_BLOCK_SIZE * sizeof(LatLng));
+            ok = false;
+        }
+    }
+    if (!ok) {
+        split_free(buffer, num * sizeof(LatLng));
+        split_free(new_blocks, new_block_num * sizeof(SplitEditBlock));
+        return false;
+    }
+    if (prefix_num > 0)
+        memcpy(buffer, ring->blocks[first_block].vertices, prefix_num * sizeof(LatLng));
+    if (vertex_num > 0)
+        memcpy(buffer + prefix_num, vertices, vertex_num * sizeof(LatLng));
+    if (suffix_num > 0) {
+        SplitEditCursor cursor;
+        split_edit_cursor_init(&cursor, ring, start + remove_num);
+        for (int i = 0; i < suffix_num; ++i) {
+            buffer[prefix_num + vertex_num + i] = *split_edit_cursor_get(&cursor);
+            split_edit_cursor_move(&cursor, 1);
+        }
+    }
+
+    /* Vertices are spread evenly */
+    int offset = 0;
+    for (int i = 0; i < new_block_num; ++i) {
+        new_blocks[i].num = num / new_block_num + ((i < num % new_block_num) ? 1 : 0);
+        memcpy(new_blocks[i].vertices, buffer + offset, new_blocks[i].num * sizeof(LatLng));
+        offset += new_blocks[i].num;
+    }
+
+    /* Replace blocks */
+    for (int i = first_block; i <= last_block; ++i)
+        split_free(ring->blocks[i].vertices, SPLIT_EDIT_BLOCK_SIZE * sizeof(LatLng));
+    memmove(
+        &ring->blocks[first_block + new_block_num],
+        &ring->blocks[last_block + 1],
+        (ring->block_num - last_block - 1) * sizeof(SplitEditBlock));
+    if (new_block_num > 0)
+        memcpy(&ring->blocks[first_block], new_blocks, new_block_num * sizeof(SplitEditBlock));
+    ring->block_num = block_num;
+    ring->vertex_num += vertex_num - remove_num;
+    for (int i = first_block; i < block_num; ++i)
+        ring->blocks[i].start = (i > 0) ? ring->blocks[i - 1].start + ring->blocks[i - 1].num : 0;
+
+    split_free(buffer, num * sizeof(LatLng));
+    split_free(new_blocks, new_block_num * sizeof(SplitEditBlock));
+    return true;
+}
+
+
+int split_edit_ring_block(const SplitEditRing* ring, int idx) {
+    /* Last block starting at or before idx */
+    int lo = 0;
+    int hi = ring->block_num - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (ring->blocks[mid].start <= idx) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+
+LinkedGeoLoop* split_edit_ring_loop(const SplitEditRing* ring) {
+    LinkedGeoLoop* loop = split_malloc(sizeof(LinkedGeoLoop));
+    if (!loop)
+        return NULL;
+    *loop = (LinkedGeoLoop){0};
+    for (int i = 0; i < ring->block_num; ++i) {
+        const SplitEditBlock* block = &ring->blocks[i];
+        for (int j = 0; j < block->num; ++j) {
+            LinkedLatLng* latlng = split_malloc(sizeof(LinkedLatLng));
+            if (!latlng) {
+                free_linked_geo_loop(loop);
+                return NULL;
+            }
+            *latlng = (LinkedLatLng){0};
+            latlng->vertex = block->vertices[j];
+            add_linked_latlng(loop, latlng);
+        }
+    }
+    return loop;
+}
+
+
+bool split_edit_is_split_ring(const SplitEdit* edit, int ring_idx) {
+    /* Outer ring and holes crossed by antimeridian, as in split_polygon */
+    return ring_idx == 0 || edit->rings[ring_idx].crossing_num > 0;
+}
+
+
+void split_edit_cursor_init(SplitEditCursor* cursor, const SplitEditRing* ring, int idx) {
+    cursor->ring = ring;
+    cursor->block = split_edit_ring_block(ring, idx);
+    cursor->offset = idx - ring->blocks[cursor->block].start;
+}
+
+
+const LatLng* split_edit_cursor_get(const SplitEditCursor* cursor) {
+    return &cursor->ring->blocks[cursor->block].vertices[cursor->offset];
+}
+
+
+void split_edit_cursor_move(SplitEditCursor* cursor, short step) {
+    /* Wraps around the ring */
+    const SplitEditRing* ring = cursor->ring;
+    cursor->offset += step;
+    if (cursor->offset == ring->blocks[cursor->block].num) {
+        cursor->block = (cursor->block + 1) % ring->block_num;
+        cursor->offset = 0;
+    } else if (cursor->offset < 0) {
+        cursor->block = (cursor->block + ring->block_num - 1) % ring->block_num;
+        cursor->offset = ring->blocks[cursor->block].num - 1;
+    }
+}
+
+
+int split_edit_new_intersect(SplitEdit* edit) {
+    int id = edit->free_intersect;
+    if (id >= 0) {
+        edit->free_intersect = edit->intersects[id].intersect.index;
+        return id;
+    }
+    if (!split_edit_reserve(
+            (void**) &edit->intersects, &edit->max_intersect_num,
+            edit->intersect_num + 1, sizeof(SplitEditIntersect)))
+    {
+        return -1;
+    }
+    return edit->intersect_num++;
+}
+
+
+void split_edit_free_intersect(SplitEdit* edit, int id) {
+    SplitEditIntersect* intersect = &edit->intersects[id];
+    intersect->ring = -1;
+    intersect->intersect.index = edit->free_intersect;
+    edit->free_intersect = id;
+}
+
+
+bool split_edit_find_intersects(SplitEdit* edit, int ring_idx, int first, int num) {
+    /*
+      Segments first .. first + num - 1 (around the ring), vertices on the line
+      take side of the previous vertex off the line, as in split_process_ring
+     */
+    const SplitEditRing* ring = &edit->rings[ring_idx];
+    int vertex_num = ring->vertex_num;
+    SplitEditCursor cursor;
+    split_edit_cursor_init(&cursor, ring, first);
+    short sign = 0;
+    for (int i = 0; i < vertex_num && sign == 0; ++i) {
+        sign = split_line_side(&edit->line, split_edit_cursor_get(&cursor));
+        split_edit_cursor_move(&cursor, -1);
+    }
+
+    split_edit_cursor_init(&cursor, ring, first);
+    LatLng cur = *split_edit_cursor_get(&cursor);
+    for (int i = 0; i < num; ++i) {
+        split_edit_cursor_move(&cursor, 1);
+        LatLng next = *split_edit_cursor_get(&cursor);
+        short cur_sign = split_line_side(&edit->line, &cur);
+        short next_sign = split_line_side(&edit->line, &next);
+        if (cur_sign != 0)
+            sign = cur_sign;
+
+        if (sign != 0 && next_sign != 0 && next_sign != sign) {
+            int id = split_edit_new_intersect(edit);
+            if (id < 0
+                || !split_edit_reserve(
+                    (void**) &edit->added, &edit->max_added_num, edit->added_num + 1, sizeof(int)))
+            {
+                return false;
+            }
+            SplitEditIntersect* intersect = &edit->intersects[id];
+            intersect->intersect.dir = (sign < 0) ? SplitIntersectDir_WE : SplitIntersectDir_EW;
+            intersect->intersect.pos = split_line_intersect(
+                &edit->line, &cur, &next, &intersect->intersect.is_prime);
+            intersect->intersect.index = (first + i) % vertex_num;
+            intersect->intersect.sort_order = -1;
+            intersect->ring = ring_idx;
+            intersect->ring_order = -1;
+            /* Same test as lng_crossing_any, segment endpoints on opposite sides */
+            intersect->is_180 = (cur_sign != 0 && fabs(cur.lng) + fabs(next.lng) > M_PI);
+            intersect->shells[0] = -1;
+            intersect->shells[1] = -1;
+            if (!split_edit_ring_insert(edit, ring_idx, id))
+                return false;
+            edit->added[edit->added_num++] = id;
+        }
+        cur = next;
+    }
+
+    for (int i = 0; i < ring->intersect_num; ++i)
+        edit->intersects[ring->intersects[i]].ring_order = i;
+    return true;
+}
+
+
+bool split_edit_ring_insert(SplitEdit* edit, int ring_idx, int id) {
+    SplitEditRing* ring = &edit->rings[ring_idx];
+    if (!split_edit_reserve(
+            (void**) &ring->intersects, &ring->max_intersect_num, ring->intersect_num + 1, sizeof(int)))
+    {
+        return false;
+    }
+    int index = edit->intersects[id].intersect.index;
+    int lo = 0;
+    int hi = ring->intersect_num;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (edit->intersects[ring->intersects[mid]].intersect.index < index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(&ring->intersects[lo + 1], &ring->intersects[lo], (ring->intersect_num - lo) * sizeof(int));
+    ring->intersects[lo] = id;
+    ++ring->intersect_num;
+    if (edit->intersects[id].is_180)
+        ++ring->crossing_num;
+    return true;
+}
+
+
+void split_edit_ring_remove(SplitEdit* edit, int ring_idx, int old_num, int first, int num, int delta) {
+    /*
+      Removes intersections after old vertices first .. first + num - 1
+      (around the ring), indices of the following ones are shifted by delta
+     */
+    SplitEditRing* ring = &edit->rings[ring_idx];
+    int start = (first + 1) % old_num; /* first replaced vertex */
+    int kept_num = 0;
+    for (int i = 0; i < ring->intersect_num; ++i) {
+        int id = ring->intersects[i];
+        SplitEditIntersect* intersect = &edit->intersects[id];
+        if ((intersect->intersect.index - first + old_num) % old_num < num) {
+            if (intersect->is_180)
+                --ring->crossing_num;
+            intersect->ring = -1;
+            edit->removed[edit->removed_num++] = id;
+        } else {
+            if (intersect->intersect.index >= start)
+                intersect->intersect.index += delta;
+            ring->intersects[kept_num++] = id;
+        }
+    }
+    ring->intersect_num = kept_num;
+}
+
+
+bool split_edit_update_ring(SplitEdit* edit, int ring_idx, int start, int remove_num, int vertex_num) {
+    SplitEditRing* ring = &edit->rings[ring_idx];
+    int new_num = ring->vertex_num;
+    int old_num = new_num - vertex_num + remove_num;
+    if (!split_edit_reserve(
+            (void**) &edit->removed, &edit->max_removed_num, ring->intersect_num, sizeof(int)))
+    {
+        return false;
+    }
+
+    /* Vertices on the line after the new ones take their side, so the segments after them are checked too */
+    int ext_num = 0;
+    SplitEditCursor cursor;
+    split_edit_cursor_init(&cursor, ring, (start + vertex_num) % new_num);
+    while (ext_num < new_num && split_line_side(&edit->line, split_edit_cursor_get(&cursor)) == 0) {
+        ++ext_num;
+        split_edit_cursor_move(&cursor, 1);
+    }
+
+    /* Segments from the vertex before the range, the whole ring if they wrap around */
+    int old_window_num = remove_num + 1 + ext_num;
+    int new_window_num = vertex_num + 1 + ext_num;
+    if (old_window_num >= old_num || new_window_num >= new_num) {
+        split_edit_ring_remove(edit, ring_idx, old_num, 0, old_num, 0);
+        return split_edit_find_intersects(edit, ring_idx, 0, new_num);
+    }
+    split_edit_ring_remove(
+        edit, ring_idx, old_num, (start + old_num - 1) % old_num, old_window_num, vertex_num - remove_num);
+    return split_edit_find_intersects(edit, ring_idx, (start + new_num - 1) % new_num, new_window_num);
+}
+
+
+bool split_edit_sort(SplitEdit* edit) {
+    int num = 0;
+    for (int i = 0; i < edit->ring_num; ++i) {
+        if (split_edit_is_split_ring(edit, i))
+            num += edit->rings[i].intersect_num;
+    }
+    if (!split_edit_reserve((void**) &edit->sorted, &edit->max_sorted_num, num, sizeof(int)))
+        return false;
+    SplitIntersect** sorted = (num > 0) ? split_malloc(num * sizeof(SplitIntersect*)) : NULL;
+    if (num > 0 && !sorted)
+        return false;
+
+    /* Intersection is the first member, sorted pointers are mapped back to ids */
+    int sorted_num = 0;
+    for (int i = 0; i < edit->ring_num; ++i) {
+        if (!split_edit_is_split_ring(edit, i))
+            continue;
+        const SplitEditRing* ring = &edit->rings[i];
+        for (int j = 0; j < ring->intersect_num; ++j)
+            sorted[sorted_num++] = &edit->intersects[ring->intersects[j]].intersect;
+    }
+    if (num > 0)
+        qsort(sorted, num, sizeof(SplitIntersect*), &split_edit_intersect_ptr_cmp);
+    for (int i = 0; i < num; ++i) {
+        int id = (int) ((const SplitEditIntersect*) sorted[i] - edit->intersects);
+        edit->sorted[i] = id;
+        edit->intersects[id].intersect.sort_order = i;
+    }
+    edit->sorted_num = num;
+    split_free(sorted, num * sizeof(SplitIntersect*));
+    return true;
+}
+
+
+int split_edit_intersect_cmp(const SplitEditIntersect* a, const SplitEditIntersect* b) {
+    /*
+      Line order, intersections at the same point (ring touching the line at
+      a vertex) by ring and vertex, the order split_by_180 adds them in
+     */
+    double v1 = split_intersect_sort_value(&a->intersect);
+    double v2 = split_intersect_sort_value(&b->intersect);
+    if (v1 != v2)
+        return (v1 < v2) ? -1 : 1;
+    if (a->ring != b->ring)
+        return (a->ring < b->ring) ? -1 : 1;
+    if (a->intersect.index != b->intersect.index)
+        return (a->intersect.index < b->intersect.index) ? -1 : 1;
+    return 0;
+}
+
+
+int split_edit_intersect_ptr_cmp(const void* a, const void* b) {
+    /* Intersection is the first member */
+    return split_edit_intersect_cmp(
+        *((const SplitEditIntersect* const*) a), *((const SplitEditIntersect* const*) b));
+}
+
+
+bool split_edit_update_sorted(SplitEdit* edit, int ring_idx, bool was_split_ring) {
+    /* Removed intersections are dropped, and all intersections of a ring no longer split */
+    bool is_split_ring = split_edit_is_split_ring(edit, ring_idx);
+    int num = 0;
+    for (int i = 0; i < edit->sorted_num; ++i) {
+        int id = edit->sorted[i];
+        int ring = edit->intersects[id].ring;
+        if (ring >= 0 && (ring != ring_idx || is_split_ring))
+            edit->sorted[num++] = id;
+    }
+    edit->sorted_num = num;
+
+    /* New ones are inserted, all intersections of a ring that became split */
+    if (is_split_ring) {
+        const SplitEditRing* ring = &edit->rings[ring_idx];
+        const int* ids = was_split_ring ? edit->added : ring->intersects;
+        int id_num = was_split_ring ? edit->added_num : ring->intersect_num;
+        if (!split_edit_reserve(
+                (void**) &edit->sorted, &edit->max_sorted_num, edit->sorted_num + id_num, sizeof(int)))
+        {
+            return false;
+        }
+        for (int i = 0; i < id_num; ++i) {
+            const SplitEditIntersect* intersect = &edit->intersects[ids[i]];
+            int lo = 0;
+            int hi = edit->sorted_num;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (split_edit_intersect_cmp(&edit->intersects[edit->sorted[mid]], intersect) <= 0) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            memmove(&edit->sorted[lo + 1], &edit->sorted[lo], (edit->sorted_num - lo) * sizeof(int));
+            edit->sorted[lo] = ids[i];
+            ++edit->sorted_num;
+        }
+    }
+
+    for (int i = 0; i < edit->sorted_num; ++i)
+        edit->intersects[edit->sorted[i]].intersect.sort_order = i;
+    return true;
+}
+
+
+bool split_edit_update_shells(SplitEdit* edit) {
+    int old_num = edit->shell_num;
+    int old_max_num = edit->max_shell_num;
+    SplitEditShell* old_shells = edit->shells;
+
+    /* Every shell has at least two intersections on each side */
+    bool is_split = edit->rings[0].crossing_num > 0;
+    int max_shell_num = is_split ? edit->sorted_num : 1;
+    SplitEditShell* shells = split_malloc(max_shell_num * sizeof(SplitEditShell));
+    SplitEditShellKey* old_keys = (old_num > 0) ? split_malloc(old_num * sizeof(SplitEditShellKey)) : NULL;
+    int* old_to_new = (old_num > 0) ? split_malloc(old_num * sizeof(int)) : NULL;
+    if (!shells || (old_num > 0 && (!old_keys || !old_to_new))) {
+        split_free(shells, max_shell_num * sizeof(SplitEditShell));
+        split_free(old_keys, old_num * sizeof(SplitEditShellKey));
+        split_free(old_to_new, old_num * sizeof(int));
+        return false;
+    }
+    edit->shells = shells;
+    edit->max_shell_num = max_shell_num;
+    edit->shell_num = 0;
+
+    if (!is_split) {
+        /* Copy of the polygon */
+        shells[0] = (SplitEditShell){-1, 0, 0, true, false, NULL};
+        edit->shell_num = 1;
+    } else {
+        for (int i = 0; i < edit->sorted_num; ++i) {
+            SplitEditIntersect* intersect = &edit->intersects[edit->sorted[i]];
+            intersect->shells[0] = -1;
+            intersect->shells[1] = -1;
+        }
+        /* Each shell starts forward along a ring, outer ring first */
+        for (int i = 0; i < edit->ring_num; ++i) {
+            if (!split_edit_is_split_ring(edit, i))
+                continue;
+            const SplitEditRing* ring = &edit->rings[i];
+            for (int j = 0; j < ring->intersect_num; ++j) {
+                const SplitEditIntersect* intersect = &edit->intersects[ring->intersects[j]];
+                short sign = (intersect->intersect.dir == SplitIntersectDir_WE) ? 1 : -1;
+                if (intersect->shells[sign > 0] >= 0)
+                    continue;
+                assert(edit->shell_num < max_shell_num);
+                shells[edit->shell_num] = (SplitEditShell){ring->intersects[j], sign, 0, true, false, NULL};
+                split_edit_walk_shell(edit, edit->shell_num++);
+            }
+        }
+    }
+
+    /* Shells with the same cycle keep their polygons */
+    for (int i = 0; i < old_num; ++i) {
+        old_keys[i].key = old_shells[i].key;
+        old_keys[i].idx = i;
+        old_to_new[i] = -1;
+    }
+    if (is_split && old_num > 0 && old_shells[0].first >= 0) {
+        qsort(old_keys, old_num, sizeof(SplitEditShellKey), &split_edit_shell_key_cmp);
+        for (int i = 0; i < edit->shell_num; ++i) {
+            SplitEditShellKey key = {shells[i].key, 0};
+            const SplitEditShellKey* found = bsearch(
+                &key, old_keys, old_num, sizeof(SplitEditShellKey), &split_edit_shell_key_cmp);
+            if (!found || old_to_new[found->idx] >= 0)
+                continue;
+            SplitEditShell* old = &old_shells[found->idx];
+            shells[i].changed = false;
+            shells[i].has_holes = old->has_holes;
+            shells[i].polygon = old->polygon;
+            old->polygon = NULL;
+            old_to_new[found->idx] = i;
+        }
+    }
+    for (int i = 0; i < old_num; ++i) {
+        if (old_shells[i].polygon)
+            free_linked_geo_polygon(old_shells[i].polygon);
+    }
+
+    /* Non-split holes of kept shells stay, others are assigned again */
+    for (int i = 1; i < edit->ring_num; ++i) {
+        SplitEditRing* ring = &edit->rings[i];
+        ring->shell = (is_split && !split_edit_is_split_ring(edit, i) && ring->shell >= 0 && ring->shell < old_num)
+            ? old_to_new[ring->shell]
+            : -1;
+    }
+    split_free(old_shells, old_max_num * sizeof(SplitEditShell));
+    split_free(old_keys, old_num * sizeof(SplitEditShellKey));
+    split_free(old_to_new, old_num * sizeof(int));
+    return !is_split || split_edit_assign_holes(edit, true);
+}
+
+
+void split_edit_walk_shell(SplitEdit* edit, int shell_idx) {
+    /*
+      Departure, run along its ring to arrival, jump to the paired
+      intersection, until the first one is reached again. Runs and pairs
+      are both hashed, so the key identifies the cycle.
+     */
+    SplitEditShell* shell = &edit->shells[shell_idx];
+    int side = (shell->sign > 0) ? 1 : 0;
+    uint64_t key = 0;
+    int id = shell->first;
+    do {
+        int arrival = split_edit_next_on_ring(edit, id, shell->sign);
+        int next = edit->sorted[edit->intersects[arrival].intersect.sort_order ^ 1];
+        edit->intersects[id].shells[side] = shell_idx;
+        edit->intersects[arrival].shells[side] = shell_idx;
+        key += split_edit_hash(((uint64_t) id << 33) | ((uint64_t) arrival << 1) | side);
+        key += split_edit_hash(((uint64_t) arrival << 33) | ((uint64_t) next << 1) | side);
+        id = next;
+    } while (id != shell->first);
+    shell->key = key;
+}
+
+
+int split_edit_next_on_ring(const SplitEdit* edit, int id, short sign) {
+    const SplitEditIntersect* intersect = &edit->intersects[id];
+    const SplitEditRing* ring = &edit->rings[intersect->ring];
+    int order = intersect->ring_order + split_edit_step(intersect, sign);
+    return ring->intersects[(order + ring->intersect_num) % ring->intersect_num];
+}
+
+
+short split_edit_step(const SplitEditIntersect* intersect, short sign) {
+    /* Traversal moves into the shell side, see split_create_polygon_vertex */
+    return ((sign > 0) == (intersect->intersect.dir == SplitIntersectDir_WE)) ? 1 : -1;
+}
+
+
+uint64_t split_edit_hash(uint64_t value) {
+    /* splitmix64 finalizer */
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+
+int split_edit_shell_key_cmp(const void* a, const void* b) {
+    uint64_t k1 = ((const SplitEditShellKey*) a)->key;
+    uint64_t k2 = ((const SplitEditShellKey*) b)->key;
+    return (k1 < k2) ? -1 : (k1 > k2) ? 1 : 0;
+}
+
+
+bool split_edit_assign_holes(SplitEdit* edit, bool changed_only) {
+    /* Unassigned non-split holes are tested against shells in order, as in split_create_polygon_vertex */
+    int hole_num = 0;
+    for (int i = 1; i < edit->ring_num; ++i) {
+        if (edit->rings[i].shell < 0 && !split_edit_is_split_ring(edit, i))
+            ++hole_num;
+    }
+    for (int i = 0; i < edit->shell_num && hole_num > 0; ++i) {
+        SplitEditShell* shell = &edit->shells[i];
+        if (changed_only && !shell->changed)
+            continue;
+        LinkedGeoPolygon* polygon = split_edit_shell_polygon(edit, i);
+        if (!polygon)
+            return false;
+        const LinkedGeoLoop* loop = polygon->first;
+        Bbox3 bbox;
+        bbox3_from_linked_loop(&bbox, loop);
+        ring_region_bbox(&edit->line, loop, shell->sign, &bbox);
+
+        for (int j = 1; j < edit->ring_num; ++j) {
+            SplitEditRing* ring = &edit->rings[j];
+            if (ring->shell >= 0 || split_edit_is_split_ring(edit, j))
+                continue;
+            short pos = 0;
+            SplitEditCursor cursor;
+            split_edit_cursor_init(&cursor, ring, 0);
+            for (int k = 0; k < ring->vertex_num && pos == 0; ++k) {
+                pos = latlng_ring_pos(&edit->line, loop, shell->sign, &bbox, split_edit_cursor_get(&cursor));
+                split_edit_cursor_move(&cursor, 1);
+            }
+            if (pos != -1) {
+                ring->shell = i;
+                --hole_num;
+                shell->changed = true;
+            }
+        }
+
+        /* Hole copies are added again */
+        if (shell->changed && shell->has_holes)
+            split_edit_shell_changed(shell);
+    }
+    return true;
+}
+
+
+bool split_edit_local_change(
+    SplitEdit* edit, int ring_idx, int start, const Vect3* chain, int old_chain_num, int chain_num)
+{
+    /* Polygon is not split, or a non-split hole changed */
+    SplitEditRing* ring = &edit->rings[ring_idx];
+    if (edit->rings[0].crossing_num == 0) {
+        split_edit_shell_changed(&edit->shells[0]);
+        return true;
+    }
+    if (!split_edit_is_split_ring(edit, ring_idx)) {
+        /* Hole is expected to stay in its shell unless it moves to the other side */
+        short sign = 0;
+        SplitEditCursor cursor;
+        split_edit_cursor_init(&cursor, ring, 0);
+        for (int i = 0; i < ring->vertex_num && sign == 0; ++i) {
+            sign = split_line_side(&edit->line, split_edit_cursor_get(&cursor));
+            split_edit_cursor_move(&cursor, 1);
+        }
+        if (ring->shell >= 0)
+            split_edit_shell_changed(&edit->shells[ring->shell]);
+        if (ring->shell < 0 || edit->shells[ring->shell].sign != sign) {
+            ring->shell = -1;
+            return split_edit_assign_holes(edit, false);
+        }
+        return true;
+    }
+
+    /* Edited vertices are in a single run, after the last intersection before them */
+    int lo = 0;
+    int hi = ring->intersect_num;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (edit->intersects[ring->intersects[mid]].intersect.index < start) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const SplitEditIntersect* intersect =
+        &edit->intersects[ring->intersects[(lo + ring->intersect_num - 1) % ring->intersect_num]];
+    short sign = (intersect->intersect.dir == SplitIntersectDir_WE) ? 1 : -1;
+    int shell_idx = intersect->shells[sign > 0];
+    split_edit_shell_changed(&edit->shells[shell_idx]);
+
+    /* Holes of the shell may drop out, unassigned holes may get in */
+    if (!chain)
+        return true;
+    for (int i = 1; i < edit->ring_num; ++i) {
+        SplitEditRing* hole = &edit->rings[i];
+        if ((hole->shell == shell_idx || hole->shell < 0)
+            && !split_edit_is_split_ring(edit, i)
+            && split_edit_hole_flips(edit, i, sign, chain, old_chain_num, chain_num))
+        {
+            hole->shell = (hole->shell < 0) ? shell_idx : -1;
+        }
+    }
+    return true;
+}
+
+
+bool split_edit_hole_flips(
+    const SplitEdit* edit, int ring_idx, short sign, const Vect3* chain, int old_chain_num, int chain_num)
+{
+    /*
+      Old and new vertices form a closed line on the shell side. Point of the
+      hole changes being inside the shell if it's inside that line, i.e. if the
+      segment to the point outside crosses old and new vertices odd times.
+      Everything inside the line is inside the bounding cap of its vertices.
+     */
+    const LatLng* latlng = &edit->rings[ring_idx].blocks[0].vertices[0];
+    short latlng_sign = split_line_side(&edit->line, latlng);
+    if (latlng_sign != 0 && latlng_sign != sign)
+        return false;
+    Vect3 vect;
+    vect3_from_lat_lng(latlng, &vect);
+
+    Vect3 center = {0};
+    for (int i = 0; i < chain_num; ++i)
+        vect3_sum(&center, &chain[i], &center);
+    if (vect3_len(&center) > 1e-9) {
+        vect3_normalize(&center);
+        double min_dot = 1;
+        for (int i = 0; i < chain_num; ++i)
+            min_dot = fmin(min_dot, vect3_dot(&center, &chain[i]));
+        if (min_dot > 0 && vect3_dot(&center, &vect) < min_dot)
+            return false;
+    }
+
+    Vect3 out_vect;
+    latlng_out_point(&edit->line, sign, latlng, &vect, &out_vect);
+    int intersect_num = 0;
+    for (int i = 0; i + 1 < chain_num; ++i) {
+        if (i + 1 == old_chain_num || vect3_eq(&chain[i], &chain[i + 1]))
+            continue;
+        if (segment_intersect(&chain[i], &chain[i + 1], &vect, &out_vect) > 0)
+            ++intersect_num;
+    }
+    return intersect_num % 2 == 1;
+}
+
+
+void split_edit_shell_changed(SplitEditShell* shell) {
+    shell->changed = true;
+    shell->has_holes = false;
+    if (shell->polygon) {
+        free_linked_geo_polygon(shell->polygon);
+        shell->polygon = NULL;
+    }
+}
+
+
+LinkedGeoPolygon* split_edit_shell_polygon(SplitEdit* edit, int shell_idx) {
+    /* Built without holes, except copy of unsplit polygon */
+    SplitEditShell* shell = &edit->shells[shell_idx];
+    if (!shell->polygon) {
+        shell->polygon = split_edit_build_shell(edit, shell);
+        shell->has_holes = (shell->first < 0);
+    }
+    return shell->polygon;
+}
+
+
+LinkedGeoPolygon* split_edit_build_shell(const SplitEdit* edit, const SplitEditShell* shell) {
+    if (shell->first < 0) {
+        /* Polygon is not split, all rings are copied */
+        LinkedGeoPolygon* polygon = split_malloc(sizeof(LinkedGeoPolygon));
+        if (!polygon)
+            return NULL;
+        *polygon = (LinkedGeoPolygon){0};
+        for (int i = 0; i < edit->ring_num; ++i) {
+            LinkedGeoLoop* loop = split_edit_ring_loop(&edit->rings[i]);
+            if (!loop) {
+                free_linked_geo_polygon(polygon);
+                return NULL;
+            }
+            add_linked_geo_loop(polygon, loop);
+        }
+        return polygon;
+    }
+
+    LinkedGeoPolygon* polygon = create_split_polygon();
+    if (!polygon)
+        return NULL;
+    LinkedGeoLoop* loop = polygon->first;
+    int id = shell->first;
+    do {
+        /* Departure point, run of ring vertices, arrival point */
+        const SplitEditIntersect* intersect = &edit->intersects[id];
+        const SplitEditIntersect* arrival = &edit->intersects[split_edit_next_on_ring(edit, id, shell->sign)];
+        const SplitEditRing* ring = &edit->rings[intersect->ring];
+        short step = split_edit_step(intersect, shell->sign);
+        int num = (step > 0)
+            ? arrival->intersect.index - intersect->intersect.index
+            : intersect->intersect.index - arrival->intersect.index;
+        num = (num + ring->vertex_num) % ring->vertex_num;
+        SplitEditCursor cursor;
+        split_edit_cursor_init(
+            &cursor, ring, (step > 0) ? (intersect->intersect.index + 1) % ring->vertex_num : intersect->intersect.index);
+
+        LatLng latlng;
+        split_intersect_get_latlng(&edit->line, &intersect->intersect, shell->sign, &latlng);
+        bool ok = split_edit_add_latlng(loop, &latlng);
+        for (int i = 0; ok && i < num; ++i) {
+            ok = split_edit_add_latlng(loop, split_edit_cursor_get(&cursor));
+            split_edit_cursor_move(&cursor, step);
+        }
+        split_intersect_get_latlng(&edit->line, &arrival->intersect, shell->sign, &latlng);
+        if (!ok || !split_edit_add_latlng(loop, &latlng)) {
+            free_linked_geo_polygon(polygon);
+            return NULL;
+        }
+        id = edit->sorted[arrival->intersect.sort_order ^ 1];
+    } while (id != shell->first);
+    return polygon;
+}
+
+
+bool split_edit_add_latlng(LinkedGeoLoop* loop, const LatLng* latlng) {
+    bool skipped;
+    return add_latlng_unique(loop, latlng, &skipped) || skipped;
+}
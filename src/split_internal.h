@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <h3/h3api.h>
+#include <split/bbox3.h>
+#include <split/vect3.h>
+
+/*
+  Internals of split.c shared with other library sources and benchmarks,
+  not installed.
+ */
+
+typedef enum {
+    SplitIntersectDir_None = 0,
+    SplitIntersectDir_WE,
+    SplitIntersectDir_EW
+} SplitIntersectDir;
+
+typedef enum {
+    SplitLineType_180 = 0, /* 0/180 meridian circle */
+    SplitLineType_Parallel,
+    SplitLineType_GreatCircle
+} SplitLineType;
+
+typedef struct {
+    SplitLineType type;
+    double lat; /* latitude of the parallel */
+    short side; /* parts on the other side are dropped, both are kept if 0 */
+
+    /* Great circle through v1 and v2, left side is positive */
+    Vect3 v1;
+    Vect3 v2;
+    Vect3 normal;
+    Vect3 a; /* position 0, circle point closest to the polygon */
+    Vect3 b; /* position 90 degrees, normal x a */
+} SplitLine;
+
+typedef struct {
+    short dir;
+    bool is_prime;
+    double pos; /* position on split line: latitude for meridian, longitude for parallel */
+    int index;
+    int sort_order;
+} SplitIntersect;
+
+/* Point in ring test, ring vertices are added one by one */
+typedef struct {
+    Vect3 vect;
+    Vect3 out_vect; /* point outside of the ring, segment to it is checked against ring segments */
+    Vect3 first;
+    Vect3 last;
+    int64_t vertex_num;
+    int intersect_num;
+    bool on_ring;
+} SplitRingPos;
+
+/* New size of a growing array holding at least num items */
+int split_grow_num(int max_num, int num);
+
+/* Side of the line, 0 if on it */
+short split_line_side(const SplitLine* line, const LatLng* latlng);
+
+/* Position of intersection of the line and a segment crossing it */
+double split_line_intersect(
+    const SplitLine* line, const LatLng* coord1, const LatLng* coord2, bool* is_prime);
+
+/* qsort comparison of SplitIntersect pointers by position on the line */
+int split_intersect_ptr_cmp(const void* a, const void* b);
+
+double split_intersect_sort_value(const SplitIntersect* intersect);
+
+/* Intersection point as seen from sign side of the line */
+void split_intersect_get_latlng(
+    const SplitLine* line, const SplitIntersect* intersect, short sign, LatLng* latlng);
+
+LinkedGeoPolygon* create_split_polygon();
+
+int count_ring_vertices(const LinkedGeoLoop* ring);
+
+/* Appends a vertex unless it repeats the last one (skipped is set then), NULL on failure */
+LinkedLatLng* add_latlng_unique(LinkedGeoLoop* loop, const LatLng* latlng, bool* skipped);
+
+/* Extends bbox of the ring by axis points inside the part on sign side of the line */
+void ring_region_bbox(const SplitLine* line, const LinkedGeoLoop* ring, short sign, Bbox3* bbox);
+
+/* Latitude where segment crossing 0/180 meridian circle meets it */
+double split_180_lat(const LatLng *coord1, const LatLng *coord2);
+
+/* 1 if point is inside the part of the ring on sign side of the line, 0 if on the ring, -1 if outside */
+short latlng_ring_pos(
+    const SplitLine* line, const LinkedGeoLoop* ring, short sign,
+    const Bbox3* bbox, const LatLng* latlng);
+
+/* Point in ring test of latlng_ring_pos, false if the point is outside of bbox or on the other side */
+bool ring_pos_init(
+    SplitRingPos* pos, const SplitLine* line, short sign, const Bbox3* bbox, const LatLng* latlng);
+
+void ring_pos_add(SplitRingPos* pos, const LatLng* vertex);
+
+short ring_pos_finish(SplitRingPos* pos);
+
+/* Point on the other side of the line for point in ring tests */
+void latlng_out_point(
+    const SplitLine* line, short sign, const LatLng* latlng, const Vect3* vect, Vect3* out_vect);
+
+/* 1 if arcs cross, 0 if they touch, -1 if they don't meet */
+short segment_intersect(const Vect3* v1, const Vect3* v2, const Vect3* u1, const Vect3* u2);
+
+/* p on the great circle of v1 and v2: 1 if inside the arc, 0 if an endpoint, -1 if outside */
+short point_between(const Vect3* v1, const Vect3* v2, const Vect3* p);
@@ -0,0 +1,708 @@
+#include <split/split.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <split/alloc.h>
+#include <split/bbox3.h>
+#include <split/crossing.h>
+#include <split/vect3.h>
+#include "split_internal.h"
+
+/*
+
+Out-of-core split:
+
+Vertices of a polygon too large for memory are appended to an unlinked
+temporary file, mapped read-only while splitting, or read in place through
+the caller's reader when they are already in memory or mapped. The vertex array of the
+traversal in split.c is replaced by runs: vertices of a ring between an
+intersection and the next one, all on the same side and always traversed
+together. Per run only the number of vertices visited from each end is
+kept, which is enough to reproduce the vertex by vertex traversal exactly,
+so memory is proportional to the number of intersections. Shells are first
+traced as a list of runs and intersection points, then read from the mapped
+file when written, and again for each test of a non-split hole.
+ */
+
+/* Vertices buffered before they are appended to the temporary file */
+#define SPLIT_LARGE_BUFFER_SIZE (4096)
+
+typedef struct {
+    SplitIntersect intersect; /* index and sort order are the 64-bit ones below */
+    int64_t ring;
+    int64_t index; /* vertex before the intersection, in ring traversal order */
+    int64_t sort_order;
+
+    /* Run of vertices after the intersection: numbers of vertices visited from its start and end */
+    int64_t head_visited;
+    int64_t tail_visited;
+} SplitLargeIntersect;
+
+typedef struct {
+    int64_t start; /* first vertex in the file */
+    int64_t vertex_num;
+    int64_t offset; /* first vertex in traversal order, first vertex off the line */
+    int64_t first_intersect; /* -1 if ring is not split */
+    int64_t intersect_num;
+    bool assigned; /* non-split hole is added to a polygon */
+} SplitLargeRing;
+
+typedef struct {
+    int64_t ring; /* -1 for intersection point */
+    int64_t first; /* in ring traversal order */
+    int64_t num; /* intersection point if 0 */
+    short step;
+    LatLng latlng;
+} SplitLargePiece;
+
+/* Receives shell points, returns false to stop */
+typedef bool (*SplitLargePointCallback)(const LatLng* latlng, void* user_data);
+
+typedef struct {
+    Bbox3 bbox;
+    Vect3 first;
+    Vect3 last;
+    int64_t vertex_num;
+} SplitLargeBbox;
+
+struct SplitLarge {
+    SplitLine line;
+    int fd;
+    int64_t vertex_num;
+    int64_t ring_start; /* first vertex of the ring being added */
+    const LatLng* vertices; /* mapped file while splitting */
+    SplitVertexReader reader; /* vertices are read in place if set */
+    void* reader_data;
+
+    bool failed; /* adding vertices failed, polygon is dropped */
+
+    int buffer_num;
+    LatLng buffer[SPLIT_LARGE_BUFFER_SIZE];
+
+    int64_t ring_num;
+    int64_t max_ring_num;
+    SplitLargeRing* rings;
+
+    int64_t intersect_num;
+    int64_t max_intersect_num;
+    SplitLargeIntersect* intersects;
+    int64_t max_sorted_num;
+    SplitIntersect** sorted;
+
+    /* Shell being written */
+    int64_t piece_num;
+    int64_t max_piece_num;
+    SplitLargePiece* pieces;
+};
+
+static bool split_large_push_ring(SplitLarge* large, int64_t start, int64_t vertex_num);
+static bool split_large_flush(SplitLarge* large);
+static LatLng split_large_vertex(const SplitLarge* large, const SplitLargeRing* ring, int64_t idx);
+static bool split_large_run(SplitLarge* large, const SplitPointWriter* writer);
+static bool split_large_is_ring_crossed(const SplitLarge* large, int64_t ring_idx);
+static bool split_large_process_ring(SplitLarge* large, int64_t ring_idx);
+static bool split_large_sort(SplitLarge* large);
+static bool split_large_find_start(
+    const SplitLarge* large, int64_t* ring_idx, int64_t* slot, int64_t* id, int64_t* pos);
+static bool split_large_trace_shell(SplitLarge* large, int64_t id, int64_t pos);
+static bool split_large_add_piece(SplitLarge* large, const SplitLargePiece* piece);
+static bool split_large_each_shell_point(
+    const SplitLarge* large, SplitLargePointCallback callback, void* user_data);
+static bool split_large_write_ring(
+    const SplitLarge* large, int64_t ring_idx, const SplitPointWriter* writer);
+static bool split_large_assign_holes(SplitLarge* large, short sign, const SplitPointWriter* writer);
+static void split_large_region_bbox(const SplitLarge* large, short sign, Bbox3* bbox);
+static short split_large_shell_pos(
+    const SplitLarge* large, short sign, const Bbox3* bbox, const LatLng* latlng);
+static bool split_large_add_pos(const LatLng* latlng, void* pos);
+static bool split_large_add_bbox(const LatLng* latlng, void* bbox);
+static int64_t split_large_ring_next(const SplitLarge* large, int64_t id, short step);
+static int64_t split_large_run_length(const SplitLarge* large, int64_t id);
+static bool split_large_reserve(void** data, int64_t* max_num, int64_t num, size_t item_size);
+
+
+SplitLarge* split_large_new(const char* dir) {
+    if (!dir)
+        dir = getenv("TMPDIR");
+    if (!dir || !*dir)
+        dir = "/tmp";
+
+    /* File is unlinked right away, its space is freed when it is closed */
+    static const char name[] = "/split-XXXXXX";
+    size_t dir_len = strlen(dir);
+    char* path = split_malloc(dir_len + sizeof(name));
+    if (!path)
+        return NULL;
+    memcpy(path, dir, dir_len);
+    memcpy(path + dir_len, name, sizeof(name));
+    int fd = mkstemp(path);
+    if (fd >= 0)
+        unlink(path);
+    split_free(path, dir_len + sizeof(name));
+    if (fd < 0)
+        return NULL;
+
+    SplitLarge* large = split_malloc(sizeof(SplitLarge));
+    if (!large) {
+        close(fd);
+        return NULL;
+    }
+    *large = (SplitLarge){0};
+    large->line.type = SplitLineType_180;
+    large->fd = fd;
+    return large;
+}
+
+
+void split_large_free(SplitLarge* large) {
+    close(large->fd);
+    split_free(large->rings, large->max_ring_num * sizeof(SplitLargeRing));
+    split_free(large->intersects, large->max_intersect_num * sizeof(SplitLargeIntersect));
+    split_free(large->sorted, large->max_sorted_num * sizeof(SplitIntersect*));
+    split_free(large->pieces, large->max_piece_num * sizeof(SplitLargePiece));
+    split_free(large, sizeof(SplitLarge));
+}
+
+
+bool split_large_add_vertex(SplitLarge* large, const LatLng* vertex) {
+    if (large->reader) {
+        large->failed = true;
+        return false;
+    }
+    large->buffer[large->buffer_num++] = *vertex;
+    ++large->vertex_num;
+    return large->buffer_num < SPLIT_LARGE_BUFFER_SIZE || split_large_flush(large);
+}
+
+
+bool split_large_end_ring(SplitLarge* large) {
+    if (large->vertex_num == large->ring_start
+        || !split_large_push_ring(large, large->ring_start, large->vertex_num - large->ring_start))
+    {
+        large->failed = true;
+        return false;
+    }
+    large->ring_start = large->vertex_num;
+    return true;
+}
+
+
+bool split_large_add_polygon(SplitLarge* large, const LinkedGeoPolygon* polygon) {
+    for (const LinkedGeoLoop* ring = polygon->first; ring; ring = ring->next) {
+        for (const LinkedLatLng* point = ring->first; point; point = point->next) {
+            if (!split_large_add_vertex(large, &point->vertex))
+                return false;
+        }
+        if (!split_large_end_ring(large))
+            return false;
+    }
+    return true;
+}
+
+
+void split_large_set_reader(SplitLarge* large, SplitVertexReader reader, void* user_data) {
+    split_large_clear(large);
+    large->reader = reader;
+    large->reader_data = user_data;
+}
+
+
+bool split_large_add_ring(SplitLarge* large, int64_t start, int64_t vertex_num) {
+    if (!large->reader || vertex_num <= 0 || !split_large_push_ring(large, start, vertex_num)) {
+        large->failed = true;
+        return false;
+    }
+    return true;
+}
+
+
+bool split_large_by_180(SplitLarge* large, const SplitPointWriter* writer) {
+    /* Vertices added after the last ring are an error too */
+    bool ok = !large->failed && large->ring_start == large->vertex_num && split_large_flush(large);
+    if (ok && large->ring_num > 0 && large->reader) {
+        ok = split_large_run(large, writer);
+    } else if (ok && large->ring_num > 0) {
+        size_t size = large->vertex_num * sizeof(LatLng);
+        void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, large->fd, 0);
+        ok = (data != MAP_FAILED);
+        if (ok) {
+            large->vertices = data;
+            ok = split_large_run(large, writer);
+            munmap(data, size);
+            large->vertices = NULL;
+        }
+    }
+    split_large_clear(large);
+    return ok;
+}
+
+
+void split_large_clear(SplitLarge* large) {
+    /* File is truncated, so its blocks are freed */
+    large->failed = (ftruncate(large->fd, 0) != 0 || lseek(large->fd, 0, SEEK_SET) != 0);
+    large->vertex_num = 0;
+    large->ring_start = 0;
+    large->buffer_num = 0;
+    large->ring_num = 0;
+    large->intersect_num = 0;
+    large->piece_num = 0;
+}
+
+
+bool split_large_push_ring(SplitLarge* large, int64_t start, int64_t vertex_num) {
+    if (!split_large_reserve(
+            (void**) &large->rings, &large->max_ring_num, large->ring_num + 1, sizeof(SplitLargeRing)))
+        return false;
+    SplitLargeRing* ring = &large->rings[large->ring_num++];
+    *ring = (SplitLargeRing){0};
+    ring->start = start;
+    ring->vertex_num = vertex_num;
+    ring->first_intersect = -1;
+    return true;
+}
+
+
+bool split_large_flush(SplitLarge* large) {
+    const char* data = (const char*) large->buffer;
+    size_t len = large->buffer_num * sizeof(LatLng);
+    large->buffer_num = 0;
+    while (len > 0) {
+        ssize_t written = write(large->fd, data, len);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) {
+            large->failed = true;
+            return false;
+        }
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+
+LatLng split_large_vertex(const SplitLarge* large, const SplitLargeRing* ring, int64_t idx) {
+    if (!large->reader)
+        return large->vertices[ring->start + idx];
+    LatLng vertex;
+    large->reader(ring->start + idx, &vertex, large->reader_data);
+    return vertex;
+}
+
+
+bool split_large_run(SplitLarge* large, const SplitPointWriter* writer) {
+    /* Polygon is copied if outer ring is not crossed, as by split_context_by_180 */
+    if (!split_large_is_ring_crossed(large, 0)) {
+        for (int64_t i = 0; i < large->ring_num; ++i) {
+            if (!split_large_write_ring(large, i, writer))
+                return false;
+        }
+        return writer->end_polygon(writer->user_data);
+    }
+
+    /* Outer ring and crossed holes are split, other holes are assigned to shells */
+    bool has_holes = false;
+    for (int64_t i = 0; i < large->ring_num; ++i) {
+        if (i == 0 || split_large_is_ring_crossed(large, i)) {
+            if (!split_large_process_ring(large, i))
+                return false;
+        } else {
+            has_holes = true;
+        }
+    }
+    if (!split_large_sort(large))
+        return false;
+
+    int64_t ring_idx = 0;
+    int64_t slot = 0;
+    int64_t id, pos;
+    while (split_large_find_start(large, &ring_idx, &slot, &id, &pos)) {
+        /* Run sign is the side after the intersection */
+        short sign = (large->intersects[id].intersect.dir == SplitIntersectDir_WE) ? 1 : -1;
+        if (!split_large_trace_shell(large, id, pos)
+            || !split_large_each_shell_point(large, writer->add_point, writer->user_data)
+            || !writer->end_ring(writer->user_data)
+            || (has_holes && !split_large_assign_holes(large, sign, writer))
+            || !writer->end_polygon(writer->user_data))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool split_large_is_ring_crossed(const SplitLarge* large, int64_t ring_idx) {
+    /* Segments in blocks, as is_ring_crossed_by_180 of column input */
+    const SplitLargeRing* ring = &large->rings[ring_idx];
+    if (ring->vertex_num < 2)
+        return false;
+    double lngs[CROSSING_BLOCK_SIZE + 1];
+    lngs[0] = split_large_vertex(large, ring, 0).lng;
+    int64_t idx = 1;
+    bool closed = false;
+    while (true) {
+        int num = 0;
+        while (num < CROSSING_BLOCK_SIZE && !closed) {
+            if (idx < ring->vertex_num) {
+                lngs[++num] = split_large_vertex(large, ring, idx++).lng;
+            } else {
+                /* Closing segment */
+                lngs[++num] = split_large_vertex(large, ring, 0).lng;
+                closed = true;
+            }
+        }
+
+        if (lng_crossing_any(lngs, num))
+            return true;
+        if (closed)
+            return false;
+
+        /* Next block starts with last checked vertex */
+        lngs[0] = lngs[num];
+    }
+}
+
+
+bool split_large_process_ring(SplitLarge* large, int64_t ring_idx) {
+    /* As split_process_ring, traversal order starts from a vertex off the split line */
+    SplitLargeRing* ring = &large->rings[ring_idx];
+    int64_t vertex_num = ring->vertex_num;
+    LatLng cur;
+    for (ring->offset = 0; ring->offset < vertex_num; ++ring->offset) {
+        cur = split_large_vertex(large, ring, ring->offset);
+        if (split_line_side(&large->line, &cur) != 0)
+            break;
+    }
+    if (ring->offset == vertex_num) {
+        ring->offset = 0;
+        cur = split_large_vertex(large, ring, 0);
+    }
+    ring->first_intersect = large->intersect_num;
+
+    short sign = 0;
+    int64_t cur_idx = ring->offset;
+    for (int64_t i = 0; i < vertex_num; ++i) {
+        int64_t next_idx = (cur_idx + 1 < vertex_num) ? cur_idx + 1 : 0;
+        LatLng next = split_large_vertex(large, ring, next_idx);
+
+        short next_sign = split_line_side(&large->line, &next);
+        if (sign == 0)
+            sign = split_line_side(&large->line, &cur);
+        if (sign != 0 && next_sign != 0 && next_sign != sign) {
+            /* Intersection after current vertex */
+            if (!split_large_reserve(
+                    (void**) &large->intersects, &large->max_intersect_num,
+                    large->intersect_num + 1, sizeof(SplitLargeIntersect)))
+            {
+                return false;
+            }
+            SplitLargeIntersect* intersect = &large->intersects[large->intersect_num++];
+            *intersect = (SplitLargeIntersect){0};
+            intersect->intersect.dir = (sign < 0) ? SplitIntersectDir_WE : SplitIntersectDir_EW;
+            intersect->intersect.pos = split_line_intersect(
+                &large->line, &cur, &next, &intersect->intersect.is_prime);
+            intersect->intersect.index = -1;
+            intersect->intersect.sort_order = -1;
+            intersect->ring = ring_idx;
+            intersect->index = i;
+
+            sign = next_sign;
+        }
+        cur_idx = next_idx;
+        cur = next;
+    }
+    ring->intersect_num = large->intersect_num - ring->first_intersect;
+    return true;
+}
+
+
+bool split_large_sort(SplitLarge* large) {
+    /* Intersections are added in the same order as by split_process_ring, so they sort the same */
+    if (!split_large_reserve(
+            (void**) &large->sorted, &large->max_sorted_num, large->intersect_num, sizeof(SplitIntersect*)))
+        return false;
+    for (int64_t i = 0; i < large->intersect_num; ++i)
+        large->sorted[i] = &large->intersects[i].intersect;
+    qsort(large->sorted, large->intersect_num, sizeof(SplitIntersect*), &split_intersect_ptr_cmp);
+    for (int64_t i = 0; i < large->intersect_num; ++i)
+        ((SplitLargeIntersect*) large->sorted[i])->sort_order = i;
+    return true;
+}
+
+
+bool split_large_find_start(
+    const SplitLarge* large, int64_t* ring_idx, int64_t* slot, int64_t* id, int64_t* pos)
+{
+    /*
+      First unvisited vertex in traversal order, as split_find_next_vertex.
+      First vertex of a ring is inside its last run, so the ring is scanned in
+      slots: last run from the first vertex, other runs, last run up to the
+      first vertex. Scan continues from the slot of the previous start.
+     */
+    for (; *ring_idx < large->ring_num; ++*ring_idx, *slot = 0) {
+        const SplitLargeRing* ring = &large->rings[*ring_idx];
+        if (ring->first_intersect < 0 || ring->intersect_num == 0)
+            continue;
+        int64_t last = ring->first_intersect + ring->intersect_num - 1;
+        int64_t first_pos = ring->vertex_num - 1 - large->intersects[last].index;
+        for (; *slot <= ring->intersect_num; ++*slot) {
+            bool is_last = (*slot == 0 || *slot == ring->intersect_num);
+            int64_t run = is_last ? last : ring->first_intersect + *slot - 1;
+            const SplitLargeIntersect* intersect = &large->intersects[run];
+            int64_t length = split_large_run_length(large, run);
+            int64_t min_pos = (*slot == 0) ? first_pos : 0;
+            int64_t max_pos = (*slot == ring->intersect_num) ? first_pos : length;
+
+            /* Unvisited vertices are between the ones visited from run ends */
+            int64_t start = (intersect->head_visited > min_pos) ? intersect->head_visited : min_pos;
+            int64_t end = length - intersect->tail_visited;
+            if (start < end && start < max_pos) {
+                *id = run;
+                *pos = start;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+bool split_large_trace_shell(SplitLarge* large, int64_t id, int64_t pos) {
+    /* Same steps as split_create_polygon_vertex, a run at a time */
+    large->piece_num = 0;
+    short sign = (large->intersects[id].intersect.dir == SplitIntersectDir_WE) ? 1 : -1;
+    short step = 1;
+    while (true) {
+        SplitLargeIntersect* run = &large->intersects[id];
+        int64_t length = split_large_run_length(large, id);
+        if (pos < run->head_visited || pos >= length - run->tail_visited)
+            break; /* visited */
+
+        /* Vertices up to the end of the run, or up to a visited one */
+        const SplitLargeIntersect* intersect = &large->intersects[split_large_ring_next(large, id, 1)];
+        int64_t first = (run->index + 1 + pos) % large->rings[run->ring].vertex_num;
+        SplitLargePiece piece = {run->ring, first, 0, step};
+        bool is_run_end;
+        if (step > 0) {
+            piece.num = length - run->tail_visited - pos;
+            is_run_end = (run->tail_visited == 0);
+            run->tail_visited = length - pos;
+        } else {
+            piece.num = pos - run->head_visited + 1;
+            is_run_end = (run->head_visited == 0);
+            run->head_visited = pos + 1;
+            intersect = run;
+        }
+        if (!split_large_add_piece(large, &piece))
+            return false;
+        if (!is_run_end)
+            break;
+
+        /* Intersection at the end of the run and the adjacent one on the line */
+        SplitLargePiece point = {-1, 0, 0, 0};
+        split_intersect_get_latlng(&large->line, &intersect->intersect, sign, &point.latlng);
+        if (!split_large_add_piece(large, &point))
+            return false;
+        intersect = (const SplitLargeIntersect*) large->sorted[intersect->sort_order ^ 1];
+        split_intersect_get_latlng(&large->line, &intersect->intersect, sign, &point.latlng);
+        if (!split_large_add_piece(large, &point))
+            return false;
+
+        /* Run after the intersection from its first vertex, or run before it from its last one */
+        step = ((sign > 0) == (intersect->intersect.dir == SplitIntersectDir_WE)) ? 1 : -1;
+        id = intersect - large->intersects;
+        if (step > 0) {
+            pos = 0;
+        } else {
+            id = split_large_ring_next(large, id, -1);
+            pos = split_large_run_length(large, id) - 1;
+        }
+    }
+    return true;
+}
+
+
+bool split_large_add_piece(SplitLarge* large, const SplitLargePiece* piece) {
+    if (!split_large_reserve(
+            (void**) &large->pieces, &large->max_piece_num, large->piece_num + 1, sizeof(SplitLargePiece)))
+        return false;
+    large->pieces[large->piece_num++] = *piece;
+    return true;
+}
+
+
+bool split_large_each_shell_point(
+    const SplitLarge* large, SplitLargePointCallback callback, void* user_data)
+{
+    /* Repeated points are skipped, as by add_latlng_unique */
+    LatLng last = {0};
+    bool has_last = false;
+    for (int64_t i = 0; i < large->piece_num; ++i) {
+        const SplitLargePiece* piece = &large->pieces[i];
+        const SplitLargeRing* ring = NULL;
+        int64_t vertex_num = 0;
+        int64_t idx = 0;
+        int64_t num = 1;
+        if (piece->ring >= 0) {
+            ring = &large->rings[piece->ring];
+            vertex_num = ring->vertex_num;
+            idx = (ring->offset + piece->first) % vertex_num;
+            num = piece->num;
+        }
+
+        for (int64_t j = 0; j < num; ++j) {
+            LatLng latlng = ring ? split_large_vertex(large, ring, idx) : piece->latlng;
+            if (!has_last || latlng.lat != last.lat || latlng.lng != last.lng) {
+                if (!callback(&latlng, user_data))
+                    return false;
+                last = latlng;
+                has_last = true;
+            }
+
+            /* Wraps around the ring */
+            idx += piece->step;
+            if (idx == vertex_num) {
+                idx = 0;
+            } else if (idx < 0) {
+                idx = vertex_num - 1;
+            }
+        }
+    }
+    return true;
+}
+
+
+bool split_large_write_ring(const SplitLarge* large, int64_t ring_idx, const SplitPointWriter* writer) {
+    /* Vertices as added */
+    const SplitLargeRing* ring = &large->rings[ring_idx];
+    for (int64_t i = 0; i < ring->vertex_num; ++i) {
+        LatLng vertex = split_large_vertex(large, ring, i);
+        if (!writer->add_point(&vertex, writer->user_data))
+            return false;
+    }
+    return writer->end_ring(writer->user_data);
+}
+
+
+bool split_large_assign_holes(SplitLarge* large, short sign, const SplitPointWriter* writer) {
+    /* As in split_create_polygon_vertex, the shell is read again for each tested point */
+    bool has_free_holes = false;
+    for (int64_t i = 1; i < large->ring_num && !has_free_holes; ++i)
+        has_free_holes = (large->rings[i].first_intersect < 0 && !large->rings[i].assigned);
+    if (!has_free_holes)
+        return true;
+
+    /* Bbox of the shell, as bbox3_from_linked_loop */
+    SplitLargeBbox bbox = {0};
+    split_large_each_shell_point(large, &split_large_add_bbox, &bbox);
+    if (bbox.vertex_num > 1 && !vect3_eq(&bbox.last, &bbox.first)) {
+        Bbox3 segment_bbox;
+        bbox3_from_segment_vect3(&segment_bbox, &bbox.last, &bbox.first);
+        bbox3_merge(&bbox.bbox, &segment_bbox);
+    }
+    split_large_region_bbox(large, sign, &bbox.bbox);
+
+    for (int64_t i = 1; i < large->ring_num; ++i) {
+        SplitLargeRing* ring = &large->rings[i];
+        if (ring->first_intersect >= 0 || ring->assigned)
+            continue;
+
+        /* Check if hole vertices are inside the polygon */
+        short pos = 0;
+        for (int64_t j = 0; j < ring->vertex_num && pos == 0; ++j) {
+            LatLng vertex = split_large_vertex(large, ring, j);
+            pos = split_large_shell_pos(large, sign, &bbox.bbox, &vertex);
+        }
+        if (pos != -1) {
+            if (!split_large_write_ring(large, i, writer))
+                return false;
+            ring->assigned = true;
+        }
+    }
+    return true;
+}
+
+
+void split_large_region_bbox(const SplitLarge* large, short sign, Bbox3* bbox) {
+    /* Same as ring_region_bbox */
+    static const Vect3 axes[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (int i = 0; i < 6; ++i) {
+        if (bbox3_contains_vect3(bbox, &axes[i]))
+            continue;
+        LatLng latlng;
+        vect3_to_lat_lng(&axes[i], &latlng);
+        if (split_large_shell_pos(large, sign, NULL, &latlng) != -1) {
+            Bbox3 axis_bbox;
+            bbox3_from_vect3(&axis_bbox, &axes[i]);
+            bbox3_merge(bbox, &axis_bbox);
+        }
+    }
+}
+
+
+short split_large_shell_pos(const SplitLarge* large, short sign, const Bbox3* bbox, const LatLng* latlng) {
+    SplitRingPos pos;
+    if (!ring_pos_init(&pos, &large->line, sign, bbox, latlng))
+        return -1;
+    split_large_each_shell_point(large, &split_large_add_pos, &pos);
+    return ring_pos_finish(&pos);
+}
+
+
+bool split_large_add_pos(const LatLng* latlng, void* pos) {
+    SplitRingPos* ring_pos = pos;
+    ring_pos_add(ring_pos, latlng);
+    return !ring_pos->on_ring;
+}
+
+
+bool split_large_add_bbox(const LatLng* latlng, void* bbox) {
+    SplitLargeBbox* large_bbox = bbox;
+    Vect3 vect;
+    vect3_from_lat_lng(latlng, &vect);
+    if (large_bbox->vertex_num++ == 0) {
+        bbox3_from_vect3(&large_bbox->bbox, &vect);
+        large_bbox->first = vect;
+    } else if (!vect3_eq(&large_bbox->last, &vect)) {
+        Bbox3 segment_bbox;
+        bbox3_from_segment_vect3(&segment_bbox, &large_bbox->last, &vect);
+        bbox3_merge(&large_bbox->bbox, &segment_bbox);
+    }
+    large_bbox->last = vect;
+    return true;
+}
+
+
+int64_t split_large_ring_next(const SplitLarge* large, int64_t id, short step) {
+    /* Next or previous intersection of the same ring */
+    const SplitLargeRing* ring = &large->rings[large->intersects[id].ring];
+    int64_t first = ring->first_intersect;
+    return first + (id - first + ring->intersect_num + step) % ring->intersect_num;
+}
+
+
+int64_t split_large_run_length(const SplitLarge* large, int64_t id) {
+    /* Vertices after the intersection up to the vertex before the next one */
+    const SplitLargeIntersect* intersect = &large->intersects[id];
+    int64_t length = large->intersects[split_large_ring_next(large, id, 1)].index - intersect->index;
+    return (length > 0) ? length : length + large->rings[intersect->ring].vertex_num;
+}
+
+
+bool split_large_reserve(void** data, int64_t* max_num, int64_t num, size_t item_size) {
+    if (num <= *max_num)
+        return true;
+    int64_t new_max_num = (*max_num > 0) ? *max_num * 2 : 16;
+    if (new_max_num < num)
+        new_max_num = num;
+    void* new_data = split_realloc(*data, *max_num * item_size, new_max_num * item_size);
+    if (!new_data)
+        return false;
+    *data = new_data;
+    *max_num = new_max_num;
+    return true;
+}
@@ -0,0 +1,205 @@
+#include <split/transform.h>
+#include <assert.h>
+#include <split/alloc.h>
+#include <split/h3.h>
+
+typedef struct {
+    LinkedGeoPolygon* first;
+    LinkedGeoPolygon* last;
+} Members;
+
+typedef struct {
+    SplitContext* context;
+    const SplitTransformOptions* options;
+    SplitPolygonCallback callback;
+    void* user_data;
+    Members pieces; /* antimeridian split result, cut into bands afterwards */
+} Transform;
+
+static bool transform_member(Transform* transform, LinkedGeoPolygon* polygon);
+static bool transform_bands(Transform* transform, LinkedGeoPolygon* polygon);
+static void add_piece(LinkedGeoPolygon* polygon, void* user_data);
+static void print_piece(LinkedGeoPolygon* polygon, void* user_data);
+
+
+SplitTransformResult split_transform(
+    const void* in, size_t in_len, SplitFormat in_format, SplitFormat out_format,
+    const SplitTransformOptions* options, PrintBuffer* out)
+{
+    SplitContext* context = split_context_new();
+    if (!context) {
+        out->len = 0;
+        return (SplitTransformResult){SplitTransformError_MemAllocFailed};
+    }
+    SplitTransformResult result = split_context_transform(
+        context, in, in_len, in_format, out_format, options, out);
+    split_context_free(context);
+    return result;
+}
+
+
+SplitTransformResult split_context_transform(
+    SplitContext* context,
+    const void* in, size_t in_len, SplitFormat in_format, SplitFormat out_format,
+    const SplitTransformOptions* options, PrintBuffer* out)
+{
+    SplitTransformResult result = {SplitTransformError_Ok};
+    out->len = 0;
+    out->failed = false;
+
+    if (in_format != SplitFormat_Wkt || out_format != SplitFormat_Wkt) {
+        result.error = SplitTransformError_UnsupportedFormat;
+        return result;
+    }
+    SplitTransformOptions default_options = {0};
+    if (!options)
+        options = &default_options;
+
+    /* Parse */
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Parse);
+    WktParseResult parse_result = wkt_parse_mode(in_len ? in : "", in_len, options->coord_mode);
+    if (parse_result.error) {
+        split_alloc_set_stage(prev_stage);
+        result.error = (parse_result.error == WktParseError_MemAllocFailed)
+            ? SplitTransformError_MemAllocFailed
+            : SplitTransformError_Parse;
+        result.parse_error = parse_result.error;
+        result.error_pos = parse_result.error_pos;
+        result.message = parse_result.message;
+        return result;
+    }
+
+    PolygonPrinter printer;
+    polygon_printer_init(&printer);
+    printer.coord_mode = options->coord_mode;
+    printer.buffer = out;
+
+    /* Empty data is printed as empty polygon */
+    LinkedGeoPolygon* polygon = parse_result.object;
+    bool ok = true;
+    split_alloc_set_stage(SplitAllocStage_Split);
+    if (!polygon->first && !polygon->next) {
+        free_linked_geo_polygon(polygon);
+    } else {
+        ok = split_context_members(context, polygon, options, &print_piece, &printer);
+    }
+    split_alloc_set_stage(SplitAllocStage_Output);
+    polygon_printer_finish(&printer);
+    split_alloc_set_stage(prev_stage);
+
+    if (!ok)
+        result.error = SplitTransformError_Split;
+    else if (out->failed)
+        result.error = SplitTransformError_MemAllocFailed;
+    if (result.error)
+        out->len = 0;
+    return result;
+}
+
+
+bool split_context_members(
+    SplitContext* context, LinkedGeoPolygon* polygon, const SplitTransformOptions* options,
+    SplitPolygonCallback callback, void* user_data)
+{
+    SplitTransformOptions default_options = {0};
+    Transform transform = {context, options ? options : &default_options, callback, user_data};
+
+    /* Split member polygons one by one */
+    bool ok = true;
+    while (polygon && ok) {
+        LinkedGeoPolygon* next = polygon->next;
+        polygon->next = NULL;
+        ok = transform_member(&transform, polygon);
+        polygon = next;
+    }
+    if (polygon)
+        free_linked_geo_polygon(polygon);
+    return ok;
+}
+
+
+const char* split_transform_error_to_string(SplitTransformError error) {
+    switch (error) {
+        case SplitTransformError_Ok:
+            return "Ok";
+        case SplitTransformError_UnsupportedFormat:
+            return "Unsupported format";
+        case SplitTransformError_Parse:
+            return "Failed to parse input";
+        case SplitTransformError_Split:
+            return "Failed to split polygon";
+        case SplitTransformError_MemAllocFailed:
+            return "Memory allocation failure";
+        default:
+            assert(false);
+            return NULL;
+    }
+}
+
+
+bool transform_member(Transform* transform, LinkedGeoPolygon* polygon) {
+    /* Takes ownership of the polygon */
+    if (transform->options->band_lat_num > 0)
+        return transform_bands(transform, polygon);
+
+    if (!is_crossed_by_180(polygon)) {
+        transform->callback(polygon, transform->user_data);
+        return true;
+    }
+    bool ok = split_context_by_180(transform->context, polygon, transform->callback, transform->user_data);
+    free_linked_geo_polygon(polygon);
+    return ok;
+}
+
+
+bool transform_bands(Transform* transform, LinkedGeoPolygon* polygon) {
+    /* Collect antimeridian split result first, so the context is free for band split */
+    transform->pieces = (Members){0};
+    if (!is_crossed_by_180(polygon)) {
+        transform->pieces.first = polygon;
+    } else {
+        bool ok = split_context_by_180(transform->context, polygon, &add_piece, transform);
+        free_linked_geo_polygon(polygon);
+        if (!ok) {
+            if (transform->pieces.first)
+                free_linked_geo_polygon(transform->pieces.first);
+            return false;
+        }
+    }
+
+    const SplitTransformOptions* options = transform->options;
+    LinkedGeoPolygon* piece = transform->pieces.first;
+    bool ok = true;
+    while (piece && ok) {
+        LinkedGeoPolygon* next = piece->next;
+        piece->next = NULL;
+        ok = split_context_by_parallels(
+            transform->context, piece, options->band_lats, options->band_lat_num,
+            transform->callback, transform->user_data);
+        free_linked_geo_polygon(piece);
+        piece = next;
+    }
+    if (piece)
+        free_linked_geo_polygon(piece);
+    return ok;
+}
+
+
+void add_piece(LinkedGeoPolygon* polygon, void* user_data) {
+    Transform* transform = user_data;
+    Members* pieces = &transform->pieces;
+    if (!pieces->first) {
+        pieces->first = polygon;
+    } else {
+        pieces->last->next = polygon;
+    }
+    pieces->last = polygon;
+}
+
+
+void print_piece(LinkedGeoPolygon* polygon, void* user_data) {
+    PolygonPrinter* printer = user_data;
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Output);
+    polygon_printer_add(printer, polygon);
+    split_alloc_set_stage(prev_stage);
+}
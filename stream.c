@@ -0,0 +1,530 @@
+#define _GNU_SOURCE /* fopencookie */
+#include "stream.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_ZLIB
+# include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+# include <zstd.h>
+#endif
+
+#define INPUT_BLOCK_SIZE (1024 * 1024)
+#define INPUT_BLOCK_NUM (4)
+#define COMPRESSED_BUFFER_SIZE (256 * 1024)
+#define ERROR_MESSAGE_SIZE (256)
+#define GZIP_LEVEL (6)
+#define ZSTD_LEVEL (3)
+
+static const unsigned char GzipMagic[] = {0x1f, 0x8b};
+static const unsigned char ZstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+struct InputStream {
+    FILE* file;
+    StreamCompression compression;
+
+    /* Read but not yet consumed file data */
+    unsigned char* in;
+    size_t in_len;
+    size_t in_pos;
+    bool is_file_end;
+#ifdef HAVE_ZLIB
+    z_stream gzip;
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_DStream* zstd;
+    size_t zstd_status; /* 0 at frame end */
+#endif
+
+    /* Ring of blocks, filled by reader thread */
+    pthread_t thread;
+    bool has_thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    char* blocks[INPUT_BLOCK_NUM];
+    size_t lens[INPUT_BLOCK_NUM];
+    int head;       /* next block to fill */
+    int tail;       /* next block to consume */
+    int filled_num; /* including block held by consumer */
+    bool is_held;
+    bool is_end;
+    bool is_closing;
+
+    char error[ERROR_MESSAGE_SIZE];
+};
+
+typedef struct {
+    FILE* file;
+    StreamCompression compression;
+    unsigned char* out;
+#ifdef HAVE_ZLIB
+    z_stream gzip;
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_CStream* zstd;
+#endif
+} OutputCookie;
+
+static bool input_init_compression(InputStream* stream);
+static void* input_thread(void* arg);
+static size_t input_read_block(InputStream* stream, char* block);
+static size_t read_plain(InputStream* stream, char* block);
+static bool fill_in(InputStream* stream);
+#ifdef HAVE_ZLIB
+static size_t read_gzip(InputStream* stream, char* block);
+#endif
+#ifdef HAVE_ZSTD
+static size_t read_zstd(InputStream* stream, char* block);
+#endif
+static void set_error(InputStream* stream, const char* message);
+static void input_stream_free(InputStream* stream);
+
+static ssize_t output_write(void* cookie, const char* data, size_t len);
+static int output_close(void* cookie);
+static bool output_compress(OutputCookie* cookie, const char* data, size_t len, bool is_end);
+static void output_cookie_free(OutputCookie* cookie);
+
+
+InputStream* input_stream_open(const char* path) {
+    InputStream* stream = calloc(1, sizeof(InputStream));
+    if (!stream)
+        return NULL;
+    stream->file = path ? fopen(path, "rb") : stdin;
+    stream->in = malloc(COMPRESSED_BUFFER_SIZE);
+    bool ok = stream->file && stream->in;
+    for (int i = 0; i < INPUT_BLOCK_NUM && ok; i++) {
+        stream->blocks[i] = malloc(INPUT_BLOCK_SIZE);
+        ok = stream->blocks[i] != NULL;
+    }
+    if (!ok) {
+        input_stream_free(stream);
+        return NULL;
+    }
+
+    /* Compression by magic bytes, errors are reported by first read */
+    if (fill_in(stream)) {
+        const unsigned char* in = stream->in;
+        if (stream->in_len >= sizeof(GzipMagic) && memcmp(in, GzipMagic, sizeof(GzipMagic)) == 0) {
+            stream->compression = StreamCompression_Gzip;
+        } else if (stream->in_len >= sizeof(ZstdMagic) && memcmp(in, ZstdMagic, sizeof(ZstdMagic)) == 0) {
+            stream->compression = StreamCompression_Zstd;
+        }
+        input_init_compression(stream);
+    }
+
+    /* Reader thread, input is read by calling thread if it can't be started */
+    pthread_mutex_init(&stream->mutex, NULL);
+    pthread_cond_init(&stream->cond, NULL);
+    stream->has_thread = (pthread_create(&stream->thread, NULL, &input_thread, stream) == 0);
+    return stream;
+}
+
+
+bool input_stream_next(InputStream* stream, const char** data, size_t* len) {
+    if (!stream->has_thread) {
+        *data = stream->blocks[0];
+        *len = stream->error[0] ? 0 : input_read_block(stream, stream->blocks[0]);
+        return *len > 0;
+    }
+
+    pthread_mutex_lock(&stream->mutex);
+    if (stream->is_held) {
+        /* Release previous block */
+        stream->tail = (stream->tail + 1) % INPUT_BLOCK_NUM;
+        --stream->filled_num;
+        stream->is_held = false;
+        pthread_cond_broadcast(&stream->cond);
+    }
+    while (stream->filled_num == 0 && !stream->is_end)
+        pthread_cond_wait(&stream->cond, &stream->mutex);
+    bool found = stream->filled_num > 0;
+    if (found) {
+        *data = stream->blocks[stream->tail];
+        *len = stream->lens[stream->tail];
+        stream->is_held = true;
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    return found;
+}
+
+
+const char* input_stream_error(const InputStream* stream) {
+    /* Written by reader thread before end of input is signalled */
+    return stream->error[0] ? stream->error : NULL;
+}
+
+
+void input_stream_close(InputStream* stream) {
+    if (stream->has_thread) {
+        pthread_mutex_lock(&stream->mutex);
+        stream->is_closing = true;
+        pthread_cond_broadcast(&stream->cond);
+        pthread_mutex_unlock(&stream->mutex);
+        pthread_join(stream->thread, NULL);
+    }
+    pthread_mutex_destroy(&stream->mutex);
+    pthread_cond_destroy(&stream->cond);
+    input_stream_free(stream);
+}
+
+
+StreamCompression stream_compression_from_path(const char* path) {
+    size_t len = strlen(path);
+    if (len > 3 && strcmp(path + len - 3, ".gz") == 0)
+        return StreamCompression_Gzip;
+    if (len > 4 && strcmp(path + len - 4, ".zst") == 0)
+        return StreamCompression_Zstd;
+    return StreamCompression_None;
+}
+
+
+FILE* output_stream_open(const char* path, StreamCompression compression) {
+    FILE* file = path ? fopen(path, "wb") : stdout;
+    if (!file || compression == StreamCompression_None)
+        return file;
+
+    OutputCookie* cookie = calloc(1, sizeof(OutputCookie));
+    bool ok = cookie && stream_compression_is_supported(compression);
+    if (ok) {
+        cookie->file = file;
+        cookie->compression = compression;
+        cookie->out = malloc(COMPRESSED_BUFFER_SIZE);
+        ok = cookie->out != NULL;
+    }
+#ifdef HAVE_ZLIB
+    if (ok && compression == StreamCompression_Gzip) {
+        /* 16 added to window bits writes gzip header */
+        ok = deflateInit2(&cookie->gzip, GZIP_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        if (!ok)
+            cookie->compression = StreamCompression_None;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    if (ok && compression == StreamCompression_Zstd) {
+        cookie->zstd = ZSTD_createCStream();
+        ok = cookie->zstd && !ZSTD_isError(ZSTD_initCStream(cookie->zstd, ZSTD_LEVEL));
+    }
+#endif
+    cookie_io_functions_t functions = {NULL, &output_write, NULL, &output_close};
+    FILE* stream = ok ? fopencookie(cookie, "w", functions) : NULL;
+    if (!stream) {
+        if (cookie) {
+            cookie->file = NULL;
+            output_cookie_free(cookie);
+        }
+        if (path)
+            fclose(file);
+    }
+    return stream;
+}
+
+
+bool stream_compression_is_supported(StreamCompression compression) {
+    switch (compression) {
+        case StreamCompression_None:
+            return true;
+        case StreamCompression_Gzip:
+#ifdef HAVE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case StreamCompression_Zstd:
+#ifdef HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        default:
+            assert(false);
+            return false;
+    }
+}
+
+
+const char* stream_compression_to_string(StreamCompression compression) {
+    switch (compression) {
+        case StreamCompression_None:
+            return "none";
+        case StreamCompression_Gzip:
+            return "gzip";
+        case StreamCompression_Zstd:
+            return "zstd";
+        default:
+            assert(false);
+            return NULL;
+    }
+}
+
+
+bool input_init_compression(InputStream* stream) {
+    if (!stream_compression_is_supported(stream->compression)) {
+        char message[ERROR_MESSAGE_SIZE];
+        snprintf(message, sizeof(message), "%s input is not supported by this build",
+                 stream_compression_to_string(stream->compression));
+        set_error(stream, message);
+        return false;
+    }
+#ifdef HAVE_ZLIB
+    if (stream->compression == StreamCompression_Gzip) {
+        /* 32 added to window bits detects gzip and zlib headers */
+        if (inflateInit2(&stream->gzip, 15 + 32) != Z_OK) {
+            stream->compression = StreamCompression_None;
+            set_error(stream, "Failed to initialize gzip decompression");
+            return false;
+        }
+    }
+#endif
+#ifdef HAVE_ZSTD
+    if (stream->compression == StreamCompression_Zstd) {
+        stream->zstd = ZSTD_createDStream();
+        if (!stream->zstd || ZSTD_isError(ZSTD_initDStream(stream->zstd))) {
+            set_error(stream, "Failed to initialize zstd decompression");
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+
+void* input_thread(void* arg) {
+    InputStream* stream = arg;
+    while (true) {
+        /* Wait for a free block */
+        pthread_mutex_lock(&stream->mutex);
+        while (stream->filled_num == INPUT_BLOCK_NUM && !stream->is_closing)
+            pthread_cond_wait(&stream->cond, &stream->mutex);
+        bool is_closing = stream->is_closing;
+        int head = stream->head;
+        pthread_mutex_unlock(&stream->mutex);
+        if (is_closing)
+            break;
+
+        /* Fill it without lock, consumer only reads other blocks */
+        size_t len = stream->error[0] ? 0 : input_read_block(stream, stream->blocks[head]);
+
+        pthread_mutex_lock(&stream->mutex);
+        if (len > 0) {
+            stream->lens[head] = len;
+            stream->head = (head + 1) % INPUT_BLOCK_NUM;
+            ++stream->filled_num;
+        } else {
+            stream->is_end = true;
+        }
+        pthread_cond_broadcast(&stream->cond);
+        pthread_mutex_unlock(&stream->mutex);
+        if (len == 0)
+            break;
+    }
+    return NULL;
+}
+
+
+size_t input_read_block(InputStream* stream, char* block) {
+    /* Fills whole block unless input ends, 0 at end or on error */
+    switch (stream->compression) {
+#ifdef HAVE_ZLIB
+        case StreamCompression_Gzip:
+            return read_gzip(stream, block);
+#endif
+#ifdef HAVE_ZSTD
+        case StreamCompression_Zstd:
+            return read_zstd(stream, block);
+#endif
+        default:
+            return read_plain(stream, block);
+    }
+}
+
+
+size_t read_plain(InputStream* stream, char* block) {
+    /* Bytes read for magic detection first */
+    size_t len = stream->in_len - stream->in_pos;
+    memcpy(block, stream->in + stream->in_pos, len);
+    stream->in_pos = stream->in_len;
+
+    while (len < INPUT_BLOCK_SIZE && !stream->is_file_end) {
+        size_t bytes_read = fread(block + len, 1, INPUT_BLOCK_SIZE - len, stream->file);
+        len += bytes_read;
+        if (bytes_read == 0) {
+            stream->is_file_end = true;
+            if (ferror(stream->file))
+                set_error(stream, "Read error");
+        }
+    }
+    return len;
+}
+
+
+bool fill_in(InputStream* stream) {
+    /* Reads more compressed data when all is consumed, false at end of file */
+    if (stream->in_pos < stream->in_len)
+        return true;
+    stream->in_pos = 0;
+    stream->in_len = 0;
+    if (stream->is_file_end)
+        return false;
+    stream->in_len = fread(stream->in, 1, COMPRESSED_BUFFER_SIZE, stream->file);
+    if (stream->in_len == 0) {
+        stream->is_file_end = true;
+        if (ferror(stream->file))
+            set_error(stream, "Read error");
+        return false;
+    }
+    return true;
+}
+
+
+#ifdef HAVE_ZLIB
+
+size_t read_gzip(InputStream* stream, char* block) {
+    z_stream* gzip = &stream->gzip;
+    gzip->next_out = (Bytef*) block;
+    gzip->avail_out = INPUT_BLOCK_SIZE;
+    while (gzip->avail_out > 0) {
+        if (!fill_in(stream)) {
+            /* Complete stream ends after last member */
+            if (gzip->total_in > 0 && !stream->error[0])
+                set_error(stream, "Unexpected end of gzip data");
+            break;
+        }
+        gzip->next_in = stream->in + stream->in_pos;
+        gzip->avail_in = stream->in_len - stream->in_pos;
+        int status = inflate(gzip, Z_NO_FLUSH);
+        stream->in_pos = stream->in_len - gzip->avail_in;
+
+        if (status == Z_STREAM_END) {
+            /* Concatenated members are read as one stream */
+            inflateReset(gzip);
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            set_error(stream, gzip->msg ? gzip->msg : "Invalid gzip data");
+            break;
+        }
+    }
+    return INPUT_BLOCK_SIZE - gzip->avail_out;
+}
+
+#endif
+
+#ifdef HAVE_ZSTD
+
+size_t read_zstd(InputStream* stream, char* block) {
+    ZSTD_outBuffer out = {block, INPUT_BLOCK_SIZE, 0};
+    while (out.pos < out.size) {
+        if (!fill_in(stream)) {
+            if (stream->zstd_status != 0 && !stream->error[0])
+                set_error(stream, "Unexpected end of zstd data");
+            break;
+        }
+        ZSTD_inBuffer in = {stream->in, stream->in_len, stream->in_pos};
+        size_t status = ZSTD_decompressStream(stream->zstd, &out, &in);
+        stream->in_pos = in.pos;
+        if (ZSTD_isError(status)) {
+            set_error(stream, ZSTD_getErrorName(status));
+            break;
+        }
+        stream->zstd_status = status;
+    }
+    return out.pos;
+}
+
+#endif
+
+
+void set_error(InputStream* stream, const char* message) {
+    snprintf(stream->error, sizeof(stream->error), "%s", message);
+}
+
+
+void input_stream_free(InputStream* stream) {
+#ifdef HAVE_ZLIB
+    if (stream->compression == StreamCompression_Gzip)
+        inflateEnd(&stream->gzip);
+#endif
+#ifdef HAVE_ZSTD
+    if (stream->zstd)
+        ZSTD_freeDStream(stream->zstd);
+#endif
+    if (stream->file && stream->file != stdin)
+        fclose(stream->file);
+    for (int i = 0; i < INPUT_BLOCK_NUM; i++)
+        free(stream->blocks[i]);
+    free(stream->in);
+    free(stream);
+}
+
+
+ssize_t output_write(void* cookie, const char* data, size_t len) {
+    return output_compress(cookie, data, len, false) ? (ssize_t) len : -1;
+}
+
+
+int output_close(void* cookie) {
+    OutputCookie* output = cookie;
+    bool ok = output_compress(output, NULL, 0, true);
+    ok = (fclose(output->file) == 0) && ok;
+    output->file = NULL;
+    output_cookie_free(output);
+    return ok ? 0 : EOF;
+}
+
+
+bool output_compress(OutputCookie* cookie, const char* data, size_t len, bool is_end) {
+#ifdef HAVE_ZLIB
+    if (cookie->compression == StreamCompression_Gzip) {
+        z_stream* gzip = &cookie->gzip;
+        gzip->next_in = (Bytef*) data;
+        gzip->avail_in = len;
+        int status;
+        do {
+            gzip->next_out = cookie->out;
+            gzip->avail_out = COMPRESSED_BUFFER_SIZE;
+            status = deflate(gzip, is_end ? Z_FINISH : Z_NO_FLUSH);
+            if (status == Z_STREAM_ERROR)
+                return false;
+            size_t out_len = COMPRESSED_BUFFER_SIZE - gzip->avail_out;
+            if (fwrite(cookie->out, 1, out_len, cookie->file) != out_len)
+                return false;
+        } while (gzip->avail_out == 0 || (is_end && status != Z_STREAM_END));
+        return true;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    if (cookie->compression == StreamCompression_Zstd) {
+        ZSTD_inBuffer in = {data, len, 0};
+        size_t remaining;
+        do {
+            ZSTD_outBuffer out = {cookie->out, COMPRESSED_BUFFER_SIZE, 0};
+            remaining = is_end
+                ? ZSTD_endStream(cookie->zstd, &out)
+                : ZSTD_compressStream(cookie->zstd, &out, &in);
+            if (ZSTD_isError(remaining))
+                return false;
+            if (fwrite(cookie->out, 1, out.pos, cookie->file) != out.pos)
+                return false;
+        } while (is_end ? remaining > 0 : in.pos < in.size);
+        return true;
+    }
+#endif
+    return false;
+}
+
+
+void output_cookie_free(OutputCookie* cookie) {
+#ifdef HAVE_ZLIB
+    if (cookie->compression == StreamCompression_Gzip)
+        deflateEnd(&cookie->gzip);
+#endif
+#ifdef HAVE_ZSTD
+    if (cookie->zstd)
+        ZSTD_freeCStream(cookie->zstd);
+#endif
+    if (cookie->file && cookie->file != stdout)
+        fclose(cookie->file);
+    free(cookie->out);
+    free(cookie);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+  Input and output files of the command line tool. Gzip and zstd input is
+  recognized by its magic bytes and decompressed. Reading and decompression
+  run on a separate thread into a ring of large blocks, so they overlap with
+  parsing and splitting.
+ */
+
+typedef enum {
+    StreamCompression_None = 0,
+    StreamCompression_Gzip,
+    StreamCompression_Zstd
+} StreamCompression;
+
+typedef struct InputStream InputStream;
+
+/* Reads stdin if path is NULL, returns NULL if file can't be opened */
+InputStream* input_stream_open(const char* path);
+
+/* Next block of input, valid until next call. Returns false at end of input or on error */
+bool input_stream_next(InputStream* stream, const char** data, size_t* len);
+
+/* Set when reading stopped on error */
+const char* input_stream_error(const InputStream* stream);
+
+void input_stream_close(InputStream* stream);
+
+/* Compression by file name extension: `.gz', `.zst' */
+StreamCompression stream_compression_from_path(const char* path);
+
+/* Writing stream compressed as requested, closed with fclose. NULL on failure */
+FILE* output_stream_open(const char* path, StreamCompression compression);
+
+/* Compression is not available if the library was not found when building */
+bool stream_compression_is_supported(StreamCompression compression);
+
+const char* stream_compression_to_string(StreamCompression compression);
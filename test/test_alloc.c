@@ -0,0 +1,200 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/alloc.h>
+#include <split/h3.h>
+#include <split/parse.h>
+#include <split/split.h>
+
+/* Block header keeps allocated size, so sizes passed by the library can be checked */
+#define HEADER_SIZE (16)
+
+#define THREAD_NUM (4)
+#define THREAD_ALLOC_NUM (100000)
+
+typedef struct {
+    int64_t alloc_num;
+    int64_t live_num;
+    int64_t live_bytes;
+} Counters;
+
+static const char Input[] =
+    "MULTIPOLYGON (((170 10, -170 10, -170 -10, 170 -10, 170 10),"
+    " (175 5, 175 -5, 179 -5, 179 5, 175 5)),"
+    " ((10 10, 20 10, 20 20, 10 20, 10 10)))";
+
+static void* counting_malloc(size_t size, void* user_data);
+static void* counting_realloc(void* ptr, size_t old_size, size_t size, void* user_data);
+static void counting_free(void* ptr, size_t size, void* user_data);
+static void check_size(void* ptr, size_t size);
+
+static void parse_member(LinkedGeoPolygon* polygon, void* user_data);
+static void free_result(LinkedGeoPolygon* polygon, void* user_data);
+static void check_threads();
+static void* alloc_thread(void* arg);
+static void check(bool condition, const char* message);
+
+
+int main() {
+    Counters counters = {0};
+    SplitAllocator allocator = {
+        &counting_malloc, &counting_realloc, &counting_free, &counters
+    };
+    split_set_allocator(&allocator);
+    split_alloc_stats_enable(true);
+
+    /* Parse and split, members are split as they are parsed */
+    SplitContext* context = split_context_new();
+    check(context != NULL, "failed to allocate split context");
+
+    split_alloc_set_stage(SplitAllocStage_Parse);
+    WktParser* parser = wkt_parser_new(&parse_member, context);
+    check(parser != NULL, "failed to allocate parser");
+    check(wkt_parser_feed(parser, Input, strlen(Input)) == WktParseError_Ok, "failed to parse input");
+    check(wkt_parser_finish(parser) == WktParseError_Ok, "failed to finish parsing");
+    wkt_parser_free(parser);
+    split_alloc_set_stage(SplitAllocStage_Other);
+
+    split_context_free(context);
+    split_alloc_stats_enable(false);
+    split_set_allocator(NULL);
+
+    /* Everything allocated through the hooks was freed with matching sizes */
+    check(counters.alloc_num > 0, "custom allocator not used");
+    check(counters.live_num == 0, "blocks leaked");
+    check(counters.live_bytes == 0, "bytes leaked");
+
+    /* Stats agree with the allocator */
+    SplitAllocStats stats;
+    split_alloc_stats_get(&stats);
+    uint64_t alloc_num = 0;
+    uint64_t alloc_bytes = 0;
+    uint64_t free_bytes = 0;
+    for (int i = 0; i < SplitAllocStage_Num; ++i) {
+        alloc_num += stats.stages[i].alloc_num;
+        alloc_bytes += stats.stages[i].alloc_bytes;
+        free_bytes += stats.stages[i].free_bytes;
+    }
+    check(alloc_num == (uint64_t) counters.alloc_num, "allocation count mismatch");
+    check(alloc_bytes == free_bytes, "allocated and freed bytes differ");
+    check(stats.live_bytes == 0, "live bytes not zero");
+    check(stats.stages[SplitAllocStage_Parse].alloc_num > 0, "no parse stage allocations");
+    check(stats.stages[SplitAllocStage_Split].alloc_num > 0, "no split stage allocations");
+    check(stats.stages[SplitAllocStage_Split].peak_bytes <= stats.peak_bytes, "stage peak above total peak");
+
+    split_alloc_stats_reset();
+    split_alloc_stats_get(&stats);
+    check(stats.stages[SplitAllocStage_Parse].alloc_num == 0, "stats not reset");
+
+    check_threads();
+}
+
+
+void check_threads() {
+    /* Stats are exact with threads, stage is per thread */
+    split_alloc_stats_reset();
+    split_alloc_stats_enable(true);
+    pthread_t threads[THREAD_NUM];
+    for (int i = 0; i < THREAD_NUM; ++i)
+        check(pthread_create(&threads[i], NULL, &alloc_thread, NULL) == 0, "failed to start thread");
+    for (int i = 0; i < THREAD_NUM; ++i)
+        pthread_join(threads[i], NULL);
+    split_alloc_stats_enable(false);
+
+    SplitAllocStats stats;
+    split_alloc_stats_get(&stats);
+    const SplitAllocStageStats* split_stats = &stats.stages[SplitAllocStage_Split];
+    uint64_t alloc_num = 2 * THREAD_NUM * THREAD_ALLOC_NUM; /* realloc is counted as free and allocation */
+    check(split_stats->alloc_num == alloc_num, "thread allocation count mismatch");
+    check(split_stats->free_num == alloc_num, "thread free count mismatch");
+    check(split_stats->alloc_bytes == split_stats->free_bytes, "thread allocated and freed bytes differ");
+    check(stats.stages[SplitAllocStage_Other].alloc_num == 0, "thread stage leaked to other threads");
+    check(stats.live_bytes == 0, "live bytes not zero after threads");
+    check(split_alloc_get_stage() == SplitAllocStage_Other, "thread stage changed calling thread");
+}
+
+
+void* alloc_thread(void* arg) {
+    split_alloc_set_stage(SplitAllocStage_Split);
+    for (int i = 0; i < THREAD_ALLOC_NUM; ++i) {
+        size_t size = 16 + i % 256;
+        void* ptr = split_malloc(size);
+        check(ptr != NULL, "failed to allocate in thread");
+        ptr = split_realloc(ptr, size, size * 2);
+        check(ptr != NULL, "failed to reallocate in thread");
+        split_free(ptr, size * 2);
+    }
+    return NULL;
+}
+
+
+void* counting_malloc(size_t size, void* user_data) {
+    Counters* counters = user_data;
+    char* block = malloc(HEADER_SIZE + size);
+    if (!block)
+        return NULL;
+    memcpy(block, &size, sizeof(size));
+    ++counters->alloc_num;
+    ++counters->live_num;
+    counters->live_bytes += size;
+    return block + HEADER_SIZE;
+}
+
+
+void* counting_realloc(void* ptr, size_t old_size, size_t size, void* user_data) {
+    Counters* counters = user_data;
+    check_size(ptr, old_size);
+    char* block = realloc((char*) ptr - HEADER_SIZE, HEADER_SIZE + size);
+    if (!block)
+        return NULL;
+    memcpy(block, &size, sizeof(size));
+    counters->live_bytes += (int64_t) size - (int64_t) old_size;
+    return block + HEADER_SIZE;
+}
+
+
+void counting_free(void* ptr, size_t size, void* user_data) {
+    Counters* counters = user_data;
+    check_size(ptr, size);
+    --counters->live_num;
+    counters->live_bytes -= size;
+    free((char*) ptr - HEADER_SIZE);
+}
+
+
+void check_size(void* ptr, size_t size) {
+    size_t block_size;
+    memcpy(&block_size, (char*) ptr - HEADER_SIZE, sizeof(block_size));
+    if (block_size != size) {
+        printf("[fail] block of %zu bytes freed as %zu bytes\n", block_size, size);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void parse_member(LinkedGeoPolygon* polygon, void* user_data) {
+    SplitContext* context = user_data;
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Split);
+    check(split_context_by_180(context, polygon, &free_result, NULL), "failed to split polygon");
+    free_linked_geo_polygon(polygon);
+    split_alloc_set_stage(prev_stage);
+}
+
+
+void free_result(LinkedGeoPolygon* polygon, void* user_data) {
+    SplitAllocStage prev_stage = split_alloc_set_stage(SplitAllocStage_Output);
+    free_linked_geo_polygon(polygon);
+    split_alloc_set_stage(prev_stage);
+}
+
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        printf("[fail] %s\n", message);
+        exit(EXIT_FAILURE);
+    }
+}
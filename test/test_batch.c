@@ -0,0 +1,230 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../batch.h"
+
+/* Batch pipeline on input of several blocks, compared with transforming line by line */
+
+#define LINE_NUM (30000)
+#define LINE_SIZE_MAX (256)
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t size;
+} Text;
+
+static void make_input(Text* input, bool with_errors);
+static void make_expected(const Text* input, const SplitTransformOptions* options, Text* output, Text* error_lines);
+static bool is_blank(const char* line, size_t len);
+static void run_batch(
+    const Text* input, const SplitTransformOptions* options, int worker_num, ResultCache* cache,
+    Text* output, Text* error_lines, int* status);
+static void read_all(FILE* file, Text* text);
+static void check_text(const Text* text, const Text* expected, const char* name);
+static void text_append(Text* text, const char* data, size_t len);
+static void check(bool condition, const char* message);
+
+
+int main() {
+    SplitTransformOptions options = {0};
+    Text input = {0}, expected = {0}, expected_errors = {0}, output = {0}, errors = {0};
+    int status;
+
+    /*
+      Blank lines and failed lines are left empty, errors are numbered across
+      blocks and make the run fail
+     */
+    make_input(&input, true);
+    check(input.len > 3 * BATCH_BLOCK_SIZE, "input is not several blocks");
+    make_expected(&input, &options, &expected, &expected_errors);
+    check(expected_errors.len > 0, "input has no failing lines");
+    run_batch(&input, &options, 4, NULL, &output, &errors, &status);
+    check_text(&output, &expected, "output");
+    check_text(&errors, &expected_errors, "error lines");
+    check(status == EXIT_FAILURE, "batch with failed lines succeeded");
+    printf("failed lines: ok\n");
+
+    /* Same output with a cache, repeated lines are cache hits */
+    input.len = expected.len = expected_errors.len = 0;
+    make_input(&input, false);
+    make_expected(&input, &options, &expected, &expected_errors);
+    ResultCache* cache = result_cache_new(1024 * 1024, 0);
+    check(cache != NULL, "failed to allocate cache");
+    run_batch(&input, &options, 3, cache, &output, &errors, &status);
+    check_text(&output, &expected, "output");
+    check(errors.len == 0 && status == EXIT_SUCCESS, "batch failed");
+    ResultCacheStats stats;
+    result_cache_get_stats(cache, &stats);
+    check(stats.hit_num > 0, "no cache hits");
+    result_cache_free(cache);
+    printf("cached: ok\n");
+
+    free(input.data);
+    free(expected.data);
+    free(expected_errors.data);
+    free(output.data);
+    free(errors.data);
+}
+
+
+void make_input(Text* input, bool with_errors) {
+    /* Polygons crossing antimeridian with repeats, blank and whitespace lines; last line has no newline */
+    srand(1);
+    char line[LINE_SIZE_MAX];
+    for (int i = 1; i <= LINE_NUM; ++i) {
+        if (i % 101 == 0) {
+            line[0] = '\0';
+        } else if (i % 103 == 0) {
+            strcpy(line, " \t ");
+        } else if (with_errors && i % 211 == 0) {
+            strcpy(line, (i % 2) ? "POLYGON((170 10, -170 10" : "POLYGON((170 10, -170 x, -170 -10, 170 10))");
+        } else {
+            int lat = rand() % 60;
+            int west = 160 + rand() % 20;
+            int east = -160 - rand() % 20;
+            snprintf(line, sizeof(line), "POLYGON((%d %d, %d %d, %d %d, %d %d, %d %d))",
+                     west, lat, east, lat, east, lat - 20, west, lat - 20, west, lat);
+        }
+        text_append(input, line, strlen(line));
+        if (i < LINE_NUM)
+            text_append(input, "\n", 1);
+    }
+}
+
+
+void make_expected(const Text* input, const SplitTransformOptions* options, Text* output, Text* error_lines) {
+    /* Every input line has an output line, empty for blank and failed lines */
+    PrintBuffer out;
+    print_buffer_init(&out);
+    const char* cur = input->data;
+    const char* end = cur + input->len;
+    for (size_t line_num = 1; cur < end; ++line_num) {
+        const char* line_end = memchr(cur, '\n', end - cur);
+        if (!line_end)
+            line_end = end;
+        if (!is_blank(cur, line_end - cur)) {
+            SplitTransformResult result = split_transform(
+                cur, line_end - cur, SplitFormat_Wkt, SplitFormat_Wkt, options, &out);
+            if (result.error) {
+                char prefix[64];
+                snprintf(prefix, sizeof(prefix), "Line %zu:\n", line_num);
+                text_append(error_lines, prefix, strlen(prefix));
+            } else {
+                text_append(output, out.data, out.len);
+            }
+        }
+        text_append(output, "\n", 1);
+        cur = (line_end < end) ? line_end + 1 : end;
+    }
+    print_buffer_free(&out);
+}
+
+
+bool is_blank(const char* line, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (line[i] != ' ' && line[i] != '\t')
+            return false;
+    }
+    return true;
+}
+
+
+void run_batch(
+    const Text* input, const SplitTransformOptions* options, int worker_num, ResultCache* cache,
+    Text* output, Text* error_lines, int* status)
+{
+    /* Input is read from a file, stderr is captured to collect line numbers of errors */
+    char path[] = "/tmp/test_batch_XXXXXX";
+    int fd = mkstemp(path);
+    check(fd >= 0 && write(fd, input->data, input->len) == (ssize_t) input->len && close(fd) == 0,
+          "failed to write input");
+    InputStream* stream = input_stream_open(path);
+    check(stream != NULL, "failed to open input");
+    FILE* out = tmpfile();
+    FILE* err = tmpfile();
+    check(out != NULL && err != NULL, "failed to create output files");
+
+    fflush(stderr);
+    int saved_stderr = dup(STDERR_FILENO);
+    check(saved_stderr >= 0 && dup2(fileno(err), STDERR_FILENO) >= 0, "failed to redirect stderr");
+    *status = batch(stream, out, options, worker_num, cache);
+    fflush(stderr);
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stderr);
+    input_stream_close(stream);
+    remove(path);
+
+    output->len = 0;
+    read_all(out, output);
+    fclose(out);
+
+    /* Only `Line N:' of error messages, a parse error message may continue on next line */
+    Text errors = {0};
+    read_all(err, &errors);
+    fclose(err);
+    error_lines->len = 0;
+    const char* cur = errors.data;
+    const char* end = cur + errors.len;
+    while (cur < end) {
+        const char* line_end = memchr(cur, '\n', end - cur);
+        if (!line_end)
+            line_end = end;
+        const char* colon = memchr(cur, ':', line_end - cur);
+        if (colon && strncmp(cur, "Line ", 5) == 0) {
+            text_append(error_lines, cur, colon + 1 - cur);
+            text_append(error_lines, "\n", 1);
+        }
+        cur = (line_end < end) ? line_end + 1 : end;
+    }
+    free(errors.data);
+}
+
+
+void read_all(FILE* file, Text* text) {
+    check(fflush(file) == 0, "failed to flush output");
+    rewind(file);
+    char buffer[64 * 1024];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text_append(text, buffer, len);
+}
+
+
+void check_text(const Text* text, const Text* expected, const char* name) {
+    size_t pos = 0;
+    while (pos < text->len && pos < expected->len && text->data[pos] == expected->data[pos])
+        ++pos;
+    if (pos < text->len || pos < expected->len) {
+        size_t line_num = 1;
+        for (size_t i = 0; i < pos; ++i)
+            line_num += (expected->data[i] == '\n');
+        printf("[fail] %s differs at line %zu (%zu bytes, expected %zu)\n",
+               name, line_num, text->len, expected->len);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void text_append(Text* text, const char* data, size_t len) {
+    if (text->len + len > text->size) {
+        size_t size = (text->size > 0) ? text->size * 2 : 4096;
+        while (size < text->len + len)
+            size *= 2;
+        text->data = realloc(text->data, size);
+        check(text->data != NULL, "failed to allocate text");
+        text->size = size;
+    }
+    memcpy(text->data + text->len, data, len);
+    text->len += len;
+}
+
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        printf("[fail] %s\n", message);
+        exit(EXIT_FAILURE);
+    }
+}
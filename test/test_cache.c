@@ -0,0 +1,204 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../cache.h"
+
+/* Result cache: eviction, cache file round trip and damaged files */
+
+#define FINGERPRINT (12345)
+#define HEADER_SIZE (24)
+
+static size_t entry_overhead();
+static void put(ResultCache* cache, const char* input, const char* output);
+static void check_output(ResultCache* cache, const char* input, const char* expected);
+static void check_missing(ResultCache* cache, const char* input);
+static void check_stats(ResultCache* cache, size_t entry_num, uint64_t evict_num);
+static void append_output(const char* data, size_t len, void* user_data);
+static char* read_file(const char* path, size_t* len);
+static void write_file(const char* path, const char* data, size_t len);
+static void check(bool condition, const char* message);
+
+
+int main() {
+    char path[] = "/tmp/test_cache_XXXXXX";
+    int fd = mkstemp(path);
+    check(fd >= 0, "failed to create temporary file");
+    close(fd);
+
+    /* Least recently used entry is evicted, lookups count as use */
+    size_t overhead = entry_overhead();
+    size_t limit = 3 * (overhead + 4);
+    char* long_output = malloc(limit + 1);
+    check(long_output != NULL, "failed to allocate output");
+    memset(long_output, 'x', limit);
+    long_output[limit] = '\0';
+    ResultCache* cache = result_cache_new(limit, FINGERPRINT);
+    put(cache, "a1", "b1");
+    put(cache, "a2", "b2");
+    put(cache, "a3", "b3");
+    check_output(cache, "a1", "b1");
+    put(cache, "a4", "b4");
+    check_stats(cache, 3, 1);
+    check_missing(cache, "a2");
+    put(cache, "a5", "b5");
+    check_stats(cache, 3, 2);
+    check_missing(cache, "a3");
+    check_output(cache, "a1", "b1");
+    check_output(cache, "a4", "b4");
+    check_output(cache, "a5", "b5");
+
+    /* Output larger than the limit is not stored */
+    put(cache, "a6", long_output);
+    check_missing(cache, "a6");
+    check_stats(cache, 3, 2);
+
+    /* Round trip keeps entries and use order: a1, a4, a5 from least recently used */
+    check(result_cache_save(cache, path), "failed to save cache");
+    result_cache_free(cache);
+    cache = result_cache_new(limit, FINGERPRINT);
+    check(result_cache_load(cache, path), "failed to load cache");
+    check_stats(cache, 3, 0);
+    put(cache, "a7", "b7");
+    check_missing(cache, "a1");
+    check_output(cache, "a4", "b4");
+    check_output(cache, "a5", "b5");
+    check_output(cache, "a7", "b7");
+    result_cache_free(cache);
+
+    /* Other fingerprint or missing file is an empty cache */
+    cache = result_cache_new(1024, FINGERPRINT + 1);
+    check(result_cache_load(cache, path), "failed to load cache with other fingerprint");
+    check_stats(cache, 0, 0);
+    char missing_path[sizeof(path) + 8];
+    snprintf(missing_path, sizeof(missing_path), "%s.missing", path);
+    check(result_cache_load(cache, missing_path), "failed to load missing cache");
+    check_stats(cache, 0, 0);
+    result_cache_free(cache);
+
+    /* Entries larger than the limit of the loading cache are skipped */
+    cache = result_cache_new(1024, FINGERPRINT);
+    put(cache, "c1", "d1");
+    put(cache, "c2", long_output);
+    put(cache, "c3", "d3");
+    check(result_cache_save(cache, path), "failed to save cache");
+    result_cache_free(cache);
+    cache = result_cache_new(2 * (overhead + 4), FINGERPRINT);
+    check(result_cache_load(cache, path), "failed to load cache with smaller limit");
+    check_stats(cache, 2, 0);
+    check_output(cache, "c1", "d1");
+    check_missing(cache, "c2");
+    check_output(cache, "c3", "d3");
+    result_cache_free(cache);
+    free(long_output);
+
+    /* Truncated file */
+    size_t len;
+    char* data = read_file(path, &len);
+    write_file(path, data, len - 1);
+    cache = result_cache_new(1024, FINGERPRINT);
+    check(!result_cache_load(cache, path), "truncated cache loaded");
+    result_cache_free(cache);
+
+    /* Lengths past the end of file, also when their sum overflows */
+    uint64_t bad_lens[][2] = {{1000, 0}, {0, 1000}, {UINT64_MAX - 39, 0}, {UINT64_MAX / 2 + 1, UINT64_MAX / 2 + 1}};
+    for (size_t i = 0; i < sizeof(bad_lens) / sizeof(bad_lens[0]); ++i) {
+        char bad[HEADER_SIZE + sizeof(bad_lens[0]) + 4] = {0};
+        memcpy(bad, data, HEADER_SIZE);
+        memcpy(bad + HEADER_SIZE, bad_lens[i], sizeof(bad_lens[i]));
+        write_file(path, bad, sizeof(bad));
+        cache = result_cache_new(SIZE_MAX, FINGERPRINT);
+        check(!result_cache_load(cache, path), "cache with oversized entry loaded");
+        check_stats(cache, 0, 0);
+        result_cache_free(cache);
+    }
+    free(data);
+
+    remove(path);
+    printf("cache: ok\n");
+}
+
+
+size_t entry_overhead() {
+    /* Entry size is lengths plus the private entry header */
+    ResultCache* cache = result_cache_new(1024, FINGERPRINT);
+    put(cache, "a", "b");
+    ResultCacheStats stats;
+    result_cache_get_stats(cache, &stats);
+    result_cache_free(cache);
+    return stats.bytes - 2;
+}
+
+
+void put(ResultCache* cache, const char* input, const char* output) {
+    check(result_cache_put(cache, input, strlen(input), output, strlen(output)), "failed to put entry");
+}
+
+
+void check_output(ResultCache* cache, const char* input, const char* expected) {
+    char output[256] = {0};
+    if (!result_cache_get(cache, input, strlen(input), &append_output, output)) {
+        printf("[fail] %s not cached\n", input);
+        exit(EXIT_FAILURE);
+    }
+    if (strcmp(output, expected) != 0) {
+        printf("[fail] output of %s: %s, expected %s\n", input, output, expected);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void check_missing(ResultCache* cache, const char* input) {
+    char output[256] = {0};
+    if (result_cache_get(cache, input, strlen(input), &append_output, output)) {
+        printf("[fail] %s cached\n", input);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void check_stats(ResultCache* cache, size_t entry_num, uint64_t evict_num) {
+    ResultCacheStats stats;
+    result_cache_get_stats(cache, &stats);
+    if (stats.entry_num != entry_num || stats.evict_num != evict_num) {
+        printf("[fail] %zu entries, %llu evicted, expected %zu, %llu\n",
+            stats.entry_num, (unsigned long long) stats.evict_num, entry_num, (unsigned long long) evict_num);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void append_output(const char* data, size_t len, void* user_data) {
+    char* output = user_data;
+    check(len < 256, "output too long");
+    memcpy(output, data, len);
+    output[len] = '\0';
+}
+
+
+char* read_file(const char* path, size_t* len) {
+    FILE* file = fopen(path, "rb");
+    check(file != NULL, "failed to open cache file");
+    char* data = malloc(4096);
+    check(data != NULL, "failed to allocate file data");
+    *len = fread(data, 1, 4096, file);
+    check(*len > HEADER_SIZE && *len < 4096, "unexpected cache file size");
+    fclose(file);
+    return data;
+}
+
+
+void write_file(const char* path, const char* data, size_t len) {
+    FILE* file = fopen(path, "wb");
+    check(file != NULL && fwrite(data, 1, len, file) == len && fclose(file) == 0, "failed to write cache file");
+}
+
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        printf("[fail] %s\n", message);
+        exit(EXIT_FAILURE);
+    }
+}
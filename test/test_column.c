@@ -0,0 +1,207 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/column.h>
+#include <split/h3.h>
+#include <split/parse.h>
+#include <split/print.h>
+#include <split/transform.h>
+
+static const char* Inputs[] = {
+    "POLYGON((-170 10, 170 10, 170 -10, -170 -10, -170 10))",
+    "POLYGON((10 10, 20 10, 20 20, 10 10), (12 11, 18 11, 18 17, 12 11))",
+    "",
+    "MULTIPOLYGON(((10 10, 20 10, 20 20, 10 10)), ((-175 -5.5, 175 -5.5, 175 5.5, -175 5.5, -175 -5.5)))"
+};
+
+#define INPUT_NUM ((int) (sizeof(Inputs) / sizeof(Inputs[0])))
+
+static void check_column(CoordMode coord_mode);
+static void check_batch(CoordMode coord_mode);
+static void add_geometry(SplitContext* context, SplitColumn* column, const char* wkt, CoordMode coord_mode);
+static void check_geometry(const SplitColumnView* view, int i, const char* wkt, CoordMode coord_mode);
+static void* write_column(const SplitColumnView* view, size_t* len);
+static void check_open_error(const void* data, size_t len, SplitColumnError expected);
+
+
+int main() {
+    check_column(CoordMode_Double);
+    check_column(CoordMode_E7);
+    check_batch(CoordMode_Double);
+    check_batch(CoordMode_E7);
+}
+
+
+void check_column(CoordMode coord_mode) {
+    /* Split results of inputs, one geometry each */
+    SplitContext* context = split_context_new();
+    SplitColumn column;
+    if (!context || !split_column_init(&column, coord_mode)) {
+        printf("[fail] init\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < INPUT_NUM; i++)
+        add_geometry(context, &column, Inputs[i], coord_mode);
+    split_context_free(context);
+
+    /* File data is used in place */
+    SplitColumnView built = split_column_view(&column);
+    size_t len;
+    void* data = write_column(&built, &len);
+    SplitColumnView view;
+    SplitColumnError error = split_column_open(&view, data, len);
+    if (error || view.coord_mode != coord_mode || view.geom_num != INPUT_NUM
+        || view.coord_num != built.coord_num || view.polygon_num != built.polygon_num
+        || memcmp(view.coords, built.coords, built.coord_num * (coord_mode == CoordMode_E7 ? 8 : 16)) != 0
+        || memcmp(view.ring_offsets, built.ring_offsets, (built.ring_num + 1) * sizeof(int64_t)) != 0)
+    {
+        printf("[fail] read back: %s\n", split_column_error_to_string(error));
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < INPUT_NUM; i++)
+        check_geometry(&view, i, Inputs[i], coord_mode);
+
+    /* Damaged data */
+    check_open_error(data, len - 64, SplitColumnError_InvalidSize);
+    int64_t* geom_offsets = (int64_t*) view.geom_offsets;
+    geom_offsets[1] = 1000;
+    check_open_error(data, len, SplitColumnError_InvalidOffsets);
+    memcpy(data, "SPLITXXX", 8);
+    check_open_error(data, len, SplitColumnError_InvalidHeader);
+
+    free(data);
+    split_column_free(&column);
+    printf("%s column: ok\n", coord_mode == CoordMode_E7 ? "E7" : "double");
+}
+
+
+void check_batch(CoordMode coord_mode) {
+    /* Unsplit input geometries */
+    SplitColumn input;
+    SplitColumn output;
+    SplitContext* context = split_context_new();
+    if (!context || !split_column_init(&input, coord_mode) || !split_column_init(&output, coord_mode)) {
+        printf("[fail] init\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < INPUT_NUM; i++) {
+        WktParseResult result = wkt_parse_mode(Inputs[i], strlen(Inputs[i]), coord_mode);
+        for (LinkedGeoPolygon* polygon = result.object; polygon && !result.error; polygon = polygon->next)
+            split_column_add_polygon(&input, polygon);
+        if (result.object)
+            free_linked_geo_polygon(result.object);
+        split_column_end_geometry(&input);
+    }
+
+    /* Split in one call, results print as split_transform output */
+    SplitColumnView view = split_column_view(&input);
+    if (!split_by_180_batch(context, &view, &output)) {
+        printf("[fail] batch split\n");
+        exit(EXIT_FAILURE);
+    }
+    view = split_column_view(&output);
+    if (view.geom_num != INPUT_NUM) {
+        printf("[fail] batch split: %d geometries\n", (int) view.geom_num);
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < INPUT_NUM; i++)
+        check_geometry(&view, i, Inputs[i], coord_mode);
+
+    split_column_free(&input);
+    split_column_free(&output);
+    split_context_free(context);
+    printf("%s batch split: ok\n", coord_mode == CoordMode_E7 ? "E7" : "double");
+}
+
+
+void add_geometry(SplitContext* context, SplitColumn* column, const char* wkt, CoordMode coord_mode) {
+    WktParseResult result = wkt_parse_mode(wkt, strlen(wkt), coord_mode);
+    LinkedGeoPolygon* polygon = result.object;
+    if (result.error == WktParseError_TypeExpected && !*wkt) {
+        polygon = NULL; /* empty geometry */
+    } else if (result.error) {
+        printf("[fail] `%s': %s\n", wkt, wkt_parse_error_to_string(result.error));
+        exit(EXIT_FAILURE);
+    }
+
+    SplitTransformOptions options = {coord_mode};
+    if (polygon && !split_context_members(context, polygon, &options, &split_column_take_polygon, column)) {
+        printf("[fail] `%s': split failed\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    if (column->failed || !split_column_end_geometry(column)) {
+        printf("[fail] `%s': add failed\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void check_geometry(const SplitColumnView* view, int i, const char* wkt, CoordMode coord_mode) {
+    /* Geometry read back prints as split_transform output */
+    PrintBuffer expected;
+    print_buffer_init(&expected);
+    SplitTransformOptions options = {coord_mode};
+    if (*wkt)
+        split_transform(wkt, strlen(wkt), SplitFormat_Wkt, SplitFormat_Wkt, &options, &expected);
+
+    LinkedGeoPolygon* polygon;
+    if (!split_column_geometry(view, i, &polygon)) {
+        printf("[fail] `%s': geometry failed\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    PrintBuffer out;
+    print_buffer_init(&out);
+    if (polygon) {
+        PolygonPrinter printer;
+        polygon_printer_init(&printer);
+        printer.coord_mode = coord_mode;
+        printer.buffer = &out;
+        while (polygon) {
+            LinkedGeoPolygon* next = polygon->next;
+            polygon->next = NULL;
+            polygon_printer_add(&printer, polygon);
+            polygon = next;
+        }
+        polygon_printer_finish(&printer);
+    }
+
+    if (out.len != expected.len || memcmp(out.data, expected.data, out.len) != 0) {
+        printf("[fail] `%s': got `%.*s', expected `%.*s'\n",
+               wkt, (int) out.len, out.data, (int) expected.len, expected.data);
+        exit(EXIT_FAILURE);
+    }
+    print_buffer_free(&out);
+    print_buffer_free(&expected);
+}
+
+
+void* write_column(const SplitColumnView* view, size_t* len) {
+    FILE* file = tmpfile();
+    if (!file || !split_column_write(view, file)) {
+        printf("[fail] write\n");
+        exit(EXIT_FAILURE);
+    }
+    *len = ftell(file);
+    rewind(file);
+    void* data = malloc(*len);
+    if (!data || fread(data, 1, *len, file) != *len || *len % SPLIT_COLUMN_ALIGNMENT != 0) {
+        printf("[fail] read\n");
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    return data;
+}
+
+
+void check_open_error(const void* data, size_t len, SplitColumnError expected) {
+    SplitColumnView view;
+    SplitColumnError error = split_column_open(&view, data, len);
+    if (error != expected) {
+        printf("[fail] `%s' expected, got `%s'\n",
+               split_column_error_to_string(expected), split_column_error_to_string(error));
+        exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,69 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <split/crossing.h>
+
+#define SIGN(x) (((x) < 0) ? -1 : ((x) > 0) ? 1 : 0)
+#define ROUND_NUM (10000)
+
+static double random_lng();
+static void check_mask(const double* lngs, int num);
+
+
+int main() {
+    srand(1);
+
+    /* Random longitudes with zeros and antimeridian values mixed in, all block sizes */
+    double lngs[CROSSING_BLOCK_SIZE + 1];
+    for (int round = 0; round < ROUND_NUM; ++round) {
+        int num = round % (CROSSING_BLOCK_SIZE + 1);
+        for (int i = 0; i <= num; ++i)
+            lngs[i] = random_lng();
+        check_mask(lngs, num);
+    }
+
+    /* Edge values */
+    double edge[] = {0.0, -0.0, M_PI, -M_PI, 1e-300, -1e-300, M_PI_2, -M_PI_2, 0.0};
+    check_mask(edge, sizeof(edge) / sizeof(edge[0]) - 1);
+
+    printf("%d blocks checked\n", ROUND_NUM);
+}
+
+
+double random_lng() {
+    switch (rand() % 8) {
+        case 0: return 0.0;
+        case 1: return (rand() % 2) ? M_PI : -M_PI;
+        default: return M_PI * (2.0 * rand() / RAND_MAX - 1.0);
+    }
+}
+
+
+void check_mask(const double* lngs, int num) {
+    uint64_t prime_mask;
+    uint64_t mask = lng_crossing_mask(lngs, num, &prime_mask);
+
+    for (int i = 0; i < num; ++i) {
+        /* Same test as scalar antimeridian check */
+        bool crossed = SIGN(lngs[i]) != SIGN(lngs[i + 1]);
+        bool is_180 = crossed && fabs(lngs[i]) + fabs(lngs[i + 1]) > M_PI;
+        bool is_prime = crossed && !is_180;
+        if (((mask >> i) & 1) != is_180 || ((prime_mask >> i) & 1) != is_prime) {
+            printf("[fail] segment %d of %d (%.17g, %.17g): expected %s, got %s%s\n",
+                   i, num, lngs[i], lngs[i + 1],
+                   is_180 ? "antimeridian" : is_prime ? "prime" : "none",
+                   ((mask >> i) & 1) ? "antimeridian " : "",
+                   ((prime_mask >> i) & 1) ? "prime" : "");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if ((mask != 0) != lng_crossing_any(lngs, num)) {
+        printf("[fail] any crossing check doesn't match mask for %d segments\n", num);
+        exit(EXIT_FAILURE);
+    }
+    if (num < CROSSING_BLOCK_SIZE && ((mask | prime_mask) >> num) != 0) {
+        printf("[fail] bits set past %d segments\n", num);
+        exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,106 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/e7.h>
+#include <split/h3.h>
+#include <split/parse.h>
+
+static void check_parse(const char* str, bool ok, int32_t expected);
+static void check_format(int32_t value, const char* expected);
+static void check_round_trip(int32_t value);
+static void check_ring_closing();
+static void add_member(LinkedGeoPolygon* polygon, void* user_data);
+
+
+int main() {
+    check_parse("0", true, 0);
+    check_parse("-170", true, -1700000000);
+    check_parse("+1.5", true, 15000000);
+    check_parse("12.3456789", true, 123456789);
+    check_parse("0.00000005", true, 1);     /* rounded half away from zero */
+    check_parse("-0.00000005", true, -1);
+    check_parse("0.000000049999", true, 0);
+    check_parse("1.5e1", true, 150000000);  /* exponent falls back to strtod */
+    check_parse("180.", true, 1800000000);
+    check_parse("", false, 0);
+    check_parse(".", false, 0);
+    check_parse("1.2.3", false, 0);
+    check_parse("1x", false, 0);
+    check_parse("300", false, 0);           /* int32 overflow */
+
+    check_format(0, "0.0000000");
+    check_format(-1700000000, "-170.0000000");
+    check_format(-1, "-0.0000001");
+    check_format(123456789, "12.3456789");
+
+    int32_t values[] = {0, 1, -1, 123456789, -1799999999, 1800000000, -900000000, 899999999};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+        check_round_trip(values[i]);
+
+    check_ring_closing();
+}
+
+
+void check_parse(const char* str, bool ok, int32_t expected) {
+    int32_t value = 0;
+    bool result = e7_parse(str, strlen(str), &value);
+    if (result != ok || (ok && value != expected)) {
+        printf("[fail] `%s': expected %s %d, got %s %d\n",
+               str, ok ? "ok" : "error", expected, result ? "ok" : "error", value);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void check_format(int32_t value, const char* expected) {
+    char buffer[E7_FORMAT_SIZE];
+    e7_format(value, buffer);
+    if (strcmp(buffer, expected) != 0) {
+        printf("[fail] %d formatted as `%s', expected `%s'\n", value, buffer, expected);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void check_round_trip(int32_t value) {
+    int32_t result = e7_from_rads(e7_to_rads(value));
+    if (result != value) {
+        printf("[fail] %d converted to radians and back is %d\n", value, result);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void check_ring_closing() {
+    /* Closing point differs past 7th decimal place, only E7 mode treats it as the same */
+    const char wkt[] = "POLYGON((10 10, 20 10, 20 -10, 10.000000001 10))";
+
+    LinkedGeoPolygon* polygon = NULL;
+    WktParser* parser = wkt_parser_new(&add_member, &polygon);
+    wkt_parser_set_coord_mode(parser, CoordMode_E7);
+    if (wkt_parser_feed(parser, wkt, strlen(wkt)) || wkt_parser_finish(parser) || !polygon) {
+        printf("[fail] failed to parse `%s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    wkt_parser_free(parser);
+
+    int point_num = 0;
+    for (const LinkedLatLng* point = polygon->first->first; point != NULL; point = point->next)
+        ++point_num;
+    free_linked_geo_polygon(polygon);
+
+    if (point_num != 3) {
+        printf("[fail] `%s': 3 ring points expected, got %d\n", wkt, point_num);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void add_member(LinkedGeoPolygon* polygon, void* user_data) {
+    LinkedGeoPolygon** result = user_data;
+    if (*result)
+        free_linked_geo_polygon(*result);
+    *result = polygon;
+}
@@ -0,0 +1,118 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/h3.h>
+#include <split/parse.h>
+
+#define MEMBER_NUM (20000)
+
+static char* create_multi_polygon(size_t* len);
+static void check_parallel(const char* wkt, size_t len, const char* name);
+static bool polygon_eq(const LinkedGeoPolygon* p1, const LinkedGeoPolygon* p2);
+
+static const int ThreadNums[] = {2, 3, 4, 7, 16};
+
+
+int main() {
+    size_t len;
+    char* wkt = create_multi_polygon(&len);
+    check_parallel(wkt, len, "multipolygon");
+
+    /* Content after multipolygon data end is not parsed */
+    char* garbage = malloc(len + 1);
+    memcpy(garbage, wkt, len + 1);
+    char* member_end = strstr(garbage + len / 2, ")), ((");
+    member_end[2] = ')';
+    check_parallel(garbage, len, "data end in the middle");
+
+    /* Errors are reported at the same position, whichever chunk they are in */
+    const char bad_chars[] = {'x', '(', ')', ','};
+    for (size_t i = 0; i < sizeof(bad_chars); i++) {
+        for (size_t pos = len / 10; pos < len; pos += len / 5) {
+            memcpy(garbage, wkt, len + 1);
+            garbage[pos] = bad_chars[i];
+            char name[64];
+            snprintf(name, sizeof(name), "`%c' at %d", bad_chars[i], (int) pos);
+            check_parallel(garbage, len, name);
+        }
+    }
+    memcpy(garbage, wkt, len + 1);
+    check_parallel(garbage, len - 1, "unterminated");
+
+    free(garbage);
+    free(wkt);
+}
+
+
+char* create_multi_polygon(size_t* len) {
+    /* Members of different size, some with holes, some crossing antimeridian */
+    size_t size = MEMBER_NUM * 256;
+    char* wkt = malloc(size);
+    size_t pos = snprintf(wkt, size, "MULTIPOLYGON (");
+    for (int i = 0; i < MEMBER_NUM; i++) {
+        double lng = -179.0 + (i % 357);
+        double lat = -80.0 + (i % 160);
+        double d = (i % 3 == 0) ? 2.0 : 0.5;
+        pos += snprintf(wkt + pos, size - pos,
+            "%s((%.6f %.6f, %.6f %.6f, %.6f %.6f, %.6f %.6f, %.6f %.6f)",
+            i ? ", " : "", lng, lat, lng + d, lat, lng + d, lat + d, lng, lat + d, lng, lat);
+        if (i % 5 == 0) {
+            pos += snprintf(wkt + pos, size - pos, ",\n (%.6f %.6f, %.6f %.6f, %.6f %.6f)",
+                lng + 0.1, lat + 0.1, lng + 0.2, lat + 0.1, lng + 0.2, lat + 0.2);
+        }
+        pos += snprintf(wkt + pos, size - pos, ")");
+    }
+    pos += snprintf(wkt + pos, size - pos, ")");
+    *len = pos;
+    return wkt;
+}
+
+
+void check_parallel(const char* wkt, size_t len, const char* name) {
+    WktParseResult expected = wkt_parse(wkt, len);
+    for (size_t i = 0; i < sizeof(ThreadNums) / sizeof(ThreadNums[0]); i++) {
+        WktParseResult result = wkt_parse_parallel(wkt, len, CoordMode_Double, ThreadNums[i]);
+        if (result.error != expected.error || result.error_pos != expected.error_pos
+            || result.message != expected.message)
+        {
+            printf("[fail] %s, %d threads: `%s' at %d, `%s' at %d expected\n",
+                   name, ThreadNums[i],
+                   wkt_parse_error_to_string(result.error), (int) result.error_pos,
+                   wkt_parse_error_to_string(expected.error), (int) expected.error_pos);
+            exit(EXIT_FAILURE);
+        }
+        if (!expected.error && !polygon_eq(result.object, expected.object)) {
+            printf("[fail] %s, %d threads: result doesn't match\n", name, ThreadNums[i]);
+            exit(EXIT_FAILURE);
+        }
+        if (result.object)
+            free_linked_geo_polygon(result.object);
+    }
+    printf("%s: %s at %d, ok\n",
+           name, wkt_parse_error_to_string(expected.error), (int) expected.error_pos);
+    if (expected.object)
+        free_linked_geo_polygon(expected.object);
+}
+
+
+bool polygon_eq(const LinkedGeoPolygon* p1, const LinkedGeoPolygon* p2) {
+    for (; p1 && p2; p1 = p1->next, p2 = p2->next) {
+        const LinkedGeoLoop* l1 = p1->first;
+        const LinkedGeoLoop* l2 = p2->first;
+        for (; l1 && l2; l1 = l1->next, l2 = l2->next) {
+            const LinkedLatLng* v1 = l1->first;
+            const LinkedLatLng* v2 = l2->first;
+            for (; v1 && v2; v1 = v1->next, v2 = v2->next) {
+                if (v1->vertex.lat != v2->vertex.lat || v1->vertex.lng != v2->vertex.lng)
+                    return false;
+            }
+            if (v1 || v2)
+                return false;
+        }
+        if (l1 || l2)
+            return false;
+    }
+    return !p1 && !p2;
+}
@@ -0,0 +1,188 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/h3.h>
+#include <split/parse.h>
+
+typedef struct {
+    LinkedGeoPolygon* first;
+    LinkedGeoPolygon* last;
+} Members;
+
+static void add_member(LinkedGeoPolygon* polygon, void* user_data);
+static void check_stream(const char* wkt, size_t chunk_size);
+static void check_error(const char* wkt, WktParseError error);
+static void check_reset(const char* bad_wkt, const char* wkt);
+static bool polygon_eq(const LinkedGeoPolygon* p1, const LinkedGeoPolygon* p2);
+
+static const char MultiPolygon[] =
+    "MULTIPOLYGON (((-170 10, 170 10, 170 -10, -170 -10, -170 10),"
+    " (-175 5, 175 5, 175 -5, -175 -5, -175 5)),"
+    " ((-10 10, 10 10, 10 -10, -10 -10, -10 10)),\n"
+    " ((  1.5e1 2.25E+1,16 23 ,   17 24)) )";
+
+static const char Polygon[] =
+    "polygon((-170 10, 170 10, 170 -10, -170 -10, -170 10), (-175 5, 175 5, 175 -5, -175 -5))";
+
+
+int main() {
+    size_t chunk_sizes[] = {1, 2, 3, 7, 64, 4096};
+    for (size_t i = 0; i < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); ++i) {
+        check_stream(MultiPolygon, chunk_sizes[i]);
+        check_stream(Polygon, chunk_sizes[i]);
+    }
+    check_stream("MULTIPOLYGON()", 1);
+    check_stream("MULTIPOLYGON", 1);
+
+    check_error("", WktParseError_TypeExpected);
+    check_error("LINESTRING(1 1, 2 2)", WktParseError_InvalidType);
+    check_error("MULTIPOLYGON(((1 1, 2 2, 3 3))", WktParseError_RightParenExpected);
+    check_error("MULTIPOLYGON(((1 1, 2 2, 3 3)) ((1 1, 2 2, 3 3)))", WktParseError_CommaExpected);
+    check_error("MULTIPOLYGON(((1 1, 2 2, 3 3)),)", WktParseError_LeftParenExpected);
+    check_error("POLYGON((1 1, 2 2, 3 x))", WktParseError_InvalidNumber);
+    check_error("POLYGON((1 1, 2 2, 3 3)", WktParseError_RightParenExpected);
+
+    check_reset("POLYGON((1 1, 2 2, 3 x))", Polygon);
+    check_reset("MULTIPOLYGON(((1 1, 2 2, 3 3))", MultiPolygon);
+}
+
+
+void add_member(LinkedGeoPolygon* polygon, void* user_data) {
+    Members* members = user_data;
+    if (!members->first) {
+        members->first = polygon;
+    } else {
+        members->last->next = polygon;
+    }
+    members->last = polygon;
+}
+
+
+void check_stream(const char* wkt, size_t chunk_size) {
+    size_t len = strlen(wkt);
+
+    /* Parse whole data */
+    WktParseResult expected = wkt_parse(wkt, len);
+    if (expected.error) {
+        printf("[fail] failed to parse `%s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Parse by chunks */
+    Members members = {0};
+    WktParser* parser = wkt_parser_new(&add_member, &members);
+    WktParseError error = WktParseError_Ok;
+    for (size_t pos = 0; pos < len && !error; pos += chunk_size) {
+        size_t size = (len - pos < chunk_size) ? len - pos : chunk_size;
+        error = wkt_parser_feed(parser, wkt + pos, size);
+    }
+    if (!error)
+        error = wkt_parser_finish(parser);
+    wkt_parser_free(parser);
+
+    if (error) {
+        printf("[fail] `%s', chunk size %d: %s\n",
+               wkt, (int) chunk_size, wkt_parse_error_to_string(error));
+        exit(EXIT_FAILURE);
+    }
+
+    /* Empty data is parsed into empty polygon */
+    const LinkedGeoPolygon* expected_first = expected.object;
+    if (!expected_first->first && !expected_first->next)
+        expected_first = NULL;
+
+    if (!polygon_eq(members.first, expected_first)) {
+        printf("[fail] `%s', chunk size %d: result doesn't match\n", wkt, (int) chunk_size);
+        exit(EXIT_FAILURE);
+    }
+    printf("`%s', chunk size %d: ok\n", wkt, (int) chunk_size);
+
+    if (members.first)
+        free_linked_geo_polygon(members.first);
+    free_linked_geo_polygon(expected.object);
+}
+
+
+void check_error(const char* wkt, WktParseError expected) {
+    size_t len = strlen(wkt);
+    WktParseResult expected_result = wkt_parse(wkt, len);
+
+    Members members = {0};
+    WktParser* parser = wkt_parser_new(&add_member, &members);
+    WktParseError error = WktParseError_Ok;
+    for (size_t pos = 0; pos < len && !error; ++pos)
+        error = wkt_parser_feed(parser, wkt + pos, 1);
+    if (!error)
+        error = wkt_parser_finish(parser);
+    WktParseResult result = wkt_parser_result(parser);
+    wkt_parser_free(parser);
+
+    printf("`%s': %s at %d\n", wkt, wkt_parse_error_to_string(error), (int) result.error_pos);
+    if (error != expected || expected_result.error != expected) {
+        printf("[fail] `%s' expected\n", wkt_parse_error_to_string(expected));
+        exit(EXIT_FAILURE);
+    }
+    if (result.error_pos != expected_result.error_pos) {
+        printf("[fail] error position %d expected\n", (int) expected_result.error_pos);
+        exit(EXIT_FAILURE);
+    }
+
+    if (members.first)
+        free_linked_geo_polygon(members.first);
+}
+
+
+void check_reset(const char* bad_wkt, const char* wkt) {
+    /* Parser is reused after an error, as server workers do */
+    Members members = {0};
+    WktParser* parser = wkt_parser_new(&add_member, &members);
+    WktParseError error = wkt_parser_feed(parser, bad_wkt, strlen(bad_wkt));
+    if (!error)
+        error = wkt_parser_finish(parser);
+    if (!error) {
+        printf("[fail] `%s': error expected\n", bad_wkt);
+        exit(EXIT_FAILURE);
+    }
+    if (members.first)
+        free_linked_geo_polygon(members.first);
+    members = (Members){0};
+
+    wkt_parser_reset(parser);
+    error = wkt_parser_feed(parser, wkt, strlen(wkt));
+    if (!error)
+        error = wkt_parser_finish(parser);
+    wkt_parser_free(parser);
+
+    WktParseResult expected = wkt_parse(wkt, strlen(wkt));
+    if (error || !polygon_eq(members.first, expected.object)) {
+        printf("[fail] `%s' after reset: result doesn't match\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    printf("`%s' after reset: ok\n", wkt);
+
+    free_linked_geo_polygon(members.first);
+    free_linked_geo_polygon(expected.object);
+}
+
+
+bool polygon_eq(const LinkedGeoPolygon* p1, const LinkedGeoPolygon* p2) {
+    for (; p1 && p2; p1 = p1->next, p2 = p2->next) {
+        const LinkedGeoLoop* l1 = p1->first;
+        const LinkedGeoLoop* l2 = p2->first;
+        for (; l1 && l2; l1 = l1->next, l2 = l2->next) {
+            const LinkedLatLng* v1 = l1->first;
+            const LinkedLatLng* v2 = l2->first;
+            for (; v1 && v2; v1 = v1->next, v2 = v2->next) {
+                if (v1->vertex.lat != v2->vertex.lat || v1->vertex.lng != v2->vertex.lng)
+                    return false;
+            }
+            if (v1 || v2)
+                return false;
+        }
+        if (l1 || l2)
+            return false;
+    }
+    return !p1 && !p2;
+}
@@ -0,0 +1,117 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <split/predicates.h>
+#include <split/vect3.h>
+
+#define ROUND_NUM (100000)
+
+static double random_mantissa();
+static void random_vect3(Vect3* vect);
+static void check_orient3_degenerate();
+static void check_orient3_consistent();
+static void check_cross_dot();
+static void fail(const char* message, const Vect3* a, const Vect3* b, const Vect3* c);
+
+
+int main() {
+    srand(1);
+    check_orient3_degenerate();
+    check_orient3_consistent();
+    check_cross_dot();
+}
+
+
+double random_mantissa() {
+    /* 30 significant bits in [0.5, 1), so sums of two values are exact */
+    long bits = ((long) (rand() & 0x7fff) << 15) | (rand() & 0x7fff);
+    return ldexp((double) (bits | (1L << 29)), -30);
+}
+
+
+void random_vect3(Vect3* vect) {
+    vect->x = (rand() % 2) ? random_mantissa() : -random_mantissa();
+    vect->y = (rand() % 2) ? random_mantissa() : -random_mantissa();
+    vect->z = (rand() % 2) ? random_mantissa() : -random_mantissa();
+}
+
+
+void check_orient3_degenerate() {
+    /* c = a + b (exact) lies on the great circle of a and b */
+    int naive_wrong = 0;
+    for (int i = 0; i < ROUND_NUM; ++i) {
+        Vect3 a, b, c, normal;
+        random_vect3(&a);
+        random_vect3(&b);
+        c.x = a.x + b.x;
+        c.y = a.y + b.y;
+        c.z = a.z + b.z;
+
+        if (orient3(&a, &b, &c) != 0 || orient3(&c, &a, &b) != 0)
+            fail("coplanar vectors not detected", &a, &b, &c);
+
+        vect3_cross(&a, &b, &normal);
+        if (normal.x * c.x + normal.y * c.y + normal.z * c.z != 0)
+            ++naive_wrong;
+    }
+    printf("orient3: %d coplanar triples, naive evaluation nonzero for %d\n", ROUND_NUM, naive_wrong);
+}
+
+
+void check_orient3_consistent() {
+    /* Nearly coplanar triples, sign must not depend on argument order */
+    for (int i = 0; i < ROUND_NUM; ++i) {
+        Vect3 a, b, c;
+        random_vect3(&a);
+        random_vect3(&b);
+        c.x = a.x + b.x;
+        c.y = a.y + b.y;
+        c.z = nextafter(a.z + b.z, (rand() % 2) ? 2.0 : -2.0);
+
+        short sign = orient3(&a, &b, &c);
+        if (sign == 0)
+            fail("perturbed vector reported coplanar", &a, &b, &c);
+        if (orient3(&b, &c, &a) != sign || orient3(&c, &a, &b) != sign
+            || orient3(&b, &a, &c) != -sign || orient3(&a, &c, &b) != -sign)
+        {
+            fail("inconsistent orientation", &a, &b, &c);
+        }
+    }
+    printf("orient3: %d nearly coplanar triples consistent\n", ROUND_NUM);
+}
+
+
+void check_cross_dot() {
+    for (int i = 0; i < ROUND_NUM; ++i) {
+        Vect3 a, b, c;
+        random_vect3(&a);
+        random_vect3(&b);
+        random_vect3(&c);
+
+        /* (a x b) . (a x b) > 0 */
+        if (cross_dot_sign(&a, &b, &a, &b) != 1)
+            fail("cross product square is not positive", &a, &b, &c);
+
+        /* (a x b) . (c x c) == 0 */
+        if (cross_dot_sign(&a, &b, &c, &c) != 0)
+            fail("product with zero vector is not zero", &a, &b, &c);
+
+        /* Antisymmetric in both pairs, symmetric between pairs */
+        Vect3 d = {a.x + b.x, a.y + b.y, nextafter(a.z + b.z, 2.0)};
+        short sign = cross_dot_sign(&a, &b, &c, &d);
+        if (cross_dot_sign(&b, &a, &c, &d) != -sign || cross_dot_sign(&a, &b, &d, &c) != -sign
+            || cross_dot_sign(&c, &d, &a, &b) != sign)
+        {
+            fail("inconsistent cross product sign", &a, &b, &c);
+        }
+    }
+    printf("cross_dot_sign: %d cases consistent\n", ROUND_NUM);
+}
+
+
+void fail(const char* message, const Vect3* a, const Vect3* b, const Vect3* c) {
+    printf("[fail] %s: (%.17g, %.17g, %.17g), (%.17g, %.17g, %.17g), (%.17g, %.17g, %.17g)\n",
+           message, a->x, a->y, a->z, b->x, b->y, b->z, c->x, c->y, c->z);
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,140 @@
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <split/scan.h>
+
+#define RANDOM_TEXT_SIZE (4096)
+#define RANDOM_NUMBER_NUM (100000)
+
+static uint64_t next_random(uint64_t* state);
+static void check_classes();
+static void check_double(const char* str, bool fast_expected);
+static void check_random_doubles();
+
+/* Mostly WKT characters, some other bytes */
+static const char TextChars[] = "0123456789 ,.()+-eEnaMULTIPOLYGON\t\n\r\v\f#\x80\xff";
+
+
+int main() {
+    check_classes();
+
+    check_double("0", true);
+    check_double("-0", true);
+    check_double("12.5", true);
+    check_double("-179.9999999", true);
+    check_double(".5", true);
+    check_double("5.", true);
+    check_double("+1.5e1", true);
+    check_double("2.25E+1", true);
+    check_double("1e-22", true);
+    check_double("0.000000000000000000001", true);
+    check_double("9007199254740993", false); /* above 2^53 */
+    check_double("1e23", false);
+    check_double("12345678901234567890", false);
+    check_double("0x1A", false);
+    check_double("inf", false);
+    check_double("1e", false);
+    check_double("1.2.3", false);
+    check_double("-", false);
+    check_double(".", false);
+    check_double("", false);
+    check_random_doubles();
+}
+
+
+uint64_t next_random(uint64_t* state) {
+    /* splitmix64 */
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+void check_classes() {
+    /* Block scan matches byte by byte scan at every offset and length */
+    static char text[RANDOM_TEXT_SIZE];
+    uint64_t state = 1;
+    for (size_t i = 0; i < sizeof(text); i++) {
+        /* Runs of one character class, so block scan crosses block bounds */
+        size_t run = next_random(&state) % 40;
+        char c = TextChars[next_random(&state) % (sizeof(TextChars) - 1)];
+        for (; run > 0 && i < sizeof(text); run--, i++)
+            text[i] = (next_random(&state) % 8) ? c : TextChars[next_random(&state) % 10];
+        if (i < sizeof(text))
+            text[i] = ' ';
+    }
+
+    for (size_t start = 0; start < sizeof(text); start++) {
+        const char* data = text + start;
+        size_t len = (start * 7) % (sizeof(text) - start + 1);
+
+        size_t ws = 0;
+        while (ws < len && isspace((unsigned char) data[ws]))
+            ++ws;
+        size_t number = 0;
+        while (number < len && (isalnum((unsigned char) data[number]) || strchr("+-.", data[number])))
+            ++number;
+        size_t paren = 0;
+        while (paren < len && data[paren] != '(' && data[paren] != ')')
+            ++paren;
+        int depth = 0;
+        for (size_t i = 0; i < len; i++)
+            depth += (data[i] == '(') - (data[i] == ')');
+
+        if (scan_ws(data, len) != ws || scan_number(data, len) != number
+            || scan_paren(data, len) != paren || scan_depth(data, len) != depth)
+        {
+            printf("[fail] scan at %d, length %d\n", (int) start, (int) len);
+            exit(EXIT_FAILURE);
+        }
+    }
+    printf("classes: ok\n");
+}
+
+
+void check_double(const char* str, bool fast_expected) {
+    /* Exact when fast path is taken */
+    size_t len = strlen(str);
+    double value;
+    bool fast = scan_double(str, len, &value);
+    if (fast != fast_expected) {
+        printf("[fail] `%s': fast path %s expected\n", str, fast_expected ? "" : "not ");
+        exit(EXIT_FAILURE);
+    }
+    if (fast) {
+        double expected = strtod(str, NULL);
+        if (memcmp(&value, &expected, sizeof(double)) != 0) {
+            printf("[fail] `%s': %.17g, %.17g expected\n", str, value, expected);
+            exit(EXIT_FAILURE);
+        }
+    }
+    printf("`%s': ok\n", str);
+}
+
+
+void check_random_doubles() {
+    uint64_t state = 2;
+    int fast_num = 0;
+    for (int i = 0; i < RANDOM_NUMBER_NUM; i++) {
+        /* Coordinates with up to 17 significant digits */
+        char str[64];
+        int decimal_num = next_random(&state) % 15;
+        double value = ((double) (next_random(&state) >> 11) * 0x1.0p-53 - 0.5) * 360.0;
+        int len = snprintf(str, sizeof(str), "%.*f", decimal_num, value);
+
+        double result;
+        if (scan_double(str, len, &result)) {
+            double expected = strtod(str, NULL);
+            if (memcmp(&result, &expected, sizeof(double)) != 0) {
+                printf("[fail] `%s': %.17g, %.17g expected\n", str, result, expected);
+                exit(EXIT_FAILURE);
+            }
+            ++fast_num;
+        }
+    }
+    printf("random numbers: %d of %d parsed by fast path, ok\n", fast_num, RANDOM_NUMBER_NUM);
+}
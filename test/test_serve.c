@@ -0,0 +1,215 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../serve.h"
+
+/* Server mode on stdin/stdout, run in a child process connected with pipes */
+
+typedef struct {
+    pid_t pid;
+    int request_fd;  /* server stdin */
+    int response_fd; /* server stdout */
+} Server;
+
+static const char Input[] = "POLYGON((-170 10, 170 10, 170 -10, -170 -10, -170 10))";
+
+static const char Output[] =
+    "OK\n"
+    "MULTIPOLYGON(((-170.000000 10.000000, -180.000000 10.151082, -180.000000 -10.151082,"
+    " -170.000000 -10.000000, -170.000000 10.000000)), ((170.000000 10.000000, 170.000000 -10.000000,"
+    " 180.000000 -10.151082, 180.000000 10.151082, 170.000000 10.000000)))";
+
+static const char BandsOutput[] =
+    "OK\n"
+    "MULTIPOLYGON(((-170.0000000 10.0000000, -180.0000000 10.1510817, -180.0000000 0.0000000,"
+    " -170.0000000 0.0000000, -170.0000000 10.0000000)), ((-180.0000000 -10.1510817,"
+    " -170.0000000 -10.0000000, -170.0000000 0.0000000, -180.0000000 0.0000000,"
+    " -180.0000000 -10.1510817)), ((170.0000000 10.0000000, 170.0000000 0.0000000,"
+    " 180.0000000 0.0000000, 180.0000000 10.1510817, 170.0000000 10.0000000)),"
+    " ((170.0000000 -10.0000000, 180.0000000 -10.1510817, 180.0000000 0.0000000,"
+    " 170.0000000 0.0000000, 170.0000000 -10.0000000)))";
+
+static const char InvalidOptions[] = "ERR\nInvalid request options";
+
+static void start_server(Server* server);
+static void stop_server(Server* server);
+static void send_request(Server* server, const char* options, const char* wkt);
+static void send_frame(Server* server, const char* body, size_t len, size_t header_len);
+static char* read_response(Server* server);
+static void check_response(Server* server, const char* expected, bool is_prefix);
+static void check_closed(Server* server);
+static void write_data(int fd, const void* data, size_t len);
+static bool read_data(int fd, void* data, size_t len);
+static void check(bool condition, const char* message);
+
+
+int main() {
+    /* Requests are answered in order, errors don't close the connection */
+    Server server;
+    start_server(&server);
+    send_request(&server, "", Input);
+    check_response(&server, Output, false);
+    send_request(&server, "wkt e7 bands=0", Input);
+    check_response(&server, BandsOutput, false);
+    send_request(&server, "xml", Input);
+    check_response(&server, InvalidOptions, false);
+    send_request(&server, "bands=95", Input);
+    check_response(&server, InvalidOptions, false);
+    send_request(&server, "bands=", Input);
+    check_response(&server, InvalidOptions, false);
+    send_frame(&server, Input, strlen(Input), strlen(Input)); /* no option line */
+    check_response(&server, InvalidOptions, false);
+    send_request(&server, "", "POLYGON((-170 10, 170 10");
+    check_response(&server, "ERR\n(at ", true);
+    send_request(&server, "", Input);
+    check_response(&server, Output, false);
+    stop_server(&server);
+
+    /* Frame longer than the limit closes the connection */
+    start_server(&server);
+    send_frame(&server, "", 0, (size_t) SERVE_REQUEST_SIZE_MAX + 1);
+    check_response(&server, "ERR\nRequest is too large", false);
+    check_closed(&server);
+    stop_server(&server);
+
+    /* Input ending inside a frame */
+    start_server(&server);
+    send_frame(&server, "\nPOLY", 5, 100);
+    close(server.request_fd);
+    server.request_fd = -1;
+    check_response(&server, "ERR\nFailed to read request", false);
+    check_closed(&server);
+    stop_server(&server);
+
+    /* Partial frame header is an error too */
+    start_server(&server);
+    write_data(server.request_fd, "\0\0", 2);
+    close(server.request_fd);
+    server.request_fd = -1;
+    check_response(&server, "ERR\nFailed to read request", false);
+    stop_server(&server);
+
+    printf("serve: ok\n");
+}
+
+
+void start_server(Server* server) {
+    int request_pipe[2], response_pipe[2];
+    check(pipe(request_pipe) == 0 && pipe(response_pipe) == 0, "failed to create pipes");
+    fflush(stdout);
+    server->pid = fork();
+    check(server->pid >= 0, "failed to fork");
+    if (server->pid == 0) {
+        dup2(request_pipe[0], STDIN_FILENO);
+        dup2(response_pipe[1], STDOUT_FILENO);
+        close(request_pipe[0]);
+        close(request_pipe[1]);
+        close(response_pipe[0]);
+        close(response_pipe[1]);
+        exit(serve(NULL, 1));
+    }
+    close(request_pipe[0]);
+    close(response_pipe[1]);
+    server->request_fd = request_pipe[1];
+    server->response_fd = response_pipe[0];
+}
+
+
+void stop_server(Server* server) {
+    /* Server exits successfully at end of input */
+    if (server->request_fd >= 0)
+        close(server->request_fd);
+    int status;
+    check(waitpid(server->pid, &status, 0) == server->pid, "failed to wait for server");
+    check(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS, "server failed");
+    close(server->response_fd);
+}
+
+
+void send_request(Server* server, const char* options, const char* wkt) {
+    size_t options_len = strlen(options);
+    size_t wkt_len = strlen(wkt);
+    size_t len = options_len + 1 + wkt_len;
+    char* body = malloc(len);
+    check(body != NULL, "failed to allocate request");
+    memcpy(body, options, options_len);
+    body[options_len] = '\n';
+    memcpy(body + options_len + 1, wkt, wkt_len);
+    send_frame(server, body, len, len);
+    free(body);
+}
+
+
+void send_frame(Server* server, const char* body, size_t len, size_t header_len) {
+    /* Header length may differ from body length to make malformed frames */
+    unsigned char header[4] = {header_len >> 24, header_len >> 16, header_len >> 8, header_len};
+    write_data(server->request_fd, header, sizeof(header));
+    write_data(server->request_fd, body, len);
+}
+
+
+char* read_response(Server* server) {
+    /* Null-terminated response body */
+    unsigned char header[4];
+    check(read_data(server->response_fd, header, sizeof(header)), "no response");
+    size_t len = (size_t) header[0] << 24 | (size_t) header[1] << 16
+        | (size_t) header[2] << 8 | (size_t) header[3];
+    char* body = malloc(len + 1);
+    check(body != NULL, "failed to allocate response");
+    check(read_data(server->response_fd, body, len), "truncated response");
+    body[len] = '\0';
+    return body;
+}
+
+
+void check_response(Server* server, const char* expected, bool is_prefix) {
+    char* body = read_response(server);
+    bool ok = is_prefix
+        ? strncmp(body, expected, strlen(expected)) == 0
+        : strcmp(body, expected) == 0;
+    if (!ok) {
+        printf("[fail] response:\n%s\nexpected%s:\n%s\n", body, is_prefix ? " prefix" : "", expected);
+        exit(EXIT_FAILURE);
+    }
+    free(body);
+}
+
+
+void check_closed(Server* server) {
+    char c;
+    check(read(server->response_fd, &c, 1) == 0, "connection not closed after malformed frame");
+}
+
+
+void write_data(int fd, const void* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        check(n > 0, "failed to write request");
+        data = (const char*) data + n;
+        len -= n;
+    }
+}
+
+
+bool read_data(int fd, void* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = read(fd, data, len);
+        if (n <= 0)
+            return false;
+        data = (char*) data + n;
+        len -= n;
+    }
+    return true;
+}
+
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        printf("[fail] %s\n", message);
+        exit(EXIT_FAILURE);
+    }
+}
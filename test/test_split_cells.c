@@ -0,0 +1,145 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/h3.h>
+#include <split/parse.h>
+#include <split/split.h>
+#include <split/vect3.h>
+
+typedef struct {
+    int piece_num;
+    double area;
+    bool failed;
+} Pieces;
+
+static LinkedGeoPolygon* parse(const char* wkt);
+static void check_partition(const char* wkt);
+static void check_piece(LinkedGeoPolygon* polygon, H3Index cell, void* user_data);
+static double polygon_area(const LinkedGeoPolygon* polygon);
+static double ring_area(const LinkedGeoLoop* ring);
+
+
+int main() {
+    /* Small square, most likely in a single cell */
+    check_partition("POLYGON((10 10, 11 10, 11 11, 10 11, 10 10))");
+
+    /* Large square over cell edges and vertices */
+    check_partition("POLYGON((-30 -30, 50 -30, 50 40, -30 40, -30 -30))");
+
+    /* Hole */
+    check_partition(
+        "POLYGON((-30 -30, 50 -30, 50 40, -30 40, -30 -30), (0 0, 20 0, 20 20, 0 20, 0 0))");
+
+    /* Crossing antimeridian */
+    check_partition("POLYGON((120 -20, -120 -20, -120 20, 120 20, 120 -20))");
+
+    /* Around the north pole */
+    check_partition("POLYGON((0 40, 90 40, 180 40, -90 40, 0 40))");
+
+    /* Multipolygon */
+    check_partition(
+        "MULTIPOLYGON(((10 10, 11 10, 11 11, 10 11, 10 10)), ((100 -60, 120 -60, 120 -40, 100 -40, 100 -60)))");
+}
+
+
+LinkedGeoPolygon* parse(const char* wkt) {
+    WktParseResult result = wkt_parse(wkt, strlen(wkt));
+    if (result.error) {
+        printf("[fail] failed to parse `%s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    return result.object;
+}
+
+
+void check_partition(const char* wkt) {
+    LinkedGeoPolygon* polygon = parse(wkt);
+
+    /* Each piece is checked to be inside its cell, areas add up to the polygon area */
+    Pieces pieces = {0};
+    if (!split_by_base_cells_each(polygon, &check_piece, &pieces)) {
+        printf("[fail] failed to partition `%s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    double area = polygon_area(polygon);
+    if (pieces.failed || fabs(pieces.area - area) > 1e-9 * area) {
+        printf("[fail] `%s': %d pieces, area %.12f, expected %.12f\n",
+               wkt, pieces.piece_num, pieces.area, area);
+        exit(EXIT_FAILURE);
+    }
+    free_linked_geo_polygon(polygon);
+    printf("`%s': %d pieces\n", wkt, pieces.piece_num);
+}
+
+
+void check_piece(LinkedGeoPolygon* polygon, H3Index cell, void* user_data) {
+    Pieces* pieces = user_data;
+    ++pieces->piece_num;
+    pieces->area += polygon_area(polygon);
+
+    CellBoundary boundary;
+    if (cellToBoundary(cell, &boundary) != E_SUCCESS) {
+        printf("[fail] invalid cell %llx\n", (unsigned long long) cell);
+        pieces->failed = true;
+        free_linked_geo_polygon(polygon);
+        return;
+    }
+    Vect3 vertices[MAX_CELL_BNDRY_VERTS];
+    Vect3 center = {0};
+    for (int i = 0; i < boundary.numVerts; ++i) {
+        vect3_from_lat_lng(&boundary.verts[i], &vertices[i]);
+        vect3_sum(&center, &vertices[i], &center);
+    }
+
+    /* Piece vertices are on the cell side of every edge circle */
+    for (int i = 0; i < boundary.numVerts; ++i) {
+        Vect3 normal;
+        vect3_cross(&vertices[i], &vertices[(i + 1) % boundary.numVerts], &normal);
+        vect3_normalize(&normal);
+        if (normal.x * center.x + normal.y * center.y + normal.z * center.z < 0)
+            vect3_scale(&normal, -1);
+        for (const LinkedGeoLoop* ring = polygon->first; ring != NULL; ring = ring->next) {
+            for (const LinkedLatLng* point = ring->first; point != NULL; point = point->next) {
+                Vect3 vect;
+                vect3_from_lat_lng(&point->vertex, &vect);
+                if (vect3_dot(&normal, &vect) < -1e-12) {
+                    printf("[fail] piece vertex outside of cell %llx: %f %f\n",
+                           (unsigned long long) cell,
+                           radsToDegs(point->vertex.lng), radsToDegs(point->vertex.lat));
+                    pieces->failed = true;
+                }
+            }
+        }
+    }
+    free_linked_geo_polygon(polygon);
+}
+
+
+double polygon_area(const LinkedGeoPolygon* multi_polygon) {
+    double area = 0;
+    for (const LinkedGeoPolygon* polygon = multi_polygon; polygon != NULL; polygon = polygon->next) {
+        for (const LinkedGeoLoop* ring = polygon->first; ring != NULL; ring = ring->next)
+            area += (ring == polygon->first) ? ring_area(ring) : -ring_area(ring);
+    }
+    return area;
+}
+
+
+double ring_area(const LinkedGeoLoop* ring) {
+    /* Sum of signed triangle areas fanned from the first vertex */
+    Vect3 a, b, c, bc;
+    vect3_from_lat_lng(&ring->first->vertex, &a);
+    double area = 0;
+    for (const LinkedLatLng* cur = ring->first->next; cur && cur->next; cur = cur->next) {
+        vect3_from_lat_lng(&cur->vertex, &b);
+        vect3_from_lat_lng(&cur->next->vertex, &c);
+        vect3_cross(&b, &c, &bc);
+        area += 2 * atan2(
+            a.x * bc.x + a.y * bc.y + a.z * bc.z,
+            1 + vect3_dot(&a, &b) + vect3_dot(&b, &c) + vect3_dot(&c, &a));
+    }
+    return fabs(area);
+}
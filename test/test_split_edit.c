@@ -0,0 +1,376 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/h3.h>
+#include <split/split.h>
+#include <split/vect3.h>
+
+#define MAX_RING_NUM (4)
+#define MAX_VERTEX_NUM (1000)
+#define HOLE_VERTEX_NUM (12)
+#define EDIT_NUM (3000)
+
+/* Star-shaped polygon around a point on antimeridian, holes are small circles inside */
+typedef struct {
+    int ring_num;
+    int vertex_nums[MAX_RING_NUM];
+    LatLng rings[MAX_RING_NUM][MAX_VERTEX_NUM];
+    double angles[MAX_VERTEX_NUM]; /* outer ring vertex angles, increasing */
+    double hole_lngs[MAX_RING_NUM];
+} TestPolygon;
+
+typedef struct {
+    double area;
+    int ring_num;
+} Piece;
+
+static const double CenterLat = 0;
+static const double HoleLats[] = {2.5, 0, -2.5};
+
+static void init_polygon(TestPolygon* polygon, int vertex_num);
+static LatLng star_vertex(double angle);
+static void make_hole(LatLng* vertices, double lat, double lng, double min_radius);
+static void replace(
+    SplitEdit* edit, TestPolygon* polygon, int ring, int start, int remove_num,
+    const LatLng* vertices, int vertex_num);
+static void edit_outer(SplitEdit* edit, TestPolygon* polygon);
+static void edit_hole(SplitEdit* edit, TestPolygon* polygon);
+static void check_touching();
+static void check_edit(SplitEdit* edit, const TestPolygon* polygon, const LinkedGeoPolygon** kept, int* kept_num);
+static int changed_num(const SplitEdit* edit);
+static LinkedGeoPolygon* create_polygon(const TestPolygon* polygon);
+static int collect_pieces(const LinkedGeoPolygon* multi_polygon, Piece* pieces);
+static int piece_cmp(const void* a, const void* b);
+static double ring_area(const LinkedGeoLoop* ring);
+static double random_range(double min, double max);
+
+
+int main() {
+    srand(1);
+    static TestPolygon polygon;
+    init_polygon(&polygon, 200);
+    LinkedGeoPolygon* linked = create_polygon(&polygon);
+    SplitEdit* edit = split_edit_new(linked);
+    free_linked_geo_polygon(linked);
+    if (!edit) {
+        printf("[fail] split_edit_new\n");
+        exit(EXIT_FAILURE);
+    }
+    static const LinkedGeoPolygon* kept[MAX_VERTEX_NUM];
+    int kept_num = 0;
+    check_edit(edit, &polygon, kept, &kept_num);
+
+    /* Moving a vertex away from antimeridian only rebuilds its shell */
+    LatLng vertex = star_vertex(polygon.angles[100] + 0.001);
+    replace(edit, &polygon, 0, 100, 1, &vertex, 1);
+    check_edit(edit, &polygon, kept, &kept_num);
+    if (changed_num(edit) != 1) {
+        printf("[fail] local edit changed %d polygons\n", changed_num(edit));
+        exit(EXIT_FAILURE);
+    }
+
+    /* Invalid ranges */
+    if (split_edit_replace(edit, 0, 190, 20, NULL, 0)
+        || split_edit_replace(edit, MAX_RING_NUM, 0, 0, NULL, 0)
+        || split_edit_replace(edit, 1, 0, HOLE_VERTEX_NUM, NULL, 0))
+    {
+        printf("[fail] invalid range accepted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* Edit next to a vertex on antimeridian, intersections at the same point */
+    check_touching();
+
+    /* Random edits compared with split_by_180 */
+    for (int i = 0; i < EDIT_NUM; ++i) {
+        if (rand() % 5 == 0) {
+            edit_hole(edit, &polygon);
+        } else {
+            edit_outer(edit, &polygon);
+        }
+        check_edit(edit, &polygon, kept, &kept_num);
+    }
+
+    /* Polygon moved off antimeridian is not split, then moved back */
+    static TestPolygon moved;
+    LatLng* vertices = moved.rings[0];
+    for (int i = 0; i < 100; ++i) {
+        vertices[i].lat = degsToRads(6 * sin(2 * M_PI * i / 100));
+        vertices[i].lng = degsToRads(170 + 6 * cos(2 * M_PI * i / 100));
+    }
+    replace(edit, &polygon, 0, 0, polygon.vertex_nums[0], vertices, 100);
+    check_edit(edit, &polygon, kept, &kept_num);
+    init_polygon(&moved, 100);
+    replace(edit, &polygon, 0, 0, polygon.vertex_nums[0], moved.rings[0], moved.vertex_nums[0]);
+    memcpy(polygon.angles, moved.angles, sizeof(moved.angles));
+    check_edit(edit, &polygon, kept, &kept_num);
+
+    split_edit_free(edit);
+    printf("%d edits: ok\n", EDIT_NUM);
+}
+
+
+void init_polygon(TestPolygon* polygon, int vertex_num) {
+    polygon->ring_num = 1 + sizeof(HoleLats) / sizeof(HoleLats[0]);
+    polygon->vertex_nums[0] = vertex_num;
+    for (int i = 0; i < vertex_num; ++i) {
+        polygon->angles[i] = 2 * M_PI * (i + random_range(0, 0.9)) / vertex_num;
+        polygon->rings[0][i] = star_vertex(polygon->angles[i]);
+    }
+    for (int i = 1; i < polygon->ring_num; ++i) {
+        polygon->vertex_nums[i] = HOLE_VERTEX_NUM;
+        polygon->hole_lngs[i] = 180 + random_range(-2, 2);
+        make_hole(polygon->rings[i], HoleLats[i - 1], polygon->hole_lngs[i], 1);
+    }
+}
+
+
+LatLng star_vertex(double angle) {
+    /* Vertices are at least 6 degrees from the center, holes are within 4.2 */
+    double r = random_range(6, 10);
+    double lng = 180 + r * cos(angle);
+    if (lng > 180)
+        lng -= 360;
+    if (fabs(fabs(lng) - 180) < 0.3 && rand() % 4 == 0)
+        lng = 180; /* vertex on antimeridian */
+    LatLng vertex = {degsToRads(CenterLat + r * sin(angle)), degsToRads(lng)};
+    return vertex;
+}
+
+
+void make_hole(LatLng* vertices, double lat, double lng, double min_radius) {
+    /* Clockwise star of at most 1 degree radius */
+    for (int i = 0; i < HOLE_VERTEX_NUM; ++i) {
+        double angle = -2 * M_PI * i / HOLE_VERTEX_NUM;
+        double r = random_range(min_radius, 1);
+        double vertex_lng = lng + r * cos(angle);
+        if (vertex_lng > 180)
+            vertex_lng -= 360;
+        vertices[i].lat = degsToRads(lat + r * sin(angle));
+        vertices[i].lng = degsToRads(vertex_lng);
+    }
+}
+
+
+void replace(
+    SplitEdit* edit, TestPolygon* polygon, int ring, int start, int remove_num,
+    const LatLng* vertices, int vertex_num)
+{
+    LatLng* dst = polygon->rings[ring];
+    int num = polygon->vertex_nums[ring];
+    memmove(&dst[start + vertex_num], &dst[start + remove_num], (num - start - remove_num) * sizeof(LatLng));
+    memcpy(&dst[start], vertices, vertex_num * sizeof(LatLng));
+    polygon->vertex_nums[ring] = num - remove_num + vertex_num;
+
+    if (!split_edit_replace(edit, ring, start, remove_num, vertices, vertex_num)
+        || split_edit_ring_vertex_num(edit, ring) != polygon->vertex_nums[ring])
+    {
+        printf("[fail] replace %d, %d of ring %d\n", start, remove_num, ring);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void edit_outer(SplitEdit* edit, TestPolygon* polygon) {
+    /* New vertices at angles between the kept neighbours, at most 60 degrees apart */
+    int num = polygon->vertex_nums[0];
+    int start = rand() % num;
+    int remove_num = rand() % 8;
+    if (start + remove_num > num)
+        remove_num = num - start;
+    double prev = (start > 0) ? polygon->angles[start - 1] : polygon->angles[num - 1] - 2 * M_PI;
+    double next = (start + remove_num < num) ? polygon->angles[start + remove_num] : polygon->angles[0] + 2 * M_PI;
+    int vertex_num = rand() % 8;
+    int min_vertex_num = (int) ((next - prev) / (M_PI / 3));
+    if (vertex_num < min_vertex_num)
+        vertex_num = min_vertex_num;
+    if (num - remove_num + vertex_num < 40)
+        vertex_num = 40 - num + remove_num;
+    if (num - remove_num + vertex_num > MAX_VERTEX_NUM)
+        vertex_num = remove_num;
+
+    /* Angles keep increasing along the ring, within one turn */
+    LatLng vertices[MAX_VERTEX_NUM];
+    double angles[MAX_VERTEX_NUM];
+    for (int i = 0; i < vertex_num; ++i) {
+        angles[i] = prev + (next - prev) * (i + 1) / (vertex_num + 1);
+        vertices[i] = star_vertex(angles[i]);
+    }
+    replace(edit, polygon, 0, start, remove_num, vertices, vertex_num);
+    memmove(&polygon->angles[start + vertex_num], &polygon->angles[start + remove_num],
+            (num - start - remove_num) * sizeof(double));
+    memcpy(&polygon->angles[start], angles, vertex_num * sizeof(double));
+}
+
+
+void edit_hole(SplitEdit* edit, TestPolygon* polygon) {
+    /* Hole moved around, it may start or stop crossing antimeridian */
+    int ring = 1 + rand() % (polygon->ring_num - 1);
+    LatLng vertices[HOLE_VERTEX_NUM];
+    if (rand() % 2 == 0) {
+        polygon->hole_lngs[ring] = 180 + random_range(-2, 2);
+        make_hole(vertices, HoleLats[ring - 1], polygon->hole_lngs[ring], 1);
+        replace(edit, polygon, ring, 0, HOLE_VERTEX_NUM, vertices, HOLE_VERTEX_NUM);
+    } else {
+        /* Some vertices moved towards the center */
+        make_hole(vertices, HoleLats[ring - 1], polygon->hole_lngs[ring], 0.5);
+        int start = rand() % HOLE_VERTEX_NUM;
+        int num = 1 + rand() % (HOLE_VERTEX_NUM - start);
+        replace(edit, polygon, ring, start, num, &vertices[start], num);
+    }
+}
+
+
+void check_touching() {
+    /*
+      Star ring around a point on antimeridian with its east vertex moved onto
+      the line, both its segments cross the line at the vertex. Replacing the
+      vertex after it adds an intersection at the same point as a kept one.
+     */
+    static TestPolygon polygon;
+    polygon.ring_num = 1;
+    polygon.vertex_nums[0] = 40;
+    for (int i = 0; i < 40; ++i) {
+        double angle = 2 * M_PI * i / 40;
+        double lng = 180 + 8 * cos(angle);
+        if (lng > 180)
+            lng -= 360;
+        polygon.rings[0][i].lat = degsToRads(8 * sin(angle));
+        polygon.rings[0][i].lng = degsToRads(lng);
+    }
+    polygon.rings[0][0].lat = degsToRads(4);
+    polygon.rings[0][0].lng = M_PI;
+
+    LinkedGeoPolygon* linked = create_polygon(&polygon);
+    SplitEdit* edit = split_edit_new(linked);
+    free_linked_geo_polygon(linked);
+    static const LinkedGeoPolygon* kept[MAX_VERTEX_NUM];
+    int kept_num = 0;
+    check_edit(edit, &polygon, kept, &kept_num);
+
+    LatLng vertex = {degsToRads(-1), degsToRads(-172)};
+    replace(edit, &polygon, 0, 1, 1, &vertex, 1);
+    check_edit(edit, &polygon, kept, &kept_num);
+    split_edit_free(edit);
+}
+
+
+void check_edit(SplitEdit* edit, const TestPolygon* polygon, const LinkedGeoPolygon** kept, int* kept_num) {
+    /* Same pieces as split_by_180 */
+    static Piece expected[MAX_VERTEX_NUM];
+    static Piece pieces[MAX_VERTEX_NUM];
+    LinkedGeoPolygon* linked = create_polygon(polygon);
+    LinkedGeoPolygon* result = split_by_180(linked);
+    int expected_num = collect_pieces(result, expected);
+    free_linked_geo_polygon(linked);
+    free_linked_geo_polygon(result);
+
+    int piece_num = split_edit_polygon_num(edit);
+    static const LinkedGeoPolygon* polygons[MAX_VERTEX_NUM];
+    for (int i = 0; i < piece_num; ++i) {
+        polygons[i] = split_edit_polygon(edit, i);
+        if (!polygons[i]) {
+            printf("[fail] polygon %d not built\n", i);
+            exit(EXIT_FAILURE);
+        }
+        collect_pieces(polygons[i], &pieces[i]);
+
+        /* Unchanged polygons are the ones built before */
+        bool found = false;
+        for (int j = 0; j < *kept_num && !found; ++j)
+            found = (kept[j] == polygons[i]);
+        if (!split_edit_polygon_changed(edit, i) && !found) {
+            printf("[fail] unchanged polygon %d was rebuilt\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(kept, polygons, piece_num * sizeof(LinkedGeoPolygon*));
+    *kept_num = piece_num;
+
+    qsort(expected, expected_num, sizeof(Piece), &piece_cmp);
+    qsort(pieces, piece_num, sizeof(Piece), &piece_cmp);
+    bool ok = (piece_num == expected_num);
+    for (int i = 0; ok && i < piece_num; ++i) {
+        ok = fabs(pieces[i].area - expected[i].area) <= 1e-9 * expected[i].area + 1e-15
+            && pieces[i].ring_num == expected[i].ring_num;
+    }
+    if (!ok) {
+        printf("[fail] %d pieces, expected %d:\n", piece_num, expected_num);
+        for (int i = 0; i < piece_num || i < expected_num; ++i) {
+            printf("  %.12f %d | %.12f %d\n",
+                   (i < piece_num) ? pieces[i].area : 0, (i < piece_num) ? pieces[i].ring_num : 0,
+                   (i < expected_num) ? expected[i].area : 0, (i < expected_num) ? expected[i].ring_num : 0);
+        }
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+int changed_num(const SplitEdit* edit) {
+    int num = 0;
+    for (int i = 0; i < split_edit_polygon_num(edit); ++i)
+        num += split_edit_polygon_changed(edit, i) ? 1 : 0;
+    return num;
+}
+
+
+LinkedGeoPolygon* create_polygon(const TestPolygon* polygon) {
+    LinkedGeoPolygon* linked = calloc(1, sizeof(LinkedGeoPolygon));
+    for (int i = 0; i < polygon->ring_num; ++i) {
+        LinkedGeoLoop* ring = calloc(1, sizeof(LinkedGeoLoop));
+        add_linked_geo_loop(linked, ring);
+        for (int j = 0; j < polygon->vertex_nums[i]; ++j) {
+            LinkedLatLng* point = calloc(1, sizeof(LinkedLatLng));
+            point->vertex = polygon->rings[i][j];
+            add_linked_latlng(ring, point);
+        }
+    }
+    return linked;
+}
+
+
+int collect_pieces(const LinkedGeoPolygon* multi_polygon, Piece* pieces) {
+    int num = 0;
+    for (const LinkedGeoPolygon* polygon = multi_polygon; polygon != NULL; polygon = polygon->next) {
+        Piece* piece = &pieces[num++];
+        *piece = (Piece){0};
+        for (const LinkedGeoLoop* ring = polygon->first; ring != NULL; ring = ring->next) {
+            piece->area += (ring == polygon->first) ? ring_area(ring) : -ring_area(ring);
+            ++piece->ring_num;
+        }
+    }
+    return num;
+}
+
+
+int piece_cmp(const void* a, const void* b) {
+    const Piece* p1 = a;
+    const Piece* p2 = b;
+    return (p1->area < p2->area) ? -1 : (p1->area > p2->area) ? 1 : 0;
+}
+
+
+double ring_area(const LinkedGeoLoop* ring) {
+    /* Sum of signed triangle areas fanned from the first vertex */
+    Vect3 a, b, c, bc;
+    vect3_from_lat_lng(&ring->first->vertex, &a);
+    double area = 0;
+    for (const LinkedLatLng* cur = ring->first->next; cur && cur->next; cur = cur->next) {
+        vect3_from_lat_lng(&cur->vertex, &b);
+        vect3_from_lat_lng(&cur->next->vertex, &c);
+        vect3_cross(&b, &c, &bc);
+        area += 2 * atan2(
+            a.x * bc.x + a.y * bc.y + a.z * bc.z,
+            1 + vect3_dot(&a, &b) + vect3_dot(&b, &c) + vect3_dot(&c, &a));
+    }
+    return fabs(area);
+}
+
+
+double random_range(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
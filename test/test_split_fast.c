@@ -0,0 +1,155 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <h3/h3api.h>
+#include <split/h3.h>
+#include <split/split.h>
+
+#define POLYGON_NUM (2000)
+
+typedef struct {
+    LinkedGeoPolygon* first;
+    LinkedGeoPolygon* last;
+} Members;
+
+typedef enum {
+    SplitKind_180 = 0,
+    SplitKind_Parallel
+} SplitKind;
+
+static const double BandLat = 30.0;
+
+static LinkedGeoPolygon* create_random_polygon(SplitKind kind);
+static double random_range(double min, double max);
+static Members split_polygon(SplitContext* context, SplitKind kind, const LinkedGeoPolygon* polygon);
+static void check_kind(SplitKind kind);
+static void add_member(LinkedGeoPolygon* polygon, void* user_data);
+static void free_members(Members* members);
+static bool polygon_eq(const LinkedGeoPolygon* p1, const LinkedGeoPolygon* p2);
+
+
+int main() {
+    srand(1);
+
+    /* Fast path must produce exactly what the general path does */
+    check_kind(SplitKind_180);
+    check_kind(SplitKind_Parallel);
+}
+
+
+LinkedGeoPolygon* create_random_polygon(SplitKind kind) {
+    /* Star-shaped ring around a center near the split line */
+    double center_lat, center_lng;
+    if (kind == SplitKind_180) {
+        center_lat = random_range(-60, 60);
+        center_lng = 180 + random_range(-3, 3);
+    } else {
+        center_lat = BandLat + random_range(-3, 3);
+        center_lng = random_range(-160, 160);
+    }
+    double radius = random_range(0.5, 10);
+    int vertex_num = 3 + rand() % 62;
+
+    LinkedGeoPolygon* polygon = calloc(1, sizeof(LinkedGeoPolygon));
+    LinkedGeoLoop* ring = calloc(1, sizeof(LinkedGeoLoop));
+    add_linked_geo_loop(polygon, ring);
+    for (int i = 0; i < vertex_num; ++i) {
+        double angle = 2 * M_PI * (i + random_range(0, 0.9)) / vertex_num;
+        double r = radius * random_range(0.5, 1);
+        double lng = center_lng + r * cos(angle);
+        if (lng > 180) lng -= 360;
+        if (kind == SplitKind_180 && rand() % 50 == 0)
+            lng = 180; /* vertex on antimeridian, general path only */
+
+        LinkedLatLng* point = calloc(1, sizeof(LinkedLatLng));
+        point->vertex.lat = degsToRads(center_lat + r * sin(angle));
+        point->vertex.lng = degsToRads(lng);
+        add_linked_latlng(ring, point);
+    }
+    return polygon;
+}
+
+
+double random_range(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+
+Members split_polygon(SplitContext* context, SplitKind kind, const LinkedGeoPolygon* polygon) {
+    Members members = {0};
+    double lat = degsToRads(BandLat);
+    bool ok = (kind == SplitKind_180)
+        ? split_context_by_180(context, polygon, &add_member, &members)
+        : split_context_by_parallels(context, polygon, &lat, 1, &add_member, &members);
+    if (!ok) {
+        printf("[fail] failed to split polygon\n");
+        exit(EXIT_FAILURE);
+    }
+    return members;
+}
+
+
+void check_kind(SplitKind kind) {
+    SplitContext* fast = split_context_new();
+    SplitContext* general = split_context_new();
+    split_context_set_fast_path(general, false);
+
+    for (int i = 0; i < POLYGON_NUM; ++i) {
+        LinkedGeoPolygon* polygon = create_random_polygon(kind);
+        Members fast_result = split_polygon(fast, kind, polygon);
+        Members general_result = split_polygon(general, kind, polygon);
+        if (!polygon_eq(fast_result.first, general_result.first)) {
+            printf("[fail] %s split: fast and general path results differ for polygon %d\n",
+                   (kind == SplitKind_180) ? "antimeridian" : "parallel", i);
+            exit(EXIT_FAILURE);
+        }
+        free_members(&fast_result);
+        free_members(&general_result);
+        free_linked_geo_polygon(polygon);
+    }
+    printf("%s split: %d polygons match\n",
+           (kind == SplitKind_180) ? "antimeridian" : "parallel", POLYGON_NUM);
+
+    split_context_free(fast);
+    split_context_free(general);
+}
+
+
+void add_member(LinkedGeoPolygon* polygon, void* user_data) {
+    Members* members = user_data;
+    if (!members->first) {
+        members->first = polygon;
+    } else {
+        members->last->next = polygon;
+    }
+    members->last = polygon;
+}
+
+
+void free_members(Members* members) {
+    if (members->first)
+        free_linked_geo_polygon(members->first);
+    *members = (Members){0};
+}
+
+
+bool polygon_eq(const LinkedGeoPolygon* p1, const LinkedGeoPolygon* p2) {
+    for (; p1 && p2; p1 = p1->next, p2 = p2->next) {
+        const LinkedGeoLoop* l1 = p1->first;
+        const LinkedGeoLoop* l2 = p2->first;
+        for (; l1 && l2; l1 = l1->next, l2 = l2->next) {
+            const LinkedLatLng* v1 = l1->first;
+            const LinkedLatLng* v2 = l2->first;
+            for (; v1 && v2; v1 = v1->next, v2 = v2->next) {
+                if (v1->vertex.lat != v2->vertex.lat || v1->vertex.lng != v2->vertex.lng)
+                    return false;
+            }
+            if (v1 || v2)
+                return false;
+        }
+        if (l1 || l2)
+            return false;
+    }
+    return !p1 && !p2;
+}
@@ -0,0 +1,220 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/column.h>
+#include <split/h3.h>
+#include <split/parse.h>
+#include <split/split.h>
+
+static const char* Inputs[] = {
+    "POLYGON((-170 10, 170 10, 170 -10, -170 -10, -170 10))",
+    "POLYGON((10 10, 20 10, 20 20, 10 10), (12 11, 18 11, 18 17, 12 11))",
+    "",
+    "MULTIPOLYGON(((10 10, 20 10, 20 20, 10 10)), ((-175 -5.5, 175 -5.5, 175 5.5, -175 5.5, -175 -5.5)))",
+    /* Prime meridian and antimeridian */
+    "POLYGON((10 60, 100 60, -170 60, -80 60, 10 60))",
+    /* Vertex on antimeridian */
+    "POLYGON((0 60, 90 60, 180 60, -90 60, 0 60))",
+    /* Crossed hole, holes on both sides */
+    "POLYGON((160 -20, -160 -20, -160 20, 160 20, 160 -20), (170 -5, -170 -5, -170 5, 170 5, 170 -5),"
+    " (165 -15, 168 -15, 168 -12, 165 -15), (-165 12, -162 12, -162 15, -165 12))",
+    /* Crossed four times */
+    "POLYGON((170 -10, -170 -10, 170 0, -170 10, 170 10, 170 -10))"
+};
+
+#define INPUT_NUM ((int) (sizeof(Inputs) / sizeof(Inputs[0])))
+
+/* Star polygon vertex number, more than a buffer of the large split state */
+#define STAR_VERTEX_NUM (6000)
+#define HOLE_VERTEX_NUM (64)
+
+static void check_large(CoordMode coord_mode);
+static void check_errors();
+static void add_input(SplitColumn* column, const char* wkt, CoordMode coord_mode);
+static char* star_wkt();
+static int print_circle(char* out, double lng, double lat, double radius, int vertex_num);
+static void* read_file(FILE* file, size_t* len);
+
+
+int main() {
+    check_large(CoordMode_Double);
+    check_large(CoordMode_E7);
+    check_errors();
+}
+
+
+void check_large(CoordMode coord_mode) {
+    SplitColumn input;
+    SplitColumn output;
+    SplitContext* context = split_context_new();
+    SplitLarge* large = split_large_new(NULL);
+    if (!context || !large || !split_column_init(&input, coord_mode) || !split_column_init(&output, coord_mode)) {
+        printf("[fail] init\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < INPUT_NUM; i++)
+        add_input(&input, Inputs[i], coord_mode);
+    char* star = star_wkt();
+    add_input(&input, star, coord_mode);
+    free(star);
+
+    /* Expected: batch split by the general algorithm */
+    split_context_set_fast_path(context, false);
+    SplitColumnView view = split_column_view(&input);
+    if (!split_by_180_batch(context, &view, &output)) {
+        printf("[fail] batch split\n");
+        exit(EXIT_FAILURE);
+    }
+    FILE* file = tmpfile();
+    SplitColumnView expected_view = split_column_view(&output);
+    if (!file || !split_column_write(&expected_view, file)) {
+        printf("[fail] write\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t expected_len;
+    void* expected = read_file(file, &expected_len);
+
+    /* Out-of-core split writes the same file */
+    SplitColumnFile column_file;
+    file = tmpfile();
+    if (!file || !split_column_file_init(&column_file, file, coord_mode)) {
+        printf("[fail] column file init\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!split_by_180_large(large, &view, &column_file) || !split_column_file_finish(&column_file)) {
+        printf("[fail] large split\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t len;
+    void* data = read_file(file, &len);
+    if (len != expected_len || memcmp(data, expected, len) != 0) {
+        printf("[fail] large split: %d bytes differ from batch split, %d bytes\n", (int) len, (int) expected_len);
+        exit(EXIT_FAILURE);
+    }
+    SplitColumnView result;
+    SplitColumnError error = split_column_open(&result, data, len);
+    if (error || result.geom_num != INPUT_NUM + 1) {
+        printf("[fail] large split read back: %s\n", split_column_error_to_string(error));
+        exit(EXIT_FAILURE);
+    }
+
+    free(data);
+    free(expected);
+    split_column_file_free(&column_file);
+    split_column_free(&input);
+    split_column_free(&output);
+    split_large_free(large);
+    split_context_free(context);
+    printf("%s large split: ok, %d polygons\n", coord_mode == CoordMode_E7 ? "E7" : "double", (int) result.polygon_num);
+}
+
+
+void check_errors() {
+    SplitLarge* large = split_large_new(NULL);
+    if (!large) {
+        printf("[fail] init\n");
+        exit(EXIT_FAILURE);
+    }
+    SplitColumnFile column_file;
+    FILE* file = tmpfile();
+    if (!file || !split_column_file_init(&column_file, file, CoordMode_Double)) {
+        printf("[fail] column file init\n");
+        exit(EXIT_FAILURE);
+    }
+    SplitPointWriter writer = split_column_file_writer(&column_file);
+
+    /* Empty ring, vertices after last ring */
+    LatLng vertex = {0, 0};
+    if (split_large_end_ring(large) || split_large_by_180(large, &writer)) {
+        printf("[fail] empty ring accepted\n");
+        exit(EXIT_FAILURE);
+    }
+    if (!split_large_add_vertex(large, &vertex) || split_large_by_180(large, &writer)) {
+        printf("[fail] unfinished ring accepted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* State is cleared after failure */
+    LatLng vertices[3] = {{0, degsToRads(170)}, {0, degsToRads(-170)}, {degsToRads(10), degsToRads(-170)}};
+    for (int i = 0; i < 3; i++)
+        split_large_add_vertex(large, &vertices[i]);
+    if (!split_large_end_ring(large) || !split_large_by_180(large, &writer)
+        || column_file.polygon_offsets.len != 3)
+    {
+        printf("[fail] split after failure\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fclose(file);
+    split_column_file_free(&column_file);
+    split_large_free(large);
+    printf("errors: ok\n");
+}
+
+
+void add_input(SplitColumn* column, const char* wkt, CoordMode coord_mode) {
+    WktParseResult result = wkt_parse_mode(wkt, strlen(wkt), coord_mode);
+    if (result.error && *wkt) {
+        printf("[fail] failed to parse `%.64s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    for (LinkedGeoPolygon* polygon = result.object; polygon && !result.error; polygon = polygon->next)
+        split_column_add_polygon(column, polygon);
+    if (result.object)
+        free_linked_geo_polygon(result.object);
+    split_column_end_geometry(column);
+}
+
+
+char* star_wkt() {
+    /* Star centered west of antimeridian, three arms cross it */
+    char* wkt = malloc((STAR_VERTEX_NUM + 4 * HOLE_VERTEX_NUM) * 64);
+    if (!wkt) {
+        printf("[fail] allocation\n");
+        exit(EXIT_FAILURE);
+    }
+    int len = sprintf(wkt, "POLYGON((");
+    for (int i = 0; i < STAR_VERTEX_NUM; i++) {
+        double angle = 2 * M_PI * i / STAR_VERTEX_NUM;
+        double radius = 6.5 + 3.5 * cos(9 * angle);
+        double lng = 175 + radius * cos(angle);
+        len += sprintf(wkt + len, "%s%.9f %.9f", i ? ", " : "", (lng > 180) ? lng - 360 : lng, radius * sin(angle));
+    }
+
+    /* Crossed hole and holes on both sides */
+    len += sprintf(wkt + len, ")");
+    len += print_circle(wkt + len, 180, 0, 0.8, HOLE_VERTEX_NUM);
+    len += print_circle(wkt + len, 175, 0, 1, HOLE_VERTEX_NUM);
+    len += print_circle(wkt + len, 182.5, 0, 0.4, HOLE_VERTEX_NUM);
+    sprintf(wkt + len, ")");
+    return wkt;
+}
+
+
+int print_circle(char* out, double lng, double lat, double radius, int vertex_num) {
+    int len = sprintf(out, ", (");
+    for (int i = 0; i < vertex_num; i++) {
+        double angle = 2 * M_PI * i / vertex_num;
+        double point_lng = lng + radius * cos(angle);
+        len += sprintf(out + len, "%s%.9f %.9f",
+                       i ? ", " : "", (point_lng > 180) ? point_lng - 360 : point_lng, lat + radius * sin(angle));
+    }
+    return len + sprintf(out + len, ")");
+}
+
+
+void* read_file(FILE* file, size_t* len) {
+    *len = ftell(file);
+    rewind(file);
+    void* data = malloc(*len);
+    if (!data || fread(data, 1, *len, file) != *len) {
+        printf("[fail] read\n");
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    return data;
+}
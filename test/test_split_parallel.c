@@ -0,0 +1,200 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/h3.h>
+#include <split/parse.h>
+#include <split/split.h>
+#include <split/vect3.h>
+#include "print.h"
+
+/* Great circle arcs between points on a parallel stray from it by about this much (degrees) */
+#define BAND_TOLERANCE (0.002)
+
+static LinkedGeoPolygon* parse(const char* wkt);
+static void check_split(const char* wkt, double lat_deg, int polygon_num);
+static void check_bands(const char* wkt, const double* lats_deg, int lat_num, int polygon_num);
+static int find_band(const LinkedGeoPolygon* polygon, const double* lats_deg, int lat_num);
+static bool check_band_lat(double lat, const double* lats_deg, int lat_num, int band);
+
+
+int main() {
+    /* Square crossed by equator */
+    check_split("POLYGON((10 10, 20 10, 20 -10, 10 -10, 10 10))", 0, 2);
+
+    /* O-shaped polygon, hole crossed */
+    check_split(
+        "POLYGON((10 10, 20 10, 20 -10, 10 -10, 10 10), (12 5, 18 5, 18 -5, 12 -5, 12 5))",
+        0, 2);
+
+    /* U-shaped polygon, two arms north of the parallel */
+    check_split(
+        "POLYGON((10 10, 12 10, 12 -5, 18 -5, 18 10, 20 10, 20 -10, 10 -10, 10 10))",
+        0, 3);
+
+    /* Both vertices of wide segments are south of the parallel, arcs bulge across */
+    check_split("POLYGON((-85 50, 85 50, 85 45, -85 45, -85 50))", 60, 3);
+
+    /* Ring starts on the parallel */
+    check_split("POLYGON((10 0, 20 10, 20 -10, 10 -10, 10 0))", 0, 2);
+
+    /* Not crossed */
+    check_split("POLYGON((10 10, 20 10, 20 5, 10 5, 10 10))", 0, 1);
+
+    /* Cut edges span most of the parallel, they must not take the short way across antimeridian */
+    static const char wide[] =
+        "POLYGON((-170 10, -85 10, 0 10, 85 10, 170 10, 170 50, 85 50, 0 50, -85 50, -170 50, -170 10))";
+    static const double band_30[] = {30};
+    static const double bands_20_30_40[] = {20, 30, 40};
+    check_bands(wide, band_30, 1, 2);
+    check_bands(wide, bands_20_30_40, 3, 4);
+
+    /* Southern hemisphere */
+    static const double band_s30[] = {-30};
+    check_bands(
+        "POLYGON((-170 -10, -170 -50, -85 -50, 0 -50, 85 -50, 170 -50, 170 -10, 85 -10, 0 -10, -85 -10, -170 -10))",
+        band_s30, 1, 2);
+
+    /* Crossed hole, general path */
+    check_bands(
+        "POLYGON((-170 10, -85 10, 0 10, 85 10, 170 10, 170 50, 85 50, 0 50, -85 50, -170 50, -170 10),"
+        " (-160 20, -160 40, -80 40, 0 40, 80 40, 160 40, 160 20, 80 20, 0 20, -80 20, -160 20))",
+        band_30, 1, 2);
+}
+
+
+LinkedGeoPolygon* parse(const char* wkt) {
+    WktParseResult result = wkt_parse(wkt, strlen(wkt));
+    if (result.error) {
+        printf("[fail] failed to parse `%s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+    return result.object;
+}
+
+
+void check_split(const char* wkt, double lat_deg, int polygon_num) {
+    LinkedGeoPolygon* polygon = parse(wkt);
+    double lat = degsToRads(lat_deg);
+
+    LinkedGeoPolygon* result = split_by_parallels(polygon, &lat, 1);
+    if (!result) {
+        printf("[fail] failed to split `%s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Count result polygons, check that each polygon is on one side of the parallel */
+    int num = 0;
+    bool failed = false;
+    for (const LinkedGeoPolygon* cur = result; cur != NULL; cur = cur->next) {
+        ++num;
+        short side = 0;
+        for (const LinkedLatLng* point = cur->first->first; point != NULL; point = point->next) {
+            double diff = point->vertex.lat - lat;
+            short point_side = (diff < -1e-12) ? -1 : (diff > 1e-12) ? 1 : 0;
+            if (point_side == 0)
+                continue;
+            if (side != 0 && point_side != side) {
+                printf("[fail] polygon crosses the parallel: ");
+                print_latlng(&point->vertex);
+                print_nl();
+                failed = true;
+            }
+            side = point_side;
+        }
+    }
+    if (num != polygon_num) {
+        printf("[fail] %d polygons expected, got %d\n", polygon_num, num);
+        failed = true;
+    }
+
+    printf("%s split by %f: %d polygons\n", wkt, lat_deg, num);
+
+    free_linked_geo_polygon(result);
+    free_linked_geo_polygon(polygon);
+
+    if (failed)
+        exit(EXIT_FAILURE);
+}
+
+
+void check_bands(const char* wkt, const double* lats_deg, int lat_num, int polygon_num) {
+    LinkedGeoPolygon* polygon = parse(wkt);
+    double lats[8];
+    for (int i = 0; i < lat_num; ++i)
+        lats[i] = degsToRads(lats_deg[i]);
+
+    LinkedGeoPolygon* result = split_by_parallels(polygon, lats, lat_num);
+    if (!result) {
+        printf("[fail] failed to split `%s'\n", wkt);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Each vertex and edge midpoint of a result polygon is in the band of the polygon */
+    int num = 0;
+    bool failed = false;
+    for (const LinkedGeoPolygon* cur = result; cur != NULL; cur = cur->next) {
+        ++num;
+        int band = find_band(cur, lats_deg, lat_num);
+        for (const LinkedGeoLoop* loop = cur->first; loop != NULL; loop = loop->next) {
+            for (const LinkedLatLng* point = loop->first; point != NULL; point = point->next) {
+                const LinkedLatLng* next = point->next ? point->next : loop->first;
+                Vect3 v1, v2, mid;
+                LatLng mid_latlng;
+                vect3_from_lat_lng(&point->vertex, &v1);
+                vect3_from_lat_lng(&next->vertex, &v2);
+                vect3_sum(&v1, &v2, &mid);
+                vect3_normalize(&mid);
+                vect3_to_lat_lng(&mid, &mid_latlng);
+
+                if (!check_band_lat(point->vertex.lat, lats_deg, lat_num, band)
+                    || !check_band_lat(mid_latlng.lat, lats_deg, lat_num, band))
+                {
+                    printf("[fail] edge leaves band %d: ", band);
+                    print_latlng(&point->vertex);
+                    printf(" - ");
+                    print_latlng(&next->vertex);
+                    print_nl();
+                    failed = true;
+                }
+            }
+        }
+    }
+    if (num != polygon_num) {
+        printf("[fail] %d polygons expected, got %d\n", polygon_num, num);
+        failed = true;
+    }
+
+    printf("%s split into %d bands: %d polygons\n", wkt, lat_num + 1, num);
+
+    free_linked_geo_polygon(result);
+    free_linked_geo_polygon(polygon);
+
+    if (failed)
+        exit(EXIT_FAILURE);
+}
+
+
+int find_band(const LinkedGeoPolygon* polygon, const double* lats_deg, int lat_num) {
+    /* Band of the middle of vertex latitude range, all vertices may be on parallels */
+    double min_lat = 90;
+    double max_lat = -90;
+    for (const LinkedLatLng* point = polygon->first->first; point != NULL; point = point->next) {
+        double lat = radsToDegs(point->vertex.lat);
+        min_lat = fmin(min_lat, lat);
+        max_lat = fmax(max_lat, lat);
+    }
+    int band = 0;
+    while (band < lat_num && (min_lat + max_lat) / 2 > lats_deg[band])
+        ++band;
+    return band;
+}
+
+
+bool check_band_lat(double lat, const double* lats_deg, int lat_num, int band) {
+    double lat_deg = radsToDegs(lat);
+    return (band == 0 || lat_deg > lats_deg[band - 1] - BAND_TOLERANCE)
+        && (band == lat_num || lat_deg < lats_deg[band] + BAND_TOLERANCE);
+}
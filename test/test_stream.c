@@ -0,0 +1,190 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "../stream.h"
+
+/* Compressed output read back as input: round trip, concatenated members and truncated files */
+
+#define PAYLOAD_LINE_NUM (100000)
+#define WRITE_CHUNK_SIZE (7777)
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t size;
+} Text;
+
+static void check_compression(const char* dir, const char* ext, const char* truncated_error);
+static void make_payload(Text* payload, int line_num, int seed);
+static void write_stream(const char* path, const Text* payload);
+static void check_read(const char* path, const Text* expected, const char* expected_error);
+static void read_file(const char* path, Text* text);
+static void write_file(const char* path, const char* data, size_t len);
+static void text_append(Text* text, const char* data, size_t len);
+static void check(bool condition, const char* message);
+
+
+int main() {
+    char dir[] = "/tmp/test_stream_XXXXXX";
+    check(mkdtemp(dir) != NULL, "failed to create temporary directory");
+
+    check(stream_compression_from_path("a.gz") == StreamCompression_Gzip
+          && stream_compression_from_path("a.zst") == StreamCompression_Zstd
+          && stream_compression_from_path("a.txt") == StreamCompression_None
+          && stream_compression_from_path(".gz") == StreamCompression_None,
+          "compression from path");
+
+    check_compression(dir, "", NULL);
+#ifdef HAVE_ZLIB
+    check_compression(dir, ".gz", "Unexpected end of gzip data");
+#endif
+#ifdef HAVE_ZSTD
+    check_compression(dir, ".zst", "Unexpected end of zstd data");
+#endif
+    check(rmdir(dir) == 0, "failed to remove temporary directory");
+}
+
+
+void check_compression(const char* dir, const char* ext, const char* truncated_error) {
+    char path1[64], path2[64], path3[64];
+    snprintf(path1, sizeof(path1), "%s/1%s", dir, ext);
+    snprintf(path2, sizeof(path2), "%s/2%s", dir, ext);
+    snprintf(path3, sizeof(path3), "%s/3%s", dir, ext);
+
+    /* Payload of several input blocks, blocks are 1 MiB */
+    Text payload1 = {0};
+    make_payload(&payload1, PAYLOAD_LINE_NUM, 1);
+    check(payload1.len > 3 * 1024 * 1024, "payload is not several blocks");
+    write_stream(path1, &payload1);
+    check_read(path1, &payload1, NULL);
+
+    /* Short payload is only written when stream is closed */
+    Text payload2 = {0};
+    make_payload(&payload2, 3, 2);
+    write_stream(path2, &payload2);
+    check_read(path2, &payload2, NULL);
+
+    /* Concatenated files are read as one stream */
+    Text file = {0}, joined = {0};
+    read_file(path1, &file);
+    read_file(path2, &file);
+    write_file(path3, file.data, file.len);
+    text_append(&joined, payload1.data, payload1.len);
+    text_append(&joined, payload2.data, payload2.len);
+    check_read(path3, &joined, NULL);
+
+    /* Truncated compressed data is an error, in the middle and in the trailer */
+    if (truncated_error) {
+        file.len = 0;
+        read_file(path1, &file);
+        write_file(path3, file.data, file.len / 2);
+        check_read(path3, &payload1, truncated_error);
+        write_file(path3, file.data, file.len - 1);
+        check_read(path3, &payload1, truncated_error);
+    }
+
+    printf("%s: ok\n", stream_compression_to_string(stream_compression_from_path(path1)));
+    remove(path1);
+    remove(path2);
+    remove(path3);
+    free(payload1.data);
+    free(payload2.data);
+    free(file.data);
+    free(joined.data);
+}
+
+
+void make_payload(Text* payload, int line_num, int seed) {
+    srand(seed);
+    char line[128];
+    for (int i = 0; i < line_num; ++i) {
+        int lat = rand() % 90;
+        int lng = rand() % 180;
+        snprintf(line, sizeof(line), "POLYGON((%d %d, %d %d, %d %d, %d %d))\n",
+                 lng, lat, -lng, lat, -lng, -lat, lng, lat);
+        text_append(payload, line, strlen(line));
+    }
+}
+
+
+void write_stream(const char* path, const Text* payload) {
+    /* Several writes, no flush before close */
+    FILE* file = output_stream_open(path, stream_compression_from_path(path));
+    check(file != NULL, "failed to open output stream");
+    for (size_t pos = 0; pos < payload->len; pos += WRITE_CHUNK_SIZE) {
+        size_t len = (payload->len - pos < WRITE_CHUNK_SIZE) ? payload->len - pos : WRITE_CHUNK_SIZE;
+        check(fwrite(payload->data + pos, 1, len, file) == len, "failed to write output stream");
+    }
+    check(fclose(file) == 0, "failed to close output stream");
+}
+
+
+void check_read(const char* path, const Text* expected, const char* expected_error) {
+    /* With an error, data read before it is a prefix of expected */
+    InputStream* stream = input_stream_open(path);
+    check(stream != NULL, "failed to open input stream");
+    Text text = {0};
+    const char* data;
+    size_t len;
+    int block_num = 0;
+    while (input_stream_next(stream, &data, &len)) {
+        text_append(&text, data, len);
+        ++block_num;
+    }
+    const char* error = input_stream_error(stream);
+    if ((error == NULL) != (expected_error == NULL) || (error && strcmp(error, expected_error) != 0)) {
+        printf("[fail] %s: error `%s', expected `%s'\n", path, error ? error : "", expected_error ? expected_error : "");
+        exit(EXIT_FAILURE);
+    }
+    bool ok = expected_error
+        ? text.len <= expected->len && memcmp(text.data, expected->data, text.len) == 0
+        : text.len == expected->len && memcmp(text.data, expected->data, text.len) == 0;
+    if (!ok) {
+        printf("[fail] %s: read %zu bytes in %d blocks, expected %zu\n", path, text.len, block_num, expected->len);
+        exit(EXIT_FAILURE);
+    }
+    input_stream_close(stream);
+    free(text.data);
+}
+
+
+void read_file(const char* path, Text* text) {
+    /* Appended to text */
+    FILE* file = fopen(path, "rb");
+    check(file != NULL, "failed to open file");
+    char buffer[64 * 1024];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text_append(text, buffer, len);
+    fclose(file);
+}
+
+
+void write_file(const char* path, const char* data, size_t len) {
+    FILE* file = fopen(path, "wb");
+    check(file != NULL && fwrite(data, 1, len, file) == len && fclose(file) == 0, "failed to write file");
+}
+
+
+void text_append(Text* text, const char* data, size_t len) {
+    if (text->len + len > text->size) {
+        size_t size = (text->size > 0) ? text->size * 2 : 4096;
+        while (size < text->len + len)
+            size *= 2;
+        text->data = realloc(text->data, size);
+        check(text->data != NULL, "failed to allocate text");
+        text->size = size;
+    }
+    memcpy(text->data + text->len, data, len);
+    text->len += len;
+}
+
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        printf("[fail] %s\n", message);
+        exit(EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,79 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <h3/h3api.h>
+#include <split/transform.h>
+
+static const char Input[] = "POLYGON((-170 10, 170 10, 170 -10, -170 -10, -170 10))";
+
+static const char Output[] =
+    "MULTIPOLYGON(((-170.000000 10.000000, -180.000000 10.151082, -180.000000 -10.151082,"
+    " -170.000000 -10.000000, -170.000000 10.000000)), ((170.000000 10.000000, 170.000000 -10.000000,"
+    " 180.000000 -10.151082, 180.000000 10.151082, 170.000000 10.000000)))";
+
+static const char BandsOutput[] =
+    "MULTIPOLYGON(((-170.0000000 10.0000000, -180.0000000 10.1510817, -180.0000000 0.0000000,"
+    " -170.0000000 0.0000000, -170.0000000 10.0000000)), ((-180.0000000 -10.1510817,"
+    " -170.0000000 -10.0000000, -170.0000000 0.0000000, -180.0000000 0.0000000,"
+    " -180.0000000 -10.1510817)), ((170.0000000 10.0000000, 170.0000000 0.0000000,"
+    " 180.0000000 0.0000000, 180.0000000 10.1510817, 170.0000000 10.0000000)),"
+    " ((170.0000000 -10.0000000, 180.0000000 -10.1510817, 180.0000000 0.0000000,"
+    " 170.0000000 0.0000000, 170.0000000 -10.0000000)))";
+
+static const char NotSplitInput[] = "POLYGON((10 10, 20 10, 20 20, 10 10))";
+static const char NotSplitOutput[] =
+    "POLYGON((10.000000 10.000000, 20.000000 10.000000, 20.000000 20.000000, 10.000000 10.000000))";
+
+static void check_output(
+    const char* in, const SplitTransformOptions* options, PrintBuffer* out, const char* expected);
+static void check_error(const char* in, SplitFormat format, SplitTransformError expected, size_t error_pos);
+
+
+int main() {
+    /* Output buffer is shared, so shorter output after longer one is checked too */
+    PrintBuffer out;
+    print_buffer_init(&out);
+    check_output(Input, NULL, &out, Output);
+    check_output(NotSplitInput, NULL, &out, NotSplitOutput);
+
+    double band_lats[] = {0.0};
+    SplitTransformOptions options = {CoordMode_E7, band_lats, 1};
+    check_output(Input, &options, &out, BandsOutput);
+    print_buffer_free(&out);
+
+    check_error("POLYGON((1 1, 2 2, 3 x))", SplitFormat_Wkt, SplitTransformError_Parse, 22);
+    check_error("", SplitFormat_Wkt, SplitTransformError_Parse, 0);
+    check_error(Input, (SplitFormat) 1, SplitTransformError_UnsupportedFormat, 0);
+}
+
+
+void check_output(
+    const char* in, const SplitTransformOptions* options, PrintBuffer* out, const char* expected)
+{
+    SplitTransformResult result = split_transform(
+        in, strlen(in), SplitFormat_Wkt, SplitFormat_Wkt, options, out);
+    if (result.error) {
+        printf("[fail] `%s': %s\n", in, split_transform_error_to_string(result.error));
+        exit(EXIT_FAILURE);
+    }
+    if (out->len != strlen(expected) || memcmp(out->data, expected, out->len) != 0) {
+        printf("[fail] `%s': got `%.*s'\n", in, (int) out->len, out->data);
+        exit(EXIT_FAILURE);
+    }
+    printf("`%s': ok\n", in);
+}
+
+
+void check_error(const char* in, SplitFormat format, SplitTransformError expected, size_t error_pos) {
+    PrintBuffer out;
+    print_buffer_init(&out);
+    SplitTransformResult result = split_transform(in, strlen(in), format, SplitFormat_Wkt, NULL, &out);
+    print_buffer_free(&out);
+
+    printf("`%s': %s at %d\n", in, split_transform_error_to_string(result.error), (int) result.error_pos);
+    if (result.error != expected || result.error_pos != error_pos || out.len != 0) {
+        printf("[fail] `%s' at %d expected\n", split_transform_error_to_string(expected), (int) error_pos);
+        exit(EXIT_FAILURE);
+    }
+}